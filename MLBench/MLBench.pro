@@ -0,0 +1,27 @@
+# ##########################
+# Configuration      #
+# ##########################
+TEMPLATE = app
+QT -= network
+TARGET = mlbench
+NAME = mlbench
+MLPATH =..
+DESTDIR = $$MLPATH
+
+CONFIG += mainApp console
+macx:CONFIG -= app_bundle
+include($$MLPATH/MLDemos_variables.pri)
+
+# ##########################
+# Source Files       #
+# ##########################
+HEADERS += $$MLDEMOS/pluginLoader.h \
+	$$MLDEMOS/rewardSource.h \
+	$$MLDEMOS/optimization_test_functions.h \
+	benchMaximizers.h
+
+SOURCES += main.cpp \
+	benchMaximizers.cpp \
+	$$MLDEMOS/pluginLoader.cpp \
+	$$MLDEMOS/rewardSource.cpp \
+	$$MLDEMOS/mymaths.cpp
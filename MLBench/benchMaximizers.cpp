@@ -0,0 +1,451 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License,
+version 3 as published by the Free Software Foundation.
+
+This library is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#include <public.h>
+#include <rewardSource.h>
+#include "benchMaximizers.h"
+#include <QProcess>
+#include <QThread>
+#include <QTime>
+#include <algorithm>
+#include <stdio.h>
+
+using namespace std;
+
+#define BENCHMARK_CANVAS 512 // nominal drawing size, nothing is drawn
+
+static int FunctionType(QString name)
+{
+	bool ok = false;
+	int type = name.toInt(&ok);
+	if(ok) return type >= RewardFunction::GRIEWANGK && type <= RewardFunction::SIXHUMP ? type : -1;
+	for(int t=RewardFunction::GRIEWANGK; t<=RewardFunction::SIXHUMP; t++)
+	{
+		if(QString(RewardFunction::Name(t)).startsWith(name, Qt::CaseInsensitive)) return t;
+	}
+	return -1;
+}
+
+// splits a csv line on commas, except inside double quotes ("" is a quote)
+static QStringList SplitCSV(QString line)
+{
+	QStringList fields;
+	QString field;
+	bool bQuoted = false;
+	FOR(i, line.size())
+	{
+		QChar c = line[i];
+		if(bQuoted)
+		{
+			if(c != '"') field += c;
+			else if(i+1 < (u32)line.size() && line[i+1] == '"') field += line[++i];
+			else bQuoted = false;
+		}
+		else if(c == '"') bQuoted = true;
+		else if(c == ',')
+		{
+			fields << field;
+			field.clear();
+		}
+		else field += c;
+	}
+	fields << field;
+	return fields;
+}
+
+static QString JSONString(QString text)
+{
+	text.replace("\\", "\\\\").replace("\"", "\\\"");
+	return "\"" + text + "\"";
+}
+
+/************************************************************************/
+/*                            BenchmarkRun                              */
+/************************************************************************/
+BenchmarkRun::BenchmarkRun()
+	: function(0), dim(0), seed(0), evaluations(0), evaluationsToTarget(-1), iterations(0), best(0), time(0)
+{
+}
+
+bool BenchmarkRun::operator<(const BenchmarkRun &other) const
+{
+	if(algorithm != other.algorithm) return algorithm < other.algorithm;
+	if(function != other.function) return function < other.function;
+	if(dim != other.dim) return dim < other.dim;
+	return seed < other.seed;
+}
+
+QString BenchmarkRun::CSVHeader()
+{
+	return "algorithm,function,dim,seed,evaluations,evaluationsToTarget,best,iterations,time";
+}
+
+QString BenchmarkRun::ToCSV() const
+{
+	QString name = algorithm;
+	name.replace("\"", "\"\"");
+	return QString("\"%1\",%2,%3,%4,%5,%6,%7,%8,%9")
+			.arg(name).arg(RewardFunction::Name(function)).arg(dim).arg(seed)
+			.arg(evaluations).arg(evaluationsToTarget).arg(best, 0, 'g', 8)
+			.arg(iterations).arg(time, 0, 'f', 3);
+}
+
+QString BenchmarkRun::ToJSON() const
+{
+	return QString("{\"algorithm\": %1, \"function\": %2, \"dim\": %3, \"seed\": %4, \"evaluations\": %5, "
+				   "\"evaluationsToTarget\": %6, \"best\": %7, \"iterations\": %8, \"time\": %9}")
+			.arg(JSONString(algorithm)).arg(JSONString(RewardFunction::Name(function))).arg(dim).arg(seed)
+			.arg(evaluations).arg(evaluationsToTarget).arg(best, 0, 'g', 8)
+			.arg(iterations).arg(time, 0, 'f', 3);
+}
+
+bool BenchmarkRun::FromCSV(QString line)
+{
+	QStringList fields = SplitCSV(line.trimmed());
+	if(fields.size() != 9) return false;
+	algorithm = fields[0];
+	function = FunctionType(fields[1]);
+	dim = fields[2].toInt();
+	seed = fields[3].toInt();
+	evaluations = fields[4].toInt();
+	evaluationsToTarget = fields[5].toInt();
+	best = fields[6].toDouble();
+	iterations = fields[7].toInt();
+	time = fields[8].toDouble();
+	return function >= 0 && dim > 0;
+}
+
+/************************************************************************/
+/*                          MaximizeBenchmark                           */
+/************************************************************************/
+MaximizeBenchmark::MaximizeBenchmark()
+	: seeds(10), budget(10000), maxIterations(100000), target(0.99), jobs(QThread::idealThreadCount()),
+	  worker(-1), bList(false), bHelp(false)
+{
+}
+
+QString MaximizeBenchmark::Usage()
+{
+	return
+		"usage: mlbench [options]\n"
+		"Runs the maximizer plugins on the analytic test functions and reports, for each run,\n"
+		"the evaluations needed to reach the target, the best value within the budget and the wall time.\n"
+		"\n"
+		"  -a, --algorithm <name[:param=value,...]>  maximizer (see --list) and the parameters to load into it,\n"
+		"                                            e.g. \"Stochastic Methods:maximizeType=2,kSpin=10\" (repeatable,\n"
+		"                                            default: every maximizer with its default parameters)\n"
+		"  -f, --function <name,...|all>             Griewangk, Rastragin, Schwefel, Ackley, Six-Humps (2D only)\n"
+		"                                            or their index (default: all)\n"
+		"  -d, --dim <n,...>                         dimensions of the search space (default: 2)\n"
+		"  -s, --seeds <n>                           seeds 0 to n-1 (default: 10)\n"
+		"  -e, --evaluations <n>                     evaluation budget per run (default: 10000)\n"
+		"  -i, --iterations <n>                      iteration cap per run (default: 100000)\n"
+		"  -t, --target <value>                      reward to reach, between 0 and 1 (default: 0.99)\n"
+		"  -j, --jobs <n>                            seeds run in parallel (default: number of cores)\n"
+		"  -o, --output <file>                       .json for JSON, csv otherwise (default: csv on stdout)\n"
+		"  -p, --plugins <dir>                       plugin directory (default: next to the executable)\n"
+		"  -l, --list                                lists the available maximizers\n"
+		"\n"
+		"No display is needed: the plugins create no widgets and take the parameters given here.\n";
+}
+
+bool MaximizeBenchmark::Parse(QStringList arguments, QString &error)
+{
+	functions.clear();
+	dims.clear();
+	for(int i=1; i<arguments.size(); i++)
+	{
+		QString option = arguments[i];
+		if(option == "-h" || option == "--help") {bHelp = true; continue;}
+		if(option == "-l" || option == "--list") {bList = true; continue;}
+		if(i+1 >= arguments.size())
+		{
+			error = QString("missing value for %1").arg(option);
+			return false;
+		}
+		QString value = arguments[++i];
+		bool ok = true;
+		if(option == "-a" || option == "--algorithm") specs << value;
+		else if(option == "-f" || option == "--function")
+		{
+			QStringList names = value.split(",", QString::SkipEmptyParts);
+			FOR(n, names.size())
+			{
+				if(names[n].compare("all", Qt::CaseInsensitive) == 0)
+				{
+					for(int t=RewardFunction::GRIEWANGK; t<=RewardFunction::SIXHUMP; t++) functions.push_back(t);
+					continue;
+				}
+				int type = FunctionType(names[n]);
+				if(type < 0)
+				{
+					error = QString("unknown function %1").arg(names[n]);
+					return false;
+				}
+				functions.push_back(type);
+			}
+		}
+		else if(option == "-d" || option == "--dim")
+		{
+			QStringList values = value.split(",", QString::SkipEmptyParts);
+			FOR(n, values.size())
+			{
+				int dim = values[n].toInt(&ok);
+				if(!ok || dim < 1) break;
+				dims.push_back(dim);
+			}
+		}
+		else if(option == "-s" || option == "--seeds") seeds = value.toInt(&ok);
+		else if(option == "-e" || option == "--evaluations") budget = value.toInt(&ok);
+		else if(option == "-i" || option == "--iterations") maxIterations = value.toInt(&ok);
+		else if(option == "-t" || option == "--target") target = value.toDouble(&ok);
+		else if(option == "-j" || option == "--jobs") jobs = value.toInt(&ok);
+		else if(option == "-o" || option == "--output") output = value;
+		else if(option == "-p" || option == "--plugins") plugins = value;
+		else if(option == "--worker") worker = value.toInt(&ok);
+		else
+		{
+			error = QString("unknown option %1").arg(option);
+			return false;
+		}
+		if(!ok)
+		{
+			error = QString("wrong value for %1: %2").arg(option).arg(value);
+			return false;
+		}
+	}
+	if(!functions.size()) for(int t=RewardFunction::GRIEWANGK; t<=RewardFunction::SIXHUMP; t++) functions.push_back(t);
+	if(!dims.size()) dims.push_back(2);
+	seeds = max(1, seeds);
+	jobs = max(1, jobs);
+	return true;
+}
+
+bool MaximizeBenchmark::Resolve(const std::vector<MaximizeInterface *> &available, QString &error)
+{
+	algorithms.clear();
+	if(!specs.size())
+	{
+		FOR(i, available.size())
+		{
+			BenchmarkAlgorithm algorithm;
+			algorithm.maximizer = available[i];
+			algorithms.push_back(algorithm);
+		}
+	}
+	FOR(i, specs.size())
+	{
+		QString name = specs[i].section(':', 0, 0).trimmed();
+		QStringList params = specs[i].section(':', 1).split(",", QString::SkipEmptyParts);
+		BenchmarkAlgorithm algorithm;
+		algorithm.maximizer = NULL;
+		FOR(j, available.size())
+		{
+			if(available[j]->GetName().compare(name, Qt::CaseInsensitive) == 0) algorithm.maximizer = available[j];
+		}
+		if(!algorithm.maximizer)
+		{
+			error = QString("unknown maximizer %1").arg(name);
+			return false;
+		}
+		FOR(j, params.size())
+		{
+			bool ok = false;
+			float value = params[j].section('=', 1).toFloat(&ok);
+			if(!ok)
+			{
+				error = QString("wrong parameter %1 for %2").arg(params[j]).arg(name);
+				return false;
+			}
+			algorithm.params.push_back(make_pair(params[j].section('=', 0, 0).trimmed(), value));
+		}
+		algorithms.push_back(algorithm);
+	}
+	if(!algorithms.size())
+	{
+		error = "no maximizer available";
+		return false;
+	}
+	return true;
+}
+
+BenchmarkRun MaximizeBenchmark::Run(const BenchmarkAlgorithm &algorithm, int function, int dim, int seed)
+{
+	BenchmarkRun run;
+	run.function = function;
+	run.seed = seed;
+	// several algorithms can share one interface (the same maximizer with other parameters), and the interface
+	// keeps the last values it was given in its ParameterMap, so each run loads its own again
+	// (a parameter that an algorithm leaves out keeps whatever value the interface last had)
+	FOR(i, algorithm.params.size()) algorithm.maximizer->LoadParams(algorithm.params[i].first, algorithm.params[i].second);
+	run.algorithm = algorithm.maximizer->GetAlgoString();
+
+	// the maximizers draw their random numbers from the global generators, starting from their constructor
+	srand(seed);
+#ifndef WIN32
+	srand48(seed);
+#endif
+	Maximizer *maximizer = algorithm.maximizer->GetMaximizer();
+	if(!maximizer) return run;
+	RewardFunction reward(function, dim);
+	run.dim = reward.Dim();
+
+	QTime timer;
+	timer.start();
+	maximizer->Train(reward, fVec(BENCHMARK_CANVAS, BENCHMARK_CANVAS));
+	run.best = maximizer->MaximumValue();
+	if(run.best >= target) run.evaluationsToTarget = maximizer->Evaluations();
+	while(maximizer->Evaluations() < budget && run.iterations < maxIterations && !maximizer->hasConverged())
+	{
+		maximizer->Test(maximizer->Maximum());
+		run.iterations++;
+		double value = maximizer->MaximumValue();
+		if(value > run.best) run.best = value;
+		if(run.evaluationsToTarget < 0 && value >= target) run.evaluationsToTarget = maximizer->Evaluations();
+	}
+	run.time = timer.elapsed();
+	run.evaluations = maximizer->Evaluations();
+	delete maximizer;
+	return run;
+}
+
+std::vector<BenchmarkRun> MaximizeBenchmark::Run(int seed)
+{
+	std::vector<BenchmarkRun> runs;
+	FOR(a, algorithms.size())
+	{
+		FOR(f, functions.size())
+		{
+			FOR(d, dims.size())
+			{
+				// six-hump camel is only defined in 2D
+				if(functions[f] == RewardFunction::SIXHUMP && dims[d] != 2) continue;
+				runs.push_back(Run(algorithms[a], functions[f], dims[d], seed));
+			}
+		}
+	}
+	return runs;
+}
+
+std::vector<BenchmarkRun> MaximizeBenchmark::RunAll(QStringList arguments)
+{
+	std::vector<BenchmarkRun> runs;
+	if(jobs == 1 || seeds == 1)
+	{
+		FOR(s, seeds)
+		{
+			std::vector<BenchmarkRun> seedRuns = Run(s);
+			runs.insert(runs.end(), seedRuns.begin(), seedRuns.end());
+		}
+		std::sort(runs.begin(), runs.end());
+		return runs;
+	}
+
+	// each seed runs in its own process, as the maximizers share the global random generators
+	QString program = arguments.first();
+	QStringList environment = QProcess::systemEnvironment();
+	environment << "OMP_NUM_THREADS=1"; // the workers already keep the cores busy
+	std::vector<QProcess *> processes;
+	ivec processSeeds;
+	int next = 0;
+	while(next < seeds || processes.size())
+	{
+		while((int)processes.size() < jobs && next < seeds)
+		{
+			QProcess *process = new QProcess();
+			process->setEnvironment(environment);
+			process->start(program, arguments.mid(1) << "--worker" << QString::number(next));
+			processes.push_back(process);
+			processSeeds.push_back(next++);
+		}
+		for(int i=processes.size()-1; i>=0; i--)
+		{
+			QProcess *process = processes[i];
+			process->waitForFinished(20);
+			if(process->state() != QProcess::NotRunning) continue;
+			QStringList lines = QString(process->readAllStandardOutput()).split("\n", QString::SkipEmptyParts);
+			int count = 0;
+			FOR(j, lines.size())
+			{
+				BenchmarkRun run;
+				if(!run.FromCSV(lines[j])) continue;
+				runs.push_back(run);
+				count++;
+			}
+			if(process->exitStatus() != QProcess::NormalExit || process->exitCode() != 0 || !count)
+			{
+				fprintf(stderr, "seed %d failed\n%s\n", processSeeds[i], process->readAllStandardError().constData());
+			}
+			delete process;
+			processes.erase(processes.begin() + i);
+			processSeeds.erase(processSeeds.begin() + i);
+		}
+	}
+	std::sort(runs.begin(), runs.end());
+	return runs;
+}
+
+QString MaximizeBenchmark::ToCSV(const std::vector<BenchmarkRun> &runs)
+{
+	QString text = BenchmarkRun::CSVHeader() + "\n";
+	FOR(i, runs.size()) text += runs[i].ToCSV() + "\n";
+	return text;
+}
+
+QString MaximizeBenchmark::ToJSON(const std::vector<BenchmarkRun> &runs)
+{
+	QString text = QString("{\n\"budget\": %1,\n\"iterations\": %2,\n\"target\": %3,\n\"seeds\": %4,\n\"runs\": [\n")
+			.arg(budget).arg(maxIterations).arg(target).arg(seeds);
+	FOR(i, runs.size()) text += "\t" + runs[i].ToJSON() + (i+1 < runs.size() ? ",\n" : "\n");
+	text += "]\n}\n";
+	return text;
+}
+
+QString MaximizeBenchmark::Summary(const std::vector<BenchmarkRun> &runs)
+{
+	QString text = QString("%1 %2 %3 %4 %5 %6 %7\n")
+			.arg("algorithm", -32).arg("function", -10).arg("dim", 4).arg("success", 8)
+			.arg("evals", 8).arg("best", 8).arg("ms", 9);
+	// the runs are sorted, each group is a contiguous range
+	for(u32 start=0, end=0; start < runs.size(); start = end)
+	{
+		const BenchmarkRun &first = runs[start];
+		ivec toTarget;
+		double best = 0, time = 0;
+		for(end = start; end < runs.size(); end++)
+		{
+			const BenchmarkRun &run = runs[end];
+			if(run.algorithm != first.algorithm || run.function != first.function || run.dim != first.dim) break;
+			if(run.evaluationsToTarget >= 0) toTarget.push_back(run.evaluationsToTarget);
+			best += run.best;
+			time += run.time;
+		}
+		int count = end - start;
+		int median = -1;
+		if(toTarget.size())
+		{
+			std::nth_element(toTarget.begin(), toTarget.begin() + toTarget.size()/2, toTarget.end());
+			median = toTarget[toTarget.size()/2];
+		}
+		text += QString("%1 %2 %3 %4 %5 %6 %7\n")
+				.arg(first.algorithm.left(32), -32).arg(RewardFunction::Name(first.function), -10).arg(first.dim, 4)
+				.arg(QString("%1/%2").arg(toTarget.size()).arg(count), 8).arg(median, 8)
+				.arg(best/count, 8, 'f', 4).arg(time/count, 9, 'f', 1);
+	}
+	return text;
+}
@@ -0,0 +1,94 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License,
+version 3 as published by the Free Software Foundation.
+
+This library is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#ifndef _BENCH_MAXIMIZERS_H_
+#define _BENCH_MAXIMIZERS_H_
+
+#include <vector>
+#include <QString>
+#include <QStringList>
+#include <interfaces.h>
+
+// one maximizer on one test function, in one dimension, from one seed
+struct BenchmarkRun
+{
+	QString algorithm;	// GetAlgoString() of the interface
+	int function;		// RewardFunction type
+	int dim;
+	int seed;
+	int evaluations;
+	int evaluationsToTarget; // -1 if the target was never reached
+	int iterations;
+	double best;		// best reward reached within the budget
+	double time;		// wall time of the run, in milliseconds
+
+	BenchmarkRun();
+	bool operator<(const BenchmarkRun &other) const;
+	QString ToCSV() const;
+	QString ToJSON() const;
+	bool FromCSV(QString line);
+	static QString CSVHeader();
+};
+
+// maximizer interface and the parameters loaded into it before each run
+// the names are the ones of the saved parameter files (e.g. maximizeType, kSpin)
+struct BenchmarkAlgorithm
+{
+	MaximizeInterface *maximizer;
+	std::vector< std::pair<QString, float> > params;
+};
+
+// runs the maximizers on the analytic test functions, without showing any GUI
+class MaximizeBenchmark
+{
+	QStringList specs; // algorithms as given on the command line
+	BenchmarkRun Run(const BenchmarkAlgorithm &algorithm, int function, int dim, int seed);
+
+public:
+	std::vector<BenchmarkAlgorithm> algorithms;
+	ivec functions;
+	ivec dims;
+	int seeds;
+	int budget;			// evaluations per run
+	int maxIterations;	// for the maximizers that stop evaluating before the budget
+	double target;
+	int jobs;			// seeds running in parallel, each in its own process
+	int worker;			// seed to run if this process is a worker, -1 otherwise
+	QString output;
+	QString plugins;
+	bool bList, bHelp;
+
+	MaximizeBenchmark();
+	// reads the command line, returns false and a message in error if the options are wrong
+	bool Parse(QStringList arguments, QString &error);
+	// picks the algorithms among the loaded maximizers (all of them if none were given)
+	bool Resolve(const std::vector<MaximizeInterface *> &available, QString &error);
+	static QString Usage();
+
+	// every run of one seed, in this process
+	std::vector<BenchmarkRun> Run(int seed);
+	// every run of every seed, the seeds are spread over jobs worker processes
+	std::vector<BenchmarkRun> RunAll(QStringList arguments);
+
+	QString ToCSV(const std::vector<BenchmarkRun> &runs);
+	QString ToJSON(const std::vector<BenchmarkRun> &runs);
+	// success rate, median evaluations to target, mean best value and time per algorithm, function and dimension
+	QString Summary(const std::vector<BenchmarkRun> &runs);
+};
+
+#endif // _BENCH_MAXIMIZERS_H_
@@ -0,0 +1,46 @@
+##############################
+#                            #
+#  Plugin Benchmark Target   #
+#                            #
+##############################
+
+# included by the bench<Name>.pro of each plugin folder, which defines
+# NAME (bench<Name>), PLUGIN (the plugin target, e.g. mld_GMM) and MLPATH
+TEMPLATE = app
+QT -= network
+TARGET = $$NAME
+DESTDIR = $$MLPATH
+
+CONFIG += mainApp console
+macx:CONFIG -= app_bundle
+include($$MLPATH/MLDemos_variables.pri)
+win32:LIBS += -lpsapi
+
+# the baseline lives next to the .pro file, so that it is versioned with the plugin it measures
+DEFINES += BENCH_PLUGIN=\\\"$$PLUGIN\\\" \
+	BENCH_BASELINE=\\\"$$_PRO_FILE_PWD_/benchmark.csv\\\"
+INCLUDEPATH += $$MLPATH/MLBench \
+	$$MLPATH/MLRun
+
+# ##########################
+# Source Files       #
+# ##########################
+HEADERS += $$MLDEMOS/pluginLoader.h \
+	$$MLDEMOS/datasetManager.h \
+	$$MLDEMOS/rewardSource.h \
+	$$MLPATH/MLRun/runner.h \
+	$$MLPATH/MLBench/benchPlugins.h
+
+SOURCES += $$MLPATH/MLBench/benchPluginMain.cpp \
+	$$MLPATH/MLBench/benchPlugins.cpp \
+	$$MLPATH/MLRun/runner.cpp \
+	$$MLDEMOS/pluginLoader.cpp \
+	$$MLDEMOS/datasetManager.cpp \
+	$$MLDEMOS/rewardSource.cpp \
+	$$MLDEMOS/mymaths.cpp
+
+# make benchmark: runs the benchmark against the stored baseline
+# DESTDIR is relative to the build directory, which is not the source one in shadow builds
+benchmark.commands = $$OUT_PWD/$$DESTDIR/$$TARGET
+benchmark.depends = $$OUT_PWD/$$DESTDIR/$$TARGET
+QMAKE_EXTRA_TARGETS += benchmark
@@ -0,0 +1,80 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License,
+version 3 as published by the Free Software Foundation.
+
+This library is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#include <QCoreApplication>
+#include <stdio.h>
+#include <pluginLoader.h>
+#include "benchPlugins.h"
+
+// BENCH_PLUGIN and BENCH_BASELINE are defined by benchPlugin.pri, from the .pro file of each plugin benchmark
+int main(int argc, char *argv[])
+{
+	QStringList arguments;
+	for(int i=0; i<argc; i++) arguments << QString::fromLocal8Bit(argv[i]);
+
+	PluginBenchmark benchmark(BENCH_PLUGIN, BENCH_BASELINE);
+	QString error;
+	if(!benchmark.Parse(arguments, error))
+	{
+		fprintf(stderr, "%s\n\n%s", qPrintable(error), qPrintable(benchmark.Usage()));
+		return 1;
+	}
+	if(benchmark.bHelp)
+	{
+		printf("%s", qPrintable(benchmark.Usage()));
+		return 0;
+	}
+
+	// the plugin interfaces build no parameter widget under a QCoreApplication, no display is needed
+	QCoreApplication a(argc, argv);
+
+	PluginLoader loader;
+	QDir directory = benchmark.plugins.isEmpty() ? PluginLoader::PluginDirectory() : QDir(benchmark.plugins);
+	if(!loader.Load(directory, "*" + benchmark.plugin + "*"))
+	{
+		fprintf(stderr, "unable to load %s from %s\n", qPrintable(benchmark.plugin), qPrintable(directory.absolutePath()));
+		return 1;
+	}
+
+	std::vector<PluginBenchRun> runs = benchmark.Run(loader);
+	if(benchmark.bUpdate)
+	{
+		if(!benchmark.SaveBaseline(runs))
+		{
+			fprintf(stderr, "unable to write %s\n", qPrintable(benchmark.baseline));
+			return 1;
+		}
+		printf("\nbaseline written to %s\n", qPrintable(benchmark.baseline));
+		return 0;
+	}
+	// without a complete baseline nothing is tracked, which is a failure rather than a pass
+	int missing = 0;
+	int regressions = benchmark.Compare(runs, missing);
+	if(regressions < 0)
+	{
+		fprintf(stderr, "\nno timings in %s, record them with --update on the reference machine\n", qPrintable(benchmark.baseline));
+		return 3;
+	}
+	if(regressions) return 2;
+	if(missing)
+	{
+		fprintf(stderr, "\nthe baseline %s is incomplete, record it again with --update\n", qPrintable(benchmark.baseline));
+		return 3;
+	}
+	return 0;
+}
@@ -0,0 +1,465 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License,
+version 3 as published by the Free Software Foundation.
+
+This library is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#include <public.h>
+#include <basicMath.h>
+#include <mymaths.h>
+#include <rewardSource.h>
+#include <runner.h>
+#include "benchPlugins.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+#include <map>
+#include <float.h>
+#include <stdio.h>
+
+using namespace std;
+
+#define BENCH_CLASSES 3		// classes (and clusters) of the synthetic blobs
+#define BENCH_LENGTH 50		// points per synthetic trajectory
+#define BENCH_TRAIN_NOISE 0.1	// milliseconds, differences below this are never regressions
+#define BENCH_TEST_NOISE 0.5	// microseconds, same for the per-sample timings
+
+// splits a csv line on commas, except inside double quotes ("" is a quote)
+static QStringList SplitCSV(QString line)
+{
+	QStringList fields;
+	QString field;
+	bool bQuoted = false;
+	FOR(i, line.size())
+	{
+		QChar c = line[i];
+		if(bQuoted)
+		{
+			if(c != '"') field += c;
+			else if(i+1 < (u32)line.size() && line[i+1] == '"') field += line[++i];
+			else bQuoted = false;
+		}
+		else if(c == '"') bQuoted = true;
+		else if(c == ',')
+		{
+			fields << field;
+			field.clear();
+		}
+		else field += c;
+	}
+	fields << field;
+	return fields;
+}
+
+// the first count samples, row-major
+static fvec Contiguous(const std::vector<fvec> &samples, int count)
+{
+	int dim = samples.size() ? samples[0].size() : 0;
+	fvec data(count*dim);
+	FOR(i, count)
+	{
+		FOR(d, dim) data[i*dim + d] = samples[i][d];
+	}
+	return data;
+}
+
+static ivec ParseList(QString value, bool &ok)
+{
+	ivec list;
+	QStringList values = value.split(",", QString::SkipEmptyParts);
+	ok = values.size() > 0;
+	FOR(i, values.size())
+	{
+		int n = values[i].toInt(&ok);
+		if(!ok || n < 1) return ivec();
+		list.push_back(n);
+	}
+	return list;
+}
+
+/************************************************************************/
+/*                            PluginBenchRun                            */
+/************************************************************************/
+PluginBenchRun::PluginBenchRun()
+	: count(0), dim(0), train(0), batch(0), single(0)
+{
+}
+
+QString PluginBenchRun::Key() const
+{
+	return QString("%1|%2|%3|%4").arg(type).arg(algorithm).arg(count).arg(dim);
+}
+
+QString PluginBenchRun::CSVHeader()
+{
+	return "type,algorithm,count,dim,train,batch,single";
+}
+
+QString PluginBenchRun::ToCSV() const
+{
+	QString name = algorithm;
+	name.replace("\"", "\"\"");
+	return QString("%1,\"%2\",%3,%4,%5,%6,%7")
+			.arg(type).arg(name).arg(count).arg(dim)
+			.arg(train, 0, 'f', 3).arg(batch < 0 ? QString() : QString::number(batch, 'f', 3)).arg(single, 0, 'f', 3);
+}
+
+bool PluginBenchRun::FromCSV(QString line)
+{
+	QStringList fields = SplitCSV(line.trimmed());
+	if(fields.size() != 7) return false;
+	type = fields[0];
+	algorithm = fields[1];
+	count = fields[2].toInt();
+	dim = fields[3].toInt();
+	train = fields[4].toDouble();
+	batch = fields[5].isEmpty() ? -1 : fields[5].toDouble();
+	single = fields[6].toDouble();
+	return count > 0 && dim > 0;
+}
+
+/************************************************************************/
+/*                           PluginBenchmark                            */
+/************************************************************************/
+PluginBenchmark::PluginBenchmark(QString plugin, QString baseline)
+	: plugin(plugin), baseline(baseline), testCount(1000), repeats(3), seed(0), threshold(0.25f), bUpdate(false), bHelp(false)
+{
+	counts.push_back(100);
+	counts.push_back(1000);
+	dims.push_back(2);
+	dims.push_back(8);
+}
+
+QString PluginBenchmark::Usage() const
+{
+	return QString(
+		"usage: bench%1 [options]\n"
+		"Times the training, the batch testing and the single-sample testing of every algorithm of the\n"
+		"%1 plugin on seeded synthetic data, and compares the timings to the baseline file.\n"
+		"Exits with 2 if any timing is slower than the baseline by more than the threshold, and with 3 if\n"
+		"the baseline is missing, empty, or lacks some of the timings (record it with --update).\n"
+		"Batch timings go through TestBatch, they are left empty for the clusterers, the multi-class\n"
+		"classifiers and the maximizers, which have no batch entry point.\n"
+		"\n"
+		"  -c, --counts <n,...>       training set sizes (iterations for maximizers, default: 100,1000)\n"
+		"  -d, --dims <n,...>         dimensions (default: 2,8)\n"
+		"  -n, --test <n>             samples in the test batch (default: 1000)\n"
+		"  -r, --repeats <n>          each timing is the best of n runs (default: 3)\n"
+		"  -s, --seed <n>             seed of the synthetic data (default: 0)\n"
+		"  -t, --threshold <value>    relative slowdown counted as a regression (default: 0.25)\n"
+		"  -b, --baseline <file>      baseline timings (default: %2)\n"
+		"  -u, --update               writes the timings to the baseline instead of comparing them\n"
+		"  -P, --plugins <dir>        plugin directory (default: next to the executable)\n"
+		"\n"
+		"The baselines depend on the machine: regenerate them with --update on the reference machine.\n"
+		"No display is needed: the plugins create no widgets and run with their default parameters.\n")
+		.arg(plugin.section('_', -1)).arg(baseline);
+}
+
+bool PluginBenchmark::Parse(QStringList arguments, QString &error)
+{
+	for(int i=1; i<arguments.size(); i++)
+	{
+		QString option = arguments[i];
+		if(option == "-h" || option == "--help") {bHelp = true; continue;}
+		if(option == "-u" || option == "--update") {bUpdate = true; continue;}
+		if(i+1 >= arguments.size())
+		{
+			error = QString("missing value for %1").arg(option);
+			return false;
+		}
+		QString value = arguments[++i];
+		bool ok = true;
+		if(option == "-c" || option == "--counts") counts = ParseList(value, ok);
+		else if(option == "-d" || option == "--dims") dims = ParseList(value, ok);
+		else if(option == "-n" || option == "--test") testCount = value.toInt(&ok);
+		else if(option == "-r" || option == "--repeats") repeats = value.toInt(&ok);
+		else if(option == "-s" || option == "--seed") seed = value.toInt(&ok);
+		else if(option == "-t" || option == "--threshold") threshold = value.toFloat(&ok);
+		else if(option == "-b" || option == "--baseline") baseline = value;
+		else if(option == "-P" || option == "--plugins") plugins = value;
+		else
+		{
+			error = QString("unknown option %1").arg(option);
+			return false;
+		}
+		if(!ok)
+		{
+			error = QString("wrong value for %1: %2").arg(option).arg(value);
+			return false;
+		}
+	}
+	testCount = max(1, testCount);
+	repeats = max(1, repeats);
+	return true;
+}
+
+void PluginBenchmark::Blobs(int count, int dim, int classes, std::vector<fvec> &samples, ivec &labels)
+{
+	vector<fvec> centers(classes);
+	FOR(c, classes)
+	{
+		centers[c].resize(dim);
+		FOR(d, dim) centers[c][d] = ranf();
+	}
+	samples.resize(count);
+	labels.resize(count);
+	FOR(i, count)
+	{
+		labels[i] = i % classes;
+		samples[i] = RandN(dim, 0.f, 0.1f);
+		samples[i] += centers[labels[i]];
+	}
+}
+
+std::vector<fvec> PluginBenchmark::Function(int count, int dim)
+{
+	vector<fvec> samples(count);
+	FOR(i, count)
+	{
+		fvec &sample = samples[i];
+		sample.resize(dim);
+		float value = 0;
+		FOR(d, dim-1)
+		{
+			sample[d] = ranf();
+			value += sinf(2*PIf*sample[d]) / (d+1);
+		}
+		sample[dim-1] = value + RandN(0.f, 0.05f);
+	}
+	return samples;
+}
+
+std::vector< std::vector<fvec> > PluginBenchmark::Spirals(int count, int dim, int length)
+{
+	const float dT = 0.02f;
+	const float speed = 2.f; // rotation in each plane of two dimensions
+	vector< vector<fvec> > trajectories(max(1, count/length));
+	FOR(t, trajectories.size())
+	{
+		fvec position = RandN(dim, 0.f, 1.f);
+		trajectories[t].resize(length);
+		FOR(i, length)
+		{
+			fvec velocity(dim);
+			FOR(d, dim)
+			{
+				velocity[d] = -position[d];
+				if(d+1 < (u32)dim && !(d%2)) velocity[d] -= speed*position[d+1];
+				if(d%2) velocity[d] += speed*position[d-1];
+			}
+			fvec &point = trajectories[t][i];
+			point.resize(dim*2);
+			FOR(d, dim)
+			{
+				point[d] = position[d];
+				point[dim+d] = velocity[d];
+			}
+			FOR(d, dim) position[d] += velocity[d]*dT;
+		}
+	}
+	return trajectories;
+}
+
+void PluginBenchmark::Measure(PluginLoader &loader, int type, int count, int dim, std::vector<PluginBenchRun> &runs)
+{
+	int interfaces = 0;
+	switch(type)
+	{
+	case Runner::CLASSIFICATION: interfaces = loader.classifiers.size(); break;
+	case Runner::REGRESSION: interfaces = loader.regressors.size(); break;
+	case Runner::CLUSTERING: interfaces = loader.clusterers.size(); break;
+	case Runner::DYNAMICAL: interfaces = loader.dynamicals.size(); break;
+	case Runner::MAXIMIZATION: interfaces = loader.maximizers.size(); break;
+	}
+	if(type == Runner::REGRESSION && dim < 2) return; // one input and the output at least
+
+	FOR(a, interfaces)
+	{
+		PluginBenchRun run;
+		run.type = Runner::TypeName(type);
+		run.count = count;
+		run.dim = dim;
+		run.train = run.batch = run.single = DBL_MAX;
+		FOR(r, repeats)
+		{
+			// every repeat and every algorithm sees the same data and starts from the same random state
+			srand(seed);
+#ifndef WIN32
+			srand48(seed);
+#endif
+			RunReport report;
+			QElapsedTimer timer;
+			double batch = -1; // stays negative for the types without a batch entry point
+			float ratio = count / (float)(count + testCount);
+			switch(type)
+			{
+			case Runner::CLASSIFICATION:
+			{
+				vector<fvec> samples;
+				ivec labels;
+				Blobs(count + testCount, dim, BENCH_CLASSES, samples, labels);
+				Classifier *classifier = loader.classifiers[a]->GetClassifier();
+				run.algorithm = loader.classifiers[a]->GetAlgoString();
+				report = Runner::Classify(classifier, samples, labels, ratio);
+				// the multi-class classifiers have no batch entry point
+				if(!classifier->IsMultiClass())
+				{
+					fvec inputs = Contiguous(samples, testCount), scores(testCount);
+					timer.start();
+					classifier->TestBatch(&inputs[0], &scores[0], testCount, dim);
+					batch = timer.nsecsElapsed()/1e3/testCount;
+				}
+				DEL(classifier);
+			}
+				break;
+			case Runner::REGRESSION:
+			{
+				vector<fvec> samples = Function(count + testCount, dim);
+				Regressor *regressor = loader.regressors[a]->GetRegressor();
+				run.algorithm = loader.regressors[a]->GetAlgoString();
+				report = Runner::Regress(regressor, samples, ivec(samples.size(), 0), ratio);
+				fvec inputs = Contiguous(samples, testCount), outputs(testCount);
+				timer.start();
+				regressor->TestBatch(&inputs[0], &outputs[0], testCount, dim);
+				batch = timer.nsecsElapsed()/1e3/testCount;
+				DEL(regressor);
+			}
+				break;
+			case Runner::CLUSTERING:
+			{
+				vector<fvec> samples;
+				ivec labels;
+				Blobs(count + testCount, dim, BENCH_CLASSES, samples, labels);
+				Clusterer *clusterer = loader.clusterers[a]->GetClusterer();
+				run.algorithm = loader.clusterers[a]->GetAlgoString();
+				report = Runner::Cluster(clusterer, samples, labels, ratio);
+				DEL(clusterer); // no batch entry point for the clusterers
+			}
+				break;
+			case Runner::DYNAMICAL:
+			{
+				vector< vector<fvec> > trajectories = Spirals(count, dim, BENCH_LENGTH);
+				int points = trajectories.size()*BENCH_LENGTH;
+				Dynamical *dynamical = loader.dynamicals[a]->GetDynamical();
+				run.algorithm = loader.dynamicals[a]->GetAlgoString();
+				report = Runner::Dynamize(dynamical, trajectories, ivec(points, 0));
+				// the batch goes through TestBatch, as the rollouts do
+				fvec positions(testCount*dim), velocities(testCount*dim);
+				FOR(i, positions.size()) positions[i] = RandN(0.f, 1.f);
+				timer.start();
+				dynamical->TestBatch(&positions[0], &velocities[0], testCount, dim);
+				batch = timer.nsecsElapsed()/1e3/testCount;
+				DEL(dynamical);
+			}
+				break;
+			case Runner::MAXIMIZATION:
+			{
+				// the maximizers run for count iterations, single is the median iteration, there is no batch
+				Maximizer *maximizer = loader.maximizers[a]->GetMaximizer();
+				run.algorithm = loader.maximizers[a]->GetAlgoString();
+				report = Runner::Maximize(maximizer, RewardFunction(RewardFunction::GRIEWANGK, dim), count, FLT_MAX);
+				DEL(maximizer);
+			}
+				break;
+			}
+			run.train = min(run.train, report.trainTime);
+			run.batch = batch < 0 ? -1 : min(run.batch, batch);
+			run.single = min(run.single, report.Percentile(.5f));
+		}
+		runs.push_back(run);
+		printf("%s\n", qPrintable(run.ToCSV()));
+		fflush(stdout);
+	}
+}
+
+std::vector<PluginBenchRun> PluginBenchmark::Run(PluginLoader &loader)
+{
+	std::vector<PluginBenchRun> runs;
+	printf("%s\n", qPrintable(PluginBenchRun::CSVHeader()));
+	FOR(t, Runner::TYPE_COUNT)
+	{
+		FOR(c, counts.size())
+		{
+			FOR(d, dims.size()) Measure(loader, t, counts[c], dims[d], runs);
+		}
+	}
+	return runs;
+}
+
+bool PluginBenchmark::SaveBaseline(const std::vector<PluginBenchRun> &runs)
+{
+	QFile file(baseline);
+	if(!file.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+	QTextStream stream(&file);
+	stream << "# baseline of bench" << plugin.section('_', -1) << ", regenerate with --update on the reference machine\n";
+	stream << PluginBenchRun::CSVHeader() << "\n";
+	FOR(i, runs.size()) stream << runs[i].ToCSV() << "\n";
+	return true;
+}
+
+int PluginBenchmark::Compare(const std::vector<PluginBenchRun> &runs, int &missing)
+{
+	missing = 0;
+	QFile file(baseline);
+	if(!file.open(QIODevice::ReadOnly | QIODevice::Text)) return -1;
+	map<QString, PluginBenchRun> reference;
+	QTextStream stream(&file);
+	while(!stream.atEnd())
+	{
+		QString line = stream.readLine();
+		if(line.startsWith("#")) continue;
+		PluginBenchRun run;
+		if(run.FromCSV(line)) reference[run.Key()] = run;
+	}
+	if(reference.empty()) return -1;
+
+	int regressions = 0;
+	printf("\n%s %s %6s %4s %21s %21s %21s\n", qPrintable(QString("type").leftJustified(14)), qPrintable(QString("algorithm").leftJustified(32)),
+		   "count", "dim", "train (ms)", "batch (us)", "single (us)");
+	FOR(i, runs.size())
+	{
+		const PluginBenchRun &run = runs[i];
+		QString line = QString("%1 %2 %3 %4").arg(run.type, -14).arg(run.algorithm.left(32), -32).arg(run.count, 6).arg(run.dim, 4);
+		if(!reference.count(run.Key()))
+		{
+			printf("%s   (not in the baseline)\n", qPrintable(line));
+			missing++;
+			continue;
+		}
+		const PluginBenchRun &base = reference[run.Key()];
+		double values[3] = {run.train, run.batch, run.single};
+		double bases[3] = {base.train, base.batch, base.single};
+		double noise[3] = {BENCH_TRAIN_NOISE, BENCH_TEST_NOISE, BENCH_TEST_NOISE};
+		bool bSlower = false;
+		FOR(m, 3)
+		{
+			if(values[m] < 0 || bases[m] < 0) // not measured for this type
+			{
+				line += QString(" %1        ").arg("-", 10);
+				continue;
+			}
+			bool bRegression = values[m] > bases[m]*(1 + threshold) && values[m] - bases[m] > noise[m];
+			line += QString(" %1 (x%2)%3").arg(values[m], 10, 'f', 3).arg(bases[m] > 0 ? values[m]/bases[m] : 1., 0, 'f', 2).arg(bRegression ? "!" : " ");
+			bSlower |= bRegression;
+		}
+		if(bSlower) regressions++;
+		printf("%s%s\n", qPrintable(line), bSlower ? "  SLOWER" : "");
+	}
+	printf("\n%d regression%s above %.0f%%", regressions, regressions == 1 ? "" : "s", threshold*100);
+	if(missing) printf(", %d timing%s not in the baseline", missing, missing == 1 ? "" : "s");
+	printf("\n");
+	return regressions;
+}
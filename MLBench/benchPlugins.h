@@ -0,0 +1,79 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License,
+version 3 as published by the Free Software Foundation.
+
+This library is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#ifndef _BENCH_PLUGINS_H_
+#define _BENCH_PLUGINS_H_
+
+#include <vector>
+#include <QString>
+#include <QStringList>
+#include <pluginLoader.h>
+
+// one algorithm on one synthetic dataset size and dimension
+struct PluginBenchRun
+{
+	QString type;		// Runner::TypeName
+	QString algorithm;	// GetAlgoString() of the interface
+	int count;			// training samples (iterations for the maximizers)
+	int dim;
+	double train;		// wall time of Train, in milliseconds
+	double batch;		// time per sample of a TestBatch call, in microseconds (-1 without a batch entry point)
+	double single;		// median time of a single-sample test, in microseconds
+
+	PluginBenchRun();
+	QString Key() const;
+	QString ToCSV() const;
+	bool FromCSV(QString line);
+	static QString CSVHeader();
+};
+
+// times the algorithms of one plugin on seeded synthetic data and compares them to a stored baseline
+class PluginBenchmark
+{
+	void Measure(PluginLoader &loader, int type, int count, int dim, std::vector<PluginBenchRun> &runs);
+
+public:
+	QString plugin;		// file name of the plugin to load (without prefix and extension)
+	QString baseline;	// csv file of reference timings
+	QString plugins;
+	ivec counts;
+	ivec dims;
+	int testCount;		// samples in the test batch
+	int repeats;		// each timing is the best of this many runs
+	int seed;
+	float threshold;	// relative slowdown above which a timing is a regression
+	bool bUpdate, bHelp;
+
+	PluginBenchmark(QString plugin=QString(), QString baseline=QString());
+	bool Parse(QStringList arguments, QString &error);
+	QString Usage() const;
+
+	std::vector<PluginBenchRun> Run(PluginLoader &loader);
+	// prints each timing next to its baseline, returns the number of regressions (-1 if the baseline has no timings)
+	// missing counts the timings that the baseline does not have
+	int Compare(const std::vector<PluginBenchRun> &runs, int &missing);
+	bool SaveBaseline(const std::vector<PluginBenchRun> &runs);
+
+	// seeded synthetic datasets: gaussian blobs (one per class), a smooth function of the inputs
+	// (stored in the last dimension), and trajectories spiralling into the origin (position then velocity)
+	static void Blobs(int count, int dim, int classes, std::vector<fvec> &samples, ivec &labels);
+	static std::vector<fvec> Function(int count, int dim);
+	static std::vector< std::vector<fvec> > Spirals(int count, int dim, int length);
+};
+
+#endif // _BENCH_PLUGINS_H_
@@ -0,0 +1,89 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License,
+version 3 as published by the Free Software Foundation.
+
+This library is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#include <QCoreApplication>
+#include <QFile>
+#include <QTextStream>
+#include <stdio.h>
+#include <pluginLoader.h>
+#include "benchMaximizers.h"
+
+int main(int argc, char *argv[])
+{
+	QStringList arguments;
+	for(int i=0; i<argc; i++) arguments << QString::fromLocal8Bit(argv[i]);
+
+	MaximizeBenchmark benchmark;
+	QString error;
+	if(!benchmark.Parse(arguments, error))
+	{
+		fprintf(stderr, "%s\n\n%s", qPrintable(error), qPrintable(MaximizeBenchmark::Usage()));
+		return 1;
+	}
+	if(benchmark.bHelp)
+	{
+		printf("%s", qPrintable(MaximizeBenchmark::Usage()));
+		return 0;
+	}
+
+	// the maximizer interfaces build no parameter widget under a QCoreApplication, no display is needed
+	QCoreApplication a(argc, argv);
+
+	PluginLoader loader;
+	loader.Load(benchmark.plugins.isEmpty() ? PluginLoader::PluginDirectory() : QDir(benchmark.plugins));
+	if(benchmark.bList)
+	{
+		FOR(i, loader.maximizers.size())
+		{
+			printf("%s\t(%s)\n", qPrintable(loader.maximizers[i]->GetName()), qPrintable(loader.maximizers[i]->GetAlgoString()));
+		}
+		return 0;
+	}
+	if(!benchmark.Resolve(loader.maximizers, error))
+	{
+		fprintf(stderr, "%s\n", qPrintable(error));
+		return 1;
+	}
+
+	// worker processes hand their runs back to the main one as csv lines
+	if(benchmark.worker >= 0)
+	{
+		std::vector<BenchmarkRun> runs = benchmark.Run(benchmark.worker);
+		FOR(i, runs.size()) printf("%s\n", qPrintable(runs[i].ToCSV()));
+		return 0;
+	}
+
+	std::vector<BenchmarkRun> runs = benchmark.RunAll(arguments);
+	if(benchmark.output.isEmpty())
+	{
+		printf("%s", qPrintable(benchmark.ToCSV(runs)));
+		return 0;
+	}
+	QFile file(benchmark.output);
+	if(!file.open(QIODevice::WriteOnly | QIODevice::Text))
+	{
+		fprintf(stderr, "unable to write %s\n", qPrintable(benchmark.output));
+		return 1;
+	}
+	QTextStream stream(&file);
+	if(benchmark.output.endsWith(".json", Qt::CaseInsensitive)) stream << benchmark.ToJSON(runs);
+	else stream << benchmark.ToCSV(runs);
+	file.close();
+	printf("%s", qPrintable(benchmark.Summary(runs)));
+	return 0;
+}
@@ -58,6 +58,11 @@ HEADERS += basicMath.h \
 	obstacles.h \
 	regressor.h \
 	maximize.h \
+	rewardSource.h \
+	sampleBatch.h \
+	queryWorker.h \
+	pluginLoader.h \
+	rollout.h \
 	dynamical.h \
     clusterer.h \
     compare.h
@@ -74,5 +79,9 @@ SOURCES += canvas.cpp \
     mlsaving.cpp \
     mymaths.cpp \
 	roc.cpp \
+	rewardSource.cpp \
+	queryWorker.cpp \
+	pluginLoader.cpp \
+	rollout.cpp \
     widget.cpp \
     compare.cpp
@@ -443,12 +443,25 @@ void Canvas::DrawSamples(QPainter &painter)
 	int radius = 10;
 	painter.setRenderHint(QPainter::Antialiasing, true);
 	painter.setRenderHint(QPainter::HighQualityAntialiasing);
+	// the samples are drawn one label after the other so that the painter style (and the svg groups)
+	// only change once per label, the samples outside of the canvas are skipped
+	QRectF bounds = QRectF(0, 0, width(), height()).adjusted(-radius, -radius, radius, radius);
+	map<int, vector<QPointF> > points;
 	for(int i=0; i<data->GetCount(); i++)
 	{
 		if(data->GetFlag(i) == _TRAJ) continue;
-		int label = data->GetLabel(i);
 		QPointF point = toCanvasCoords(data->GetSample(i));
-		Canvas::drawSample(painter, point, (data->GetFlag(i)==_TRAJ)?5:radius, bDisplaySingle ? 0 : label);
+		if(!bounds.contains(point)) continue;
+		points[bDisplaySingle ? 0 : data->GetLabel(i)].push_back(point);
+	}
+	for(map<int, vector<QPointF> >::iterator it = points.begin(); it != points.end(); ++it)
+	{
+		Canvas::setSampleStyle(painter, it->first);
+		FOR(i, it->second.size())
+		{
+			QPointF point = it->second[i];
+			painter.drawEllipse(QRectF(point.x()-radius/2., point.y()-radius/2., radius, radius));
+		}
 	}
 }
 
@@ -171,11 +171,8 @@ public:
 		painter.drawLine(QPointF(x+radius, y-radius), QPointF(x-radius, y+radius));
 	}
 
-	static void drawSample(QPainter &painter, QPointF point, float radius, int label)
+	static void setSampleStyle(QPainter &painter, int label)
 	{
-		float x = point.x();
-		float y = point.y();
-
 		QColor color = SampleColor[label%SampleColorCnt];
 		QColor edge = Qt::black;
 		if(label == 1)
@@ -183,9 +180,17 @@ public:
 			color = Qt::black;
 			edge = Qt::white;
 		}
-		//		radius = 10;
 		painter.setBrush(color);
 		painter.setPen(edge);
+	}
+
+	static void drawSample(QPainter &painter, QPointF point, float radius, int label)
+	{
+		float x = point.x();
+		float y = point.y();
+
+		//		radius = 10;
+		setSampleStyle(painter, label);
 		painter.drawEllipse(QRectF(x-radius/2.,y-radius/2.,radius,radius));
 
 	}
@@ -53,6 +53,7 @@ public:
 	int type;
 	std::vector< std::vector<f32pair> > rocdata;
 	std::vector<const char *> roclabels;
+	std::vector< std::vector<RocCurve> > roccurves; // computed once from rocdata by UpdateRoc
 
 	Classifier(): posClass(0), bFixedThreshold(true), classThresh(0.5f), classSpan(0.1f), bSingleClass(true), bUsesDrawTimer(true), bMultiClass(false), type(CLASS_NONE)
 	{
@@ -66,13 +67,29 @@ public:
 	std::vector <fvec> GetSamples(){return samples;};
 
 	virtual void Train(std::vector< fvec > samples, ivec labels){};
+	// optional: trains on samples[indices] (all of them if indices is empty) without a copy of the dataset
+	// labels has one entry per sample, returns false if the model needs its own copy (Train is used then)
+	virtual bool TrainInPlace(const std::vector< fvec > &samples, const ivec &labels, const ivec &indices){return false;};
 	virtual fvec TestMulti(const fvec &sample){ return fvec();};
 	virtual float Test(const fvec &sample){ return 0; };
 	virtual float Test(const fVec &sample){ if(dim==2) return Test((fvec)sample); fvec s = (fvec)sample; s.resize(dim,0); return Test(s);};
+	// batch of count samples, row-major (count x dim), one Test score per sample
+	// models with a vectorized or reentrant evaluation can override it
+	virtual void TestBatch(const float *samples, float *scores, int count, int dim)
+	{
+		fvec sample(dim);
+		FOR(i, count)
+		{
+			FOR(d, dim) sample[d] = samples[i*dim + d];
+			scores[i] = Test(sample);
+		}
+	};
 	virtual char *GetInfoString(){return NULL;};
 	bool SingleClass(){return bSingleClass;};
 	bool UsesDrawTimer(){return bUsesDrawTimer;};
 	bool IsMultiClass(){return bMultiClass;};
+	// to be called whenever rocdata has been filled
+	void UpdateRoc(){roccurves = GetRocCurves(rocdata, bMultiClass);};
 	int Dim(){return dim;};
 };
 
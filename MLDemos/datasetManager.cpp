@@ -23,13 +23,14 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include "datasetManager.h"
 #include <fstream>
 #include <map>
+#include <algorithm>
 
 using namespace std;
 
 u32 DatasetManager::IDCount = 0;
 
 DatasetManager::DatasetManager(int dimension)
-: size(dimension)
+: size(dimension), capacity(0), nextSampleId(0), resampledType(-1), resampledCount(0), resampledDim(0)
 {
 	ID = IDCount++;
 	perm = NULL;
@@ -43,6 +44,8 @@ DatasetManager::~DatasetManager()
 void DatasetManager::Clear()
 {
 	samples.clear();
+	sampleIds.clear();
+	resampled.clear();
 	obstacles.clear();
 	flags.clear();
 	labels.clear();
@@ -57,6 +60,7 @@ void DatasetManager::AddSample(fvec sample, int label, dsmFlags flag)
 	size = sample.size();
 
 	samples.push_back(sample);
+	sampleIds.push_back(nextSampleId++);
 	labels.push_back(label);
 	flags.push_back(flag);
 	KILL(perm);
@@ -71,6 +75,7 @@ void DatasetManager::AddSamples(std::vector< fvec > newSamples, ivec newLabels,
 		if(newSamples[i].size())
 		{
 			samples.push_back(newSamples[i]);
+			sampleIds.push_back(nextSampleId++);
 			if(i < newFlags.size()) flags.push_back(newFlags[i]);
 			else flags.push_back(_UNUSED);
 		}
@@ -86,6 +91,56 @@ void DatasetManager::AddSamples(DatasetManager &newSamples)
 	AddSamples(newSamples.GetSamples(), newSamples.GetLabels(), newSamples.GetFlags());
 }
 
+int DatasetManager::Append(const std::vector< fvec > &newSamples, const ivec &newLabels, const std::vector< ipair > &newSequences)
+{
+	int start = samples.size();
+	samples.reserve(start + newSamples.size());
+	sampleIds.reserve(start + newSamples.size());
+	FOR(i, newSamples.size())
+	{
+		if(newSamples[i].size()) size = newSamples[i].size();
+		samples.push_back(newSamples[i]);
+		sampleIds.push_back(nextSampleId++);
+		labels.push_back(i < newLabels.size() ? newLabels[i] : 0);
+		flags.push_back(_UNUSED);
+	}
+	// the new sequences all come after the existing ones, they stay sorted
+	FOR(i, newSequences.size())
+	{
+		ipair sequence(newSequences[i].first + start, newSequences[i].second + start);
+		if(sequence.first < start || sequence.second >= samples.size() || sequence.first > sequence.second) continue;
+		for(int j=sequence.first; j<=sequence.second; j++) flags[j] = _TRAJ;
+		sequences.push_back(sequence);
+	}
+	KILL(perm); // regenerated by GetSamples when needed
+
+	// the oldest samples are evicted by chunks of a quarter of the capacity, so that their cost
+	// is amortized over the appended batches
+	int count = samples.size();
+	if(!capacity || count <= capacity + capacity/4) return 0;
+	int evicted = count - capacity;
+	samples.erase(samples.begin(), samples.begin() + evicted);
+	sampleIds.erase(sampleIds.begin(), sampleIds.begin() + evicted);
+	labels.erase(labels.begin(), labels.begin() + evicted);
+	flags.erase(flags.begin(), flags.begin() + evicted);
+	int kept = 0;
+	FOR(i, sequences.size())
+	{
+		ipair sequence = sequences[i];
+		if(sequence.second < evicted) continue;
+		sequence.first = max(sequence.first, evicted) - evicted;
+		sequence.second -= evicted;
+		if(sequence.first == sequence.second) // nothing left to draw
+		{
+			flags[sequence.first] = _UNUSED;
+			continue;
+		}
+		sequences[kept++] = sequence;
+	}
+	sequences.resize(kept);
+	return evicted;
+}
+
 void DatasetManager::RemoveSample(unsigned int index)
 {
 	if(index >= samples.size()) return;
@@ -98,10 +153,12 @@ void DatasetManager::RemoveSample(unsigned int index)
 	for (unsigned int i = index; i < samples.size()-1; i++)
 	{
 		samples[i] = samples[i+1];
+		sampleIds[i] = sampleIds[i+1];
 		labels[i] = labels[i+1];
 		flags[i] = flags[i+1];
 	}
 	samples.pop_back();
+	sampleIds.pop_back();
 	labels.pop_back();
 	flags.pop_back();
 
@@ -231,13 +288,18 @@ void DatasetManager::ResetFlags()
 
 void DatasetManager::SetSample(int index, fvec sample)
 {
-	if(index >= 0 && index < samples.size()) samples[index] = sample;
+	if(index >= 0 && index < samples.size())
+	{
+		samples[index] = sample;
+		sampleIds[index] = nextSampleId++;
+	}
 }
 
 std::vector< fvec > DatasetManager::GetSamples(u32 count, dsmFlags flag, dsmFlags replaceWith)
 {
 	std::vector< fvec > selected;
-	if (!samples.size() || !perm) return selected;
+	if (!samples.size()) return selected;
+	if (!perm) perm = randPerm(samples.size());
 
 	if (!count)
 	{
@@ -265,52 +327,110 @@ std::vector< fvec > DatasetManager::GetSamples(u32 count, dsmFlags flag, dsmFlag
 	return selected;
 }
 
-std::vector< std::vector < fvec > > DatasetManager::GetTrajectories(int resampleType, int resampleCount, int centerType, float dT, int zeroEnding)
+// count points resampled from the length samples starting at first, written to dest (count x dim)
+static void ResampleSequence(const std::vector<fvec> &samples, int first, int length, int dim, int resampleType, int count, float *dest)
 {
+	if(resampleType != 1) // none, the sequence is cut
+	{
+		FOR(j, min(count, length)) FOR(d, dim) dest[j*dim + d] = samples[first + j][d];
+		return;
+	}
+	// uniform, same as interpolate()
+	FOR(i, count)
+	{
+		float ratio = i/(float)count;
+		int index = (int)(ratio*length);
+		float remainder = ratio*length - (float)(int)(ratio*length);
+		const float *pt0 = &samples[first + index][0];
+		float *pt = dest + i*dim;
+		if(remainder == 0 || index == length-1)
+		{
+			FOR(d, dim) pt[d] = pt0[d];
+		}
+		else // we need to interpolate
+		{
+			const float *pt1 = &samples[first + index + 1][0];
+			FOR(d, dim) pt[d] = pt0[d]*(1.f-remainder) + pt1[d]*remainder;
+		}
+	}
+}
 
+std::vector< std::vector < fvec > > DatasetManager::GetTrajectories(int resampleType, int resampleCount, int centerType, float dT, int zeroEnding)
+{
 	// we split the data into trajectories
 	vector< vector<fvec> > trajectories;
 	if(!sequences.size() || !samples.size()) return trajectories;
 	int dim = samples[0].size();
-	trajectories.resize(sequences.size());
-	FOR(i, sequences.size())
+	int count = sequences.size();
+	if(resampleType != 1) // no resampling, the trajectories are cut to the shortest one
 	{
-		int length = sequences[i].second-sequences[i].first+1;
-		trajectories[i].resize(length);
-		FOR(j, length)
-		{
-			trajectories[i][j].resize(dim*2);
-			// copy data
-			FOR(d, dim) trajectories[i][j][d] = samples[sequences[i].first + j][d];
-		}
+		FOR(i, count) resampleCount = min(resampleCount, sequences[i].second-sequences[i].first+1);
 	}
+	if(resampleCount <= 0) return trajectories;
 
-	switch(resampleType)
+	// the resampled positions are kept from one call to the next,
+	// only the sequences that are new or whose samples have changed are resampled
+	if(resampleType != resampledType || resampleCount != resampledCount || dim != resampledDim)
 	{
-	case 0: // none
+		resampled.clear();
+		resampledType = resampleType;
+		resampledCount = resampleCount;
+		resampledDim = dim;
+	}
+	map<u32, ResampledSequence> current;
+	vector<ResampledSequence> duplicates; // sequences starting at the same sample, not cached
+	duplicates.reserve(count);
+	vector<ResampledSequence*> entries(count);
+	ivec missing;
+	FOR(i, count)
 	{
-		FOR(i,sequences.size())
+		int first = sequences[i].first, length = sequences[i].second - first + 1;
+		const u32 *ids = &sampleIds[first];
+		u32 key = ids[0];
+		ResampledSequence *entry;
+		if(current.count(key))
 		{
-			int cnt = sequences[i].second-sequences[i].first+1;
-			if(resampleCount > cnt) resampleCount = cnt;
+			duplicates.push_back(ResampledSequence());
+			entry = &duplicates.back();
 		}
-		FOR(i, trajectories.size())
+		else
 		{
-			while(trajectories[i].size() > resampleCount) trajectories[i].pop_back();
+			entry = &current[key];
+			map<u32, ResampledSequence>::iterator cached = resampled.find(key);
+			if(cached != resampled.end() && cached->second.ids.size() == length && std::equal(ids, ids + length, cached->second.ids.begin()))
+			{
+				entry->ids.swap(cached->second.ids);
+				entry->points.swap(cached->second.points);
+				entries[i] = entry;
+				continue;
+			}
 		}
+		entry->ids.assign(ids, ids + length);
+		entry->points.resize(resampleCount*dim);
+		entries[i] = entry;
+		missing.push_back(i);
 	}
-		break;
-	case 1: // uniform
+	resampled.swap(current); // drops the sequences that are gone
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) if(missing.size() > 1)
+#endif
+	for(int m=0; m<missing.size(); m++)
 	{
-		FOR(i, trajectories.size())
-		{
-			vector<fvec> trajectory = trajectories[i];
-			trajectories[i] = interpolate(trajectory, resampleCount);
-		}
-	}
-		break;
+		int i = missing[m];
+		int first = sequences[i].first, length = sequences[i].second - first + 1;
+		ResampleSequence(samples, first, length, dim, resampleType, resampleCount, &entries[i]->points[0]);
 	}
 
+	// positions and velocities of all the trajectories, contiguous (count x resampleCount x 2dim)
+	int stride = dim*2;
+	int points = resampleCount*stride;
+	fvec store(count*points, 0.f);
+	FOR(i, count)
+	{
+		const float *source = &entries[i]->points[0];
+		float *dest = &store[i*points];
+		FOR(j, resampleCount) FOR(d, dim) dest[j*stride + d] = source[j*dim + d];
+	}
 
 	if(centerType)
 	{
@@ -336,76 +456,55 @@ std::vector< std::vector < fvec > > DatasetManager::GetTrajectories(int resample
 			int label = p->first;
 			centers[label] /= p->second;
 		}
-		FOR(i, trajectories.size())
+		FOR(i, count)
 		{
-			if(centerType == 1)
-			{
-				fvec difference = centers[trajLabels[i]] - trajectories[i].back();
-				FOR(j, resampleCount) trajectories[i][j] += difference;
-			}
-			else
-			{
-				fvec difference = centers[trajLabels[i]] - trajectories[i][0];
-				FOR(j, resampleCount) trajectories[i][j] += difference;
-			}
+			float *trajectory = &store[i*points];
+			const float *reference = centerType == 1 ? trajectory + (resampleCount-1)*stride : trajectory;
+			const fvec &center = centers[trajLabels[i]];
+			fvec difference(dim);
+			FOR(d, dim) difference[d] = center[d] - reference[d];
+			FOR(j, resampleCount) FOR(d, dim) trajectory[j*stride + d] += difference[d];
 		}
 	}
 
-	float maxV = -FLT_MAX;
 	// we compute the velocity
-	FOR(i, trajectories.size())
+	fvec maxVs(count, -FLT_MAX);
+#ifdef _OPENMP
+#pragma omp parallel for if(count*points > 65536)
+#endif
+	for(int i=0; i<count; i++)
 	{
+		float *trajectory = &store[i*points];
+		float maxV = -FLT_MAX;
 		FOR(j, resampleCount-1)
 		{
+			float *pt = trajectory + j*stride;
 			FOR(d, dim)
 			{
-				float velocity = (trajectories[i][j+1][d] - trajectories[i][j][d]) / dT;
-				trajectories[i][j][dim + d] = velocity;
+				float velocity = (pt[stride + d] - pt[d]) / dT;
+				pt[dim + d] = velocity;
 				if(velocity > maxV) maxV = velocity;
 			}
 		}
-		if(!zeroEnding)
+		if(!zeroEnding && resampleCount > 1)
 		{
-			FOR(d, dim)
-			{
-				trajectories[i][resampleCount-1][dim + d] = trajectories[i][resampleCount-2][dim + d];
-			}
+			FOR(d, dim) trajectory[(resampleCount-1)*stride + dim + d] = trajectory[(resampleCount-2)*stride + dim + d];
 		}
+		maxVs[i] = maxV;
 	}
+	float maxV = *max_element(maxVs.begin(), maxVs.end());
 
-	// we normalize the velocities as the variance of the data
-	fvec mean, sigma;
-	mean.resize(dim,0);
-	int cnt = 0;
-	sigma.resize(dim,0);
-	FOR(i, trajectories.size())
+	// we normalize the velocities by the largest one
+	trajectories.resize(count);
+	FOR(i, count)
 	{
+		float *trajectory = &store[i*points];
+		trajectories[i].resize(resampleCount);
 		FOR(j, resampleCount)
 		{
-			mean += trajectories[i][j];
-			cnt++;
-		}
-	}
-	mean /= cnt;
-	FOR(i, trajectories.size())
-	{
-		FOR(j, resampleCount)
-		{
-			fvec diff = (mean - trajectories[i][j]);
-			FOR(d,dim) sigma[d] += diff[d]*diff[d];
-		}
-	}
-	sigma /= cnt;
-
-	FOR(i, trajectories.size())
-	{
-		FOR(j, resampleCount)
-		{
-			FOR(d, dim)
-			{
-				trajectories[i][j][dim + d] /= maxV;
-				//trajectories[i][j][dim + d] /= sqrt(sigma[d]);
-			}
+			float *pt = trajectory + j*stride;
+			FOR(d, dim) pt[dim + d] /= maxV;
+			trajectories[i][j] = fvec(pt, pt + stride);
 		}
 	}
 	return trajectories;
@@ -483,6 +582,7 @@ bool DatasetManager::Load(const char *filename)
 		file >> label;
 		file >> flag;
 		samples.push_back(sample);
+		sampleIds.push_back(nextSampleId++);
 		labels.push_back(label);
 		flags.push_back((dsmFlags)flag);
 	}
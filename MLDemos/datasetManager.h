@@ -20,6 +20,7 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #define _DATASET_MANAGER_H_
 
 #include <vector>
+#include <map>
 #include "public.h"
 
 enum DatasetManagerFlags
@@ -235,6 +236,25 @@ protected:
 
 	u32 *perm;
 
+	int capacity; // maximum number of samples kept by Append, 0 for no limit
+
+	// every sample gets a new id when it is added or modified, the ids move along with the samples
+	std::vector<u32> sampleIds;
+
+	u32 nextSampleId;
+
+	// resampled positions of a sequence (count x dim), reused by GetTrajectories as long as
+	// the samples of the sequence (ids) and the resampling parameters stay the same
+	struct ResampledSequence
+	{
+		std::vector<u32> ids;
+		fvec points;
+	};
+
+	std::map<u32, ResampledSequence> resampled; // indexed by the id of the first sample
+
+	int resampledType, resampledCount, resampledDim;
+
 public:
 	DatasetManager(int dimension = 2);
 
@@ -250,6 +270,14 @@ public:
 
 	void AddSamples(DatasetManager &newSamples);
 
+	// appends the samples in O(newSamples), sequences index the new samples (starting at 0)
+	// when over capacity the oldest samples are evicted, returns the number of evicted samples
+	int Append(const std::vector< fvec > &newSamples, const ivec &newLabels, const std::vector< ipair > &newSequences);
+
+	void SetCapacity(int capacity){this->capacity = capacity;}
+
+	int GetCapacity(){return capacity;}
+
 	void AddSequence(int start, int stop);
 
 	void AddSequence(ipair newSequence);
@@ -274,6 +302,9 @@ public:
 
 	std::vector< fvec > GetSamples(){return samples;}
 
+	// read-only access, for the callers that do not need their own copy
+	const std::vector< fvec > &Samples() const {return samples;}
+
 	std::vector< fvec > GetSamples(u32 count, dsmFlags flag=_UNUSED, dsmFlags replaceWith=_TRAIN);
 
 	ipair GetSequence(unsigned int index){return index < sequences.size() ? sequences[index] : ipair(-1,-1);}
@@ -28,6 +28,7 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include "public.h"
 #include "basicMath.h"
 #include "drawSVG.h"
+#include "rollout.h"
 
 using namespace std;
 
@@ -45,93 +46,110 @@ DrawSVG::~DrawSVG()
 
 }
 
+#define STREAM_CHUNK 1024 // streamlines integrated and written together
+#define OPACITY_LEVELS 16 // segments are grouped in one path per opacity level
+#define RESOLUTION 0.5f // pixels, shorter segments are merged with the next ones
+
+SvgStream::SvgStream(QString filename, int w, int h, QString title, QString description)
+	: file(filename), w(w), h(h), layers(0)
+{
+	if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return;
+	QString header = QString("<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"no\"?>\n"
+							 "<svg width=\"%1\" height=\"%2\" viewBox=\"0 0 %1 %2\"\n"
+							 " xmlns=\"http://www.w3.org/2000/svg\" xmlns:xlink=\"http://www.w3.org/1999/xlink\" version=\"1.2\" baseProfile=\"tiny\">\n"
+							 "<title>%3</title>\n<desc>%4</desc>\n").arg(w).arg(h).arg(Qt::escape(title)).arg(Qt::escape(description));
+	file.write(header.toUtf8());
+}
+
+SvgStream::~SvgStream()
+{
+	if(!file.isOpen()) return;
+	file.write("</svg>\n");
+	file.close();
+}
+
+void SvgStream::Append(const QByteArray &svg)
+{
+	if(!file.isOpen()) return;
+	int start = svg.indexOf("<defs>");
+	if(start < 0) start = svg.indexOf("</desc>") + 7;
+	int stop = svg.lastIndexOf("</svg>");
+	if(start < 7 || stop < start) return;
+	// every generator numbers its gradients from the start
+	QByteArray prefix = "layer" + QByteArray::number(layers) + "_";
+	QByteArray body = svg.mid(start, stop - start);
+	body.replace("id=\"", "id=\"" + prefix);
+	body.replace("url(#", "url(#" + prefix);
+	body.replace("xlink:href=\"#", "xlink:href=\"#" + prefix);
+	file.write("<g id=\"layer" + QByteArray::number(layers++) + "\">\n");
+	file.write(body);
+	file.write("</g>\n");
+}
+
+SvgLayer::SvgLayer(int w, int h)
+{
+	generator.setOutputDevice(&buffer);
+	generator.setSize(QSize(w, h));
+	generator.setViewBox(QRect(0, 0, w, h));
+	painter.begin(&generator);
+}
+
+QByteArray SvgLayer::Finish()
+{
+	painter.end();
+	return buffer.data();
+}
+
 void DrawSVG::Write(QString filename)
 {
 	if(!canvas) return;
-	QSvgGenerator generator;
-	generator.setFileName(filename);
-	generator.setSize(QSize(canvas->width(), canvas->height()));
-	generator.setTitle("MLDemos screenshot");
-	generator.setDescription("Generated with MLDemos");
-	QPainter painter;
-	painter.begin(&generator);
-	// we need to paint the different layers:
-	// confidence map
-	// samples + trajectories + reward
-	canvas->Paint(painter, true);
+	w = canvas->width();
+	h = canvas->height();
+	SvgStream stream(filename, w, h, "MLDemos screenshot", "Generated with MLDemos");
+	if(!stream.isOpen()) return;
+	// we need to paint the different layers, each one is written to disk before the next one is painted
+	{
+		// confidence map
+		// samples + trajectories + reward
+		SvgLayer layer(w, h);
+		canvas->Paint(layer.painter, true);
+		stream.Append(layer.Finish());
+	}
 
 	if(canvas->bDisplayLearned)
 	{
 		// learned model
-		if(classifier) drawClass->DrawModel(canvas, painter, classifier);
-		if(regressor) drawRegr->DrawModel(canvas, painter, regressor);
-		if(dynamical) drawDyn->DrawModel(canvas, painter, dynamical);
-		if(clusterer) drawClust->DrawModel(canvas, painter, clusterer);
+		{
+			SvgLayer layer(w, h);
+			if(classifier) drawClass->DrawModel(canvas, layer.painter, classifier);
+			if(regressor) drawRegr->DrawModel(canvas, layer.painter, regressor);
+			if(dynamical) drawDyn->DrawModel(canvas, layer.painter, dynamical);
+			if(clusterer) drawClust->DrawModel(canvas, layer.painter, clusterer);
+			stream.Append(layer.Finish());
+		}
 		if(dynamical)
 		{
-			int cnt = 10000; // not too many or it will make unreadable files
+			int cnt = 10000; // the streamlines are simplified to the output resolution
 			int steps = 8;
-			VectorsFast(cnt, steps, painter);
+			Vectors(cnt, steps, stream);
 		}
 		if(maximizer)
 		{
-			Maximization(painter);
+			SvgLayer layer(w, h);
+			Maximization(layer.painter);
+			stream.Append(layer.Finish());
 		}
 	}
 
 	if(canvas->bDisplayInfo)
 	{
 		// model info
-		if(classifier) drawClass->DrawInfo(canvas, painter, classifier);
-		if(regressor) drawRegr->DrawInfo(canvas, painter, regressor);
-		if(dynamical) drawDyn->DrawInfo(canvas, painter, dynamical);
-		if(clusterer) drawClust->DrawInfo(canvas, painter, clusterer);
-	}
-	painter.end();
-}
-
-void DrawSVG::Vectors(int count, int steps, QPainter &painter)
-{
-	if(!dynamical) return;
-	float dT = dynamical->dT;// * (dynamical->count/100.f);
-	//float dT = 0.02f;
-	fvec sample;
-	sample.resize(2,0);
-	int w = canvas->width();
-	int h = canvas->height();
-
-	painter.setRenderHint(QPainter::Antialiasing, true);
-	painter.setRenderHint(QPainter::HighQualityAntialiasing, true);
-	vector<Obstacle> obstacles = canvas->data->GetObstacles();
-
-	QPointF oldPoint(-FLT_MAX,-FLT_MAX);
-	QPointF oldPointUp(-FLT_MAX,-FLT_MAX);
-	QPointF oldPointDown(-FLT_MAX,-FLT_MAX);
-	FOR(i, count)
-	{
-		QPointF samplePre(rand()/(float)RAND_MAX * w, rand()/(float)RAND_MAX * h);
-		sample = canvas->toSampleCoords(samplePre);
-		float color = (rand()/(float)RAND_MAX*0.7f)*255.f;
-		color = 0;
-		QPointF oldPoint = canvas->toCanvasCoords(sample);
-		FOR(j, steps)
-		{
-			fvec res = dynamical->Test(sample);
-			if(dynamical->avoid)
-			{
-				dynamical->avoid->SetObstacles(obstacles);
-				fvec newRes = dynamical->avoid->Avoid(sample, res);
-				res = newRes;
-			}
-			sample += res*dT;
-			float speed = sqrtf(res[0]*res[0] + res[1]*res[1]);
-			QPointF point = canvas->toCanvasCoords(sample);
-			painter.setOpacity(speed);
-			QColor c(color,color,color);
-			painter.setPen(QPen(c, 0.25));
-			painter.drawLine(point, oldPoint);
-			oldPoint = point;
-		}
+		SvgLayer layer(w, h);
+		if(classifier) drawClass->DrawInfo(canvas, layer.painter, classifier);
+		if(regressor) drawRegr->DrawInfo(canvas, layer.painter, regressor);
+		if(dynamical) drawDyn->DrawInfo(canvas, layer.painter, dynamical);
+		if(clusterer) drawClust->DrawInfo(canvas, layer.painter, clusterer);
+		stream.Append(layer.Finish());
 	}
 }
 
@@ -143,46 +161,83 @@ void DrawSVG::Maximization(QPainter &painter)
 	maximizer->Draw(painter);
 }
 
-void DrawSVG::VectorsFast(int count, int steps, QPainter &painter)
+void DrawSVG::Vectors(int count, int steps, SvgStream &stream)
 {
-	if(!dynamical) return;
-	QPointF oldPoint(-FLT_MAX,-FLT_MAX);
-	QPointF oldPointUp(-FLT_MAX,-FLT_MAX);
-	QPointF oldPointDown(-FLT_MAX,-FLT_MAX);
-	float dT = dynamical->dT;// * (dynamical->count/100.f);
-	//float dT = 0.02f;
-	fvec sample;
-	sample.resize(2,0);
-	int w = canvas->width();
-	int h = canvas->height();
-
-	painter.setRenderHint(QPainter::Antialiasing, true);
-	painter.setRenderHint(QPainter::HighQualityAntialiasing, true);
-	vector<Obstacle> obstacles = canvas->data->GetObstacles();
-	FOR(i, count)
+	if(!dynamical || !count) return;
+	int w = stream.Width();
+	int h = stream.Height();
+	// the obstacles are only passed once per export
+	if(dynamical->avoid) dynamical->avoid->SetObstacles(canvas->data->GetObstacles());
+
+	// the streamlines are integrated by chunks, their segments are written as one path per opacity level
+	// (the opacity follows the speed), segments outside of the canvas are dropped
+	stream.Write("<g fill=\"none\" stroke=\"#000000\" stroke-width=\"0.25\" stroke-linecap=\"round\">\n");
+	for(int chunk=0; chunk<count; chunk += STREAM_CHUNK)
 	{
-		QPointF samplePre(rand()/(float)RAND_MAX * w, rand()/(float)RAND_MAX * h);
-		sample = canvas->toSampleCoords(samplePre);
-		float color = (rand()/(float)RAND_MAX*0.7f)*255.f;
-		color = 0;
-		QPointF oldPoint = canvas->toCanvasCoords(sample);
-		FOR(j, steps)
+		int chunkSize = min(STREAM_CHUNK, count - chunk);
+		vector<fvec> starts(chunkSize);
+		FOR(i, chunkSize)
+		{
+			QPointF samplePre(rand()/(float)RAND_MAX * w, rand()/(float)RAND_MAX * h);
+			starts[i] = canvas->toSampleCoords(samplePre);
+		}
+		int dim = starts[0].size();
+		Rollout rollout(dynamical, dim, dynamical->integrator);
+		rollout.avoid = dynamical->avoid;
+		rollout.Start(starts, steps);
+
+		vector<QPointF> last(chunkSize);
+		ivec lastLevel(chunkSize, -1); // level of the polyline the streamline is currently writing
+		// the streamlines advance together, so each one buffers its current polyline and appends it whole
+		// to the path of its level once the level changes (the paths are shared by the whole chunk)
+		vector<QByteArray> polylines(chunkSize);
+		FOR(i, chunkSize) last[i] = canvas->toCanvasCoords(starts[i]);
+		QByteArray paths[OPACITY_LEVELS+1];
+		int active = chunkSize;
+		while(active)
 		{
-			fvec res = dynamical->Test(sample);
-			if(dynamical->avoid)
+			active = rollout.Step();
+			FOR(i, chunkSize)
 			{
-				dynamical->avoid->SetObstacles(obstacles);
-				fvec newRes = dynamical->avoid->Avoid(sample, res);
-				res = newRes;
+				const float *sample = rollout.Position(i);
+				QPointF point = canvas->toCanvasCoords(fvec(sample, sample + dim));
+				QPointF delta = point - last[i];
+				// short segments are merged with the next one (the last one is always written)
+				if(rollout.Active(i) && delta.x()*delta.x() + delta.y()*delta.y() < RESOLUTION*RESOLUTION) continue;
+				if(point == last[i]) continue;
+				const float *res = rollout.Velocity(i);
+				float speed = sqrtf(res[0]*res[0] + (dim > 1 ? res[1]*res[1] : 0));
+				int level = (int)(min(1.f, speed)*OPACITY_LEVELS + 0.5f);
+				bool bCulled = (point.x() < 0 && last[i].x() < 0) || (point.x() > w && last[i].x() > w) ||
+						(point.y() < 0 && last[i].y() < 0) || (point.y() > h && last[i].y() > h);
+				if(!level || bCulled || lastLevel[i] != level)
+				{
+					if(lastLevel[i] > 0) paths[lastLevel[i]] += polylines[i];
+					polylines[i].clear();
+					lastLevel[i] = -1;
+				}
+				if(level && !bCulled)
+				{
+					QByteArray &polyline = polylines[i];
+					// QByteArray::number ignores the locale, sprintf would write decimal commas under de_DE & co
+					if(lastLevel[i] != level)
+					{
+						polyline += 'M' + QByteArray::number(last[i].x(), 'f', 1) + ' ' + QByteArray::number(last[i].y(), 'f', 1);
+					}
+					polyline += 'L' + QByteArray::number(point.x(), 'f', 1) + ' ' + QByteArray::number(point.y(), 'f', 1);
+					lastLevel[i] = level;
+				}
+				last[i] = point;
 			}
-			sample += res*dT;
-			float speed = sqrtf(res[0]*res[0] + res[1]*res[1]);
-			QPointF point = canvas->toCanvasCoords(sample);
-			painter.setOpacity(speed);
-			QColor c(color,color,color);
-			painter.setPen(QPen(c, 0.25));
-			painter.drawLine(point, oldPoint);
-			oldPoint = point;
+		}
+		FOR(i, chunkSize) if(lastLevel[i] > 0) paths[lastLevel[i]] += polylines[i];
+		for(int level=1; level<=OPACITY_LEVELS; level++)
+		{
+			if(paths[level].isEmpty()) continue;
+			stream.Write("<path stroke-opacity=\"" + QByteArray::number(level/(double)OPACITY_LEVELS, 'g', 4) + "\" d=\"");
+			stream.Write(paths[level]);
+			stream.Write("\"/>\n");
 		}
 	}
+	stream.Write("</g>\n");
 }
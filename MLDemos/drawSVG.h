@@ -30,6 +30,36 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include "interfaces.h"
 #include <QMutex>
 #include <QMutexLocker>
+#include <QFile>
+#include <QBuffer>
+
+// svg document written progressively to disk, one layer after the other
+class SvgStream
+{
+	QFile file;
+	int w, h;
+	int layers;
+public:
+	SvgStream(QString filename, int w, int h, QString title, QString description);
+	~SvgStream(); // closes the document
+	bool isOpen(){return file.isOpen();};
+	int Width(){return w;};
+	int Height(){return h;};
+	// appends the content of a document written by QSvgGenerator, its ids are made unique to the layer
+	void Append(const QByteArray &svg);
+	void Write(const QByteArray &text){file.write(text);};
+};
+
+// layer painted through its own QSvgGenerator, kept in memory until it is appended to the stream
+class SvgLayer
+{
+	QBuffer buffer;
+	QSvgGenerator generator;
+public:
+	QPainter painter;
+	SvgLayer(int w, int h);
+	QByteArray Finish();
+};
 
 class DrawSVG
 {
@@ -42,8 +72,7 @@ public:
 	DrawSVG(Canvas *canvas, QMutex *mutex);
 	~DrawSVG();
 	void Write(QString filename);
-	void Vectors(int count, int steps, QPainter &painter);
-	void VectorsFast(int count, int steps, QPainter &painter);
+	void Vectors(int count, int steps, SvgStream &stream);
 	void Maximization(QPainter &painter);
 
 	Classifier *classifier;
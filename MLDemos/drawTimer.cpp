@@ -27,6 +27,7 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include "public.h"
 #include "basicMath.h"
 #include "drawTimer.h"
+#include "rollout.h"
 
 using namespace std;
 
@@ -177,6 +178,7 @@ void DrawTimer::Vectors(int count, int steps)
 	painter.setRenderHint(QPainter::Antialiasing, true);
 	painter.setRenderHint(QPainter::HighQualityAntialiasing, true);
 	vector<Obstacle> obstacles = canvas->data->GetObstacles();
+	ObstacleAvoidance *avoid = 0;
 
 	QPointF oldPoint(-FLT_MAX,-FLT_MAX);
 	QPointF oldPointUp(-FLT_MAX,-FLT_MAX);
@@ -195,8 +197,12 @@ void DrawTimer::Vectors(int count, int steps)
 			fvec res = (*dynamical)->Test(sample);
 			if((*dynamical)->avoid)
 			{
-				(*dynamical)->avoid->SetObstacles(obstacles);
-				fvec newRes = (*dynamical)->avoid->Avoid(sample, res);
+				if((*dynamical)->avoid != avoid) // the obstacles are only passed once per frame
+				{
+					avoid = (*dynamical)->avoid;
+					avoid->SetObstacles(obstacles);
+				}
+				fvec newRes = avoid->Avoid(sample, res);
 				res = newRes;
 			}
 			mutex->unlock();
@@ -255,6 +261,7 @@ void DrawTimer::Test(int start, int stop)
 	if(stop < 0 || stop > w*h) stop = w*h;
 	fvec sample(2);
 	vector<Obstacle> obstacles = canvas->data->GetObstacles();
+	ObstacleAvoidance *avoid = 0;
 	for (int i=start; i<stop; i++)
 	{
 		drawMutex.lock();
@@ -314,8 +321,12 @@ void DrawTimer::Test(int start, int stop)
 			val = (*dynamical)->Test(sample);
 			if((*dynamical)->avoid)
 			{
-				(*dynamical)->avoid->SetObstacles(obstacles);
-				fvec newRes = (*dynamical)->avoid->Avoid(sample, val);
+				if((*dynamical)->avoid != avoid) // the obstacles are only passed once per frame
+				{
+					avoid = (*dynamical)->avoid;
+					avoid->SetObstacles(obstacles);
+				}
+				fvec newRes = avoid->Avoid(sample, val);
 				val = newRes;
 			}
 			float speed = sqrtf(val[0]*val[0] + val[1]*val[1]);
@@ -337,49 +348,60 @@ void DrawTimer::VectorsFast(int count, int steps)
 {
 	if(!(*dynamical)) return;
 	if(!bRunning || !mutex) return;
-	QPointF oldPoint(-FLT_MAX,-FLT_MAX);
-	QPointF oldPointUp(-FLT_MAX,-FLT_MAX);
-	QPointF oldPointDown(-FLT_MAX,-FLT_MAX);
-	mutex->lock();
-	float dT = (*dynamical)->dT;// * (dynamical->count/100.f);
-	mutex->unlock();
-	//float dT = 0.02f;
-	fvec sample;
-	sample.resize(2,0);
 	int w = canvas->width();
 	int h = canvas->height();
+	// the streamlines start from random points and are integrated together, one batch per step
+	vector<fvec> starts(count);
+	vector<QPointF> points(count);
+	FOR(i, count)
+	{
+		QPointF samplePre(rand()/(float)RAND_MAX * w, rand()/(float)RAND_MAX * h);
+		starts[i] = canvas->toSampleCoords(samplePre);
+		points[i] = canvas->toCanvasCoords(starts[i]);
+	}
+	if(!count) return;
+	int dim = starts[0].size();
+	mutex->lock();
+	Dynamical *model = *dynamical;
+	if(!model)
+	{
+		mutex->unlock();
+		return;
+	}
+	Rollout rollout(model, dim, model->integrator);
+	if(model->avoid) // the obstacles are only passed once per frame
+	{
+		model->avoid->SetObstacles(canvas->data->GetObstacles());
+		rollout.avoid = model->avoid;
+	}
+	rollout.Start(starts, steps);
+	mutex->unlock();
+
 	QMutexLocker drawLock(&drawMutex);
 	QPainter painter(&modelMap);
 	painter.setRenderHint(QPainter::Antialiasing, true);
 	painter.setRenderHint(QPainter::HighQualityAntialiasing, true);
-	vector<Obstacle> obstacles = canvas->data->GetObstacles();
-	FOR(i, count)
+	painter.setPen(QPen(Qt::black, 0.25));
+	int active = count;
+	while(active)
 	{
-		QPointF samplePre(rand()/(float)RAND_MAX * w, rand()/(float)RAND_MAX * h);
-		sample = canvas->toSampleCoords(samplePre);
-		float color = (rand()/(float)RAND_MAX*0.7f)*255.f;
-		color = 0;
-		QPointF oldPoint = canvas->toCanvasCoords(sample);
-		FOR(j, steps)
+		mutex->lock();
+		if(!bRunning || *dynamical != model) // the model has changed in the meantime
 		{
-			if(!(*dynamical)) return;
-			mutex->lock();
-			fvec res = (*dynamical)->Test(sample);
-			if((*dynamical)->avoid)
-			{
-				(*dynamical)->avoid->SetObstacles(obstacles);
-				fvec newRes = (*dynamical)->avoid->Avoid(sample, res);
-				res = newRes;
-			}
 			mutex->unlock();
-			sample += res*dT;
-			float speed = sqrtf(res[0]*res[0] + res[1]*res[1]);
-			QPointF point = canvas->toCanvasCoords(sample);
-			painter.setOpacity(speed);
-			QColor c(color,color,color);
-			painter.setPen(QPen(c, 0.25));
-			painter.drawLine(point, oldPoint);
-			oldPoint = point;
+			return;
+		}
+		active = rollout.Step();
+		mutex->unlock();
+		FOR(i, count)
+		{
+			const float *sample = rollout.Position(i);
+			QPointF point = canvas->toCanvasCoords(fvec(sample, sample + dim));
+			if(point == points[i]) continue;
+			const float *res = rollout.Velocity(i);
+			painter.setOpacity(sqrtf(res[0]*res[0] + (dim > 1 ? res[1]*res[1] : 0)));
+			painter.drawLine(point, points[i]);
+			points[i] = point;
 		}
 	}
 }
@@ -390,6 +412,7 @@ void DrawTimer::TestFast(int start, int stop)
 	fVec sample;
 	mutex->lock();
 	vector<Obstacle> obstacles = canvas->data->GetObstacles();
+	ObstacleAvoidance *avoid = 0;
 	mutex->unlock();
 	for (int i=start; i<stop; i++)
 	{
@@ -482,8 +505,12 @@ void DrawTimer::TestFast(int start, int stop)
 			val = (*dynamical)->Test(sample);
 			if((*dynamical)->avoid)
 			{
-				(*dynamical)->avoid->SetObstacles(obstacles);
-				fVec newRes = (*dynamical)->avoid->Avoid(sample, val);
+				if((*dynamical)->avoid != avoid) // the obstacles are only passed once per frame
+				{
+					avoid = (*dynamical)->avoid;
+					avoid->SetObstacles(obstacles);
+				}
+				fVec newRes = avoid->Avoid(sample, val);
 				val = newRes;
 			}
 			float speed = sqrtf(val[0]*val[0] + val[1]*val[1]);
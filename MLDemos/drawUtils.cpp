@@ -126,7 +126,7 @@ QColor ColorFromVector(fvec a)
 	return QColor(c3[0],c3[1],c3[2]);
 }
 
-QPixmap RocImage(std::vector< std::vector<f32pair> > rocdata, std::vector<const char *> roclabels, QSize size)
+QPixmap RocImage(const std::vector< std::vector<RocCurve> > &roccurves, std::vector<const char *> roclabels, QSize size)
 {
 	QPixmap pixmap(size);
 	QPainter painter(&pixmap);
@@ -137,75 +137,38 @@ QPixmap RocImage(std::vector< std::vector<f32pair> > rocdata, std::vector<const
 
 	int PAD = 16;
 
-	FOR(d, rocdata.size())
+	FOR(d, roccurves.size())
 	{
 		int minCol = 70;
-		int color = (rocdata.size() == 1) ? 255 : (255 - minCol)*(rocdata.size() - d -1)/(rocdata.size()-1) + minCol;
+		int color = (roccurves.size() == 1) ? 255 : (255 - minCol)*(roccurves.size() - d -1)/(roccurves.size()-1) + minCol;
 		color = 255 - color;
 
-		std::vector<f32pair> data = rocdata[d];
-		if(!data.size()) continue;
-		std::sort(data.begin(), data.end());
+		if(!roccurves[d].size()) continue;
 
-		std::vector<fvec> allData;
-		fVec oldVal(1,0);
-		FOR(i, data.size())
+		painter.setPen(QColor(color,color,color));
+		// multi-class sets have one (one-vs-rest) curve per class
+		FOR(c, roccurves[d].size())
 		{
-			float thresh = data[i].first;
-			u32 tp = 0, fp = 0;
-			u32 fn = 0, tn = 0;
-
-			FOR(j, data.size())
+			const RocCurve &curve = roccurves[d][c];
+			if(!curve.size()) continue;
+			fVec pt1, pt2 = curve.Point(curve.size()-1);
+			pt2 = fVec(pt2.x*size.width(), pt2.y*size.height());
+			FOR(i, curve.size()-1)
 			{
-				if(data[j].second == 1)
-				{
-					if(data[j].first >= thresh) tp++;
-					else fn++;
-				}
-				else
-				{
-					if(data[j].first >= thresh) fp++;
-					else tn++;
-				}
+				pt1 = curve.Point(i);
+				pt2 = curve.Point(i+1);
+				pt1 = fVec(pt1.x*size.width(), pt1.y*size.height());
+				pt2 = fVec(pt2.x*size.width(), pt2.y*size.height());
+				painter.drawLine(QPointF(pt1.x+PAD, pt1.y+PAD),QPointF(pt2.x+PAD, pt2.y+PAD));
 			}
-			fVec val;
-			float fmeasure = 0;
-			if((fp+tn)>0 && (tp+fn)>0 && (tp+fp)>0)
-			{
-				val=fVec(fp/float(fp+tn), 1 - tp/float(tp+fn));
-				float precision = tp / float(tp+fp);
-				float recall = tp /float(tp+fn);
-				fmeasure = tp == 0 ? 0 : 2 * (precision * recall) / (precision + recall);
-			}
-
-			fvec dat;
-			dat.push_back(val.x);
-			dat.push_back(val.y);
-			dat.push_back(data[i].first);
-			dat.push_back(fmeasure);
-			allData.push_back(dat);
-
-			oldVal = val;
-		}
-
-		painter.setPen(QColor(color,color,color));
-		// we highlight the current roc curve
-		fVec pt1, pt2;
-		FOR(i, allData.size()-1)
-		{
-			pt1 = fVec(allData[i][0]*size.width(), allData[i][1]*size.height());
-			pt2 = fVec(allData[i+1][0]*size.width(), allData[i+1][1]*size.height());
+			pt1 = fVec(0,size.width());
 			painter.drawLine(QPointF(pt1.x+PAD, pt1.y+PAD),QPointF(pt2.x+PAD, pt2.y+PAD));
 		}
-		pt1 = fVec(0,size.width());
-		painter.drawLine(QPointF(pt1.x+PAD, pt1.y+PAD),QPointF(pt2.x+PAD, pt2.y+PAD));
 
-		//cvDrawLine(roc, cvPoint(0 + PAD,resolution.height + PAD), cvPoint(oldVal.x*resolution.width+vpad.x,oldVal.y*resolution.height+vpad.y), color);
 		if(d < roclabels.size())
 		{
 			QPointF pos(3*size.width()/4,size.height() - (d+1)*16);
 			painter.drawText(pos,QString(roclabels[roclabels.size()-1-d]));
-			//cvPutText(roc, roclabels[d], point, rocfont, color);
 		}
 	}
 	return pixmap;
@@ -30,7 +30,7 @@ void DrawEllipse(float *mean, float *sigma, float rad, QPainter *painter, QSize
 void DrawEllipse(float *mean, float *sigma, float rad, QPainter *painter, Canvas *canvas);
 void DrawArrow( const QPointF &ppt, const QPointF &pt, double sze, QPainter &painter);
 QColor ColorFromVector(fvec a);
-QPixmap RocImage(std::vector< std::vector<f32pair> > rocdata, std::vector<const char *> roclabels, QSize size);
+QPixmap RocImage(const std::vector< std::vector<RocCurve> > &roccurves, std::vector<const char *> roclabels, QSize size);
 QPixmap BoxPlot(std::vector<fvec> allData, QSize size, float maxVal=-FLT_MAX, float minVal=FLT_MAX);
 QPixmap Histogram(std::vector<fvec> allData, QSize size, float maxVal=-FLT_MAX, float minVal=FLT_MAX);
 
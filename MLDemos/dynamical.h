@@ -39,10 +39,11 @@ public:
 	fvec trainErrors, testErrors;
 	int type;
 	float dT;
+	int integrator; // see Rollout
 	u32 count;
 	ObstacleAvoidance *avoid;
 
-	Dynamical(): type(DYN_NONE), count(100), dT(0.02f), avoid(0){}
+	Dynamical(): type(DYN_NONE), count(100), dT(0.02f), integrator(0), avoid(0){}
 	~Dynamical(){if(avoid) delete avoid;};
 	std::vector< std::vector<fvec> > GetTrajectories(){return trajectories;};
 	int Dim(){return dim;};
@@ -51,6 +52,18 @@ public:
 	virtual std::vector<fvec> Test( const fvec &sample, const int count){ return std::vector<fvec>(); };
 	virtual fvec Test( const fvec &sample){ return fvec(); };
 	virtual fVec Test(const fVec &sample){ return fVec(Test((fvec)sample)); };
+	// batch of count samples, samples and velocities are row-major (count x dim)
+	// models whose Test is reentrant can override it to spread the batch over several threads
+	virtual void TestBatch(const float *samples, float *velocities, int count, int dim)
+	{
+		fvec sample(dim);
+		FOR(i, count)
+		{
+			FOR(d, dim) sample[d] = samples[i*dim + d];
+			fvec velocity = Test(sample);
+			FOR(d, dim) velocities[i*dim + d] = d < velocity.size() ? velocity[d] : 0.f;
+		}
+	};
 	virtual char *GetInfoString(){return NULL;};
 };
 
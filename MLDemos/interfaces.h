@@ -20,6 +20,7 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #define _INTERFACES_H_
 
 #include <vector>
+#include <map>
 #include <fstream>
 #include "classifier.h"
 #include "clusterer.h"
@@ -28,7 +29,9 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include "maximize.h"
 #include "canvas.h"
 #include "drawTimer.h"
+#include "sampleBatch.h"
 #include <QtPlugin>
+#include <QApplication>
 #include <QWidget>
 #include <QSettings>
 #include <QBitmap>
@@ -36,6 +39,23 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include <QUrl>
 #include <QTextStream>
 
+// parameters of an algorithm interface that runs without its widget (command-line tools under a QCoreApplication)
+// LoadParams stores the values under their name (the group is dropped), SetParams and GetAlgoString then
+// read them back with the default of the ui file as fallback. The rest of the interface is only used by the GUI
+class ParameterMap
+{
+	std::map<QString, float> values;
+public:
+	void Set(QString name, float value){values[name.section(':', -1)] = value;}
+	float Get(QString name, float fallback) const
+	{
+		std::map<QString, float>::const_iterator it = values.find(name);
+		return it == values.end() ? fallback : it->second;
+	}
+	// the parameter widgets can only be created by a GUI QApplication
+	static bool HasGUI(){return qobject_cast<QApplication *>(QCoreApplication::instance()) != 0;}
+};
+
 class ClassifierInterface
 {
 public:
@@ -158,6 +178,9 @@ public:
 	virtual bool LoadOptions(QSettings &settings) = 0;
 	virtual void SaveParams(QTextStream &stream) = 0;
 	virtual bool LoadParams(QString name, float value) = 0;
+	// optional: binary dump of a trained model, to restore it without retraining
+	virtual bool SaveModel(QString filename, Regressor *regressor){return false;}
+	virtual bool LoadModel(QString filename, Regressor *regressor){return false;}
 
 	void Draw(Canvas *canvas, Regressor *regressor)
 	{
@@ -213,6 +236,9 @@ public:
 	virtual void SaveParams(QTextStream &stream) = 0;
 	virtual bool LoadParams(QString name, float value) = 0;
 	virtual bool UsesDrawTimer() = 0;
+	// optional: binary dump of a trained model, to restore it without retraining
+	virtual bool SaveModel(QString filename, Dynamical *dynamical){return false;}
+	virtual bool LoadModel(QString filename, Dynamical *dynamical){return false;}
 
 	void Draw(Canvas *canvas, Dynamical *dynamical)
 	{
@@ -321,19 +347,28 @@ public:
 	virtual const char* FetchResultsSlot() = 0; // void FetchResults(std::vector<fvec> results);
 	virtual QObject *object() = 0; // trick to get access to the QObject interface for signals and slots
 	virtual const char* DoneSignal() = 0; // void Done(QObject *);
+	// batched queries (optional): the batch target selects the model, results come back as a batch of the same count
+	virtual const char* QueryBatchSignal(){return 0;} // void QueryBatch(SampleBatch samples);
+	virtual const char* FetchBatchSlot(){return 0;} // void FetchBatch(SampleBatch results);
+	// streamed data (optional): batches are appended to the current dataset, trajectories index the samples of their batch
+	virtual const char* AppendDataSignal(){return 0;} // void AppendData(SampleBatch samples, ivec labels, std::vector<ipair> trajectories);
+	virtual const char* DataAppendedSlot(){return 0;} // void DataAppended(SampleBatch samples); once the batch has been ingested
+	virtual const char* SetCapacitySignal(){return 0;} // void SetCapacity(int capacity); samples kept when appending (oldest evicted first), 0 keeps them all
 
 	virtual QString GetName() = 0;
 	virtual void Start() = 0;
 	virtual void Stop() = 0;
 };
 
-Q_DECLARE_INTERFACE(ClassifierInterface, "com.MLDemos.ClassifierInterface/1.0")
+// bump the version whenever the virtuals of an interface, or of the model classes it creates, change
+// so that stale plugin binaries are refused at load time (collections hand out all of them)
+Q_DECLARE_INTERFACE(ClassifierInterface, "com.MLDemos.ClassifierInterface/1.1")
 Q_DECLARE_INTERFACE(ClustererInterface, "com.MLDemos.ClustererInterface/1.0")
-Q_DECLARE_INTERFACE(RegressorInterface, "com.MLDemos.RegressorInterface/1.0")
-Q_DECLARE_INTERFACE(DynamicalInterface, "com.MLDemos.DynamicalInterface/1.0")
-Q_DECLARE_INTERFACE(AvoidanceInterface, "com.MLDemos.AvoidInterface/1.0")
-Q_DECLARE_INTERFACE(MaximizeInterface, "com.MLDemos.MaximizeInterface/1.0")
-Q_DECLARE_INTERFACE(CollectionInterface, "com.MLDemos.CollectionInterface/1.0")
-Q_DECLARE_INTERFACE(InputOutputInterface, "com.MLDemos.InputOutputInterface/1.0")
+Q_DECLARE_INTERFACE(RegressorInterface, "com.MLDemos.RegressorInterface/1.1")
+Q_DECLARE_INTERFACE(DynamicalInterface, "com.MLDemos.DynamicalInterface/1.1")
+Q_DECLARE_INTERFACE(AvoidanceInterface, "com.MLDemos.AvoidInterface/1.1")
+Q_DECLARE_INTERFACE(MaximizeInterface, "com.MLDemos.MaximizeInterface/1.1")
+Q_DECLARE_INTERFACE(CollectionInterface, "com.MLDemos.CollectionInterface/1.1")
+Q_DECLARE_INTERFACE(InputOutputInterface, "com.MLDemos.InputOutputInterface/1.1")
 
 #endif // _INTERFACES_H_
@@ -22,6 +22,7 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include <vector>
 #include "public.h"
 #include "mymaths.h"
+#include "rewardSource.h"
 #include <QPainter>
 
 class Maximizer
@@ -36,16 +37,35 @@ protected:
 	std::vector< fvec > history;
 	std::vector<double> historyValue;
 	double maximumValue;
-	float *data;
+	RewardSource *reward;
 	int evaluations;
 
+	// keeps a copy of the reward to be maximized, the search space takes the dimension of the reward
+	void SetReward(const RewardSource &source, fVec size)
+	{
+		DEL(reward);
+		reward = source.Clone();
+		w = size.x;
+		h = size.y;
+		if(dim == (u32)reward->Dim() && maximum.size() == dim) return;
+		dim = reward->Dim();
+		maximum.resize(dim);
+		FOR(d,dim) maximum[d] = rand()/(float)RAND_MAX;
+	}
+	// evaluates count candidates (count x dim, row-major) in one go, large batches are spread over the available cores
+	void GetValues(const float *samples, int count, float *values)
+	{
+		if(reward) reward->Evaluate(samples, count, values);
+		else FOR(i, count) values[i] = 0.f;
+	}
+
 public:
 	int age, maxAge;
 	double stopValue;
 
-	Maximizer() : evaluations(0), stopValue(.99), maxAge(200), age(0), dim(2), bIterative(false) , bConverged(true), data(NULL), w(1), h(1), maximumValue(-FLT_MAX){ maximum.resize(2);};
-	~Maximizer(){if(data) delete [] data;};
-	void Maximize(float *dataMap, int w, int h) {Train(dataMap,fVec(w,h));};
+	Maximizer() : evaluations(0), stopValue(.99), maxAge(200), age(0), dim(2), bIterative(false) , bConverged(true), reward(NULL), w(1), h(1), maximumValue(-FLT_MAX){ maximum.resize(2);};
+	virtual ~Maximizer(){DEL(reward);};
+	void Maximize(float *dataMap, int w, int h) {Train(RewardRaster(dataMap,w,h),fVec(w,h));};
 	bool hasConverged(){return bConverged;};
 	void SetConverged(bool converged){bConverged = converged;};
 	std::vector<fvec> &History(){return history;};
@@ -54,16 +74,13 @@ public:
 	double MaximumValue(){return GetValue(maximum);};
 	std::vector<fvec> &Visited(){return visited;};
 	int &Evaluations(){return evaluations;};
-	float GetValue(fvec sample)
-	{
-		int xIndex = max(0, min(w-1, (int)(sample[0]*w)));
-		int yIndex = max(0, min(h-1, (int)(sample[1]*h)));
-		int index = yIndex*w + xIndex;
-		return data[index];
-	}
+	float GetValue(const fvec &sample){return reward ? reward->ValueAt(&sample[0]) : 0.f;};
+	const RewardSource *Reward(){return reward;};
 
+	// the canvas shows the first two dimensions of the search space
 	virtual void Draw(QPainter &painter){};
-	virtual void Train(float *dataMap, fVec size, fvec startingPoint=fvec()){};
+	// size is the size of the canvas the maximizer is drawn onto
+	virtual void Train(const RewardSource &source, fVec size, fvec startingPoint=fvec()){};
 	virtual fvec Test( const fvec &sample){ return fvec(); };
 	virtual fvec Test(const fVec &sample){ return Test((fvec)sample); };
 	virtual char *GetInfoString(){return NULL;};
@@ -30,8 +30,11 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include "drawSVG.h"
 #include <iostream>
 #include <sstream>
-#include "optimization_test_functions.h"
+#include "rewardSource.h"
+#include "queryWorker.h"
+#include "pluginLoader.h"
 
+using namespace std;
 
 MLDemos::MLDemos(QString filename, QWidget *parent, Qt::WFlags flags)
     : QMainWindow(parent, flags),
@@ -47,7 +50,9 @@ MLDemos::MLDemos(QString filename, QWidget *parent, Qt::WFlags flags)
       compare(0),
       trajectory(ipair(-1,-1)),
       bNewObstacle(false),
-      tabUsedForTraining(0)
+      tabUsedForTraining(0),
+      rewardBenchmark(-1),
+      modelGeneration(0)
 {
     QApplication::setWindowIcon(QIcon(":/MLDemos/logo.png"));
     ui.setupUi(this);
@@ -372,6 +377,7 @@ void MLDemos::initDialogs()
     connect(optionsDynamic->resampleSpin, SIGNAL(valueChanged(int)), this, SLOT(ChangeActiveOptions()));
 
 	connect(optionsDynamic->dtSpin, SIGNAL(valueChanged(double)), this, SLOT(ChangeActiveOptions()));
+	connect(optionsDynamic->integratorCombo, SIGNAL(currentIndexChanged(int)), this, SLOT(ChangeActiveOptions()));
 	connect(optionsDynamic->obstacleCombo, SIGNAL(currentIndexChanged(int)), this, SLOT(AvoidOptionChanged()));
 	connect(optionsDynamic->compareButton, SIGNAL(clicked()), this, SLOT(CompareAdd()));
 	connect(optionsDynamic->colorCheck, SIGNAL(clicked()), this, SLOT(ColorMapChanged()));
@@ -425,114 +431,37 @@ void MLDemos::initDialogs()
     drawTimer->dynamical = &dynamical;
     drawTimer->clusterer = &clusterer;
     drawTimer->maximizer = &maximizer;
+
+    // batches are answered in the order they are received
+    // (their evaluation is serialized by the model mutex anyway)
+    queryPool.setMaxThreadCount(1);
+    qRegisterMetaType<SampleBatch>("SampleBatch");
+    qRegisterMetaType< std::vector<fvec> >("std::vector<fvec>");
+    qRegisterMetaType<ivec>("ivec");
+    qRegisterMetaType< std::vector<ipair> >("std::vector<ipair>");
     connect(drawTimer, SIGNAL(MapReady(QImage)), canvas, SLOT(SetConfidenceMap(QImage)));
     connect(drawTimer, SIGNAL(ModelReady(QImage)), canvas, SLOT(SetModelImage(QImage)));
     connect(drawTimer, SIGNAL(CurveReady()), this, SLOT(SetROCInfo()));
+
+    appendTimer.setSingleShot(true);
+    connect(&appendTimer, SIGNAL(timeout()), canvas, SLOT(update()));
 }
 
 void MLDemos::initPlugins()
 {
     qDebug() << "Importing plugins";
-    QDir pluginsDir = QDir(qApp->applicationDirPath());
-    QStringList pluginFileNames;
-    QDir alternativeDir = pluginsDir;
-
-#if defined(Q_OS_WIN)
-    if (pluginsDir.dirName().toLower() == "debug" || pluginsDir.dirName().toLower() == "release") pluginsDir.cdUp();
-#elif defined(Q_OS_MAC)
-    if (pluginsDir.dirName() == "MacOS") {
-        if(!pluginsDir.cd("plugins"))
-        {
-            qDebug() << "looking for alternative directory";
-            pluginsDir.cdUp();
-            pluginsDir.cdUp();
-            alternativeDir = pluginsDir;
-            alternativeDir.cd("plugins");
-        }
-        pluginsDir.cdUp();
-    }
-#endif
-    bool bFoundPlugins = false;
-#if defined(DEBUG)
-    qDebug() << "looking for debug plugins";
-    bFoundPlugins = pluginsDir.cd("pluginsDebug");
-#else
-    qDebug() << "looking for release plugins";
-    bFoundPlugins = pluginsDir.cd("plugins");
-#endif
-    if(!bFoundPlugins)
-    {
-        qDebug() << "plugins not found on: " << pluginsDir.absolutePath();
-        qDebug() << "using alternative directory: " << alternativeDir.absolutePath();
-        pluginsDir = alternativeDir;
-    }
-    foreach (QString fileName, pluginsDir.entryList(QDir::Files))
-    {
-        QPluginLoader loader(pluginsDir.absoluteFilePath(fileName));
-        QObject *plugin = loader.instance();
-        if (plugin)
-        {
-            qDebug() << fileName;
-            // check type of plugin
-            CollectionInterface *iCollection = qobject_cast<CollectionInterface *>(plugin);
-            if(iCollection)
-            {
-                std::vector<ClassifierInterface*> classifierList = iCollection->GetClassifiers();
-                std::vector<ClustererInterface*> clustererList = iCollection->GetClusterers();
-                std::vector<RegressorInterface*> regressorList = iCollection->GetRegressors();
-                std::vector<DynamicalInterface*> dynamicalList = iCollection->GetDynamicals();
-                std::vector<MaximizeInterface*> maximizerList = iCollection->GetMaximizers();
-                FOR(i, classifierList.size()) AddPlugin(classifierList[i], SLOT(ChangeActiveOptions));
-                FOR(i, clustererList.size()) AddPlugin(clustererList[i], SLOT(ChangeActiveOptions));
-                FOR(i, regressorList.size()) AddPlugin(regressorList[i], SLOT(ChangeActiveOptions));
-                FOR(i, dynamicalList.size()) AddPlugin(dynamicalList[i], SLOT(ChangeActiveOptions));
-                FOR(i, maximizerList.size()) AddPlugin(maximizerList[i], SLOT(ChangeActiveOptions));
-                continue;
-            }
-            ClassifierInterface *iClassifier = qobject_cast<ClassifierInterface *>(plugin);
-            if (iClassifier)
-            {
-                AddPlugin(iClassifier, SLOT(ChangeActiveOptions()));
-                continue;
-            }
-            ClustererInterface *iClusterer = qobject_cast<ClustererInterface *>(plugin);
-            if (iClusterer)
-            {
-                AddPlugin(iClusterer, SLOT(ChangeActiveOptions()));
-                continue;
-            }
-            RegressorInterface *iRegressor = qobject_cast<RegressorInterface *>(plugin);
-            if (iRegressor)
-            {
-                AddPlugin(iRegressor, SLOT(ChangeActiveOptions()));
-                continue;
-            }
-            DynamicalInterface *iDynamical = qobject_cast<DynamicalInterface *>(plugin);
-            if (iDynamical)
-            {
-                AddPlugin(iDynamical, SLOT(ChangeActiveOptions()));
-                continue;
-            }
-            MaximizeInterface *iMaximize = qobject_cast<MaximizeInterface *>(plugin);
-            if (iMaximize)
-            {
-                AddPlugin(iMaximize, SLOT(ChangeActiveOptions()));
-                continue;
-            }
-            InputOutputInterface *iIO = qobject_cast<InputOutputInterface *>(plugin);
-            if (iIO)
-            {
-                AddPlugin(iIO);
-                continue;
-            }
-            AvoidanceInterface *iAvoid = qobject_cast<AvoidanceInterface *>(plugin);
-            if (iAvoid)
-            {
-                AddPlugin(iAvoid, SLOT(ChangeActiveOptions()));
-                continue;
-            }
-        }
-    }
+    // same discovery as the command-line tools, so that the tab indices of saved parameter files agree
+    QDir pluginsDir = PluginLoader::PluginDirectory();
+    qDebug() << "plugins directory: " << pluginsDir.absolutePath();
+    PluginLoader loader;
+    loader.Load(pluginsDir);
+    FOR(i, loader.classifiers.size()) AddPlugin(loader.classifiers[i], SLOT(ChangeActiveOptions()));
+    FOR(i, loader.clusterers.size()) AddPlugin(loader.clusterers[i], SLOT(ChangeActiveOptions()));
+    FOR(i, loader.regressors.size()) AddPlugin(loader.regressors[i], SLOT(ChangeActiveOptions()));
+    FOR(i, loader.dynamicals.size()) AddPlugin(loader.dynamicals[i], SLOT(ChangeActiveOptions()));
+    FOR(i, loader.maximizers.size()) AddPlugin(loader.maximizers[i], SLOT(ChangeActiveOptions()));
+    FOR(i, loader.inputs.size()) AddPlugin(loader.inputs[i]);
+    FOR(i, loader.avoiders.size()) AddPlugin(loader.avoiders[i], SLOT(ChangeActiveOptions()));
 }
 
 void MLDemos::SetTextFontSize()
@@ -647,6 +576,11 @@ void MLDemos::AddPlugin(InputOutputInterface *iIO)
     connect(iIO->object(), iIO->QueryDynamicalSignal(), this, SLOT(QueryDynamical(std::vector<fvec>)));
     connect(iIO->object(), iIO->QueryClustererSignal(), this, SLOT(QueryClusterer(std::vector<fvec>)));
     connect(iIO->object(), iIO->QueryMaximizerSignal(), this, SLOT(QueryMaximizer(std::vector<fvec>)));
+    if(iIO->QueryBatchSignal()) connect(iIO->object(), iIO->QueryBatchSignal(), this, SLOT(QueryBatch(SampleBatch)));
+    if(iIO->FetchBatchSlot()) connect(this, SIGNAL(SendBatch(SampleBatch)), iIO->object(), iIO->FetchBatchSlot());
+    if(iIO->AppendDataSignal()) connect(iIO->object(), iIO->AppendDataSignal(), this, SLOT(AppendData(SampleBatch, ivec, std::vector<ipair>)));
+    if(iIO->SetCapacitySignal()) connect(iIO->object(), iIO->SetCapacitySignal(), this, SLOT(SetCapacity(int)));
+    if(iIO->DataAppendedSlot()) connect(this, SIGNAL(DataAppended(SampleBatch)), iIO->object(), iIO->DataAppendedSlot());
     connect(iIO->object(), iIO->DoneSignal(), this, SLOT(DisactivateIO(QObject *)));
     QString name = iIO->GetName();
     QAction *pluginAction = ui.menuInput_Output->addAction(name);
@@ -701,6 +635,7 @@ void MLDemos::AddPlugin(MaximizeInterface *iMaximizer, const char *method)
 
 MLDemos::~MLDemos()
 {
+    queryPool.waitForDone();
     Clear();
     FOR(i, inputoutputs.size())
     {
@@ -728,6 +663,7 @@ void MLDemos::closeEvent(QCloseEvent *event)
         mutex.lock();
         DEL(regressor);
         DEL(classifier);
+        modelGeneration++;
         mutex.unlock();
         qApp->quit();
     } else {
@@ -1041,6 +977,7 @@ void MLDemos::Clear()
     DEL(dynamical);
     DEL(clusterer);
     DEL(maximizer);
+    modelGeneration++;
     canvas->confidencePixmap = QPixmap();
     canvas->modelPixmap = QPixmap();
     canvas->infoPixmap = QPixmap();
@@ -1090,6 +1027,7 @@ void MLDemos::ClearData()
         canvas->targets.clear();
         canvas->rewardPixmap = QPixmap();
     }
+    rewardBenchmark = -1;
     Clear();
     ResetPositiveClass();
     UpdateInfo();
@@ -1296,6 +1234,7 @@ void MLDemos::DisplayOptionChanged()
         canvas->trajectoryCenterType = optionsDynamic->centerCombo->currentIndex();
         canvas->trajectoryResampleType = optionsDynamic->resampleCombo->currentIndex();
         canvas->trajectoryResampleCount = optionsDynamic->resampleSpin->value();
+        if(dynamical) dynamical->integrator = optionsDynamic->integratorCombo->currentIndex();
     }
     canvas->ResetSamples();
     canvas->repaint();
@@ -1652,6 +1591,7 @@ void MLDemos::Drawing( fvec sample, int label)
         float radius = drawToolbarContext4->spinRadius->value();
         float alpha = drawToolbarContext4->spinAlpha->value();
         canvas->PaintReward(sample, radius, label ? alpha : -alpha);
+        rewardBenchmark = -1;
         /*
   // if we need to initialize the reward map
   if(!canvas->data->GetReward()->rewards)
@@ -1925,91 +1865,26 @@ void MLDemos::BenchmarkButton()
     QImage image(w, h, QImage::Format_ARGB32);
     image.fill(qRgb(255,255,255));
 
-    int dim = 2;
-    float minSpace = 0.f;
-    float maxSpace = 1.f;
-    float minVal = FLT_MAX;
-    float maxVal = -FLT_MAX;
-    switch(type)
-    {
-    case 0: // griewangk
-        minSpace = -60.f;
-        maxSpace = 60.f;
-        minVal = 0;
-        maxVal = 2;
-        break;
-    case 1: // rastragin
-        minSpace = -5.12f;
-        maxSpace = 5.12f;
-        minVal = 0;
-        maxVal = 82;
-        break;
-    case 2: // schwefel
-        minSpace = -500.f;
-        maxSpace = 500.f;
-        minVal = -838;
-        maxVal = 838;
-        break;
-    case 3: // ackley
-        minSpace = -2.f;
-        maxSpace = 2.f;
-        minVal = 0;
-        maxVal = 2.3504;
-    case 4: // michalewicz
-        minSpace = -2;
-        maxSpace = 2;
-        minVal = -1.03159;
-        maxVal = 5.74;
-        //		minVal = -1.03159;
-        //		maxVal = 55.74;
-    }
-
-    bool bSetValues = minVal == FLT_MAX;
-    Eigen::VectorXd x(2);
-    fVec point;
-    float value = 0;
+    // we only rasterize the function for display, the maximizers evaluate it directly
+    RewardFunction benchmark(type);
+    vector<float> samples(h*2), values(h);
     FOR(i, w)
     {
-        x[0] = i/(float)w*(maxSpace - minSpace) + minSpace;
         FOR(j, h)
         {
-            x[1] = j/(float)h*(maxSpace - minSpace) + minSpace;
-
-            switch(type)
-            {
-            case 0:
-                value = griewangk(x)(0);
-                break;
-            case 1:
-                value = rastragin(x)(0);
-                break;
-            case 2:
-                value = schwefel(x)(0);
-                break;
-            case 3:
-                value = ackley(x)(0);
-                break;
-            case 4:
-                value = sixhump(x)(0);
-                break;
-            }
-            if(bSetValues)
-            {
-                if(value < minVal) minVal = value;
-                if(value > maxVal) maxVal = value;
-            }
-            else
-            {
-                value = (value-minVal)/(maxVal-minVal);
-            }
-
-            int color = 255.f*max(0.f,min(1.f,value));
+            samples[j*2] = i/(float)w;
+            samples[j*2+1] = j/(float)h;
+        }
+        benchmark.ValueAtBatch(&samples[0], h, &values[0]);
+        FOR(j, h)
+        {
+            int color = 255.f*(1.f - values[j]);
             image.setPixel(i,j,qRgba(255, color, color, 255));
         }
     }
-    if(bSetValues) qDebug() << "minmax: " << minVal << " " << maxVal;
 
     canvas->rewardPixmap = QPixmap::fromImage(image);
+    rewardBenchmark = type;
     canvas->repaint();
 }
 
@@ -2233,80 +2108,55 @@ void MLDemos::SetData(std::vector<fvec> samples, ivec labels, std::vector<ipair>
     canvas->repaint();
 }
 
+#define APPEND_REFRESH 40 // ms between two repaints of the appended data
+
+void MLDemos::AppendData(SampleBatch samples, ivec labels, std::vector<ipair> trajectories)
+{
+    // only the new samples are drawn on top of the samples pixmap, unless older ones were evicted
+    if(canvas->data->Append(samples.ToSamples(), labels, trajectories)) canvas->ResetSamples();
+    if(!appendTimer.isActive()) appendTimer.start(APPEND_REFRESH);
+    emit DataAppended(samples);
+}
+
+void MLDemos::SetCapacity(int capacity)
+{
+    canvas->data->SetCapacity(capacity);
+}
+
+// the std::vector<fvec> queries go through the same workers as the batched ones
 void MLDemos::QueryClassifier(std::vector<fvec> samples)
 {
-    std::vector<fvec> results;
-    QMutexLocker lock(&mutex);
-    fvec result;
-    result.resize(1);
-    if(classifier && samples.size())
-    {
-        results.resize(samples.size());
-        FOR(i, samples.size())
-        {
-            result[0] = classifier->Test(samples[i]);
-            results[i] = result;
-        }
-    }
-    emit SendResults(results);
+    queryPool.start(new QueryWorker(this, SampleBatch::FromSamples(samples, SampleBatch::CLASSIFIER), true));
 }
 
 void MLDemos::QueryRegressor(std::vector<fvec> samples)
 {
-    std::vector<fvec> results;
-    QMutexLocker lock(&mutex);
-    if(regressor && samples.size())
-    {
-        results.resize(samples.size());
-        FOR(i, samples.size())
-        {
-            results[i] = regressor->Test(samples[i]);
-        }
-    }
-    emit SendResults(results);
+    queryPool.start(new QueryWorker(this, SampleBatch::FromSamples(samples, SampleBatch::REGRESSOR), true));
 }
 
 void MLDemos::QueryDynamical(std::vector<fvec> samples)
 {
-    std::vector<fvec> results;
-    QMutexLocker lock(&mutex);
-    if(dynamical && samples.size())
-    {
-        results.resize(samples.size());
-        FOR(i, samples.size())
-        {
-            results[i] = dynamical->Test(samples[i]);
-        }
-    }
-    emit SendResults(results);
+    queryPool.start(new QueryWorker(this, SampleBatch::FromSamples(samples, SampleBatch::DYNAMICAL), true));
 }
 
 void MLDemos::QueryClusterer(std::vector<fvec> samples)
 {
-    std::vector<fvec> results;
-    QMutexLocker lock(&mutex);
-    if(clusterer && samples.size())
-    {
-        results.resize(samples.size());
-        FOR(i, samples.size())
-        {
-            results[i] = clusterer->Test(samples[i]);
-        }
-    }
-    emit SendResults(results);
+    queryPool.start(new QueryWorker(this, SampleBatch::FromSamples(samples, SampleBatch::CLUSTERER), true));
 }
 
 void MLDemos::QueryMaximizer(std::vector<fvec> samples)
 {
-    std::vector<fvec> results;
-    QMutexLocker lock(&mutex);
-    if(maximizer && samples.size())
-    {
-        results.resize(samples.size());
-        FOR(i, samples.size())
-        {
-            results[i] = maximizer->Test(samples[i]);
-        }
-    }
-    emit SendResults(results);
+    queryPool.start(new QueryWorker(this, SampleBatch::FromSamples(samples, SampleBatch::MAXIMIZER), true));
+}
+
+void MLDemos::QueryBatch(SampleBatch samples)
+{
+    queryPool.start(new QueryWorker(this, samples));
+}
+
+// called from the query workers, the receivers get the results through queued connections
+void MLDemos::SendBatchResults(SampleBatch results, bool bLegacy)
+{
+    if(bLegacy) emit SendResults(results.ToSamples());
+    else emit SendBatch(results);
 }
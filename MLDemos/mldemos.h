@@ -24,6 +24,8 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include <QResizeEvent>
 #include <QMutex>
 #include <QMutexLocker>
+#include <QThreadPool>
+#include <QTimer>
 #include "ui_mldemos.h"
 #include "ui_viewOptions.h"
 #include "ui_aboutDialog.h"
@@ -137,6 +139,8 @@ private:
 	void SetTextFontSize();
 	void SaveParams(QString filename);
 	void LoadParams(QString filename);
+	bool RestoreRegression(QString modelFile);
+	bool RestoreDynamical(QString modelFile);
 	void Load(QString filename);
 	void Save(QString filename);
 
@@ -149,25 +153,35 @@ public:
 	~MLDemos();
 
 	int tabUsedForTraining;
+	int rewardBenchmark; // benchmark function drawn in the reward pixmap, -1 if the reward was painted
 	Classifier *classifier;
 	Regressor *regressor;
 	Dynamical *dynamical;
 	Clusterer *clusterer;
 	Maximizer *maximizer;
 	QMutex mutex;
+	int modelGeneration; // bumped under the mutex whenever a model is created or cleared, see QueryWorker
+	QThreadPool queryPool; // answers the input/output plugins' queries, see QueryWorker
+	void SendBatchResults(SampleBatch results, bool bLegacy=false);
+	QTimer appendTimer; // coalesces the repaints of the appended data
 	void resizeEvent( QResizeEvent *event );
 	void dragEnterEvent(QDragEnterEvent *event);
 	void dropEvent(QDropEvent *event);
 
 signals:
 	void SendResults(std::vector<fvec> results);
+	void SendBatch(SampleBatch results);
+	void DataAppended(SampleBatch samples);
 public slots:
 	void SetData(std::vector<fvec> samples, ivec labels, std::vector<ipair> trajectories);
+	void AppendData(SampleBatch samples, ivec labels, std::vector<ipair> trajectories);
+	void SetCapacity(int capacity);
 	void QueryClassifier(std::vector<fvec> samples);
 	void QueryRegressor(std::vector<fvec> samples);
 	void QueryDynamical(std::vector<fvec> samples);
 	void QueryClusterer(std::vector<fvec> samples);
 	void QueryMaximizer(std::vector<fvec> samples);
+	void QueryBatch(SampleBatch samples);
 
 private slots:
 	void ShowAbout();
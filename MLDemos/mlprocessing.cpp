@@ -25,6 +25,7 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include "clusterer.h"
 #include "maximize.h"
 #include "roc.h"
+#include "rollout.h"
 #include <QDebug>
 #include <fstream>
 #include <QPixmap>
@@ -35,6 +36,51 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 
 using namespace std;
 
+// roc pairs (response, label) of samples[perm[start..end)] (perm may be NULL), the binary
+// classifiers are evaluated through their batch entry point
+static void TestRoc(Classifier *classifier, const vector<fvec> &samples, const ivec &labels, const u32 *perm, int start, int end, bool bMulticlass, vector<f32pair> &rocData)
+{
+	int count = end - start;
+	if(count <= 0) return;
+	if(bMulticlass)
+	{
+		for(int i=start; i<end; i++)
+		{
+			int index = perm ? perm[i] : i;
+			fvec res = classifier->TestMulti(samples[index]);
+			int max = 0;
+			for(int j=1; j<res.size(); j++) if(res[max] < res[j]) max = j;
+			rocData.push_back(f32pair(max, labels[index]));
+		}
+		return;
+	}
+	int dim = samples[0].size();
+	fvec batch(count*dim), scores(count);
+	FOR(i, count)
+	{
+		const fvec &sample = samples[perm ? perm[start+i] : start+i];
+		FOR(d, dim) batch[i*dim + d] = sample[d];
+	}
+	classifier->TestBatch(&batch[0], &scores[0], count, dim);
+	FOR(i, count) rocData.push_back(f32pair(scores[i], labels[perm ? perm[start+i] : start+i]));
+}
+
+// absolute errors on the last dimension of samples[perm[start..end)] (perm may be NULL), through the batch entry point
+static void TestErrors(Regressor *regressor, const vector<fvec> &samples, const u32 *perm, int start, int end, fvec &errors)
+{
+	int count = end - start;
+	if(count <= 0) return;
+	int dim = samples[0].size();
+	fvec batch(count*dim), outputs(count);
+	FOR(i, count)
+	{
+		const fvec &sample = samples[perm ? perm[start+i] : start+i];
+		FOR(d, dim) batch[i*dim + d] = sample[d];
+	}
+	regressor->TestBatch(&batch[0], &outputs[0], count, dim);
+	FOR(i, count) errors.push_back(fabs(outputs[i] - batch[i*dim + dim-1]));
+}
+
 void MLDemos::Classify()
 {
     if(!canvas || !canvas->data->GetCount()) return;
@@ -49,6 +95,7 @@ void MLDemos::Classify()
 	int tab = optionsClassify->tabWidget->currentIndex();
     if(tab >= classifiers.size() || !classifiers[tab]) return;
     classifier = classifiers[tab]->GetClassifier();
+    modelGeneration++;
     tabUsedForTraining = tab;
     float ratios [] = {.1f,.25f,1.f/3.f,.5f,2.f/3.f,.75f,.9f,1.f};
     int ratioIndex = optionsClassify->traintestRatioCombo->currentIndex();
@@ -104,15 +151,16 @@ void MLDemos::ClassifyCross()
     {
         DEL(classifier);
         classifier = classifiers[tab]->GetClassifier();
+        modelGeneration++;
         trained = Train(classifier, positive, trainRatio);
         if(!trained) break;
-        if(classifier->rocdata.size()>0)
+        if(classifier->roccurves.size()>0)
         {
-            fmeasures[0].push_back(GetBestFMeasure(classifier->rocdata[0]));
+            fmeasures[0].push_back(GetBestFMeasure(classifier->roccurves[0]));
         }
-        if(classifier->rocdata.size()>1)
+        if(classifier->roccurves.size()>1)
         {
-            fmeasures[1].push_back(GetBestFMeasure(classifier->rocdata[1]));
+            fmeasures[1].push_back(GetBestFMeasure(classifier->roccurves[1]));
         }
     }
     classifier->crossval = fmeasures;
@@ -136,6 +184,7 @@ void MLDemos::Regression()
 	int tab = optionsRegress->tabWidget->currentIndex();
     if(tab >= regressors.size() || !regressors[tab]) return;
     regressor = regressors[tab]->GetRegressor();
+    modelGeneration++;
     tabUsedForTraining = tab;
 
     float ratios [] = {.1f,.25f,1.f/3.f,.5f,2.f/3.f,.75f,.9f,1.f};
@@ -161,6 +210,7 @@ void MLDemos::RegressionCross()
 	int tab = optionsRegress->tabWidget->currentIndex();
     if(tab >= regressors.size() || !regressors[tab]) return;
     regressor = regressors[tab]->GetRegressor();
+    modelGeneration++;
     tabUsedForTraining = tab;
 
     float ratios [] = {.1f,.25f,1.f/3.f,.5f,2.f/3.f,.75f,.9f,1.f};
@@ -175,6 +225,7 @@ void MLDemos::RegressionCross()
     {
         DEL(regressor);
         regressor = regressors[tab]->GetRegressor();
+        modelGeneration++;
         Train(regressor, trainRatio);
         if(regressor->trainErrors.size())
         {
@@ -207,6 +258,7 @@ void MLDemos::Dynamize()
 	int tab = optionsDynamic->tabWidget->currentIndex();
     if(tab >= dynamicals.size() || !dynamicals[tab]) return;
     dynamical = dynamicals[tab]->GetDynamical();
+    modelGeneration++;
     tabUsedForTraining = tab;
 
     Train(dynamical);
@@ -297,6 +349,7 @@ void MLDemos::Cluster()
 	int tab = optionsCluster->tabWidget->currentIndex();
     if(tab >= clusterers.size() || !clusterers[tab]) return;
     clusterer = clusterers[tab]->GetClusterer();
+    modelGeneration++;
     tabUsedForTraining = tab;
     Train(clusterer);
 	drawTimer->Stop();
@@ -318,6 +371,7 @@ void MLDemos::ClusterIterate()
     if(!clusterer)
     {
         clusterer = clusterers[tab]->GetClusterer();
+        modelGeneration++;
         tabUsedForTraining = tab;
     }
     else clusterers[tab]->SetParams(clusterer);
@@ -341,6 +395,7 @@ void MLDemos::Maximize()
 	int tab = optionsMaximize->tabWidget->currentIndex();
 	if(tab >= maximizers.size() || !maximizers[tab]) return;
 	maximizer = maximizers[tab]->GetMaximizer();
+	modelGeneration++;
 	maximizer->maxAge = optionsMaximize->iterationsSpin->value();
 	maximizer->stopValue = optionsMaximize->stoppingSpin->value();
 	tabUsedForTraining = tab;
@@ -403,27 +458,14 @@ bool MLDemos::Train(Classifier *classifier, int positive, float trainRatio)
     classifier->rocdata.clear();
     classifier->roclabels.clear();
 
-    vector<fvec> samples = canvas->data->GetSamples();
+    // the dataset is only read, the classifiers that can train in place never get a copy of it
+    const vector<fvec> &samples = canvas->data->Samples();
     if(trainRatio == 1)
     {
-        classifier->Train(samples, newLabels);
+        if(!classifier->TrainInPlace(samples, newLabels, ivec())) classifier->Train(samples, newLabels);
         // we generate the roc curve for this guy
         vector<f32pair> rocData;
-        FOR(i, samples.size())
-        {
-			if(bMulticlass)
-			{
-				fvec res = classifier->TestMulti(samples[i]);
-				int max = 0;
-				for(int j=1; j<res.size(); j++) if(res[max] < res[j]) max = j;
-				rocData.push_back(f32pair(max, newLabels[i]));
-			}
-			else
-			{
-				float resp = classifier->Test(samples[i]);
-				rocData.push_back(f32pair(resp, newLabels[i]));
-			}
-        }
+        TestRoc(classifier, samples, newLabels, 0, 0, samples.size(), bMulticlass, rocData);
         classifier->rocdata.push_back(rocData);
         classifier->roclabels.push_back("training");
     }
@@ -431,56 +473,33 @@ bool MLDemos::Train(Classifier *classifier, int positive, float trainRatio)
     {
         int trainCnt = (int)(samples.size()*trainRatio);
         u32 *perm = randPerm(samples.size());
-        vector<fvec> trainSamples;
-        ivec trainLabels;
-        trainSamples.resize(trainCnt);
-        trainLabels.resize(trainCnt);
-        FOR(i, trainCnt)
+        ivec trainIndices(perm, perm + trainCnt);
+        if(!classifier->TrainInPlace(samples, newLabels, trainIndices))
         {
-            trainSamples[i] = samples[perm[i]];
-            trainLabels[i] = newLabels[perm[i]];
+            vector<fvec> trainSamples;
+            ivec trainLabels;
+            trainSamples.resize(trainCnt);
+            trainLabels.resize(trainCnt);
+            FOR(i, trainCnt)
+            {
+                trainSamples[i] = samples[perm[i]];
+                trainLabels[i] = newLabels[perm[i]];
+            }
+            classifier->Train(trainSamples, trainLabels);
         }
-        classifier->Train(trainSamples, trainLabels);
 
         // we generate the roc curve for this guy
         vector<f32pair> rocData;
-        FOR(i, trainCnt)
-        {
-			if(bMulticlass)
-			{
-				fvec res = classifier->TestMulti(samples[perm[i]]);
-				int max = 0;
-				for(int j=1; j<res.size(); j++) if(res[max] < res[j]) max = j;
-				rocData.push_back(f32pair(max, newLabels[perm[i]]));
-			}
-			else
-			{
-				float resp = classifier->Test(samples[perm[i]]);
-				rocData.push_back(f32pair(resp, newLabels[perm[i]]));
-			}
-        }
+        TestRoc(classifier, samples, newLabels, perm, 0, trainCnt, bMulticlass, rocData);
         classifier->rocdata.push_back(rocData);
         classifier->roclabels.push_back("training");
         rocData.clear();
-        for(int i=trainCnt; i<samples.size(); i++)
-        {
-			if(bMulticlass)
-			{
-				fvec res = classifier->TestMulti(samples[perm[i]]);
-				int max = 0;
-				for(int j=1; j<res.size(); j++) if(res[max] < res[j]) max = j;
-				rocData.push_back(f32pair(max, newLabels[perm[i]]));
-			}
-			else
-			{
-				float resp = classifier->Test(samples[perm[i]]);
-				rocData.push_back(f32pair(resp, newLabels[perm[i]]));
-			}
-        }
+        TestRoc(classifier, samples, newLabels, perm, trainCnt, samples.size(), bMulticlass, rocData);
         classifier->rocdata.push_back(rocData);
         classifier->roclabels.push_back("test");
         KILL(perm);
     }
+    classifier->UpdateRoc();
     bIsRocNew = true;
     bIsCrossNew = true;
     SetROCInfo();
@@ -497,14 +516,7 @@ void MLDemos::Train(Regressor *regressor, float trainRatio)
     {
         regressor->Train(samples, labels);
         trainErrors.clear();
-        FOR(i, samples.size())
-        {
-            fvec sample = samples[i];
-            int dim = sample.size();
-            fvec res = regressor->Test(sample);
-            float error = fabs(res[0] - sample[dim-1]);
-            trainErrors.push_back(error);
-        }
+        TestErrors(regressor, samples, 0, 0, samples.size(), trainErrors);
         regressor->trainErrors = trainErrors;
         regressor->testErrors.clear();
     }
@@ -523,22 +535,8 @@ void MLDemos::Train(Regressor *regressor, float trainRatio)
         }
         regressor->Train(trainSamples, trainLabels);
 
-        FOR(i, trainCnt)
-        {
-            fvec sample = samples[perm[i]];
-            int dim = sample.size();
-            fvec res = regressor->Test(sample);
-            float error = fabs(res[0] - sample[dim-1]);
-            trainErrors.push_back(error);
-        }
-        for(int i=trainCnt; i<samples.size(); i++)
-        {
-            fvec sample = samples[perm[i]];
-            int dim = sample.size();
-            fvec res = regressor->Test(sample);
-            float error = fabs(res[0] - sample[dim-1]);
-            testErrors.push_back(error);
-        }
+        TestErrors(regressor, samples, perm, 0, trainCnt, trainErrors);
+        TestErrors(regressor, samples, perm, trainCnt, samples.size(), testErrors);
         regressor->trainErrors = trainErrors;
         regressor->testErrors = testErrors;
         KILL(perm);
@@ -570,6 +568,7 @@ fvec MLDemos::Train(Dynamical *dynamical)
 	//float dT = 10.f; // time span between each data frame
 	float dT = optionsDynamic->dtSpin->value();
 	dynamical->dT = dT;
+	dynamical->integrator = optionsDynamic->integratorCombo->currentIndex();
 	//dT = 10.f;
 	vector< vector<fvec> > trajectories = canvas->data->GetTrajectories(resampleType, count, centerType, dT, zeroEnding);
 	interpolate(trajectories[0],count);
@@ -588,23 +587,8 @@ void MLDemos::Train(Maximizer *maximizer)
 {
 	if(!maximizer) return;
 	if(canvas->rewardPixmap.isNull()) return;
-	QImage rewardImage = canvas->rewardPixmap.toImage();
-	QRgb *pixels = (QRgb*) rewardImage.bits();
-	int w = rewardImage.width();
-	int h = rewardImage.height();
-	float *data = new float[w*h];
-
-	float maxData = 0;
-	FOR(i, w*h)
-	{
-		data[i] = 1.f - qBlue(pixels[i])/255.f; // all data is in a 0-1 range
-		maxData = max(maxData, data[i]);
-		//data[i] = qRed(pixels[i])*(qAlpha(pixels[i]) / 255.f)/255.f; // all data is in a 0-1 range
-	}
-	if(maxData > 0)
-	{
-		FOR(i, w*h) data[i] /= maxData; // we ensure that the data is normalized
-	}
+	int w = canvas->rewardPixmap.width();
+	int h = canvas->rewardPixmap.height();
 	fvec startingPoint;
 	if(canvas->targets.size())
 	{
@@ -613,9 +597,31 @@ void MLDemos::Train(Maximizer *maximizer)
 		startingPoint[0] = starting.x()/w;
 		startingPoint[1] = starting.y()/h;
 	}
-	maximizer->Train(data, fVec(w,h), startingPoint);
+	if(rewardBenchmark >= 0) // the benchmark functions are evaluated directly
+	{
+		maximizer->Train(RewardFunction(rewardBenchmark), fVec(w,h), startingPoint);
+	}
+	else
+	{
+		QImage rewardImage = canvas->rewardPixmap.toImage();
+		QRgb *pixels = (QRgb*) rewardImage.bits();
+		RewardRaster raster(w, h);
+		float *data = raster.Data();
+
+		float maxData = 0;
+		FOR(i, w*h)
+		{
+			data[i] = 1.f - qBlue(pixels[i])/255.f; // all data is in a 0-1 range
+			maxData = max(maxData, data[i]);
+			//data[i] = qRed(pixels[i])*(qAlpha(pixels[i]) / 255.f)/255.f; // all data is in a 0-1 range
+		}
+		if(maxData > 0)
+		{
+			FOR(i, w*h) data[i] /= maxData; // we ensure that the data is normalized
+		}
+		maximizer->Train(raster, fVec(w,h), startingPoint);
+	}
 	maximizer->age = 0;
-	delete [] data;
 }
 
 void MLDemos::Test(Maximizer *maximizer)
@@ -636,37 +642,45 @@ fvec MLDemos::Test(Dynamical *dynamical, vector< vector<fvec> > trajectories, iv
 	if(!dynamical || !trajectories.size()) return fvec();
 	int dim = trajectories[0][0].size()/2;
 	//(int dim = dynamical->Dim();
-	float dT = dynamical->dT;
-	fvec sample; sample.resize(dim,0);
-	fvec vTrue; vTrue.resize(dim, 0);
 	fvec xMin, xMax;
 	xMin.resize(dim, FLT_MAX);
 	xMax.resize(dim, -FLT_MAX);
 
-	// test each trajectory for errors
-	int errorCnt=0;
-	float errorOne = 0, errorAll = 0;
+	// test each trajectory for errors, the samples of all the trajectories go in a single batch
+	int errorCnt = 0;
+	FOR(i, trajectories.size()) errorCnt += trajectories[i].size();
+	fvec samples(errorCnt*dim), vTrue(errorCnt*dim), velocities(errorCnt*dim);
+	int index = 0;
 	FOR(i, trajectories.size())
 	{
-		vector<fvec> t = trajectories[i];
-		float errorTraj = 0;
-		FOR(j, t.size())
+		FOR(j, trajectories[i].size())
 		{
+			const fvec &t = trajectories[i][j];
 			FOR(d, dim)
 			{
-				sample[d] = t[j][d];
-				vTrue[d] = t[j][d+dim];
-				if(xMin[d] > sample[d]) xMin[d] = sample[d];
-				if(xMax[d] < sample[d]) xMax[d] = sample[d];
+				samples[index*dim + d] = t[d];
+				vTrue[index*dim + d] = t[d+dim];
+				if(xMin[d] > t[d]) xMin[d] = t[d];
+				if(xMax[d] < t[d]) xMax[d] = t[d];
 			}
-			fvec v = dynamical->Test(sample);
+			index++;
+		}
+	}
+	dynamical->TestBatch(&samples[0], &velocities[0], errorCnt, dim);
+	float errorOne = 0, errorAll = 0;
+	index = 0;
+	FOR(i, trajectories.size())
+	{
+		float errorTraj = 0;
+		FOR(j, trajectories[i].size())
+		{
 			float error = 0;
-			FOR(d, dim) error += (v[d] - vTrue[d])*(v[d] - vTrue[d]);
+			FOR(d, dim) error += (velocities[index*dim + d] - vTrue[index*dim + d])*(velocities[index*dim + d] - vTrue[index*dim + d]);
 			errorTraj += error;
-			errorCnt++;
+			index++;
 		}
 		errorOne += errorTraj;
-		errorAll += errorTraj / t.size();
+		errorAll += errorTraj / trajectories[i].size();
 	}
 	errorOne /= errorCnt;
 	errorAll /= trajectories.size();
@@ -674,47 +688,38 @@ fvec MLDemos::Test(Dynamical *dynamical, vector< vector<fvec> > trajectories, iv
 	res.push_back(errorOne);
 
 	vector<fvec> endpoints;
-
-	float errorTarget = 0;
-	// test each trajectory for target
+	vector<fvec> starts(trajectories.size());
+	vector<fvec> ends(trajectories.size());
 	FOR(i, trajectories.size())
 	{
-		fvec pos = trajectories[i][0];
-		fvec end = trajectories[i][trajectories[i].size()-1];
-		FOR(d, dim)
-		{
-			pos.pop_back();
-			end.pop_back();
-		}
-		if(!endpoints.size()) endpoints.push_back(end);
-		else
+		fvec &end = ends[i];
+		starts[i] = fvec(trajectories[i][0].begin(), trajectories[i][0].begin() + dim);
+		end = fvec(trajectories[i].back().begin(), trajectories[i].back().begin() + dim);
+		bool bExists = false;
+		FOR(j, endpoints.size())
 		{
-			bool bExists = false;
-			FOR(j, endpoints.size())
+			if(endpoints[j] == end)
 			{
-				if(endpoints[j] == end)
-				{
-					bExists = true;
-					break;
-				}
+				bExists = true;
+				break;
 			}
-			if(!bExists) endpoints.push_back(end);
-		}
-		int steps = 500;
-		float eps = FLT_MIN;
-		FOR(j, steps)
-		{
-			fvec v = dynamical->Test(pos);
-			float speed = 0;
-			FOR(d, dim) speed += v[d]*v[d];
-			speed = sqrtf(speed);
-			if(speed*dT < eps) break;
-			pos += v*dT;
 		}
+		if(!bExists) endpoints.push_back(end);
+	}
+
+	// test each trajectory for target
+	int steps = 500;
+	Rollout rollout(dynamical, dim, dynamical->integrator);
+	rollout.Start(starts, steps);
+	rollout.Run();
+	float errorTarget = 0;
+	FOR(i, trajectories.size())
+	{
+		const float *pos = rollout.Position(i);
 		float error = 0;
 		FOR(d, dim)
 		{
-			error += (pos[d] - end[d])*(pos[d] - end[d]);
+			error += (pos[d] - ends[i][d])*(pos[d] - ends[i][d]);
 		}
 		error = sqrtf(error);
 		errorTarget += error;
@@ -722,28 +727,24 @@ fvec MLDemos::Test(Dynamical *dynamical, vector< vector<fvec> > trajectories, iv
 	errorTarget /= trajectories.size();
 	res.push_back(errorTarget);
 
+	// random starting points should reach one of the targets
 	fvec xDiff = xMax - xMin;
-	fvec pos; pos.resize(dim);
-	errorTarget = 0;
 	int testCount = 100;
+	starts.resize(testCount);
 	FOR(i, testCount)
 	{
+		starts[i].resize(dim);
 		FOR(d, dim)
 		{
-			pos[d] = ((drand48()*2 - 0.5)*xDiff[d] + xMin[d]);
-		}
-
-		int steps = 500;
-		float eps = FLT_MIN;
-		FOR(j, steps)
-		{
-			fvec v = dynamical->Test(pos);
-			float speed = 0;
-			FOR(d, dim) speed += v[d]*v[d];
-			speed = sqrtf(speed);
-			if(speed*dT < eps) break;
-			pos += v*dT;
+			starts[i][d] = ((drand48()*2 - 0.5)*xDiff[d] + xMin[d]);
 		}
+	}
+	rollout.Start(starts, steps);
+	rollout.Run();
+	errorTarget = 0;
+	FOR(i, testCount)
+	{
+		const float *pos = rollout.Position(i);
 		float minError = FLT_MAX;
 		FOR(j, endpoints.size())
 		{
@@ -752,10 +753,9 @@ fvec MLDemos::Test(Dynamical *dynamical, vector< vector<fvec> > trajectories, iv
 			{
 				error += (pos[d] - endpoints[j][d])*(pos[d] - endpoints[j][d]);
 			}
-			error = sqrtf(error);
 			if(minError > error) minError = error;
 		}
-		errorTarget += minError;
+		errorTarget += sqrtf(minError);
 	}
 	errorTarget /= testCount;
 	res.push_back(errorTarget);
@@ -811,6 +811,7 @@ void MLDemos::Compare()
 			FOR(f, folds)
 			{
 				maximizer = maximizers[tab]->GetMaximizer();
+				modelGeneration++;
 				if(!maximizer) continue;
 				maximizer->maxAge = optionsMaximize->iterationsSpin->value();
 				maximizer->stopValue = optionsMaximize->stoppingSpin->value();
@@ -854,15 +855,16 @@ void MLDemos::Compare()
 			FOR(f, folds)
 			{
 				classifier = classifiers[tab]->GetClassifier();
+				modelGeneration++;
 				if(!classifier) continue;
 				Train(classifier, positive, trainRatio);
-				if(classifier->rocdata.size()>0)
+				if(classifier->roccurves.size()>0)
 				{
-					resultTrain.push_back(GetBestFMeasure(classifier->rocdata[0]));
+					resultTrain.push_back(GetBestFMeasure(classifier->roccurves[0]));
 				}
-				if(classifier->rocdata.size()>1)
+				if(classifier->roccurves.size()>1)
 				{
-					resultTest.push_back(GetBestFMeasure(classifier->rocdata[1]));
+					resultTest.push_back(GetBestFMeasure(classifier->roccurves[1]));
 				}
 				DEL(classifier);
 
@@ -898,6 +900,7 @@ void MLDemos::Compare()
 			FOR(f, folds)
 			{
 				regressor = regressors[tab]->GetRegressor();
+				modelGeneration++;
 				if(!regressor) continue;
 				Train(regressor, trainRatio);
 				if(regressor->trainErrors.size())
@@ -948,6 +951,7 @@ void MLDemos::Compare()
 			FOR(f, folds)
 			{
 				dynamical = dynamicals[tab]->GetDynamical();
+				modelGeneration++;
 				if(!dynamical) continue;
 				fvec results = Train(dynamical);
 				if(results.size())
@@ -370,6 +370,11 @@ void MLDemos::SaveParams( QString filename )
 		if(tab < regressors.size() && regressors[tab])
 		{
 			regressors[tab]->SaveParams(out);
+			// trained models that can be dumped are stored next to the data and restored without retraining
+			if(tab == tabUsedForTraining && regressors[tab]->SaveModel(filename + "-regressor.bin", regressor))
+			{
+				out << groupName << ":" << "binaryModel" << " " << 1 << "\n";
+			}
 		}
 	}
 	if(dynamical)
@@ -387,6 +392,10 @@ void MLDemos::SaveParams( QString filename )
 		if(tab < dynamicals.size() && dynamicals[tab])
 		{
 			dynamicals[tab]->SaveParams(out);
+			if(tab == tabUsedForTraining && dynamicals[tab]->SaveModel(filename + "-dynamical.bin", dynamical))
+			{
+				out << groupName << ":" << "binaryModel" << " " << 1 << "\n";
+			}
 		}
 	}
 	if(clusterer)
@@ -455,6 +464,7 @@ void MLDemos::LoadParams( QString filename )
 	qDebug() << "Skipping "<< sampleCnt <<" samples" << endl;
 	FOR(i, sampleCnt) line = in.readLine();
 	bool bClass = false, bRegr = false, bDyn = false, bClust = false, bMaxim = false;
+	bool bRegrModel = false, bDynModel = false;
 	qDebug() << "Loading parameter list" << endl;
 	int tab = 0;
 	while(!in.atEnd())
@@ -475,6 +485,7 @@ void MLDemos::LoadParams( QString filename )
 			bRegr = true;
 			algorithmOptions->tabWidget->setCurrentWidget(algorithmOptions->tabRegr);
 			if(line.endsWith("tab")) optionsRegress->tabWidget->setCurrentIndex(tab = (int)value);
+			if(line.endsWith("binaryModel")) bRegrModel = (int)value;
 			if(tab < regressors.size() && regressors[tab]) regressors[tab]->LoadParams(line,value);
 		}
 		if(line.startsWith(dynGroup))
@@ -489,6 +500,7 @@ void MLDemos::LoadParams( QString filename )
 			if(line.endsWith("dT")) optionsDynamic->dtSpin->setValue((float)value);
 			if(line.endsWith("colorCheck")) optionsDynamic->colorCheck->setChecked((int)value);
 			if(line.endsWith("tab")) optionsDynamic->tabWidget->setCurrentIndex(tab = (int)value);
+			if(line.endsWith("binaryModel")) bDynModel = (int)value;
 			if(tab < dynamicals.size() && dynamicals[tab]) dynamicals[tab]->LoadParams(line,value);
 		}
 		if(line.startsWith(clustGroup))
@@ -512,8 +524,8 @@ void MLDemos::LoadParams( QString filename )
 	}
 	ResetPositiveClass();
 	if(bClass) Classify();
-	if(bRegr) Regression();
-	if(bDyn) Dynamize();
+	if(bRegr && !(bRegrModel && RestoreRegression(filename + "-regressor.bin"))) Regression();
+	if(bDyn && !(bDynModel && RestoreDynamical(filename + "-dynamical.bin"))) Dynamize();
 	if(bClust) Cluster();
 	if(bMaxim) Maximize();
 	if(algorithmWidget->isVisible())
@@ -525,3 +537,71 @@ void MLDemos::LoadParams( QString filename )
 		actionMaximizers->setChecked(algorithmOptions->tabWidget->currentWidget() == algorithmOptions->tabMax);
 	}
 }
+
+bool MLDemos::RestoreRegression(QString modelFile)
+{
+	if(!canvas || !QFile::exists(modelFile)) return false;
+	int tab = optionsRegress->tabWidget->currentIndex();
+	if(tab >= regressors.size() || !regressors[tab]) return false;
+	drawTimer->Stop();
+	drawTimer->Clear();
+
+	QMutexLocker lock(&mutex);
+	DEL(clusterer);
+	DEL(regressor);
+	DEL(dynamical);
+	DEL(classifier);
+	DEL(maximizer);
+	regressor = regressors[tab]->GetRegressor();
+	modelGeneration++;
+	if(!regressors[tab]->LoadModel(modelFile, regressor))
+	{
+		DEL(regressor);
+		return false;
+	}
+	tabUsedForTraining = tab;
+	regressors[tab]->Draw(canvas, regressor);
+	UpdateInfo();
+	return true;
+}
+
+bool MLDemos::RestoreDynamical(QString modelFile)
+{
+	if(!canvas || !QFile::exists(modelFile)) return false;
+	int tab = optionsDynamic->tabWidget->currentIndex();
+	if(tab >= dynamicals.size() || !dynamicals[tab]) return false;
+	drawTimer->Stop();
+	drawTimer->Clear();
+
+	QMutexLocker lock(&mutex);
+	DEL(clusterer);
+	DEL(regressor);
+	DEL(dynamical);
+	DEL(classifier);
+	DEL(maximizer);
+	dynamical = dynamicals[tab]->GetDynamical();
+	modelGeneration++;
+	dynamical->dT = optionsDynamic->dtSpin->value();
+	if(!dynamicals[tab]->LoadModel(modelFile, dynamical))
+	{
+		DEL(dynamical);
+		return false;
+	}
+	tabUsedForTraining = tab;
+	dynamicals[tab]->Draw(canvas, dynamical);
+
+	// the first index is "none", so we subtract 1
+	int avoidIndex = optionsDynamic->obstacleCombo->currentIndex()-1;
+	if(avoidIndex >=0 && avoidIndex < avoiders.size() && avoiders[avoidIndex])
+	{
+		DEL(dynamical->avoid);
+		dynamical->avoid = avoiders[avoidIndex]->GetObstacleAvoidance();
+	}
+	UpdateInfo();
+	if(dynamicals[tab]->UsesDrawTimer())
+	{
+		drawTimer->bColorMap = optionsDynamic->colorCheck->isChecked();
+		drawTimer->start(QThread::NormalPriority);
+	}
+	return true;
+}
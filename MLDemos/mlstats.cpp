@@ -142,7 +142,7 @@ void MLDemos::SetROCInfo()
 	QSize size(showStats->rocWidget->width(),showStats->rocWidget->height());
 	if(classifier && bIsRocNew)
 	{
-		QPixmap rocImage = RocImage(classifier->rocdata, classifier->roclabels, size);
+		QPixmap rocImage = RocImage(classifier->roccurves, classifier->roclabels, size);
 		bIsRocNew = false;
 	//	rocImage.save("roc.png");
 		rocWidget->ShowImage(rocImage);
@@ -27,7 +27,7 @@ class ObstacleAvoidance
 {
 public:
 	std::vector< Obstacle > obstacles;
-	virtual void SetObstacles(std::vector< Obstacle > obstacles)
+	virtual void SetObstacles(const std::vector< Obstacle > &obstacles)
 	{
 		this->obstacles = obstacles;
 	}
@@ -43,6 +43,21 @@ public:
 		fvec vx=x, vxdot=xdot;
 		return fVec(Avoid(vx, vxdot));
 	}
+	// batch of count samples, x and xdot are row-major (count x dim), xdot is modulated in place
+	virtual void Avoid(const float *x, float *xdot, int count, int dim)
+	{
+		fvec vx(dim), vxdot(dim);
+		FOR(i, count)
+		{
+			FOR(d, dim)
+			{
+				vx[d] = x[i*dim + d];
+				vxdot[d] = xdot[i*dim + d];
+			}
+			fvec newXDot = Avoid(vx, vxdot);
+			FOR(d, dim) xdot[i*dim + d] = newXDot[d];
+		}
+	}
 };
 
 #endif // _OBSTACLES_H_
@@ -0,0 +1,127 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License,
+version 3 as published by the Free Software Foundation.
+
+This library is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#include "pluginLoader.h"
+#include <QCoreApplication>
+#include <QPluginLoader>
+
+QDir PluginLoader::PluginDirectory()
+{
+	QDir pluginsDir = QDir(QCoreApplication::applicationDirPath());
+	QDir alternativeDir = pluginsDir;
+#if defined(Q_OS_WIN)
+	if (pluginsDir.dirName().toLower() == "debug" || pluginsDir.dirName().toLower() == "release") pluginsDir.cdUp();
+#elif defined(Q_OS_MAC)
+	if (pluginsDir.dirName() == "MacOS") {
+		if(!pluginsDir.cd("plugins"))
+		{
+			pluginsDir.cdUp();
+			pluginsDir.cdUp();
+			alternativeDir = pluginsDir;
+			alternativeDir.cd("plugins");
+		}
+		pluginsDir.cdUp();
+	}
+#endif
+	bool bFoundPlugins = false;
+#if defined(DEBUG)
+	bFoundPlugins = pluginsDir.cd("pluginsDebug");
+#else
+	bFoundPlugins = pluginsDir.cd("plugins");
+#endif
+	if(!bFoundPlugins) return alternativeDir;
+	return pluginsDir;
+}
+
+int PluginLoader::Load(QDir directory, QString filter)
+{
+	int count = 0;
+	QStringList filters;
+	if(!filter.isEmpty()) filters << filter;
+	foreach (QString fileName, directory.entryList(filters, QDir::Files))
+	{
+		QPluginLoader loader(directory.absoluteFilePath(fileName));
+		QObject *plugin = loader.instance();
+		if (!plugin) continue;
+		count++;
+		CollectionInterface *iCollection = qobject_cast<CollectionInterface *>(plugin);
+		if(iCollection)
+		{
+			std::vector<ClassifierInterface*> classifierList = iCollection->GetClassifiers();
+			std::vector<ClustererInterface*> clustererList = iCollection->GetClusterers();
+			std::vector<RegressorInterface*> regressorList = iCollection->GetRegressors();
+			std::vector<DynamicalInterface*> dynamicalList = iCollection->GetDynamicals();
+			std::vector<MaximizeInterface*> maximizerList = iCollection->GetMaximizers();
+			classifiers.insert(classifiers.end(), classifierList.begin(), classifierList.end());
+			clusterers.insert(clusterers.end(), clustererList.begin(), clustererList.end());
+			regressors.insert(regressors.end(), regressorList.begin(), regressorList.end());
+			dynamicals.insert(dynamicals.end(), dynamicalList.begin(), dynamicalList.end());
+			maximizers.insert(maximizers.end(), maximizerList.begin(), maximizerList.end());
+			continue;
+		}
+		// a plugin goes in the first list it fits, in the order of the GUI tabs
+		ClassifierInterface *iClassifier = qobject_cast<ClassifierInterface *>(plugin);
+		if(iClassifier)
+		{
+			classifiers.push_back(iClassifier);
+			continue;
+		}
+		ClustererInterface *iClusterer = qobject_cast<ClustererInterface *>(plugin);
+		if(iClusterer)
+		{
+			clusterers.push_back(iClusterer);
+			continue;
+		}
+		RegressorInterface *iRegressor = qobject_cast<RegressorInterface *>(plugin);
+		if(iRegressor)
+		{
+			regressors.push_back(iRegressor);
+			continue;
+		}
+		DynamicalInterface *iDynamical = qobject_cast<DynamicalInterface *>(plugin);
+		if(iDynamical)
+		{
+			dynamicals.push_back(iDynamical);
+			continue;
+		}
+		MaximizeInterface *iMaximize = qobject_cast<MaximizeInterface *>(plugin);
+		if(iMaximize)
+		{
+			maximizers.push_back(iMaximize);
+			continue;
+		}
+		InputOutputInterface *iIO = qobject_cast<InputOutputInterface *>(plugin);
+		if(iIO)
+		{
+			inputs.push_back(iIO);
+			continue;
+		}
+		AvoidanceInterface *iAvoid = qobject_cast<AvoidanceInterface *>(plugin);
+		if(iAvoid) avoiders.push_back(iAvoid);
+	}
+	return count;
+}
+
+MaximizeInterface *PluginLoader::Maximizer(QString name)
+{
+	FOR(i, maximizers.size())
+	{
+		if(maximizers[i]->GetName().compare(name, Qt::CaseInsensitive) == 0) return maximizers[i];
+	}
+	return NULL;
+}
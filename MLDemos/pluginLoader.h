@@ -0,0 +1,49 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License,
+version 3 as published by the Free Software Foundation.
+
+This library is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#ifndef _PLUGIN_LOADER_H_
+#define _PLUGIN_LOADER_H_
+
+#include <vector>
+#include <QDir>
+#include "interfaces.h"
+
+// loads the algorithm and input plugins, for the GUI and the command-line tools alike
+// under a plain QCoreApplication the interfaces build no parameter widget, see ParameterMap
+class PluginLoader
+{
+public:
+	std::vector<ClassifierInterface *> classifiers;
+	std::vector<ClustererInterface *> clusterers;
+	std::vector<RegressorInterface *> regressors;
+	std::vector<DynamicalInterface *> dynamicals;
+	std::vector<MaximizeInterface *> maximizers;
+	std::vector<AvoidanceInterface *> avoiders;
+	std::vector<InputOutputInterface *> inputs;
+
+	// plugins (pluginsDebug in debug builds) next to the application, as for the GUI
+	static QDir PluginDirectory();
+	// returns the number of plugin files that could be loaded, filter restricts them by file name (e.g. "*mld_GMM*")
+	int Load(QDir directory, QString filter=QString());
+	int Load(){return Load(PluginDirectory());};
+
+	// lookup by GetName(), NULL if there is no such plugin
+	MaximizeInterface *Maximizer(QString name);
+};
+
+#endif // _PLUGIN_LOADER_H_
@@ -0,0 +1,93 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License,
+version 3 as published by the Free Software Foundation.
+
+This library is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#include "public.h"
+#include "queryWorker.h"
+#include "mldemos.h"
+#include <algorithm>
+
+#define QUERY_BLOCK 256
+
+QueryWorker::QueryWorker(MLDemos *mldemos, const SampleBatch &samples, bool bLegacy)
+	: mldemos(mldemos), samples(samples), generation(mldemos->modelGeneration), bLegacy(bLegacy)
+{
+	setAutoDelete(true);
+}
+
+const void *QueryWorker::Model(const MLDemos *mldemos, int target)
+{
+	switch(target)
+	{
+	case SampleBatch::CLASSIFIER: return mldemos->classifier;
+	case SampleBatch::REGRESSOR: return mldemos->regressor;
+	case SampleBatch::DYNAMICAL: return mldemos->dynamical;
+	case SampleBatch::CLUSTERER: return mldemos->clusterer;
+	case SampleBatch::MAXIMIZER: return mldemos->maximizer;
+	}
+	return 0;
+}
+
+void QueryWorker::run()
+{
+	SampleBatch results(samples.target);
+	for(int start=0; start<samples.count; start+=QUERY_BLOCK)
+	{
+		QMutexLocker lock(&mldemos->mutex);
+		if(mldemos->modelGeneration != generation || !Model(mldemos, samples.target))
+		{
+			results = SampleBatch(samples.target);
+			break;
+		}
+		Evaluate(mldemos, samples, start, std::min(QUERY_BLOCK, samples.count-start), results);
+	}
+	mldemos->SendBatchResults(results, bLegacy);
+}
+
+void QueryWorker::Evaluate(MLDemos *mldemos, const SampleBatch &samples, int start, int length, SampleBatch &results)
+{
+	if(samples.target == SampleBatch::CLASSIFIER)
+	{
+		// one score per sample, the whole block goes through the batch entry point
+		if(!results.count) results = SampleBatch(samples.target, samples.count, 1);
+		mldemos->classifier->TestBatch(samples.Sample(start), results.Sample(start), length, samples.dim);
+		return;
+	}
+	if(samples.target == SampleBatch::DYNAMICAL)
+	{
+		// velocities have the dimension of the samples
+		if(!results.count) results = SampleBatch(samples.target, samples.count, samples.dim);
+		mldemos->dynamical->TestBatch(samples.Sample(start), results.Sample(start), length, samples.dim);
+		return;
+	}
+	fvec sample(samples.dim);
+	fvec result(1);
+	for(int i=start; i<start+length; i++)
+	{
+		sample.assign(samples.Sample(i), samples.Sample(i) + samples.dim);
+		switch(samples.target)
+		{
+		case SampleBatch::REGRESSOR: result = mldemos->regressor->Test(sample); break;
+		case SampleBatch::CLUSTERER: result = mldemos->clusterer->Test(sample); break;
+		case SampleBatch::MAXIMIZER: result = mldemos->maximizer->Test(sample); break;
+		}
+		// the dimension of the results is the one of the first answer
+		if(!results.count) results = SampleBatch(samples.target, samples.count, result.size());
+		float *dest = results.Sample(i);
+		FOR(d, results.dim) dest[d] = d < result.size() ? result[d] : 0.f;
+	}
+}
@@ -0,0 +1,47 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License,
+version 3 as published by the Free Software Foundation.
+
+This library is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#ifndef _QUERY_WORKER_H_
+#define _QUERY_WORKER_H_
+
+#include <QRunnable>
+#include "sampleBatch.h"
+
+class MLDemos;
+
+// answers a batch of queries from the input/output plugins, away from the gui thread
+// the model is the one in place when the batch was submitted, samples are evaluated in blocks
+// each block holds the model mutex (the plugins' Test functions are not reentrant) so drawing is never held up for a whole batch
+// if the model is replaced or cleared in the meantime, the batch is answered with no results
+// (this is checked on MLDemos::modelGeneration, a new model can be allocated where the old one was)
+class QueryWorker : public QRunnable
+{
+	MLDemos *mldemos;
+	SampleBatch samples;
+	int generation;
+	bool bLegacy; // answer through SendResults(std::vector<fvec>)
+public:
+	QueryWorker(MLDemos *mldemos, const SampleBatch &samples, bool bLegacy=false);
+	void run();
+
+	static const void *Model(const MLDemos *mldemos, int target);
+	// evaluates the samples [start, start+length) with the current model, results are allocated with the first answer
+	static void Evaluate(MLDemos *mldemos, const SampleBatch &samples, int start, int length, SampleBatch &results);
+};
+
+#endif // _QUERY_WORKER_H_
@@ -53,6 +53,17 @@ public:
 	virtual void Train(std::vector< fvec > samples, ivec labels){};
 	virtual fvec Test( const fvec &sample){ return fvec(); };
 	virtual fVec Test(const fVec &sample){ if (dim==2) return fVec(Test((fvec)sample)); fvec s = (fvec)sample; s.resize(dim,0); return Test(s);};
+	// batch of count samples, row-major (count x dim), the first output of Test for each sample
+	virtual void TestBatch(const float *samples, float *outputs, int count, int dim)
+	{
+		fvec sample(dim);
+		FOR(i, count)
+		{
+			FOR(d, dim) sample[d] = samples[i*dim + d];
+			fvec res = Test(sample);
+			outputs[i] = res.size() ? res[0] : 0.f;
+		}
+	};
 	virtual char *GetInfoString(){return NULL;};
 };
 
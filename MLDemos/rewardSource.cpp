@@ -0,0 +1,215 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License,
+version 3 as published by the Free Software Foundation.
+
+This library is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#include "public.h"
+#include "rewardSource.h"
+#include "datasetManager.h"
+#include "optimization_test_functions.h"
+#include <algorithm>
+
+using namespace std;
+
+#define EVALUATION_BLOCK 256
+
+void RewardSource::ValueAtBatch(const float *samples, int count, float *values) const
+{
+	int dim = Dim();
+	FOR(i, count) values[i] = ValueAt(samples + i*dim);
+}
+
+void RewardSource::Evaluate(const float *samples, int count, float *values) const
+{
+	if(count <= 0) return;
+	int dim = Dim();
+	int blocks = (count + EVALUATION_BLOCK - 1) / EVALUATION_BLOCK;
+	// the reward sources are read-only, each thread evaluates whole blocks
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) if(blocks > 1)
+#endif
+	for(int b=0; b<blocks; b++)
+	{
+		int start = b*EVALUATION_BLOCK;
+		int length = min(EVALUATION_BLOCK, count - start);
+		ValueAtBatch(samples + start*dim, length, values + start);
+	}
+}
+
+/************************************************************************/
+/*                            RewardRaster                              */
+/************************************************************************/
+RewardRaster::RewardRaster(int w, int h)
+	: w(w), h(h), data(w*h, 0.f)
+{
+}
+
+RewardRaster::RewardRaster(const float *data, int w, int h)
+	: w(w), h(h), data(data, data + w*h)
+{
+}
+
+float RewardRaster::ValueAt(const float *sample) const
+{
+	int xIndex = max(0, min(w-1, (int)(sample[0]*w)));
+	int yIndex = max(0, min(h-1, (int)(sample[1]*h)));
+	return data[yIndex*w + xIndex];
+}
+
+/************************************************************************/
+/*                             RewardGrid                               */
+/************************************************************************/
+RewardGrid::RewardGrid(const RewardMap &map)
+	: size(map.size), rewards(map.rewards, map.rewards + map.length)
+{
+	stride.resize(size.size(), 1);
+	for(u32 d=1; d<size.size(); d++) stride[d] = stride[d-1]*size[d-1];
+}
+
+RewardGrid::RewardGrid(const float *rewards, const ivec &size)
+	: size(size)
+{
+	stride.resize(size.size(), 1);
+	for(u32 d=1; d<size.size(); d++) stride[d] = stride[d-1]*size[d-1];
+	this->rewards.assign(rewards, rewards + stride.back()*size.back());
+}
+
+float RewardGrid::ValueAt(const float *sample) const
+{
+	int dim = size.size();
+	if(!dim || rewards.empty()) return 0.f;
+	// each corner of the cell containing the sample is weighted by the volume of the opposite sub-cell
+	float value = 0;
+	for(int corner=0; corner < (1<<dim); corner++)
+	{
+		int index = 0;
+		float weight = 1.f;
+		FOR(d, dim)
+		{
+			float u = max(0.f, min(1.f, sample[d]))*size[d] - 0.5f;
+			u = max(0.f, min((float)(size[d]-1), u));
+			int i = (int)u;
+			float t = u - i;
+			if(corner & (1<<d))
+			{
+				i = min(i+1, size[d]-1);
+				weight *= t;
+			}
+			else weight *= 1.f - t;
+			index += i*stride[d];
+		}
+		if(weight > 0) value += weight*rewards[index];
+	}
+	return value;
+}
+
+/************************************************************************/
+/*                           RewardFunction                             */
+/************************************************************************/
+RewardFunction::RewardFunction(int type, int dim)
+	: type(type), dim(dim), minSpace(0), maxSpace(1), minVal(0), maxVal(1)
+{
+	if(type == SIXHUMP) this->dim = dim = 2; // only defined in 2D
+	// the ranges are the ones of the 2D functions, scaled with the dimension for the separable sums
+	float scale = dim/2.f;
+	switch(type)
+	{
+	case GRIEWANGK:
+		minSpace = -60.f;
+		maxSpace = 60.f;
+		minVal = 0;
+		maxVal = 2*scale;
+		break;
+	case RASTRAGIN:
+		minSpace = -5.12f;
+		maxSpace = 5.12f;
+		minVal = 0;
+		maxVal = 82*scale;
+		break;
+	case SCHWEFEL:
+		minSpace = -500.f;
+		maxSpace = 500.f;
+		minVal = -838*scale;
+		maxVal = 838*scale;
+		break;
+	case ACKLEY:
+		minSpace = -2.f;
+		maxSpace = 2.f;
+		minVal = 0;
+		maxVal = 2.3504;
+		break;
+	case SIXHUMP:
+		minSpace = -2;
+		maxSpace = 2;
+		minVal = -1.03159;
+		maxVal = 5.74;
+		break;
+	}
+}
+
+const char *RewardFunction::Name(int type)
+{
+	switch(type)
+	{
+	case GRIEWANGK: return "Griewangk";
+	case RASTRAGIN: return "Rastragin";
+	case SCHWEFEL: return "Schwefel";
+	case ACKLEY: return "Ackley";
+	case SIXHUMP: return "Six-Humps";
+	}
+	return "";
+}
+
+static float EvaluateFunction(int type, Eigen::VectorXd &x)
+{
+	switch(type)
+	{
+	case RewardFunction::GRIEWANGK: return griewangk(x)(0);
+	case RewardFunction::RASTRAGIN: return rastragin(x)(0);
+	case RewardFunction::SCHWEFEL: return schwefel(x)(0);
+	case RewardFunction::ACKLEY: return ackley(x)(0);
+	case RewardFunction::SIXHUMP: return sixhump(x)(0);
+	}
+	return 0;
+}
+
+float RewardFunction::ValueAt(const float *sample) const
+{
+	Eigen::VectorXd x(dim);
+	FOR(d, dim) x[d] = max(0.f, min(1.f, sample[d]))*(maxSpace - minSpace) + minSpace;
+	float value = (EvaluateFunction(type, x) - minVal)/(maxVal - minVal);
+	return 1.f - max(0.f, min(1.f, value));
+}
+
+void RewardFunction::ValueAtBatch(const float *samples, int count, float *values) const
+{
+#ifdef _OPENMP
+#pragma omp parallel if(count > 256)
+#endif
+	{
+		Eigen::VectorXd x(dim);
+#ifdef _OPENMP
+#pragma omp for
+#endif
+		for(int i=0; i<count; i++)
+		{
+			const float *sample = samples + i*dim;
+			FOR(d, dim) x[d] = max(0.f, min(1.f, sample[d]))*(maxSpace - minSpace) + minSpace;
+			float value = (EvaluateFunction(type, x) - minVal)/(maxVal - minVal);
+			values[i] = 1.f - max(0.f, min(1.f, value));
+		}
+	}
+}
@@ -0,0 +1,92 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License,
+version 3 as published by the Free Software Foundation.
+
+This library is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#ifndef _REWARD_SOURCE_H_
+#define _REWARD_SOURCE_H_
+
+#include <vector>
+#include "types.h"
+
+struct RewardMap;
+
+// reward function explored by the maximizers
+// samples live in the unit hypercube [0,1]^Dim(), coordinates outside of it are clamped
+// rewards are in a 0-1 range, the higher the better
+class RewardSource
+{
+public:
+	virtual ~RewardSource(){};
+	virtual RewardSource *Clone() const = 0;
+	virtual int Dim() const = 0;
+	virtual float ValueAt(const float *sample) const = 0;
+	// samples is count x Dim(), row-major
+	virtual void ValueAtBatch(const float *samples, int count, float *values) const;
+	// same as ValueAtBatch, large batches are split into blocks evaluated in parallel
+	void Evaluate(const float *samples, int count, float *values) const;
+};
+
+// w x h image, looked up at the closest pixel (this is what the canvas reward used to be)
+class RewardRaster : public RewardSource
+{
+	int w, h;
+	std::vector<float> data;
+public:
+	RewardRaster(int w, int h);
+	RewardRaster(const float *data, int w, int h);
+	RewardSource *Clone() const {return new RewardRaster(*this);};
+	int Dim() const {return 2;};
+	float ValueAt(const float *sample) const;
+	float *Data(){return &data[0];};
+	int Width() const {return w;};
+	int Height() const {return h;};
+};
+
+// N-dimensional reward map, multilinear interpolation between the centers of its cells
+// the unit hypercube spans the boundaries of the map
+class RewardGrid : public RewardSource
+{
+	ivec size;
+	ivec stride;
+	std::vector<float> rewards;
+public:
+	RewardGrid(const RewardMap &map);
+	RewardGrid(const float *rewards, const ivec &size);
+	RewardSource *Clone() const {return new RewardGrid(*this);};
+	int Dim() const {return size.size();};
+	float ValueAt(const float *sample) const;
+};
+
+// benchmark functions from optimization_test_functions.h, evaluated at full precision
+// the functions are minimized, the reward is 1 at their minimum value and 0 at their maximum value
+class RewardFunction : public RewardSource
+{
+	int type, dim;
+	float minSpace, maxSpace;
+	float minVal, maxVal;
+public:
+	enum {GRIEWANGK=0, RASTRAGIN=1, SCHWEFEL=2, ACKLEY=3, SIXHUMP=4};
+	RewardFunction(int type, int dim=2);
+	RewardSource *Clone() const {return new RewardFunction(*this);};
+	int Dim() const {return dim;};
+	float ValueAt(const float *sample) const;
+	void ValueAtBatch(const float *samples, int count, float *values) const;
+	int Type() const {return type;};
+	static const char *Name(int type);
+};
+
+#endif // _REWARD_SOURCE_H_
@@ -282,182 +282,173 @@ std::vector<f32pair> LoadRoc(const char *filename)
 }
 
 
-float GetBestThreshold( std::vector<f32pair> data )
+/************************************************************************/
+/*                               RocCurve                               */
+/************************************************************************/
+static bool ScoreGreater(const std::pair<float, bool> &e1, const std::pair<float, bool> &e2)
 {
-	if(!data.size()) return 0;
+	return e1.first > e2.first;
+}
 
-	std::vector< std::vector<f32> > measures;
+RocCurve::RocCurve(const std::vector<f32pair> &data)
+	: positives(0), negatives(0)
+{
+	std::vector< std::pair<float, bool> > scores(data.size());
+	FOR(i, data.size()) scores[i] = std::make_pair(data[i].first, data[i].second == 1);
+	Sweep(scores);
+}
 
-	std::sort(data.begin(), data.end(), UDLesser);
+RocCurve::RocCurve(const std::vector<f32pair> &data, float positiveClass)
+	: positives(0), negatives(0)
+{
+	std::vector< std::pair<float, bool> > scores(data.size());
+	FOR(i, data.size()) scores[i] = std::make_pair(data[i].first == positiveClass ? 1.f : 0.f, data[i].second == positiveClass);
+	Sweep(scores);
+}
 
-	fVec oldVal(1,0);
-	FOR(i, data.size())
+void RocCurve::Sweep(std::vector< std::pair<float, bool> > &scores)
+{
+	thresholds.clear();
+	tp.clear();
+	fp.clear();
+	std::sort(scores.begin(), scores.end(), ScoreGreater);
+	// from the highest score down, the counts at a threshold include every sample with the same score
+	u32 tpCount = 0, fpCount = 0;
+	for(u32 i=0; i<scores.size();)
 	{
-		float thresh = data[i].first;
-		u32 tp = 0, fp = 0;
-		u32 fn = 0, tn = 0;
-		FOR(j, data.size())
+		float threshold = scores[i].first;
+		for(; i<scores.size() && scores[i].first == threshold; i++)
 		{
-			if(data[j].second == 1)
-			{
-				if(data[j].first >= thresh) tp++;
-				else fn++;
-			}
-			else 
-			{
-				if(data[j].first >= thresh) fp++;
-				else tn++;
-			}
+			if(scores[i].second) tpCount++;
+			else fpCount++;
 		}
-		fVec val(fp/float(fp+tn), 1 - tp/float(tp+fn));
-		float precision = tp / float(tp+fp);
-		float recall = tp /float(tp+fn);
-		float fmeasure = tp == 0 ? 0 : 2 * (precision * recall) / (precision + recall);
+		thresholds.push_back(threshold);
+		tp.push_back(tpCount);
+		fp.push_back(fpCount);
+	}
+	positives = tpCount;
+	negatives = fpCount;
+	std::reverse(thresholds.begin(), thresholds.end());
+	std::reverse(tp.begin(), tp.end());
+	std::reverse(fp.begin(), fp.end());
+}
 
-		std::vector<f32> dat;
-		dat.push_back(val.x);
-		dat.push_back(val.y);
-		dat.push_back(thresh);
-		dat.push_back(fmeasure);
-		measures.push_back(dat);
+float RocCurve::FMeasure(u32 i) const
+{
+	u32 truePositives = i < size() ? tp[i] : 0;
+	u32 falsePositives = i < size() ? fp[i] : 0;
+	float precision = truePositives / float(truePositives + falsePositives);
+	float recall = truePositives / float(positives);
+	return truePositives == 0 ? 0 : 2 * (precision * recall) / (precision + recall);
+}
 
-		oldVal = val;
-	}
+float RocCurve::FMeasureAt(float threshold) const
+{
+	// no sample scores between the threshold and the first entry at or above it
+	return FMeasure(std::lower_bound(thresholds.begin(), thresholds.end(), threshold) - thresholds.begin());
+}
 
-	float tmax = 0;
+float RocCurve::BestFMeasure() const
+{
 	float fmax = 0;
-	FOR(j, measures.size())
+	FOR(i, size()) fmax = std::max(fmax, FMeasure(i));
+	return fmax;
+}
+
+float RocCurve::BestThreshold() const
+{
+	// the lowest threshold reaching the best f-measure
+	float tmax = 0, fmax = 0;
+	FOR(i, size())
 	{
-		if(measures[j][3] > fmax)
+		float fmeasure = FMeasure(i);
+		if(fmeasure > fmax)
 		{
-			tmax = measures[j][2];
-			fmax = measures[j][3];
+			tmax = thresholds[i];
+			fmax = fmeasure;
 		}
 	}
 	return tmax;
 }
 
-float GetBestFMeasure( std::vector<f32pair> data )
+float RocCurve::AveragePrecision() const
 {
-	if(!data.size()) return 0;
-
-	std::vector< std::vector<f32> > measures;
-
-	std::sort(data.begin(), data.end(), UDLesser);
-
-	fVec oldVal(1,0);
-	FOR(i, data.size())
+	float averagePrecision = 0, oldRecall = 1;
+	FOR(i, size())
 	{
-		float thresh = data[i].first;
-		u32 tp = 0, fp = 0;
-		u32 fn = 0, tn = 0;
-		FOR(j, data.size())
-		{
-			if(data[j].second == 1)
-			{
-				if(data[j].first >= thresh) tp++;
-				else fn++;
-			}
-			else 
-			{
-				if(data[j].first >= thresh) fp++;
-				else tn++;
-			}
-		}
-		fVec val(fp/float(fp+tn), 1 - tp/float(tp+fn));
-		float precision = tp / float(tp+fp);
-		float recall = tp /float(tp+fn);
-		float fmeasure = tp == 0 ? 0 : 2 * (precision * recall) / (precision + recall);
-
-		std::vector<f32> dat;
-		dat.push_back(val.x);
-		dat.push_back(val.y);
-		dat.push_back(thresh);
-		dat.push_back(fmeasure);
-		measures.push_back(dat);
-
-		oldVal = val;
+		float precision = tp[i] / float(tp[i] + fp[i]);
+		float recall = tp[i] / float(positives);
+		averagePrecision += precision*(oldRecall-recall);
+		oldRecall = recall;
 	}
+	return averagePrecision;
+}
 
-	float tmax = 0;
-	float fmax = 0;
-	FOR(j, measures.size())
+std::vector< std::vector<RocCurve> > GetRocCurves(const std::vector< std::vector<f32pair> > &rocdata, bool bMultiClass)
+{
+	std::vector< std::vector<RocCurve> > curves(rocdata.size());
+	// one job per curve: the set it comes from and its positive class
+	std::vector< std::pair<u32, float> > jobs;
+	FOR(d, rocdata.size())
 	{
-		if(measures[j][3] > fmax)
+		if(!bMultiClass)
 		{
-			tmax = measures[j][2];
-			fmax = measures[j][3];
+			curves[d].resize(1);
+			jobs.push_back(std::make_pair(d, 1.f));
+			continue;
 		}
+		fvec classes(rocdata[d].size());
+		FOR(i, rocdata[d].size()) classes[i] = rocdata[d][i].second;
+		std::sort(classes.begin(), classes.end());
+		classes.erase(std::unique(classes.begin(), classes.end()), classes.end());
+		curves[d].resize(classes.size());
+		FOR(c, classes.size()) jobs.push_back(std::make_pair(d, classes[c]));
 	}
-	return fmax;
+	ivec offsets(rocdata.size()+1, 0);
+	FOR(d, rocdata.size()) offsets[d+1] = offsets[d] + curves[d].size();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) if(jobs.size() > 1)
+#endif
+	for(int j=0; j<(int)jobs.size(); j++)
+	{
+		u32 d = jobs[j].first;
+		RocCurve &curve = curves[d][j - offsets[d]];
+		if(bMultiClass) curve = RocCurve(rocdata[d], jobs[j].second);
+		else curve = RocCurve(rocdata[d]);
+	}
+	return curves;
 }
 
+float GetBestFMeasure(const std::vector<RocCurve> &curves)
+{
+	if(!curves.size()) return 0;
+	float fmeasure = 0;
+	FOR(i, curves.size()) fmeasure += curves[i].BestFMeasure();
+	return fmeasure / curves.size();
+}
 
-float GetAveragePrecision( std::vector<f32pair> data )
+float GetBestThreshold(const std::vector<f32pair> &data)
 {
 	if(!data.size()) return 0;
-
-	std::vector< std::vector<f32> > measures;
-
-	std::sort(data.begin(), data.end(), UDLesser);
-
-	float averagePrecision = 0, oldRecall = 1;
-	float m = 0;
-	FOR(i, data.size()) m += data[i].second;
-	FOR(i, data.size())
-	{
-		float thresh = data[i].first;
-		u32 tp = 0, fp = 0;
-		u32 fn = 0, tn = 0;
-		FOR(j, data.size())
-		{
-			if(data[j].second == 1)
-			{
-				if(data[j].first >= thresh) tp++;
-				else fn++;
-			}
-			else 
-			{
-				if(data[j].first >= thresh) fp++;
-				else tn++;
-			}
-		}
-		float t = float(tp+fp);
-		float precision = tp / float(tp+fp);
-		float recall = tp / float(tp+fn);
-		//averagePrecision += precision/t;
-		averagePrecision += precision*(oldRecall-recall);
-		oldRecall = recall;
-	}
-//	averagePrecision /= m
-	return averagePrecision;
+	return RocCurve(data).BestThreshold();
 }
 
-float GetRocValueAt(std::vector<f32pair> data, float threshold)
+float GetBestFMeasure(const std::vector<f32pair> &data)
 {
 	if(!data.size()) return 0;
+	return RocCurve(data).BestFMeasure();
+}
 
-	u32 tp = 0, fp = 0;
-	u32 fn = 0, tn = 0;
-	FOR(j, data.size())
-	{
-		if(data[j].second == 1)
-		{
-			if(data[j].first >= threshold) tp++;
-			else fn++;
-		}
-		else 
-		{
-			if(data[j].first >= threshold) fp++;
-			else tn++;
-		}
-	}
-	fVec val(fp/float(fp+tn), 1 - tp/float(tp+fn));
-	float precision = tp / float(tp+fp);
-	float recall = tp /float(tp+fn);
-	float fmeasure = tp == 0 ? 0 : 2 * (precision * recall) / (precision + recall);
+float GetAveragePrecision(const std::vector<f32pair> &data)
+{
+	if(!data.size()) return 0;
+	return RocCurve(data).AveragePrecision();
+}
 
-	return fmeasure;
+float GetRocValueAt(const std::vector<f32pair> &data, float threshold)
+{
+	if(!data.size()) return 0;
+	return RocCurve(data).FMeasureAt(threshold);
 }
 
 /*
@@ -19,9 +19,50 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #ifndef _ROC_H_
 #define _ROC_H_
 
+#include <vector>
+#include "mymaths.h"
+
 typedef std::pair<float, float> f32pair;
 typedef std::vector<f32pair> rocData;
 
+// true and false positive counts of a set of (score, label) pairs for every threshold, label 1 being the positive class
+// computed with a single sort and a cumulative sweep, entry i counts the samples with score >= thresholds[i]
+// the thresholds are the distinct scores, in increasing order
+class RocCurve
+{
+public:
+	fvec thresholds;
+	std::vector<u32> tp, fp;
+	u32 positives, negatives;
+
+	RocCurve() : positives(0), negatives(0) {};
+	RocCurve(const std::vector<f32pair> &data);
+	// one-vs-rest curve of a multi-class set of (predicted class, label) pairs
+	RocCurve(const std::vector<f32pair> &data, float positiveClass);
+
+	u32 size() const {return thresholds.size();};
+	// false positive rate, 1 - true positive rate (the way the curves are drawn)
+	fVec Point(u32 i) const
+	{
+		if(!negatives || !positives) return fVec();
+		return fVec(fp[i]/float(negatives), 1 - tp[i]/float(positives));
+	};
+	float FMeasure(u32 i) const;
+	float FMeasureAt(float threshold) const;
+	float BestFMeasure() const;
+	float BestThreshold() const;
+	float AveragePrecision() const;
+
+private:
+	void Sweep(std::vector< std::pair<float, bool> > &scores);
+};
+
+// curves of each set of rocdata, multi-class sets are split into one-vs-rest curves (one per label)
+// the curves are independent and computed in parallel
+std::vector< std::vector<RocCurve> > GetRocCurves(const std::vector< std::vector<f32pair> > &rocdata, bool bMultiClass=false);
+// best f-measure of a binary curve, or mean over the classes of one-vs-rest curves
+float GetBestFMeasure(const std::vector<RocCurve> &curves);
+
 /*
 IplImage *GetRocImage();
 void roc_on_mouse( int event, int x, int y, int flags, void* param );
@@ -35,9 +76,9 @@ void SaveRoc(std::vector<f32pair> data, const char *filename);
 std::vector<f32pair> LoadRoc(const char *filename);
 
 std::vector<float> GetBestFMeasures();
-float GetBestThreshold(std::vector<f32pair> data);
-float GetBestFMeasure(std::vector<f32pair> data);
-float GetAveragePrecision(std::vector<f32pair> data);
-float GetRocValueAt(std::vector<f32pair> data, float threshold);
+float GetBestThreshold(const std::vector<f32pair> &data);
+float GetBestFMeasure(const std::vector<f32pair> &data);
+float GetAveragePrecision(const std::vector<f32pair> &data);
+float GetRocValueAt(const std::vector<f32pair> &data, float threshold);
 
 #endif // _ROC_H_
@@ -0,0 +1,197 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License,
+version 3 as published by the Free Software Foundation.
+
+This library is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#include "public.h"
+#include "rollout.h"
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+
+using namespace std;
+
+#define PARALLEL_SIZE 4096 // values per step below which the arithmetic is not worth spreading over threads
+#define MIN_STEP 1e-3f // smallest adaptive step (in units of dT), always accepted
+
+Rollout::Rollout(Dynamical *dynamical, int dim, int integrator)
+	: dT(dynamical ? dynamical->dT : 0.02f), eps(FLT_MIN), tolerance(1e-4f), avoid(0),
+	  dynamical(dynamical), dim(dim), count(0), integrator(integrator), maxSteps(0)
+{
+}
+
+void Rollout::Start(const float *starts, int count, int steps)
+{
+	this->count = count;
+	maxSteps = steps;
+	positions.assign(starts, starts + count*dim);
+	velocities.assign(count*dim, 0.f);
+	bActive.assign(count, steps > 0);
+	this->steps.assign(count, 0);
+	time.assign(count, 0.f);
+	h.assign(count, dT);
+	active.clear();
+	if(steps > 0) FOR(i, count) active.push_back(i);
+}
+
+void Rollout::Start(const std::vector<fvec> &starts, int steps)
+{
+	fvec buffer(starts.size()*dim, 0.f);
+	FOR(i, starts.size())
+	{
+		FOR(d, min((int)starts[i].size(), dim)) buffer[i*dim + d] = starts[i][d];
+	}
+	Start(buffer.size() ? &buffer[0] : 0, starts.size(), steps);
+}
+
+void Rollout::Evaluate(const float *x, float *v, int n)
+{
+	dynamical->TestBatch(x, v, n, dim);
+	if(avoid) avoid->Avoid(x, v, n, dim);
+}
+
+void Rollout::Compact(const ivec &keep)
+{
+	FOR(j, keep.size())
+	{
+		int i = keep[j];
+		active[j] = active[i];
+		FOR(d, dim)
+		{
+			x[j*dim + d] = x[i*dim + d];
+			k1[j*dim + d] = k1[i*dim + d];
+		}
+	}
+	active.resize(keep.size());
+}
+
+int Rollout::Step()
+{
+	int n = active.size();
+	if(!n || !dynamical) return 0;
+	x.resize(n*dim);
+	k1.resize(n*dim);
+	FOR(i, n) FOR(d, dim) x[i*dim + d] = positions[active[i]*dim + d];
+	Evaluate(&x[0], &k1[0], n);
+
+	// the trajectories that have converged stay where they are
+	ivec keep;
+	keep.reserve(n);
+	FOR(i, n)
+	{
+		int t = active[i];
+		const float *v = &k1[i*dim];
+		float speed = 0;
+		FOR(d, dim)
+		{
+			velocities[t*dim + d] = v[d];
+			speed += v[d]*v[d];
+		}
+		speed = sqrtf(speed);
+		if(speed*dT < eps) bActive[t] = 0;
+		else keep.push_back(i);
+	}
+	if(keep.size() < n) Compact(keep);
+	n = active.size();
+	if(!n) return 0;
+	int size = n*dim;
+
+	switch(integrator)
+	{
+	case RK4:
+	{
+		k2.resize(size);
+		k3.resize(size);
+		k4.resize(size);
+		tmp.resize(size);
+		float half = dT*0.5f;
+#ifdef _OPENMP
+#pragma omp parallel for if(size > PARALLEL_SIZE)
+#endif
+		for(int i=0; i<size; i++) tmp[i] = x[i] + k1[i]*half;
+		Evaluate(&tmp[0], &k2[0], n);
+#ifdef _OPENMP
+#pragma omp parallel for if(size > PARALLEL_SIZE)
+#endif
+		for(int i=0; i<size; i++) tmp[i] = x[i] + k2[i]*half;
+		Evaluate(&tmp[0], &k3[0], n);
+#ifdef _OPENMP
+#pragma omp parallel for if(size > PARALLEL_SIZE)
+#endif
+		for(int i=0; i<size; i++) tmp[i] = x[i] + k3[i]*dT;
+		Evaluate(&tmp[0], &k4[0], n);
+#ifdef _OPENMP
+#pragma omp parallel for if(size > PARALLEL_SIZE)
+#endif
+		for(int i=0; i<size; i++) x[i] += (k1[i] + 2*k2[i] + 2*k3[i] + k4[i])*(dT/6.f);
+	}
+		break;
+	case ADAPTIVE:
+	{
+		k2.resize(size);
+		tmp.resize(size);
+		FOR(i, n) FOR(d, dim) tmp[i*dim + d] = x[i*dim + d] + k1[i*dim + d]*h[active[i]];
+		Evaluate(&tmp[0], &k2[0], n);
+		float duration = maxSteps*dT;
+		FOR(i, n)
+		{
+			int t = active[i];
+			float step = h[t];
+			float *xi = &x[i*dim];
+			const float *v1 = &k1[i*dim], *v2 = &k2[i*dim];
+			// the difference between the Euler and Heun steps estimates the local error
+			float error = 0;
+			FOR(d, dim) error += (v2[d] - v1[d])*(v2[d] - v1[d]);
+			error = sqrtf(error)*step*0.5f;
+			float scale = error > 0 ? 0.9f*sqrtf(tolerance/error) : 2.f;
+			if(error <= tolerance || step <= MIN_STEP*dT)
+			{
+				FOR(d, dim) xi[d] += (v1[d] + v2[d])*(step*0.5f);
+				time[t] += step;
+				scale = min(scale, 2.f);
+			}
+			else scale = max(scale, 0.2f);
+			h[t] = max(MIN_STEP*dT, min(step*scale, duration - time[t]));
+		}
+	}
+		break;
+	default: // EULER
+#ifdef _OPENMP
+#pragma omp parallel for if(size > PARALLEL_SIZE)
+#endif
+		for(int i=0; i<size; i++) x[i] += k1[i]*dT;
+		break;
+	}
+
+	// scatter the new positions back and retire the trajectories that are done
+	int kept = 0;
+	FOR(i, n)
+	{
+		int t = active[i];
+		FOR(d, dim) positions[t*dim + d] = x[i*dim + d];
+		steps[t]++;
+		bool bDone = integrator == ADAPTIVE ? time[t] >= maxSteps*dT*(1.f - 1e-6f) : steps[t] >= maxSteps;
+		if(bDone) bActive[t] = 0;
+		else active[kept++] = t;
+	}
+	active.resize(kept);
+	return kept;
+}
+
+void Rollout::Run()
+{
+	while(Step());
+}
@@ -0,0 +1,67 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License,
+version 3 as published by the Free Software Foundation.
+
+This library is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#ifndef _ROLLOUT_H_
+#define _ROLLOUT_H_
+
+#include <vector>
+#include "dynamical.h"
+
+// integrates many trajectories of a dynamical model at once
+// positions are stored contiguously (count x dim), at each step the trajectories that are still moving
+// are gathered and their velocities queried with a single TestBatch (one per stage of the integrator)
+// a trajectory stops when its speed*dT drops below eps or when it has used up its steps
+class Rollout
+{
+public:
+	enum Integrator {EULER=0, RK4, ADAPTIVE}; // ADAPTIVE: Heun steps with an Euler error estimate
+
+	Rollout(Dynamical *dynamical, int dim, int integrator=EULER);
+	// starts is count x dim, the fixed step integrators take at most steps steps of dT,
+	// the adaptive one integrates over the same time span with steps of its own
+	void Start(const float *starts, int count, int steps);
+	void Start(const std::vector<fvec> &starts, int steps);
+	int Step(); // advances every active trajectory, returns how many are still active
+	void Run(); // steps until every trajectory has stopped
+
+	int Count() const {return count;};
+	int Dim() const {return dim;};
+	const float *Position(int i) const {return &positions[i*dim];};
+	const float *Velocity(int i) const {return &velocities[i*dim];}; // at the beginning of the last step
+	bool Active(int i) const {return bActive[i] != 0;};
+
+	float dT;
+	float eps; // convergence threshold on speed*dT
+	float tolerance; // local error allowed per adaptive step
+	ObstacleAvoidance *avoid; // modulates the velocities if set (with its obstacles already set)
+
+private:
+	void Evaluate(const float *x, float *v, int n);
+	void Compact(const ivec &keep); // keeps the gathered rows at keep
+
+	Dynamical *dynamical;
+	int dim, count, integrator, maxSteps;
+	fvec positions, velocities;
+	std::vector<char> bActive;
+	ivec steps;
+	fvec time, h; // adaptive integration
+	ivec active; // indices of the gathered trajectories
+	fvec x, k1, k2, k3, k4, tmp; // gathered states, active.size() x dim
+};
+
+#endif // _ROLLOUT_H_
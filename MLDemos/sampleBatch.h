@@ -0,0 +1,67 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License,
+version 3 as published by the Free Software Foundation.
+
+This library is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#ifndef _SAMPLE_BATCH_H_
+#define _SAMPLE_BATCH_H_
+
+#include <vector>
+#include <QVector>
+#include <QMetaType>
+#include "types.h"
+
+// count x dim samples stored contiguously (row-major), used to query the current model from the input/output plugins
+// the buffer is implicitly shared: copies (e.g. through queued signals) only increase a reference count,
+// writing to a shared batch detaches it first
+class SampleBatch
+{
+public:
+	enum Target {CLASSIFIER=0, REGRESSOR, DYNAMICAL, CLUSTERER, MAXIMIZER};
+	int target;
+	int count, dim;
+	QVector<float> data;
+	qint64 stamp; // set by the sender (e.g. to time round trips), receivers pass it along untouched
+
+	SampleBatch(int target=CLASSIFIER, int count=0, int dim=0)
+		: target(target), count(count), dim(dim), data(count*dim), stamp(0) {};
+
+	float *Sample(int i){return data.data() + i*dim;};
+	const float *Sample(int i) const {return data.constData() + i*dim;};
+
+	static SampleBatch FromSamples(const std::vector<fvec> &samples, int target=CLASSIFIER)
+	{
+		SampleBatch batch(target, samples.size(), samples.size() ? samples[0].size() : 0);
+		float *dest = batch.data.data();
+		FOR(i, samples.size())
+		{
+			// shorter samples are zero-padded, longer ones truncated
+			FOR(d, batch.dim) dest[i*batch.dim + d] = d < samples[i].size() ? samples[i][d] : 0.f;
+		}
+		return batch;
+	};
+
+	std::vector<fvec> ToSamples() const
+	{
+		std::vector<fvec> samples(count);
+		FOR(i, count) samples[i] = fvec(Sample(i), Sample(i) + dim);
+		return samples;
+	};
+};
+
+Q_DECLARE_METATYPE(SampleBatch)
+
+#endif // _SAMPLE_BATCH_H_
@@ -33,3 +33,21 @@ SUBDIRS += WebImport
 PCAFaces.file = $$INPUTPATH/PCAFaces/pluginPCAFaces.pro
 RandomEmitter.file = $$INPUTPATH/RandomEmitter/pluginRandomEmitter.pro
 WebImport.file = $$INPUTPATH/WebImport/pluginWebImport.pro
+
+# command-line tools
+SUBDIRS += MLBench MLRun
+MLBench.file = MLBench/MLBench.pro
+MLRun.file = MLRun/MLRun.pro
+
+# plugin micro-benchmarks (qmake CONFIG+=benchmarks), each compares its plugin to the benchmark.csv of its folder
+CONFIG(benchmarks){
+	BENCHPLUGINS = GMM KernelMethods KNN LWPR Maximizers OpenCV Projections SEDS XMeans
+	for(plugin, BENCHPLUGINS){
+		SUBDIRS += bench$${plugin}
+		eval(bench$${plugin}.file = $$ALGOPATH/$${plugin}/bench$${plugin}.pro)
+		benchmark.recurse += bench$${plugin}
+	}
+	# make benchmark: runs the benchmark target of every bench project (only those define it)
+	benchmark.CONFIG = recursive
+	QMAKE_EXTRA_TARGETS += benchmark
+}
@@ -84,3 +84,11 @@ macx|unix {
 	QMAKE_CXXFLAGS += -Wno-deprecated-declarations
 	QMAKE_CXXFLAGS += -Wno-missing-braces
 }
+
+##########################################
+# OpenMP for the multi-threaded engines  #
+##########################################
+unix:!macx{
+	QMAKE_CXXFLAGS += -fopenmp
+	QMAKE_LFLAGS += -fopenmp
+}
@@ -0,0 +1,29 @@
+# ##########################
+# Configuration      #
+# ##########################
+TEMPLATE = app
+QT -= network
+TARGET = mlrun
+NAME = mlrun
+MLPATH =..
+DESTDIR = $$MLPATH
+
+CONFIG += mainApp console
+macx:CONFIG -= app_bundle
+include($$MLPATH/MLDemos_variables.pri)
+win32:LIBS += -lpsapi
+
+# ##########################
+# Source Files       #
+# ##########################
+HEADERS += $$MLDEMOS/pluginLoader.h \
+	$$MLDEMOS/datasetManager.h \
+	$$MLDEMOS/rewardSource.h \
+	runner.h
+
+SOURCES += main.cpp \
+	runner.cpp \
+	$$MLDEMOS/pluginLoader.cpp \
+	$$MLDEMOS/datasetManager.cpp \
+	$$MLDEMOS/rewardSource.cpp \
+	$$MLDEMOS/mymaths.cpp
@@ -0,0 +1,76 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License,
+version 3 as published by the Free Software Foundation.
+
+This library is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#include <QCoreApplication>
+#include <QFile>
+#include <QTextStream>
+#include <stdio.h>
+#include <pluginLoader.h>
+#include "runner.h"
+
+int main(int argc, char *argv[])
+{
+	QStringList arguments;
+	for(int i=0; i<argc; i++) arguments << QString::fromLocal8Bit(argv[i]);
+
+	Runner runner;
+	QString error;
+	if(!runner.Parse(arguments, error))
+	{
+		fprintf(stderr, "%s\n\n%s", qPrintable(error), qPrintable(Runner::Usage()));
+		return 1;
+	}
+	if(runner.bHelp)
+	{
+		printf("%s", qPrintable(Runner::Usage()));
+		return 0;
+	}
+
+	// without a GUI application the plugin interfaces keep their parameters in a ParameterMap, no display is needed
+	QCoreApplication a(argc, argv);
+
+	PluginLoader loader;
+	loader.Load(runner.plugins.isEmpty() ? PluginLoader::PluginDirectory() : QDir(runner.plugins));
+	if(runner.bList)
+	{
+		Runner::List(loader);
+		return 0;
+	}
+
+	RunReport report;
+	if(!runner.Run(loader, report, error))
+	{
+		fprintf(stderr, "%s\n", qPrintable(error));
+		return 1;
+	}
+	if(runner.output.isEmpty())
+	{
+		printf("%s", qPrintable(report.ToJSON()));
+		return 0;
+	}
+	QFile file(runner.output);
+	if(!file.open(QIODevice::WriteOnly | QIODevice::Text))
+	{
+		fprintf(stderr, "unable to write %s\n", qPrintable(runner.output));
+		return 1;
+	}
+	QTextStream stream(&file);
+	stream << report.ToJSON();
+	file.close();
+	return 0;
+}
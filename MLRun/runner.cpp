@@ -0,0 +1,605 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License,
+version 3 as published by the Free Software Foundation.
+
+This library is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#include <public.h>
+#include <basicMath.h>
+#include <datasetManager.h>
+#include <rewardSource.h>
+#include "runner.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+#include <algorithm>
+#include <map>
+#include <stdio.h>
+#if defined(WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+
+#define RUNNER_CANVAS 512 // nominal drawing size for the maximizers, nothing is drawn
+
+static QString JSONString(QString text)
+{
+	text.replace("\\", "\\\\").replace("\"", "\\\"");
+	return "\"" + text + "\"";
+}
+
+// shuffles the samples into a training and a testing set, everything is used for both if ratio is 1
+static void Split(int count, float ratio, ivec &train, ivec &test)
+{
+	train.clear();
+	test.clear();
+	if(ratio >= 1.f)
+	{
+		FOR(i, count) train.push_back(i);
+		test = train;
+		return;
+	}
+	int trainCnt = max(1, (int)(count*ratio));
+	u32 *perm = randPerm(count);
+	FOR(i, count) (i < (u32)trainCnt ? train : test).push_back(perm[i]);
+	free(perm);
+}
+
+template <typename T>
+static T *Find(const std::vector<T *> &list, QString name, int tab)
+{
+	if(name.isEmpty()) return tab >= 0 && tab < (int)list.size() ? list[tab] : NULL;
+	FOR(i, list.size())
+	{
+		if(list[i]->GetName().compare(name, Qt::CaseInsensitive) == 0) return list[i];
+	}
+	return NULL;
+}
+
+/************************************************************************/
+/*                              RunReport                               */
+/************************************************************************/
+RunReport::RunReport()
+	: dim(0), trainCount(0), testCount(0), trainTime(0), score(0), peakRSS(-1)
+{
+}
+
+double RunReport::Percentile(float fraction) const
+{
+	if(!latencies.size()) return 0;
+	fvec sorted = latencies;
+	int index = min((int)sorted.size()-1, max(0, (int)(fraction*sorted.size())));
+	std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+	return sorted[index];
+}
+
+QString RunReport::ToJSON() const
+{
+	double mean = 0, total = 0;
+	FOR(i, latencies.size()) total += latencies[i];
+	if(latencies.size()) mean = total / latencies.size();
+	return QString("{\n\"type\": %1,\n\"algorithm\": %2,\n\"dim\": %3,\n\"trainCount\": %4,\n\"testCount\": %5,\n"
+				   "\"trainTime\": %6,\n\"testTime\": %7,\n"
+				   "\"latency\": {\"mean\": %8, \"p50\": %9, \"p90\": %10, \"p99\": %11, \"max\": %12},\n"
+				   "\"%13\": %14,\n\"peakRSS\": %15\n}\n")
+			.arg(JSONString(type)).arg(JSONString(algorithm)).arg(dim).arg(trainCount).arg(testCount)
+			.arg(trainTime, 0, 'f', 3).arg(total/1000., 0, 'f', 3)
+			.arg(mean, 0, 'f', 3).arg(Percentile(.5f), 0, 'f', 3).arg(Percentile(.9f), 0, 'f', 3)
+			.arg(Percentile(.99f), 0, 'f', 3).arg(Percentile(1.f), 0, 'f', 3)
+			.arg(metric).arg(score, 0, 'g', 8).arg(peakRSS);
+}
+
+/************************************************************************/
+/*                                Runner                                */
+/************************************************************************/
+Runner::Runner()
+	: tab(-1), positive(1), resampleType(1), resampleCount(100), centerType(0), zeroEnding(1), dT(0.02f),
+	  iterations(200), stopValue(.99), type(-1), trainRatio(1.f), seed(0), function(-1), bList(false), bHelp(false)
+{
+}
+
+QString Runner::TypeName(int type)
+{
+	switch(type)
+	{
+	case CLASSIFICATION: return "classification";
+	case REGRESSION: return "regression";
+	case CLUSTERING: return "clustering";
+	case DYNAMICAL: return "dynamical";
+	case MAXIMIZATION: return "maximization";
+	}
+	return "";
+}
+
+QString Runner::Usage()
+{
+	return
+		"usage: mlrun -d <dataset> [options]\n"
+		"Trains and tests one algorithm plugin on a dataset saved from MLDemos and reports, as JSON,\n"
+		"the training time, the latency of single-sample tests, the peak memory and the accuracy.\n"
+		"\n"
+		"  -d, --data <file>          dataset saved from MLDemos (not needed for maximization)\n"
+		"  -p, --params <file>        parameters saved from MLDemos (default: the dataset file itself)\n"
+		"  -t, --type <type>          classification, regression, clustering, dynamical or maximization\n"
+		"                             (default: the one found in the parameter file)\n"
+		"  -a, --algorithm <name>     plugin to run (see --list, default: the tab saved in the parameter file)\n"
+		"  -r, --ratio <value>        fraction of the samples used for training, the others are tested,\n"
+		"                             1 trains and tests on all of them (default: 1)\n"
+		"  -s, --seed <n>             seed of the train/test split and of the algorithm (default: 0)\n"
+		"  -f, --function <n>         maximization: Griewangk, Rastragin, Schwefel, Ackley or Six-Humps (0-4)\n"
+		"                             (default: the benchmark saved in the parameter file)\n"
+		"  -o, --output <file>        JSON report (default: stdout)\n"
+		"  -P, --plugins <dir>        plugin directory (default: next to the executable)\n"
+		"  -l, --list                 lists the available algorithms\n"
+		"\n"
+		"Scores: classification accuracy, regression mean absolute error, clustering purity,\n"
+		"dynamical mean squared velocity error, maximization best value.\n"
+		"Times are in milliseconds, latencies in microseconds and the peak memory in kilobytes.\n"
+		"No display is needed: the plugins create no widgets and take the parameters from the file.\n";
+}
+
+bool Runner::Parse(QStringList arguments, QString &error)
+{
+	for(int i=1; i<arguments.size(); i++)
+	{
+		QString option = arguments[i];
+		if(option == "-h" || option == "--help") {bHelp = true; continue;}
+		if(option == "-l" || option == "--list") {bList = true; continue;}
+		if(i+1 >= arguments.size())
+		{
+			error = QString("missing value for %1").arg(option);
+			return false;
+		}
+		QString value = arguments[++i];
+		bool ok = true;
+		if(option == "-d" || option == "--data") dataFile = value;
+		else if(option == "-p" || option == "--params") paramFile = value;
+		else if(option == "-a" || option == "--algorithm") algorithm = value;
+		else if(option == "-t" || option == "--type")
+		{
+			type = -1;
+			FOR(t, TYPE_COUNT) if(type == -1 && TypeName(t).startsWith(value, Qt::CaseInsensitive)) type = t;
+			ok = type != -1;
+		}
+		else if(option == "-r" || option == "--ratio") trainRatio = value.toFloat(&ok);
+		else if(option == "-s" || option == "--seed") seed = value.toInt(&ok);
+		else if(option == "-f" || option == "--function") function = value.toInt(&ok);
+		else if(option == "-o" || option == "--output") output = value;
+		else if(option == "-P" || option == "--plugins") plugins = value;
+		else
+		{
+			error = QString("unknown option %1").arg(option);
+			return false;
+		}
+		if(!ok)
+		{
+			error = QString("wrong value for %1: %2").arg(option).arg(value);
+			return false;
+		}
+	}
+	if(bHelp || bList) return true;
+	if(trainRatio <= 0.f || trainRatio > 1.f)
+	{
+		error = "the training ratio must be in ]0,1]";
+		return false;
+	}
+	if(function > RewardFunction::SIXHUMP)
+	{
+		error = QString("unknown function %1").arg(function);
+		return false;
+	}
+	if(paramFile.isEmpty()) paramFile = dataFile;
+	if(!paramFile.isEmpty() && !LoadParams(paramFile, error)) return false;
+	if(type != MAXIMIZATION && dataFile.isEmpty())
+	{
+		error = "no dataset given";
+		return false;
+	}
+	return true;
+}
+
+// same format as MLDemos::LoadParams: the sample count and dimension, the samples, then group:name value lines
+bool Runner::LoadParams(QString filename, QString &error)
+{
+	QFile file(filename);
+	if(!file.open(QFile::ReadOnly | QFile::Text))
+	{
+		error = QString("unable to read %1").arg(filename);
+		return false;
+	}
+	QTextStream in(&file);
+	const char *groups[TYPE_COUNT] = {"classificationOptions", "regressionOptions", "clusterOptions", "dynamicalOptions", "maximizationOptions"};
+	// the samples never start with a group name, so there is no need to count them
+	while(!in.atEnd())
+	{
+		QStringList fields = in.readLine().split(" ", QString::SkipEmptyParts);
+		if(fields.size() != 2) continue;
+		QString line = fields[0];
+		bool ok = false;
+		float value = fields[1].toFloat(&ok);
+		if(!ok) continue;
+		int group = -1;
+		FOR(t, TYPE_COUNT) if(line.startsWith(groups[t])) group = t;
+		if(line.startsWith("clusteringOptions")) group = CLUSTERING; // the name MLDemos::LoadParams looks for
+		if(group == -1) continue;
+		if(type == -1) type = group;
+		if(group != type) continue;
+		if(line.endsWith(":tab")) tab = (int)value;
+		else if(line.endsWith("positiveClass")) positive = (int)value;
+		else if(line.endsWith("resampleType")) resampleType = (int)value;
+		else if(line.endsWith("resampleCount")) resampleCount = (int)value;
+		else if(line.endsWith("centerType")) centerType = (int)value;
+		else if(line.endsWith("zeroCheck")) zeroEnding = (int)value;
+		else if(line.endsWith(":dT")) dT = value;
+		else if(line.endsWith("iterationsSpin")) iterations = (int)value;
+		else if(line.endsWith("stoppingSpin")) stopValue = value;
+		else if(line.endsWith("benchmarkCombo")) {if(function == -1) function = (int)value;}
+		else params.push_back(make_pair(line, value));
+	}
+	return true;
+}
+
+void Runner::List(PluginLoader &loader)
+{
+	FOR(i, loader.classifiers.size()) printf("classification\t%s\n", qPrintable(loader.classifiers[i]->GetName()));
+	FOR(i, loader.regressors.size()) printf("regression\t%s\n", qPrintable(loader.regressors[i]->GetName()));
+	FOR(i, loader.clusterers.size()) printf("clustering\t%s\n", qPrintable(loader.clusterers[i]->GetName()));
+	FOR(i, loader.dynamicals.size()) printf("dynamical\t%s\n", qPrintable(loader.dynamicals[i]->GetName()));
+	FOR(i, loader.maximizers.size()) printf("maximization\t%s\n", qPrintable(loader.maximizers[i]->GetName()));
+}
+
+bool Runner::Run(PluginLoader &loader, RunReport &report, QString &error)
+{
+	// without a type, the algorithm name tells which kind of plugin to look for
+	if(type == -1 && !algorithm.isEmpty())
+	{
+		if(Find(loader.classifiers, algorithm, -1)) type = CLASSIFICATION;
+		else if(Find(loader.regressors, algorithm, -1)) type = REGRESSION;
+		else if(Find(loader.clusterers, algorithm, -1)) type = CLUSTERING;
+		else if(Find(loader.dynamicals, algorithm, -1)) type = DYNAMICAL;
+		else if(Find(loader.maximizers, algorithm, -1)) type = MAXIMIZATION;
+	}
+	if(type == -1)
+	{
+		error = algorithm.isEmpty() ? "no algorithm given and none found in the parameter file" : QString("unknown algorithm %1").arg(algorithm);
+		return false;
+	}
+
+	DatasetManager data;
+	if(type != MAXIMIZATION && !data.Load(qPrintable(dataFile)))
+	{
+		error = QString("unable to read %1").arg(dataFile);
+		return false;
+	}
+	if(type != MAXIMIZATION && !data.GetCount())
+	{
+		error = QString("no samples in %1").arg(dataFile);
+		return false;
+	}
+
+	// the algorithms draw their random numbers from the global generators
+	srand(seed);
+#ifndef WIN32
+	srand48(seed);
+#endif
+	bool bFound = false;
+	switch(type)
+	{
+	case CLASSIFICATION:
+	{
+		ClassifierInterface *plugin = Find(loader.classifiers, algorithm, tab);
+		if(!(bFound = plugin != NULL)) break;
+		FOR(i, params.size()) plugin->LoadParams(params[i].first, params[i].second);
+		// the positive class is kept within the labels, as the GUI does
+		ivec labels = data.GetLabels();
+		int labMin = *std::min_element(labels.begin(), labels.end());
+		int labMax = *std::max_element(labels.begin(), labels.end());
+		Classifier *classifier = plugin->GetClassifier();
+		report = Classify(classifier, data.Samples(), labels, trainRatio, max(labMin, min(labMax, positive)));
+		report.algorithm = plugin->GetAlgoString();
+		DEL(classifier);
+	}
+		break;
+	case REGRESSION:
+	{
+		RegressorInterface *plugin = Find(loader.regressors, algorithm, tab);
+		if(!(bFound = plugin != NULL)) break;
+		FOR(i, params.size()) plugin->LoadParams(params[i].first, params[i].second);
+		Regressor *regressor = plugin->GetRegressor();
+		report = Regress(regressor, data.Samples(), data.GetLabels(), trainRatio);
+		report.algorithm = plugin->GetAlgoString();
+		DEL(regressor);
+	}
+		break;
+	case CLUSTERING:
+	{
+		ClustererInterface *plugin = Find(loader.clusterers, algorithm, tab);
+		if(!(bFound = plugin != NULL)) break;
+		FOR(i, params.size()) plugin->LoadParams(params[i].first, params[i].second);
+		Clusterer *clusterer = plugin->GetClusterer();
+		report = Cluster(clusterer, data.Samples(), data.GetLabels(), trainRatio);
+		report.algorithm = plugin->GetAlgoString();
+		DEL(clusterer);
+	}
+		break;
+	case DYNAMICAL:
+	{
+		DynamicalInterface *plugin = Find(loader.dynamicals, algorithm, tab);
+		if(!(bFound = plugin != NULL)) break;
+		if(!data.GetSequences().size())
+		{
+			error = QString("no trajectories in %1").arg(dataFile);
+			return false;
+		}
+		FOR(i, params.size()) plugin->LoadParams(params[i].first, params[i].second);
+		Dynamical *dynamical = plugin->GetDynamical();
+		dynamical->dT = dT;
+		vector< vector<fvec> > trajectories = data.GetTrajectories(resampleType, resampleCount, centerType, dT, zeroEnding);
+		report = Dynamize(dynamical, trajectories, data.GetLabels());
+		report.algorithm = plugin->GetAlgoString();
+		DEL(dynamical);
+	}
+		break;
+	case MAXIMIZATION:
+	{
+		MaximizeInterface *plugin = Find(loader.maximizers, algorithm, tab);
+		if(!(bFound = plugin != NULL)) break;
+		FOR(i, params.size()) plugin->LoadParams(params[i].first, params[i].second);
+		Maximizer *maximizer = plugin->GetMaximizer();
+		report = Maximize(maximizer, RewardFunction(function == -1 ? RewardFunction::GRIEWANGK : function), iterations, stopValue);
+		report.algorithm = plugin->GetAlgoString();
+		DEL(maximizer);
+	}
+		break;
+	}
+	if(!bFound)
+	{
+		error = algorithm.isEmpty() ? QString("no %1 plugin for tab %2").arg(TypeName(type)).arg(tab)
+									: QString("unknown %1 algorithm %2").arg(TypeName(type)).arg(algorithm);
+		return false;
+	}
+	report.peakRSS = PeakRSS();
+	return true;
+}
+
+RunReport Runner::Classify(Classifier *classifier, const std::vector<fvec> &samples, const ivec &labels, float trainRatio, int positive)
+{
+	RunReport report;
+	report.type = TypeName(CLASSIFICATION);
+	report.metric = "accuracy";
+	if(!classifier || !samples.size()) return report;
+	report.dim = samples[0].size();
+
+	// binary classifiers learn the positive class against all the others
+	bool bMulticlass = classifier->IsMultiClass();
+	ivec newLabels = labels;
+	if(!bMulticlass)
+	{
+		if(positive == 0) FOR(i, labels.size()) newLabels[i] = (!labels[i] || labels[i] == -1) ? 1 : -1;
+		else FOR(i, labels.size()) newLabels[i] = labels[i] == positive ? 1 : -1;
+	}
+	ivec train, test;
+	Split(samples.size(), trainRatio, train, test);
+	// the copy of the training set is only made for the classifiers that cannot train in place
+	QElapsedTimer timer;
+	timer.start();
+	if(!classifier->TrainInPlace(samples, newLabels, train))
+	{
+		vector<fvec> trainSamples(train.size());
+		ivec trainLabels(train.size());
+		FOR(i, train.size())
+		{
+			trainSamples[i] = samples[train[i]];
+			trainLabels[i] = newLabels[train[i]];
+		}
+		timer.restart();
+		classifier->Train(trainSamples, trainLabels);
+	}
+	report.trainTime = timer.nsecsElapsed()/1e6;
+	report.trainCount = train.size();
+
+	int correct = 0;
+	FOR(i, test.size())
+	{
+		const fvec &sample = samples[test[i]];
+		int answer = 0;
+		if(bMulticlass)
+		{
+			timer.restart();
+			fvec res = classifier->TestMulti(sample);
+			report.latencies.push_back(timer.nsecsElapsed()/1e3);
+			for(int j=1; j<(int)res.size(); j++) if(res[answer] < res[j]) answer = j;
+		}
+		else
+		{
+			timer.restart();
+			float resp = classifier->Test(sample);
+			report.latencies.push_back(timer.nsecsElapsed()/1e3);
+			answer = resp > 0 ? 1 : -1;
+		}
+		if(answer == newLabels[test[i]]) correct++;
+	}
+	report.testCount = test.size();
+	report.score = test.size() ? correct / (double)test.size() : 0;
+	return report;
+}
+
+RunReport Runner::Regress(Regressor *regressor, const std::vector<fvec> &samples, const ivec &labels, float trainRatio)
+{
+	RunReport report;
+	report.type = TypeName(REGRESSION);
+	report.metric = "error";
+	if(!regressor || !samples.size()) return report;
+	report.dim = samples[0].size();
+
+	ivec train, test;
+	Split(samples.size(), trainRatio, train, test);
+	vector<fvec> trainSamples(train.size());
+	ivec trainLabels(train.size());
+	FOR(i, train.size())
+	{
+		trainSamples[i] = samples[train[i]];
+		trainLabels[i] = labels[train[i]];
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+	regressor->Train(trainSamples, trainLabels);
+	report.trainTime = timer.nsecsElapsed()/1e6;
+	report.trainCount = train.size();
+
+	// the last dimension is the one being regressed
+	double error = 0;
+	FOR(i, test.size())
+	{
+		const fvec &sample = samples[test[i]];
+		timer.restart();
+		fvec res = regressor->Test(sample);
+		report.latencies.push_back(timer.nsecsElapsed()/1e3);
+		if(res.size()) error += fabs(res[0] - sample[sample.size()-1]);
+	}
+	report.testCount = test.size();
+	report.score = test.size() ? error / test.size() : 0;
+	return report;
+}
+
+RunReport Runner::Cluster(Clusterer *clusterer, const std::vector<fvec> &samples, const ivec &labels, float trainRatio)
+{
+	RunReport report;
+	report.type = TypeName(CLUSTERING);
+	report.metric = "purity";
+	if(!clusterer || !samples.size()) return report;
+	report.dim = samples[0].size();
+
+	ivec train, test;
+	Split(samples.size(), trainRatio, train, test);
+	vector<fvec> trainSamples(train.size());
+	FOR(i, train.size()) trainSamples[i] = samples[train[i]];
+
+	QElapsedTimer timer;
+	timer.start();
+	clusterer->Train(trainSamples);
+	report.trainTime = timer.nsecsElapsed()/1e6;
+	report.trainCount = train.size();
+
+	// purity: each cluster is given its most frequent label, we count the samples that share it
+	map< int, map<int,int> > counts;
+	FOR(i, test.size())
+	{
+		const fvec &sample = samples[test[i]];
+		timer.restart();
+		fvec res = clusterer->Test(sample);
+		report.latencies.push_back(timer.nsecsElapsed()/1e3);
+		int cluster = 0;
+		for(int j=1; j<(int)res.size(); j++) if(res[cluster] < res[j]) cluster = j;
+		counts[cluster][labels[test[i]]]++;
+	}
+	int matching = 0;
+	for(map< int, map<int,int> >::iterator it = counts.begin(); it != counts.end(); it++)
+	{
+		int best = 0;
+		for(map<int,int>::iterator l = it->second.begin(); l != it->second.end(); l++) best = max(best, l->second);
+		matching += best;
+	}
+	report.testCount = test.size();
+	report.score = test.size() ? matching / (double)test.size() : 0;
+	return report;
+}
+
+RunReport Runner::Dynamize(Dynamical *dynamical, const std::vector< std::vector<fvec> > &trajectories, const ivec &labels)
+{
+	RunReport report;
+	report.type = TypeName(DYNAMICAL);
+	report.metric = "velocityError";
+	if(!dynamical || !trajectories.size() || !trajectories[0].size()) return report;
+	int dim = trajectories[0][0].size()/2;
+	report.dim = dim;
+
+	QElapsedTimer timer;
+	timer.start();
+	dynamical->Train(trajectories, labels);
+	report.trainTime = timer.nsecsElapsed()/1e6;
+	report.trainCount = trajectories.size();
+
+	// each point of the trajectories holds the position followed by the velocity
+	double error = 0;
+	FOR(i, trajectories.size())
+	{
+		FOR(j, trajectories[i].size())
+		{
+			const fvec &point = trajectories[i][j];
+			fvec position(point.begin(), point.begin() + dim);
+			timer.restart();
+			fvec velocity = dynamical->Test(position);
+			report.latencies.push_back(timer.nsecsElapsed()/1e3);
+			if((int)velocity.size() < dim) continue;
+			FOR(d, dim) error += (velocity[d] - point[dim+d])*(velocity[d] - point[dim+d]);
+		}
+	}
+	report.testCount = report.latencies.size();
+	report.score = report.testCount ? error / report.testCount : 0;
+	return report;
+}
+
+RunReport Runner::Maximize(Maximizer *maximizer, const RewardSource &reward, int iterations, double stopValue)
+{
+	RunReport report;
+	report.type = TypeName(MAXIMIZATION);
+	report.metric = "best";
+	if(!maximizer) return report;
+	report.dim = reward.Dim();
+	maximizer->maxAge = iterations;
+	maximizer->stopValue = stopValue;
+
+	QElapsedTimer timer;
+	timer.start();
+	maximizer->Train(reward, fVec(RUNNER_CANVAS, RUNNER_CANVAS));
+	report.trainTime = timer.nsecsElapsed()/1e6;
+	maximizer->age = 0;
+
+	// as MLDemos::Test(Maximizer*), each iteration tests the current maximum
+	while(maximizer->age < maximizer->maxAge && maximizer->MaximumValue() < maximizer->stopValue)
+	{
+		timer.restart();
+		maximizer->Test(maximizer->Maximum());
+		report.latencies.push_back(timer.nsecsElapsed()/1e3);
+		maximizer->age++;
+	}
+	report.trainCount = 1;
+	report.testCount = report.latencies.size();
+	report.score = maximizer->MaximumValue();
+	return report;
+}
+
+long Runner::PeakRSS()
+{
+#if defined(WIN32)
+	PROCESS_MEMORY_COUNTERS counters;
+	if(!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return -1;
+	return (long)(counters.PeakWorkingSetSize / 1024);
+#else
+	struct rusage usage;
+	if(getrusage(RUSAGE_SELF, &usage)) return -1;
+#if defined(MACX)
+	return usage.ru_maxrss / 1024; // bytes on mac
+#else
+	return usage.ru_maxrss; // kilobytes on linux
+#endif
+#endif
+}
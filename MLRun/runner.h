@@ -0,0 +1,94 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License,
+version 3 as published by the Free Software Foundation.
+
+This library is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#ifndef _RUNNER_H_
+#define _RUNNER_H_
+
+#include <vector>
+#include <QString>
+#include <QStringList>
+#include <pluginLoader.h>
+
+// what one train/test run measured
+struct RunReport
+{
+	QString type;		// classification, regression, clustering, dynamical or maximization
+	QString algorithm;	// GetAlgoString() of the interface
+	int dim;
+	int trainCount;		// samples (or trajectories) used for training
+	int testCount;		// samples tested one by one
+	double trainTime;	// wall time of Train, in milliseconds
+	fvec latencies;		// wall time of each single-sample Test, in microseconds
+	QString metric;		// accuracy, error, purity, velocityError or best
+	double score;
+	long peakRSS;		// peak resident set size of the process, in kilobytes (-1 if unknown)
+
+	RunReport();
+	// latency below which the given fraction (0-1) of the tests ran
+	double Percentile(float fraction) const;
+	QString ToJSON() const;
+};
+
+// trains and tests any algorithm plugin on a dataset file from the command line
+// it runs under a QCoreApplication, the interfaces then read their parameters from a ParameterMap instead of their widgets
+// the parameters are read from a file saved by MLDemos (the group:name value lines after the samples)
+class Runner
+{
+	std::vector< std::pair<QString, float> > params; // loaded into the interface before training
+	int tab; // algorithm tab saved in the parameter file
+	int positive; // classification: class taken as positive by binary classifiers
+	int resampleType, resampleCount, centerType, zeroEnding; // dynamical: trajectory preprocessing
+	float dT;
+	int iterations; // maximization: iteration cap and value at which to stop
+	double stopValue;
+
+	bool LoadParams(QString filename, QString &error);
+
+public:
+	enum Type {CLASSIFICATION=0, REGRESSION, CLUSTERING, DYNAMICAL, MAXIMIZATION, TYPE_COUNT};
+	int type;
+	QString algorithm;
+	QString dataFile;
+	QString paramFile;
+	QString output;
+	QString plugins;
+	float trainRatio;
+	int seed;
+	int function; // maximization: RewardFunction type
+	bool bList, bHelp;
+
+	Runner();
+	// reads the command line and the parameter file, returns false and a message in error if something is wrong
+	bool Parse(QStringList arguments, QString &error);
+	static QString Usage();
+	static QString TypeName(int type);
+	static void List(PluginLoader &loader);
+
+	// picks the plugin, loads its parameters and runs it on the dataset
+	bool Run(PluginLoader &loader, RunReport &report, QString &error);
+
+	// the measurements themselves, on data that is already in memory
+	static RunReport Classify(Classifier *classifier, const std::vector<fvec> &samples, const ivec &labels, float trainRatio, int positive=1);
+	static RunReport Regress(Regressor *regressor, const std::vector<fvec> &samples, const ivec &labels, float trainRatio);
+	static RunReport Cluster(Clusterer *clusterer, const std::vector<fvec> &samples, const ivec &labels, float trainRatio);
+	static RunReport Dynamize(Dynamical *dynamical, const std::vector< std::vector<fvec> > &trajectories, const ivec &labels);
+	static RunReport Maximize(Maximizer *maximizer, const RewardSource &reward, int iterations, double stopValue);
+	static long PeakRSS();
+};
+
+#endif // _RUNNER_H_
@@ -53,7 +53,8 @@ Optimizer::Optimizer(int NVAR, int NCONS, Eigen::VectorXd LOWERBOUND, Eigen::Vec
 	initType = 0;
 	m_indexInit = 0;
 	m_filenameInit = "";
-	data = 0;
+	m_reward = 0;
+	m_rewardContext = 0;
 }
 
 Optimizer::~Optimizer() {
@@ -153,23 +154,22 @@ bool Optimizer::loadFirstGuessSolutionFromFile(int nvar, string name, Eigen::Mat
 	return flagread;
 }
 
-void Optimizer::SetData(float *data, int w, int h)
+void Optimizer::SetReward(void (*reward)(const float *samples, int count, float *values, const void *context), const void *context)
 {
-	this->data = data;
-	dataW = w;
-	dataH = h;
+	m_reward = reward;
+	m_rewardContext = context;
 }
 
 Eigen::VectorXd Optimizer::EvaluateModel(Eigen::VectorXd& x)
 {
-	if(dim == 2 && data)
+	if(m_reward)
 	{
 		Eigen::VectorXd y(1);
-		int i = (x[0] - m_LOWERBOUND(0)) / (m_UPPERBOUND(0) - m_LOWERBOUND(0)) * dataW;
-		int j = (x[1] - m_LOWERBOUND(1)) / (m_UPPERBOUND(1) - m_LOWERBOUND(1)) * dataH;
-		i = max(0, min(dataW-1, i));
-		j = max(0, min(dataH-1, j));
-		y(0) = 1.f - data[j*dataW + i];
+		std::vector<float> sample(dim);
+		for(int d=0; d<dim; d++) sample[d] = (x[d] - m_LOWERBOUND(d)) / (m_UPPERBOUND(d) - m_LOWERBOUND(d));
+		float value = 0;
+		m_reward(&sample[0], 1, &value, m_rewardContext);
+		y(0) = 1.f - value;
 		return y;
 	}
 	else return m_model(x);
@@ -192,6 +192,24 @@ void Optimizer::evaluateParticles(const int iternumber, const bool useOpenMP, in
 {
 	if(!swarm || !Jswarm || !Cswarm) return;
 
+	if(m_reward && objectiveCount == 1)
+	{
+		// the external reward evaluates the whole swarm in one batch
+		m_rewardSamples.resize(swarmsize*dim);
+		m_rewardValues.resize(swarmsize);
+		for(int i=0;i<swarmsize;i++)
+			for(int j=0;j<dim;j++)
+				m_rewardSamples[i*dim+j] = (swarm[i][j] - m_LOWERBOUND(j)) / (m_UPPERBOUND(j) - m_LOWERBOUND(j));
+		m_reward(&m_rewardSamples[0], swarmsize, &m_rewardValues[0], m_rewardContext);
+		for(int i=0;i<swarmsize;i++)
+		{
+			for(int j=0;j<constraintCount;j++) Cswarm[i][j]=0;
+			Jswarm[i][0]=1.f - m_rewardValues[i];
+		}
+		modelEvaluationsCount += swarmsize;
+		return;
+	}
+
 	Eigen::VectorXd var(dim), objconst(objectiveCount+constraintCount);
 	int chunk=1; double penalty=0;
 
@@ -30,6 +30,7 @@
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <vector>
 
 #include <Eigen/Core>
 
@@ -92,7 +93,9 @@ public:
 	int modelEvaluationsCount;
     Eigen::VectorXd (*m_model)(Eigen::VectorXd& x);
 	Eigen::VectorXd EvaluateModel(Eigen::VectorXd& x);
-	void SetData(float *data, int w, int h);
+	// external reward in [0,1] evaluated on the unit hypercube spanned by the bounds, used instead of m_model when set
+	// the whole swarm is handed over at once (count x dim samples, row-major)
+	void SetReward(void (*reward)(const float *samples, int count, float *values, const void *context), const void *context);
 
 protected:
 	string m_name;
@@ -100,8 +103,9 @@ protected:
     Eigen::VectorXd m_LOWERBOUND, m_UPPERBOUND;
 	Eigen::VectorXd m_GLOWERBOUND, m_GUPPERBOUND;
 	Eigen::VectorXd m_bestFeasible; // best feasible solution if m_feasibleOnly option is on
-	float *data;
-	int dataW, dataH;
+	void (*m_reward)(const float *samples, int count, float *values, const void *context);
+	const void *m_rewardContext;
+	std::vector<float> m_rewardSamples, m_rewardValues;
 
 	int opt_print_level;		//0: no info messages printed on console, the final results are saved in the files; 1: optimization results printed on console and saved to files; 2: iteration results printed on console and to files; 3: iteration and initialization results print
 	int initType;		// = 0: random initialization, = 1: initialization from a given solution, = 2: initialization from a given file
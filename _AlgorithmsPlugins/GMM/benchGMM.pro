@@ -0,0 +1,8 @@
+# ##########################
+# Configuration      #
+# ##########################
+NAME = benchGMM
+PLUGIN = mld_GMM
+MLPATH =../..
+
+include($$MLPATH/MLBench/benchPlugin.pri)
@@ -29,24 +29,26 @@ using namespace std;
 ClassGMM::ClassGMM()
 {
 	params = new Ui::ParametersGMM();
+	widget = 0;
+	if(!ParameterMap::HasGUI()) return;
 	params->setupUi(widget = new QWidget());
 }
 
 void ClassGMM::SetParams(Classifier *classifier)
 {
 	if(!classifier) return;
-	int clusters = params->gmmCount->value();
-	int covType = params->gmmCovarianceCombo->currentIndex();
-	int initType = params->gmmInitCombo->currentIndex();
+	int clusters = widget ? params->gmmCount->value() : options.Get("gmmCount", 1);
+	int covType = widget ? params->gmmCovarianceCombo->currentIndex() : options.Get("gmmCovariance", 0);
+	int initType = widget ? params->gmmInitCombo->currentIndex() : options.Get("gmmInit", 2);
 
 	((ClassifierGMM *)classifier)->SetParams(clusters, covType, initType);
 }
 
 QString ClassGMM::GetAlgoString()
 {
-	int clusters = params->gmmCount->value();
-	int covType = params->gmmCovarianceCombo->currentIndex();
-	int initType = params->gmmInitCombo->currentIndex();
+	int clusters = widget ? params->gmmCount->value() : options.Get("gmmCount", 1);
+	int covType = widget ? params->gmmCovarianceCombo->currentIndex() : options.Get("gmmCovariance", 0);
+	int initType = widget ? params->gmmInitCombo->currentIndex() : options.Get("gmmInit", 2);
 	QString algo = QString("GMM %1").arg(clusters);
 	switch(covType)
 	{
@@ -169,6 +171,11 @@ void ClassGMM::SaveParams(QTextStream &file)
 
 bool ClassGMM::LoadParams(QString name, float value)
 {
+	if(!widget)
+	{
+		options.Set(name, value);
+		return true;
+	}
 	if(name.endsWith("gmmCount")) params->gmmCount->setValue((int)value);
 	if(name.endsWith("gmmCovariance")) params->gmmCovarianceCombo->setCurrentIndex((int)value);
 	if(name.endsWith("gmmInit")) params->gmmInitCombo->setCurrentIndex((int)value);
@@ -31,6 +31,7 @@ class ClassGMM : public QObject, public ClassifierInterface
 private:
 	QWidget *widget;
 	Ui::ParametersGMM *params;
+	ParameterMap options;
 public:
 	ClassGMM();
 	// virtual functions to manage the algorithm creation
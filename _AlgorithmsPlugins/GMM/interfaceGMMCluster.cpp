@@ -27,15 +27,17 @@ using namespace std;
 ClustGMM::ClustGMM()
 {
 	params = new Ui::ParametersGMMClust();
+	widget = 0;
+	if(!ParameterMap::HasGUI()) return;
 	params->setupUi(widget = new QWidget());
 }
 
 void ClustGMM::SetParams(Clusterer *clusterer)
 {
 	if(!clusterer) return;
-	int clusters = params->gmmCount->value();
-	int covType = params->gmmCovarianceCombo->currentIndex();
-	int initType = params->gmmInitCombo->currentIndex();
+	int clusters = widget ? params->gmmCount->value() : options.Get("gmmCount", 1);
+	int covType = widget ? params->gmmCovarianceCombo->currentIndex() : options.Get("gmmCovariance", 0);
+	int initType = widget ? params->gmmInitCombo->currentIndex() : options.Get("gmmInit", 2);
 
 	((ClustererGMM *)clusterer)->SetParams(clusters, covType, initType);
 }
@@ -142,6 +144,11 @@ void ClustGMM::SaveParams(QTextStream &file)
 
 bool ClustGMM::LoadParams(QString name, float value)
 {
+	if(!widget)
+	{
+		options.Set(name, value);
+		return true;
+	}
 	if(name.endsWith("gmmCount")) params->gmmCount->setValue((int)value);
 	if(name.endsWith("gmmCovariance")) params->gmmCovarianceCombo->setCurrentIndex((int)value);
 	if(name.endsWith("gmmInit")) params->gmmInitCombo->setCurrentIndex((int)value);
@@ -31,6 +31,7 @@ class ClustGMM : public QObject, public ClustererInterface
 private:
 	QWidget *widget;
 	Ui::ParametersGMMClust *params;
+	ParameterMap options;
 public:
 	ClustGMM();
 	// virtual functions to manage the algorithm creation
@@ -31,6 +31,7 @@ class DynamicGMM : public QObject, public DynamicalInterface
 private:
 	QWidget *widget;
 	Ui::ParametersGMMDynamic *params;
+	ParameterMap options;
 public:
 	DynamicGMM();
 	// virtual functions to manage the algorithm creation
@@ -27,24 +27,26 @@ using namespace std;
 RegrGMM::RegrGMM()
 {
 	params = new Ui::ParametersGMMRegr();
+	widget = 0;
+	if(!ParameterMap::HasGUI()) return;
 	params->setupUi(widget = new QWidget());
 }
 
 void RegrGMM::SetParams(Regressor *regressor)
 {
 	if(!regressor) return;
-	int clusters = params->gmmCount->value();
-	int covType = params->gmmCovarianceCombo->currentIndex();
-	int initType = params->gmmInitCombo->currentIndex();
+	int clusters = widget ? params->gmmCount->value() : options.Get("gmmCount", 1);
+	int covType = widget ? params->gmmCovarianceCombo->currentIndex() : options.Get("gmmCovariance", 0);
+	int initType = widget ? params->gmmInitCombo->currentIndex() : options.Get("gmmInit", 2);
 
 	((RegressorGMR *)regressor)->SetParams(clusters, covType, initType);
 }
 
 QString RegrGMM::GetAlgoString()
 {
-	int clusters = params->gmmCount->value();
-	int covType = params->gmmCovarianceCombo->currentIndex();
-	int initType = params->gmmInitCombo->currentIndex();
+	int clusters = widget ? params->gmmCount->value() : options.Get("gmmCount", 1);
+	int covType = widget ? params->gmmCovarianceCombo->currentIndex() : options.Get("gmmCovariance", 0);
+	int initType = widget ? params->gmmInitCombo->currentIndex() : options.Get("gmmInit", 2);
 	QString algo = QString("GMM %1").arg(clusters);
 	switch(covType)
 	{
@@ -218,6 +220,11 @@ void RegrGMM::SaveParams(QTextStream &file)
 
 bool RegrGMM::LoadParams(QString name, float value)
 {
+	if(!widget)
+	{
+		options.Set(name, value);
+		return true;
+	}
 	if(name.endsWith("gmmCount")) params->gmmCount->setValue((int)value);
 	if(name.endsWith("gmmCovariance")) params->gmmCovarianceCombo->setCurrentIndex((int)value);
 	if(name.endsWith("gmmInit")) params->gmmInitCombo->setCurrentIndex((int)value);
@@ -31,6 +31,7 @@ class RegrGMM : public QObject, public RegressorInterface
 private:
 	QWidget *widget;
 	Ui::ParametersGMMRegr *params;
+	ParameterMap options;
 public:
 	RegrGMM();
 	// virtual functions to manage the algorithm creation
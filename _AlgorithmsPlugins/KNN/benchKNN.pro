@@ -0,0 +1,8 @@
+# ##########################
+# Configuration      #
+# ##########################
+NAME = benchKNN
+PLUGIN = mld_KNN
+MLPATH =../..
+
+include($$MLPATH/MLBench/benchPlugin.pri)
@@ -26,24 +26,26 @@ using namespace std;
 ClassKNN::ClassKNN()
 {
 	params = new Ui::ParametersKNN();
+	widget = 0;
+	if(!ParameterMap::HasGUI()) return;
 	params->setupUi(widget = new QWidget());
 }
 
 void ClassKNN::SetParams(Classifier *classifier)
 {
 	if(!classifier) return;
-	int k = params->knnKspin->value();
-	int metricType = params->knnNormCombo->currentIndex();
-	int metricP = params->knnNormSpin->value();
+	int k = widget ? params->knnKspin->value() : options.Get("knnK", 2);
+	int metricType = widget ? params->knnNormCombo->currentIndex() : options.Get("knnNorm", 1);
+	int metricP = widget ? params->knnNormSpin->value() : options.Get("knnPower", 5);
 
 	((ClassifierKNN *)classifier)->SetParams(k, metricType, metricP);
 }
 
 QString ClassKNN::GetAlgoString()
 {
-	int k = params->knnKspin->value();
-	int metricType = params->knnNormCombo->currentIndex();
-	int metricP = params->knnNormSpin->value();
+	int k = widget ? params->knnKspin->value() : options.Get("knnK", 2);
+	int metricType = widget ? params->knnNormCombo->currentIndex() : options.Get("knnNorm", 1);
+	int metricP = widget ? params->knnNormSpin->value() : options.Get("knnPower", 5);
 	QString algo = QString("KNN %1 %2").arg(k).arg(metricType==3? 0 : metricType == 2 ? metricP : metricType+1);
 	return algo;
 }
@@ -117,6 +119,11 @@ void ClassKNN::SaveParams(QTextStream &file)
 
 bool ClassKNN::LoadParams(QString name, float value)
 {
+	if(!widget)
+	{
+		options.Set(name, value);
+		return true;
+	}
 	if(name.endsWith("knnK")) params->knnKspin->setValue((int)value);
 	if(name.endsWith("knnNorm")) params->knnNormCombo->setCurrentIndex((int)value);
 	if(name.endsWith("knnPower")) params->knnNormSpin->setValue((int)value);
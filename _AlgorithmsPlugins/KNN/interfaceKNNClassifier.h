@@ -31,6 +31,7 @@ class ClassKNN : public QObject, public ClassifierInterface
 private:
 	QWidget *widget;
 	Ui::ParametersKNN *params;
+	ParameterMap options;
 public:
 	ClassKNN();
 	// virtual functions to manage the algorithm creation
@@ -26,15 +26,17 @@ using namespace std;
 DynamicKNN::DynamicKNN()
 {
 	params = new Ui::ParametersKNNDynamic();
+	widget = 0;
+	if(!ParameterMap::HasGUI()) return;
 	params->setupUi(widget = new QWidget());
 }
 
 void DynamicKNN::SetParams(Dynamical *dynamical)
 {
 	if(!dynamical) return;
-	int k = params->knnKspin->value();
-	int metricType = params->knnNormCombo->currentIndex();
-	int metricP = params->knnNormSpin->value();
+	int k = widget ? params->knnKspin->value() : options.Get("knnK", 2);
+	int metricType = widget ? params->knnNormCombo->currentIndex() : options.Get("knnNorm", 1);
+	int metricP = widget ? params->knnNormSpin->value() : options.Get("knnPower", 5);
 
 	((DynamicalKNN *)dynamical)->SetParams(k, metricType, metricP);
 }
@@ -70,6 +72,11 @@ void DynamicKNN::SaveParams(QTextStream &file)
 
 bool DynamicKNN::LoadParams(QString name, float value)
 {
+	if(!widget)
+	{
+		options.Set(name, value);
+		return true;
+	}
 	if(name.endsWith("knnK")) params->knnKspin->setValue((int)value);
 	if(name.endsWith("knnNorm")) params->knnNormCombo->setCurrentIndex((int)value);
 	if(name.endsWith("knnPower")) params->knnNormSpin->setValue((int)value);
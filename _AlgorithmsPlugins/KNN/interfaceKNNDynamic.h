@@ -31,6 +31,7 @@ class DynamicKNN : public QObject, public DynamicalInterface
 private:
 	QWidget *widget;
 	Ui::ParametersKNNDynamic *params;
+	ParameterMap options;
 public:
 	DynamicKNN();
 	// virtual functions to manage the algorithm creation
@@ -28,24 +28,26 @@ using namespace std;
 RegrKNN::RegrKNN()
 {
 	params = new Ui::ParametersKNNRegress();
+	widget = 0;
+	if(!ParameterMap::HasGUI()) return;
 	params->setupUi(widget = new QWidget());
 }
 
 void RegrKNN::SetParams(Regressor *regressor)
 {
 	if(!regressor) return;
-	int k = params->knnKspin->value();
-	int metricType = params->knnNormCombo->currentIndex();
-	int metricP = params->knnNormSpin->value();
+	int k = widget ? params->knnKspin->value() : options.Get("knnK", 2);
+	int metricType = widget ? params->knnNormCombo->currentIndex() : options.Get("knnNorm", 1);
+	int metricP = widget ? params->knnNormSpin->value() : options.Get("knnPower", 5);
 
 	((RegressorKNN *)regressor)->SetParams(k, metricType, metricP);
 }
 
 QString RegrKNN::GetAlgoString()
 {
-	int k = params->knnKspin->value();
-	int metricType = params->knnNormCombo->currentIndex();
-	int metricP = params->knnNormSpin->value();
+	int k = widget ? params->knnKspin->value() : options.Get("knnK", 2);
+	int metricType = widget ? params->knnNormCombo->currentIndex() : options.Get("knnNorm", 1);
+	int metricP = widget ? params->knnNormSpin->value() : options.Get("knnPower", 5);
 	QString algo = QString("KNN %1 %2").arg(k).arg(metricType==3? 0 : metricType == 2 ? metricP : metricType+1);
 	return algo;
 }
@@ -123,6 +125,11 @@ void RegrKNN::SaveParams(QTextStream &file)
 
 bool RegrKNN::LoadParams(QString name, float value)
 {
+	if(!widget)
+	{
+		options.Set(name, value);
+		return true;
+	}
 	if(name.endsWith("knnK")) params->knnKspin->setValue((int)value);
 	if(name.endsWith("knnNorm")) params->knnNormCombo->setCurrentIndex((int)value);
 	if(name.endsWith("knnPower")) params->knnNormSpin->setValue((int)value);
@@ -31,6 +31,7 @@ class RegrKNN : public QObject, public RegressorInterface
 private:
 	QWidget *widget;
 	Ui::ParametersKNNRegress *params;
+	ParameterMap options;
 public:
 	RegrKNN();
 	// virtual functions to manage the algorithm creation
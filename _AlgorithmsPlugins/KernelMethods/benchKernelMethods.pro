@@ -0,0 +1,8 @@
+# ##########################
+# Configuration      #
+# ##########################
+NAME = benchKernelMethods
+PLUGIN = mld_KernelMethods
+MLPATH =../..
+
+include($$MLPATH/MLBench/benchPlugin.pri)
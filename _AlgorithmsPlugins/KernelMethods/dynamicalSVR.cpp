@@ -200,6 +200,36 @@ fVec DynamicalSVR::Test( const fVec &sample )
 	return res;
 }
 
+void DynamicalSVR::TestBatch(const float *samples, float *velocities, int count, int dim)
+{
+	if(!svm1 || !svm2)
+	{
+		FOR(i, count*dim) velocities[i] = 0;
+		return;
+	}
+	// svm_predict is reentrant, each thread fills its own nodes
+#ifdef _OPENMP
+#pragma omp parallel if(count > 64)
+#endif
+	{
+		svm_node *nodes = new svm_node[dim+1];
+		FOR(d, dim) nodes[d].index = d+1;
+		nodes[dim].index = -1;
+#ifdef _OPENMP
+#pragma omp for
+#endif
+		for(int i=0; i<count; i++)
+		{
+			FOR(d, dim) nodes[d].value = samples[i*dim + d];
+			float *velocity = velocities + i*dim;
+			FOR(d, dim) velocity[d] = 0;
+			velocity[0] = (float)svm_predict(svm1, nodes);
+			if(dim > 1) velocity[1] = (float)svm_predict(svm2, nodes);
+		}
+		delete [] nodes;
+	}
+}
+
 void DynamicalSVR::SetParams(int svmType, float svmC, float svmP, u32 kernelType, float kernelParam)
 {
 	// default values
@@ -37,6 +37,7 @@ public:
 	std::vector<fvec> Test( const fvec &sample, const int count);
 	fvec Test( const fvec &sample);
 	fVec Test(const fVec &sample);
+	void TestBatch(const float *samples, float *velocities, int count, int dim);
 	char *GetInfoString();
 
 	void SetParams(int svmType, float svmC, float svmP, u32 kernelType, float kernelParam);
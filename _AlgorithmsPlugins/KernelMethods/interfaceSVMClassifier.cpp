@@ -27,6 +27,8 @@ using namespace std;
 ClassSVM::ClassSVM()
 {
 	params = new Ui::Parameters();
+	widget = 0;
+	if(!ParameterMap::HasGUI()) return;
 	params->setupUi(widget = new QWidget());
 	connect(params->svmTypeCombo, SIGNAL(currentIndexChanged(int)), this, SLOT(ChangeOptions()));
 }
@@ -63,14 +65,15 @@ void ClassSVM::ChangeOptions()
 
 QString ClassSVM::GetAlgoString()
 {
-	int C = params->svmCSpin->value();
-	int sv = params->maxSVSpin->value();
-	int kernelType = params->kernelTypeCombo->currentIndex();
-	float kernelGamma = params->kernelWidthSpin->value();
-	float kernelDegree = params->kernelDegSpin->value();
+	int svmType = widget ? params->svmTypeCombo->currentIndex() : options.Get("svmType", 0);
+	int C = widget ? params->svmCSpin->value() : options.Get("svmC", 1.f);
+	int sv = widget ? params->maxSVSpin->value() : options.Get("maxSVSpin", 2);
+	int kernelType = widget ? params->kernelTypeCombo->currentIndex() : options.Get("kernelType", 0);
+	float kernelGamma = widget ? params->kernelWidthSpin->value() : options.Get("kernelWidth", 0.1f);
+	float kernelDegree = widget ? params->kernelDegSpin->value() : options.Get("kernelDeg", 2);
 
 	QString algo;
-	switch(params->svmTypeCombo->currentIndex())
+	switch(svmType)
 	{
 	case 0: // C-SVM
 		algo += "C-SVM";
@@ -107,12 +110,12 @@ QString ClassSVM::GetAlgoString()
 void ClassSVM::SetParams(Classifier *classifier)
 {
 	if(!classifier) return;
-	int svmType = params->svmTypeCombo->currentIndex();
-	int maxSV = params->maxSVSpin->value();
-	float svmC = params->svmCSpin->value();
-	int kernelType = params->kernelTypeCombo->currentIndex();
-	float kernelGamma = params->kernelWidthSpin->value();
-	float kernelDegree = params->kernelDegSpin->value();
+	int svmType = widget ? params->svmTypeCombo->currentIndex() : options.Get("svmType", 0);
+	int maxSV = widget ? params->maxSVSpin->value() : options.Get("maxSVSpin", 2);
+	float svmC = widget ? params->svmCSpin->value() : options.Get("svmC", 1.f);
+	int kernelType = widget ? params->kernelTypeCombo->currentIndex() : options.Get("kernelType", 0);
+	float kernelGamma = widget ? params->kernelWidthSpin->value() : options.Get("kernelWidth", 0.1f);
+	float kernelDegree = widget ? params->kernelDegSpin->value() : options.Get("kernelDeg", 2);
 
 	switch(classifier->type)
 	{
@@ -160,7 +163,7 @@ void ClassSVM::SetParams(Classifier *classifier)
 
 Classifier *ClassSVM::GetClassifier()
 {
-	int svmType = params->svmTypeCombo->currentIndex();
+	int svmType = widget ? params->svmTypeCombo->currentIndex() : options.Get("svmType", 0);
 	Classifier *classifier = 0;
 	switch(svmType)
 	{
@@ -298,6 +301,11 @@ void ClassSVM::SaveParams(QTextStream &file)
 
 bool ClassSVM::LoadParams(QString name, float value)
 {
+	if(!widget)
+	{
+		options.Set(name, value);
+		return true;
+	}
 	if(name.endsWith("kernelDeg")) params->kernelDegSpin->setValue((int)value);
 	if(name.endsWith("kernelType")) params->kernelTypeCombo->setCurrentIndex((int)value);
 	if(name.endsWith("kernelWidth")) params->kernelWidthSpin->setValue(value);
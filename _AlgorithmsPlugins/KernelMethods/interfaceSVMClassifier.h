@@ -33,6 +33,7 @@ class ClassSVM : public QObject, public ClassifierInterface
 private:
 	QWidget *widget;
 	Ui::Parameters *params;
+	ParameterMap options;
 public:
 	ClassSVM();
 	// virtual functions to manage the algorithm creation
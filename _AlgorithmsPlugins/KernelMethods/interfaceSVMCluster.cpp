@@ -26,18 +26,20 @@ using namespace std;
 ClustSVM::ClustSVM()
 {
 	params = new Ui::ParametersClust();
+	widget = 0;
+	if(!ParameterMap::HasGUI()) return;
 	params->setupUi(widget = new QWidget());
 }
 
 void ClustSVM::SetParams(Clusterer *clusterer)
 {
 	if(!clusterer) return;
-	float type = params->svmTypeCombo->currentIndex();
-	float svmC = params->svmCSpin->value();
-	int kernelType = params->kernelTypeCombo->currentIndex();
-	float kernelGamma = params->kernelWidthSpin->value();
-	float kernelDegree = params->kernelDegSpin->value();
-	int clusters = params->kernelClusterSpin->value();
+	float type = widget ? params->svmTypeCombo->currentIndex() : options.Get("svmType", 0);
+	float svmC = widget ? params->svmCSpin->value() : options.Get("svmC", 0.1f);
+	int kernelType = widget ? params->kernelTypeCombo->currentIndex() : options.Get("kernelType", 0);
+	float kernelGamma = widget ? params->kernelWidthSpin->value() : options.Get("kernelWidth", 0.1f);
+	float kernelDegree = widget ? params->kernelDegSpin->value() : options.Get("kernelDeg", 2);
+	int clusters = widget ? params->kernelClusterSpin->value() : options.Get("kernelCluster", 2);
 
 	if(type == 0) // One-Class SVM
 	{
@@ -55,7 +57,7 @@ void ClustSVM::SetParams(Clusterer *clusterer)
 
 Clusterer *ClustSVM::GetClusterer()
 {
-	int type = params->svmTypeCombo->currentIndex();
+	int type = widget ? params->svmTypeCombo->currentIndex() : options.Get("svmType", 0);
 	Clusterer *clusterer = 0;
 
 	switch(type)
@@ -174,6 +176,11 @@ void ClustSVM::SaveParams(QTextStream &file)
 
 bool ClustSVM::LoadParams(QString name, float value)
 {
+	if(!widget)
+	{
+		options.Set(name, value);
+		return true;
+	}
 	if(name.endsWith("kernelDeg")) params->kernelDegSpin->setValue((int)value);
 	if(name.endsWith("kernelType")) params->kernelTypeCombo->setCurrentIndex((int)value);
 	if(name.endsWith("kernelWidth")) params->kernelWidthSpin->setValue(value);
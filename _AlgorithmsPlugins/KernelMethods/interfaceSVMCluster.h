@@ -32,6 +32,7 @@ class ClustSVM : public QObject, public ClustererInterface
 private:
 	QWidget *widget;
 	Ui::ParametersClust *params;
+	ParameterMap options;
 public:
 	ClustSVM();
 	// virtual functions to manage the algorithm creation
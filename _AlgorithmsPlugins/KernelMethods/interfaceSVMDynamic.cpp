@@ -26,6 +26,8 @@ using namespace std;
 DynamicSVM::DynamicSVM()
 {
 	params = new Ui::ParametersDynamic();
+	widget = 0;
+	if(!ParameterMap::HasGUI()) return;
 	params->setupUi(widget = new QWidget());
 	connect(params->svmTypeCombo, SIGNAL(currentIndexChanged(int)), this, SLOT(ChangeOptions()));
 }
@@ -62,12 +64,12 @@ void DynamicSVM::ChangeOptions()
 void DynamicSVM::SetParams(Dynamical *dynamical)
 {
 	if(!dynamical) return;
-	int kernelMethod = params->svmTypeCombo->currentIndex();
-	float svmC = params->svmCSpin->value();
-	int kernelType = params->kernelTypeCombo->currentIndex();
-	float kernelGamma = params->kernelWidthSpin->value();
-	float kernelDegree = params->kernelDegSpin->value();
-	float svmP = params->svmPSpin->value();
+	int kernelMethod = widget ? params->svmTypeCombo->currentIndex() : options.Get("svmType", 0);
+	float svmC = widget ? params->svmCSpin->value() : options.Get("svmC", 1.f);
+	int kernelType = widget ? params->kernelTypeCombo->currentIndex() : options.Get("kernelType", 0);
+	float kernelGamma = widget ? params->kernelWidthSpin->value() : options.Get("kernelWidth", 0.1f);
+	float kernelDegree = widget ? params->kernelDegSpin->value() : options.Get("kernelDeg", 2);
+	float svmP = widget ? params->svmPSpin->value() : options.Get("svmP", 0.03f);
 
 	if(kernelMethod == 2) // sogp
 	{
@@ -110,7 +112,7 @@ void DynamicSVM::SetParams(Dynamical *dynamical)
 
 Dynamical *DynamicSVM::GetDynamical()
 {
-	int svmType = params->svmTypeCombo->currentIndex();
+	int svmType = widget ? params->svmTypeCombo->currentIndex() : options.Get("svmType", 0);
 	Dynamical *dynamical = 0;
 	switch(svmType)
 	{
@@ -166,6 +168,11 @@ void DynamicSVM::SaveParams(QTextStream &file)
 
 bool DynamicSVM::LoadParams(QString name, float value)
 {
+	if(!widget)
+	{
+		options.Set(name, value);
+		return true;
+	}
 	if(name.endsWith("kernelDeg")) params->kernelDegSpin->setValue((int)value);
 	if(name.endsWith("kernelType")) params->kernelTypeCombo->setCurrentIndex((int)value);
 	if(name.endsWith("kernelWidth")) params->kernelWidthSpin->setValue(value);
@@ -32,6 +32,7 @@ class DynamicSVM : public QObject, public DynamicalInterface
 private:
 	QWidget *widget;
 	Ui::ParametersDynamic *params;
+	ParameterMap options;
 public:
 	DynamicSVM();
 	// virtual functions to manage the algorithm creation
@@ -26,6 +26,8 @@ using namespace std;
 RegrSVM::RegrSVM()
 {
 	params = new Ui::ParametersRegr();
+	widget = 0;
+	if(!ParameterMap::HasGUI()) return;
 	params->setupUi(widget = new QWidget());
 	connect(params->svmTypeCombo, SIGNAL(currentIndexChanged(int)), this, SLOT(ChangeOptions()));
 }
@@ -75,12 +77,12 @@ void RegrSVM::ChangeOptions()
 void RegrSVM::SetParams(Regressor *regressor)
 {
 	if(!regressor) return;
-	int kernelMethod = params->svmTypeCombo->currentIndex();
-	float svmC = params->svmCSpin->value();
-	int kernelType = params->kernelTypeCombo->currentIndex();
-	float kernelGamma = params->kernelWidthSpin->value();
-	float kernelDegree = params->kernelDegSpin->value();
-	float svmP = params->svmPSpin->value();
+	int kernelMethod = widget ? params->svmTypeCombo->currentIndex() : options.Get("svmType", 0);
+	float svmC = widget ? params->svmCSpin->value() : options.Get("svmC", 1.f);
+	int kernelType = widget ? params->kernelTypeCombo->currentIndex() : options.Get("kernelType", 0);
+	float kernelGamma = widget ? params->kernelWidthSpin->value() : options.Get("kernelWidth", 0.1f);
+	float kernelDegree = widget ? params->kernelDegSpin->value() : options.Get("kernelDeg", 2);
+	float svmP = widget ? params->svmPSpin->value() : options.Get("svmP", 0.03f);
 
 	if(kernelMethod == 2) // rvm
 	{
@@ -135,12 +137,12 @@ void RegrSVM::SetParams(Regressor *regressor)
 
 QString RegrSVM::GetAlgoString()
 {
-	int kernelMethod = params->svmTypeCombo->currentIndex();
-	float svmC = params->svmCSpin->value();
-	int kernelType = params->kernelTypeCombo->currentIndex();
-	float kernelGamma = params->kernelWidthSpin->value();
-	float kernelDegree = params->kernelDegSpin->value();
-	float svmP = params->svmPSpin->value();
+	int kernelMethod = widget ? params->svmTypeCombo->currentIndex() : options.Get("svmType", 0);
+	float svmC = widget ? params->svmCSpin->value() : options.Get("svmC", 1.f);
+	int kernelType = widget ? params->kernelTypeCombo->currentIndex() : options.Get("kernelType", 0);
+	float kernelGamma = widget ? params->kernelWidthSpin->value() : options.Get("kernelWidth", 0.1f);
+	float kernelDegree = widget ? params->kernelDegSpin->value() : options.Get("kernelDeg", 2);
+	float svmP = widget ? params->svmPSpin->value() : options.Get("svmP", 0.03f);
 
 	QString algo;
 	switch(kernelMethod)
@@ -183,7 +185,7 @@ QString RegrSVM::GetAlgoString()
 
 Regressor *RegrSVM::GetRegressor()
 {
-	int svmType = params->svmTypeCombo->currentIndex();
+	int svmType = widget ? params->svmTypeCombo->currentIndex() : options.Get("svmType", 0);
 	Regressor *regressor = 0;
 	switch(svmType)
 	{
@@ -459,6 +461,11 @@ void RegrSVM::SaveParams(QTextStream &file)
 
 bool RegrSVM::LoadParams(QString name, float value)
 {
+	if(!widget)
+	{
+		options.Set(name, value);
+		return true;
+	}
 	if(name.endsWith("kernelDeg")) params->kernelDegSpin->setValue((int)value);
 	if(name.endsWith("kernelType")) params->kernelTypeCombo->setCurrentIndex((int)value);
 	if(name.endsWith("kernelWidth")) params->kernelWidthSpin->setValue(value);
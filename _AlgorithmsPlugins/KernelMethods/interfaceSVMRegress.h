@@ -34,6 +34,7 @@ class RegrSVM : public QObject, public RegressorInterface
 private:
 	QWidget *widget;
 	Ui::ParametersRegr *params;
+	ParameterMap options;
 public:
 	RegrSVM();
 	// virtual functions to manage the algorithm creation
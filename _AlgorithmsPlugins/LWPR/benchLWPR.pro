@@ -0,0 +1,8 @@
+# ##########################
+# Configuration      #
+# ##########################
+NAME = benchLWPR
+PLUGIN = mld_LWPR
+MLPATH =../..
+
+include($$MLPATH/MLBench/benchPlugin.pri)
@@ -119,6 +119,36 @@ void DynamicalLWPR::SetParams(double initD, double initAlpha, double wGen)
 	this->wGen = wGen;
 }
 
+bool DynamicalLWPR::SaveModel(const char *filename)
+{
+	if(!model) return false;
+	return model->writeBinary(filename) != 0;
+}
+
+bool DynamicalLWPR::LoadModel(const char *filename)
+{
+	// the binary file contains the whole set of receptive fields, no need to replay the trajectories
+	LWPR_Object *loaded = 0;
+	try
+	{
+		loaded = new LWPR_Object(filename);
+	}
+	catch(LWPR_Exception &)
+	{
+		return false;
+	}
+	if(loaded->nIn() != loaded->nOut())
+	{
+		delete loaded;
+		return false;
+	}
+	DEL(model);
+	model = loaded;
+	dim = model->nIn();
+	wGen = model->wGen();
+	return true;
+}
+
 char *DynamicalLWPR::GetInfoString()
 {
 	char *text = new char[1024];
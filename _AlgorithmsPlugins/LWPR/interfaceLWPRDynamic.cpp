@@ -26,15 +26,17 @@ using namespace std;
 DynamicLWPR::DynamicLWPR()
 {
 	params = new Ui::ParametersLWPRDynamic();
+	widget = 0;
+	if(!ParameterMap::HasGUI()) return;
 	params->setupUi(widget = new QWidget());
 }
 
 void DynamicLWPR::SetParams(Dynamical *dynamical)
 {
 	if(!dynamical) return;
-	float gen = params->lwprGenSpin->value();
-	float delta = params->lwprInitialDSpin->value();
-	float alpha = params->lwprAlphaSpin->value();
+	float gen = widget ? params->lwprGenSpin->value() : options.Get("lwprGen", 0.2f);
+	float delta = widget ? params->lwprInitialDSpin->value() : options.Get("lwprInitialD", 50.f);
+	float alpha = widget ? params->lwprAlphaSpin->value() : options.Get("lwprAlpha", 250.f);
 
 	((DynamicalLWPR *)dynamical)->SetParams(delta, alpha, gen);
 }
@@ -102,8 +104,25 @@ void DynamicLWPR::SaveParams(QTextStream &file)
 
 bool DynamicLWPR::LoadParams(QString name, float value)
 {
+	if(!widget)
+	{
+		options.Set(name, value);
+		return true;
+	}
 	if(name.endsWith("lwprAlpha")) params->lwprAlphaSpin->setValue(value);
 	if(name.endsWith("lwprInitialD")) params->lwprInitialDSpin->setValue(value);
 	if(name.endsWith("lwprGen")) params->lwprGenSpin->setValue(value);
 	return true;
 }
+
+bool DynamicLWPR::SaveModel(QString filename, Dynamical *dynamical)
+{
+	if(!dynamical) return false;
+	return ((DynamicalLWPR*)dynamical)->SaveModel(filename.toAscii());
+}
+
+bool DynamicLWPR::LoadModel(QString filename, Dynamical *dynamical)
+{
+	if(!dynamical) return false;
+	return ((DynamicalLWPR*)dynamical)->LoadModel(filename.toAscii());
+}
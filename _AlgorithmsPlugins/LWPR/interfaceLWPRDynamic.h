@@ -31,6 +31,7 @@ class DynamicLWPR : public QObject, public DynamicalInterface
 private:
 	QWidget *widget;
 	Ui::ParametersLWPRDynamic *params;
+	ParameterMap options;
 public:
 	DynamicLWPR();
 	// virtual functions to manage the algorithm creation
@@ -49,6 +50,8 @@ public:
 	bool LoadOptions(QSettings &settings);
 	void SaveParams(QTextStream &stream);
 	bool LoadParams(QString name, float value);
+	bool SaveModel(QString filename, Dynamical *dynamical);
+	bool LoadModel(QString filename, Dynamical *dynamical);
 };
 
 #endif // _INTERFACELWPRDYNAMIC_H_
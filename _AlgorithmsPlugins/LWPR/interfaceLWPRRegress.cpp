@@ -26,24 +26,26 @@ using namespace std;
 RegrLWPR::RegrLWPR()
 {
 	params = new Ui::ParametersLWPRRegress();
+	widget = 0;
+	if(!ParameterMap::HasGUI()) return;
 	params->setupUi(widget = new QWidget());
 }
 
 void RegrLWPR::SetParams(Regressor *regressor)
 {
 	if(!regressor) return;
-	float gen = params->lwprGenSpin->value();
-	float delta = params->lwprInitialDSpin->value();
-	float alpha = params->lwprAlphaSpin->value();
+	float gen = widget ? params->lwprGenSpin->value() : options.Get("lwprGen", 0.2f);
+	float delta = widget ? params->lwprInitialDSpin->value() : options.Get("lwprInitialD", 50.f);
+	float alpha = widget ? params->lwprAlphaSpin->value() : options.Get("lwprAlpha", 250.f);
 
 	((RegressorLWPR*)regressor)->SetParams(delta, alpha, gen);
 }
 
 QString RegrLWPR::GetAlgoString()
 {
-	float gen = params->lwprGenSpin->value();
-	float delta = params->lwprInitialDSpin->value();
-	float alpha = params->lwprAlphaSpin->value();
+	float gen = widget ? params->lwprGenSpin->value() : options.Get("lwprGen", 0.2f);
+	float delta = widget ? params->lwprInitialDSpin->value() : options.Get("lwprInitialD", 50.f);
+	float alpha = widget ? params->lwprAlphaSpin->value() : options.Get("lwprAlpha", 250.f);
 
 	QString algo = QString("LWPR %1 %2 %3").arg(gen).arg(delta).arg(alpha);
 	return algo;
@@ -149,8 +151,25 @@ void RegrLWPR::SaveParams(QTextStream &file)
 
 bool RegrLWPR::LoadParams(QString name, float value)
 {
+	if(!widget)
+	{
+		options.Set(name, value);
+		return true;
+	}
 	if(name.endsWith("lwprAlpha")) params->lwprAlphaSpin->setValue(value);
 	if(name.endsWith("lwprInitialD")) params->lwprInitialDSpin->setValue(value);
 	if(name.endsWith("lwprGen")) params->lwprGenSpin->setValue(value);
 	return true;
 }
+
+bool RegrLWPR::SaveModel(QString filename, Regressor *regressor)
+{
+	if(!regressor) return false;
+	return ((RegressorLWPR*)regressor)->SaveModel(filename.toAscii());
+}
+
+bool RegrLWPR::LoadModel(QString filename, Regressor *regressor)
+{
+	if(!regressor) return false;
+	return ((RegressorLWPR*)regressor)->LoadModel(filename.toAscii());
+}
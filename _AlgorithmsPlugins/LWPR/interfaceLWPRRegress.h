@@ -31,6 +31,7 @@ class RegrLWPR : public QObject, public RegressorInterface
 private:
 	QWidget *widget;
 	Ui::ParametersLWPRRegress *params;
+	ParameterMap options;
 public:
 	RegrLWPR();
 	// virtual functions to manage the algorithm creation
@@ -49,6 +50,8 @@ public:
 	bool LoadOptions(QSettings &settings);
 	void SaveParams(QTextStream &stream);
 	bool LoadParams(QString name, float value);
+	bool SaveModel(QString filename, Regressor *regressor);
+	bool LoadModel(QString filename, Regressor *regressor);
 };
 
 #endif // _INTERFACELWPRREGRESS_H_
@@ -72,6 +72,36 @@ void RegressorLWPR::SetParams(double initD, double initAlpha, double wGen)
 	this->wGen = wGen;
 }
 
+bool RegressorLWPR::SaveModel(const char *filename)
+{
+	if(!model) return false;
+	return model->writeBinary(filename) != 0;
+}
+
+bool RegressorLWPR::LoadModel(const char *filename)
+{
+	// the binary file contains the whole set of receptive fields, no need to replay the samples
+	LWPR_Object *loaded = 0;
+	try
+	{
+		loaded = new LWPR_Object(filename);
+	}
+	catch(LWPR_Exception &)
+	{
+		return false;
+	}
+	if(loaded->nIn() != 1 || loaded->nOut() != 1)
+	{
+		delete loaded;
+		return false;
+	}
+	DEL(model);
+	model = loaded;
+	dim = model->nIn() + 1;
+	wGen = model->wGen();
+	return true;
+}
+
 char *RegressorLWPR::GetInfoString()
 {
 	char *text = new char[1024];
@@ -40,6 +40,8 @@ public:
 
 	void SetParams(double initD, double initAlpha, double wGen);
 	LWPR_Object *GetModel(){return model;};
+	bool SaveModel(const char *filename);
+	bool LoadModel(const char *filename);
 };
 
 #endif // _REGRESSOR_LWPR_H_
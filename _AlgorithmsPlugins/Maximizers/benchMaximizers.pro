@@ -0,0 +1,8 @@
+# ##########################
+# Configuration      #
+# ##########################
+NAME = benchMaximizers
+PLUGIN = mld_Maximizers
+MLPATH =../..
+
+include($$MLPATH/MLBench/benchPlugin.pri)
@@ -9,188 +9,102 @@ using namespace std;
 /*                 Genetic Algorithm Training Procedure                 */
 /************************************************************************/
 
-GATrain::GATrain(float *data, int w, int h, int populationSize, int dim)
-:	dim(dim), popSize(populationSize), data(data), w(w), h(h),
-	alphaMute(0.01f), alphaCross(0.5f), alphaSurvivors(0.2f),
-	bestFitness(0), meanFitness(0), best(GAPeon(dim))
+GATrain::GATrain(const RewardSource *reward, int populationSize, int dim)
+:	best(dim, 0.f), dim(dim), alphaMute(0.01f), alphaCross(0.5f), alphaSurvivors(0.2f),
+	bestFitness(0), meanFitness(0), popSize(populationSize), evaluated(0), reward(reward)
 {
 }
 
 void GATrain::Generate( u32 count )
 {
-	popSize = count;
-	population.clear();
-	fitness.clear();
-	oldFitness.clear();
+	popSize = max(2u, count);
+	population.Resize(dim, popSize);
+	population.Randomize();
+	offspring.Resize(dim, popSize);
+	order.resize(popSize);
+	parents.resize(popSize);
+	probs.resize(popSize);
+	evaluated = 0;
 	bestFitness = meanFitness = 0;
-	FOR(i, count)
-	{
-		GAPeon peon = GAPeon::Random(dim);
-		population.push_back(peon);
-		fitness.push_back(0);
-	}
-	best = population[GetBest()];
+	best = population.ToSample(0);
 }
 
-int GATrain::GetBest()
+struct FitterThan
 {
-	double fit = fitness[0];
-	int best = 0;
-	FOR(i, fitness.size())
-	{
-		if(fit < fitness[i])
-		{
-			best = i;
-			fit = fitness[i];
-		}
-	}
-	return best;
-}
+	const float *fitness;
+	FitterThan(const float *fitness) : fitness(fitness){}
+	bool operator()(int a, int b) const {return fitness[a] > fitness[b];}
+};
 
-void GATrain::NextGen()
+int GATrain::NextGen()
 {
-	// we compute the fitness for each peon
-	FOR(i, population.size())
-	{
-		fitness[i] = population[i].Fitness(data, w, h);
-	}
-
-	std::vector< std::pair<double, u32> > fits;
-	FOR(i, fitness.size()) fits.push_back(std::pair<double, u32>(fitness[i], i));
-	std::sort(fits.begin(), fits.end(), std::greater< std::pair<double,u32> >());
-	std::vector<GAPeon> newPop;
-	std::vector<double> newFits;
-	FOR(i, max(1,(int)(fits.size()*alphaSurvivors)))
-	{
-		newPop.push_back(population[fits[i].second]);
-		newFits.push_back(fitness[fits[i].second]);
-	}
-	for(int i=newPop.size(); i<popSize; i++)
-	{
-		newPop.push_back(GAPeon::Random(dim));
-		newFits.push_back(0);
-	}
-	population = newPop;
-	fitness = newFits;
-
-	double maxFitness = fitness[0];
-
+	// we compute the fitness for each peon we don't know yet
+	int evaluations = popSize - evaluated;
+	population.Evaluate(reward, evaluated);
+	const float *fitness = population.Fitness();
+
+	int bestIndex = population.Best();
+	bestFitness = fitness[bestIndex];
+	best = population.ToSample(bestIndex);
 	meanFitness = 0;
-	u32 cnt = 0;
-	FOR(i, fitness.size())
+	FOR(i, popSize) meanFitness += fitness[i];
+	meanFitness /= popSize;
+
+	// the survivors go through untouched, we only need the best ones, not a full sort
+	u32 survivors = max(1u, min(popSize-1, (u32)(popSize*alphaSurvivors)));
+	FOR(i, popSize) order[i] = i;
+	nth_element(order.begin(), order.begin()+survivors-1, order.end(), FitterThan(fitness));
+	FOR(i, survivors)
 	{
-		if(fitness[i] < -1e8) continue;
-		meanFitness += fitness[i];
-		//fitness[i] += drand48() * 0.01f; // we add some noise to ensure that we pick 0-valued elements
-		cnt++;
+		std::copy(population.Sample(order[i]), population.Sample(order[i])+dim, offspring.Sample(i));
+		offspring.Fitness()[i] = fitness[order[i]];
 	}
-	meanFitness /= (double)cnt;
-	best = population[0];
-	bestFitness = fitness[0];
-	oldFitness = fitness;
-
 
-	// we normalize probabilities by fitness value
-	double fitnessSum = 0;
-	FOR(i, fitness.size()) fitnessSum += fitness[i]*6.f + 4.f;
-	vector<double> probs;
-	double fitnessCounter = 0;
-	FOR(i, fitness.size())
-	{
-		fitnessCounter += (fitness[i]*6.f + 4.f)/fitnessSum;
-		probs.push_back(fitnessCounter);
-	}
+	// we select the parents depending on their probability (stochastic universal sampling)
+	FOR(i, popSize) probs[i] = max(0.f, fitness[i]*6.f + 4.f);
+	u32 babies = popSize - survivors;
+	Population::Systematic(&probs[0], popSize, babies, &parents[0]);
+	// the draws come out sorted, we shuffle them to make couples
+	for(int i=babies-1; i>0; i--) std::swap(parents[i], parents[rand()%(i+1)]);
 
-	// we generate the new population
-	newPop.clear();
-	newFits.clear();
-	FOR (i, max(1.f,alphaSurvivors*popSize))
+	// let's make some babies...
+	for(u32 i=0; i<babies; i+=2)
 	{
-
-		/*
-		// copy the elite from the old population
-		if(i < (u32)(alphaSurvivors*popSize)/2)
-		{
-			newPop.push_back(population[i]);
-			newFits.push_back(fitness[i]);
-			continue;
-		}
-		*/
-
-		// we select two parents depending on their probability
-		u32 mom, dad, j;
-		double r = drand48();
-		for (j=0; j<probs.size() && r < probs[j]; j++);
-		mom = j<probs.size() ? j : 0;
-		r = drand48();
-		for (u32 j=0; j<probs.size() && r < probs[j]; j++);
-		dad = j<probs.size() ? j : probs.size()-1;
-		//mom = rand() % population.size();
-		//dad = rand() % population.size();
-		if(mom == dad) dad = mom < probs.size()-1 ? mom+1 : mom>0 ? mom-1 : 0;
-
-		// let's make some babies...
-		pair<GAPeon, GAPeon> babies;
-		if(drand48() < alphaCross)
-		{
-			babies = population[mom].Cross(population[dad]);
-		}
+		const float *mom = population.Sample(parents[i]);
+		const float *dad = population.Sample(parents[i+1 < babies ? i+1 : 0]);
+		float *baby1 = offspring.Sample(survivors+i);
+		float *baby2 = i+1 < babies ? offspring.Sample(survivors+i+1) : 0;
+		if(drand48() < alphaCross) Cross(mom, dad, baby1, baby2);
 		else // it's them clones!
 		{
-			babies.first = population[mom];
-			babies.second = population[dad];
+			std::copy(mom, mom+dim, baby1);
+			if(baby2) std::copy(dad, dad+dim, baby2);
 		}
-
-		// and we add these guys to the new population
-		newPop.push_back(babies.first);
-		newPop.push_back(babies.second);
-		newFits.push_back(-1e10);
-		newFits.push_back(-1e10);
-		i++;
+		Mutate(baby1);
+		if(baby2) Mutate(baby2);
 	}
-	FOR(i, newPop.size()) newPop[i].Mutate(alphaMute);
-
-	population = newPop;
-	fitness = newFits;
 
-	// we look for duplicates
-	u32 maxClones = 2;
-	u32 deaders = 0;
-	FOR(i, population.size()-1)
-	{
-		u32 clones = 0;
-		for(u32 j=i+1; j<population.size(); j++)
-		{
-			if(population[i] == population[j])
-			{
-				clones++;
-				if(clones > maxClones)
-				{
-					Kill(j);
-					j--;
-					deaders++;
-				}
-			}
-		}
-	}
-	//printf("clones killed: %d\n", deaders);
+	population.Swap(offspring);
+	evaluated = survivors;
+	return evaluations;
+}
 
-	// we replace the pruned clones with random offspring
-	FOR(i, deaders)
+void GATrain::Mutate(float *dna)
+{
+	FOR(d, dim)
 	{
-		newPop.push_back(GAPeon::Random(dim));
-		newFits.push_back(-1e10);
+		dna[d] += (drand48()*2.f-1.f)*alphaMute;
+		dna[d] = max(0.f, min(1.f, dna[d]));
 	}
 }
 
-void GATrain::Kill( u32 index )
+// one-point crossover, the genes after the cut are exchanged
+void GATrain::Cross(const float *mom, const float *dad, float *baby1, float *baby2)
 {
-	if(index >= fitness.size()) return;
-	for (u32 i=index; i<fitness.size()-1; i++)
+	u32 cut = dim > 1 ? rand()%(dim-1) + 1 : dim;
+	FOR(d, dim)
 	{
-		population[i] = population[i+1];
-		fitness[i] = fitness[i+1];
+		baby1[d] = d < cut ? mom[d] : dad[d];
+		if(baby2) baby2[d] = d < cut ? dad[d] : mom[d];
 	}
-	population.pop_back();
-	fitness.pop_back();
 }
@@ -2,15 +2,14 @@
 #define _GA_TRAINER_H_
 
 #include <vector>
-#include "gaPeon.h"
+#include "population.h"
 
 class GATrain
 {
 private:
-	std::vector<GAPeon> population;
-	std::vector<double> fitness;
-	std::vector<double> oldFitness;
-	GAPeon best;
+	Population population; // current generation
+	Population offspring; // next generation, built in place
+	fvec best;
 	u32 dim;
 	f32 alphaMute;
 	f32 alphaCross;
@@ -18,13 +17,19 @@ private:
 	double bestFitness;
 	double meanFitness;
 	u32 popSize;
-	float *data;
-	int w, h;
+	u32 evaluated; // individuals at the front of the population whose fitness is known (the survivors)
+	const RewardSource *reward;
+	ivec order;
+	ivec parents;
+	fvec probs;
+
+	void Mutate(float *dna);
+	void Cross(const float *mom, const float *dad, float *baby1, float *baby2);
 public:
-	GATrain(float *data, int w, int h, int populationSize=50, int dim=2);
+	GATrain(const RewardSource *reward, int populationSize=50, int dim=2);
 	void Generate(u32 count);
-	void Kill(u32 index);
-	void NextGen();
+	// evaluates the current generation and breeds the next one, returns the number of reward evaluations
+	int NextGen();
 
 	f32 AlphaMute(){return alphaMute;};
 	f32 AlphaSurvivors(){return alphaSurvivors;};
@@ -35,11 +40,9 @@ public:
 
 	double BestFitness(){return bestFitness;};
 	double MeanFitness(){return meanFitness;};
-	int GetBest();
-	GAPeon &Best(){return best;};
+	const fvec &Best(){return best;};
 
-	std::vector<double> &Fitness(){return oldFitness;};
-	std::vector<GAPeon> &Population(){return population;};
+	Population &Individuals(){return population;};
 };
 
 #endif // _GA_TRAINER_H_
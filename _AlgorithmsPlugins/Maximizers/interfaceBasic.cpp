@@ -33,6 +33,8 @@ using namespace std;
 MaximizeBasic::MaximizeBasic()
 {
 	params = new Ui::ParametersMaximizers();
+	widget = 0;
+	if(!ParameterMap::HasGUI()) return;
 	params->setupUi(widget = new QWidget());
 	connect(params->maximizeType, SIGNAL(currentIndexChanged(int)), this, SLOT(ChangeOptions()));
 }
@@ -84,10 +86,10 @@ void MaximizeBasic::ChangeOptions()
 void MaximizeBasic::SetParams(Maximizer *maximizer)
 {
 	if(!maximizer) return;
-	int type = params->maximizeType->currentIndex();
-	double variance = params->varianceSpin->value();
-	int k = params->kSpin->value();
-	bool bAdaptive = params->adaptiveCheck->isChecked();
+	int type = widget ? params->maximizeType->currentIndex() : options.Get("maximizeType", 0);
+	double variance = widget ? params->varianceSpin->value() : options.Get("varianceSpin", 0.1f);
+	int k = widget ? params->kSpin->value() : options.Get("kSpin", 10);
+	bool bAdaptive = widget ? params->adaptiveCheck->isChecked() : options.Get("adaptiveCheck", 0);
 	switch(type)
 	{
 	case 0: // random search
@@ -114,7 +116,8 @@ void MaximizeBasic::SetParams(Maximizer *maximizer)
 Maximizer *MaximizeBasic::GetMaximizer()
 {
 	Maximizer *maximizer = NULL;
-	switch(params->maximizeType->currentIndex())
+	int type = widget ? params->maximizeType->currentIndex() : options.Get("maximizeType", 0);
+	switch(type)
 	{
 	case 0:
 		maximizer = new MaximizeRandom();
@@ -141,11 +144,12 @@ Maximizer *MaximizeBasic::GetMaximizer()
 
 QString MaximizeBasic::GetAlgoString()
 {
-	double variance = params->varianceSpin->value();
-	int k = params->kSpin->value();
-	bool bAdaptive = params->adaptiveCheck->isChecked();
+	int type = widget ? params->maximizeType->currentIndex() : options.Get("maximizeType", 0);
+	double variance = widget ? params->varianceSpin->value() : options.Get("varianceSpin", 0.1f);
+	int k = widget ? params->kSpin->value() : options.Get("kSpin", 10);
+	bool bAdaptive = widget ? params->adaptiveCheck->isChecked() : options.Get("adaptiveCheck", 0);
 
-	switch(params->maximizeType->currentIndex())
+	switch(type)
 	{
 	case 0:
 		return "Random Search";
@@ -191,6 +195,11 @@ void MaximizeBasic::SaveParams(QTextStream &file)
 
 bool MaximizeBasic::LoadParams(QString name, float value)
 {
+	if(!widget)
+	{
+		options.Set(name, value);
+		return true;
+	}
 	if(name.endsWith("maximizeType")) params->maximizeType->setCurrentIndex((int)value);
 	if(name.endsWith("varianceSpin")) params->varianceSpin->setValue((float)value);
 	if(name.endsWith("adaptiveCheck")) params->adaptiveCheck->setChecked((bool)value);
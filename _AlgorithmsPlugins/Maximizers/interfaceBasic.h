@@ -31,6 +31,7 @@ class MaximizeBasic : public QObject, public MaximizeInterface
 private:
 	QWidget *widget;
 	Ui::ParametersMaximizers *params;
+	ParameterMap options;
 public:
 	MaximizeBasic();
 	// virtual functions to manage the algorithm creation
@@ -30,25 +30,27 @@ using namespace std;
 MaximizeInterfaceGA::MaximizeInterfaceGA()
 {
 	params = new Ui::ParametersGA();
+	widget = 0;
+	if(!ParameterMap::HasGUI()) return;
 	params->setupUi(widget = new QWidget());
 }
 
 void MaximizeInterfaceGA::SetParams(Maximizer *maximizer)
 {
 	if(!maximizer) return;
-	double mutation = params->mutationSpin->value();
-	double cross = params->crossSpin->value();
-	double survival = params->survivalSpin->value();
-	int population = params->populationSpin->value();
+	double mutation = widget ? params->mutationSpin->value() : options.Get("mutationSpin", 0.01f);
+	double cross = widget ? params->crossSpin->value() : options.Get("crossSpin", 0.4f);
+	double survival = widget ? params->survivalSpin->value() : options.Get("survivalSpin", 0.3f);
+	int population = widget ? params->populationSpin->value() : options.Get("populationSpin", 50);
 	((MaximizeGA *)maximizer)->SetParams(mutation, cross, survival, population);
 }
 
 QString MaximizeInterfaceGA::GetAlgoString()
 {
-	double mutation = params->mutationSpin->value();
-	double cross = params->crossSpin->value();
-	double survival = params->survivalSpin->value();
-	int population = params->populationSpin->value();
+	double mutation = widget ? params->mutationSpin->value() : options.Get("mutationSpin", 0.01f);
+	double cross = widget ? params->crossSpin->value() : options.Get("crossSpin", 0.4f);
+	double survival = widget ? params->survivalSpin->value() : options.Get("survivalSpin", 0.3f);
+	int population = widget ? params->populationSpin->value() : options.Get("populationSpin", 50);
 	QString	algo = QString("GA %1 %2 %3 %4").arg(population).arg(mutation).arg(cross).arg(survival);
 	return algo;
 }
@@ -87,6 +89,11 @@ void MaximizeInterfaceGA::SaveParams(QTextStream &file)
 
 bool MaximizeInterfaceGA::LoadParams(QString name, float value)
 {
+	if(!widget)
+	{
+		options.Set(name, value);
+		return true;
+	}
 	if(name.endsWith("populationSpin")) params->populationSpin->setValue((int)value);
 	if(name.endsWith("mutationSpin")) params->mutationSpin->setValue((float)value);
 	if(name.endsWith("crossSpin")) params->crossSpin->setValue((float)value);
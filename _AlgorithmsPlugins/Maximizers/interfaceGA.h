@@ -31,6 +31,7 @@ class MaximizeInterfaceGA : public QObject, public MaximizeInterface
 private:
 	QWidget *widget;
 	Ui::ParametersGA *params;
+	ParameterMap options;
 public:
 	MaximizeInterfaceGA();
 	// virtual functions to manage the algorithm creation
@@ -29,32 +29,34 @@ using namespace std;
 MaximizeInterfaceParticles::MaximizeInterfaceParticles()
 {
 	params = new Ui::ParametersParticles();
+	widget = 0;
+	if(!ParameterMap::HasGUI()) return;
 	params->setupUi(widget = new QWidget());
 }
 
 void MaximizeInterfaceParticles::SetParams(Maximizer *maximizer)
 {
 	if(!maximizer) return;
-	int particleCount = params->particleSpin->value();
-	double mutation = params->mutationSpin->value();
-	bool inertia = params->adaptiveCheck->isChecked();
-	double inertiaInit = params->inertiaInitSpin->value();
-	double inertiaFinal = params->inertiaFinalSpin->value();
-	double particleConfidence = params->particleConfidenceSpin->value();
-	double swarmConfidence = params->swarmConfidenceSpin->value();
+	int particleCount = widget ? params->particleSpin->value() : options.Get("particleSpin", 20);
+	double mutation = widget ? params->mutationSpin->value() : options.Get("mutationSpin", 0.01f);
+	bool inertia = widget ? params->adaptiveCheck->isChecked() : options.Get("adaptiveCheck", 1);
+	double inertiaInit = widget ? params->inertiaInitSpin->value() : options.Get("inertiaInitSpin", 0.5f);
+	double inertiaFinal = widget ? params->inertiaFinalSpin->value() : options.Get("inertiaFinalSpin", 0.5f);
+	double particleConfidence = widget ? params->particleConfidenceSpin->value() : options.Get("particleConfidenceSpin", 1.f);
+	double swarmConfidence = widget ? params->swarmConfidenceSpin->value() : options.Get("swarmConfidenceSpin", 2.f);
 
 	((MaximizeSwarm *)maximizer)->SetParams(particleCount, mutation, inertia, inertiaInit, inertiaFinal, particleConfidence, swarmConfidence);
 }
 
 QString MaximizeInterfaceParticles::GetAlgoString()
 {
-	int particleCount = params->particleSpin->value();
-	double mutation = params->mutationSpin->value();
-	bool inertia = params->adaptiveCheck->isChecked();
-	double inertiaInit = params->inertiaInitSpin->value();
-	double inertiaFinal = params->inertiaFinalSpin->value();
-	double particleConfidence = params->particleConfidenceSpin->value();
-	double swarmConfidence = params->swarmConfidenceSpin->value();
+	int particleCount = widget ? params->particleSpin->value() : options.Get("particleSpin", 20);
+	double mutation = widget ? params->mutationSpin->value() : options.Get("mutationSpin", 0.01f);
+	bool inertia = widget ? params->adaptiveCheck->isChecked() : options.Get("adaptiveCheck", 1);
+	double inertiaInit = widget ? params->inertiaInitSpin->value() : options.Get("inertiaInitSpin", 0.5f);
+	double inertiaFinal = widget ? params->inertiaFinalSpin->value() : options.Get("inertiaFinalSpin", 0.5f);
+	double particleConfidence = widget ? params->particleConfidenceSpin->value() : options.Get("particleConfidenceSpin", 1.f);
+	double swarmConfidence = widget ? params->swarmConfidenceSpin->value() : options.Get("swarmConfidenceSpin", 2.f);
 
 	QString algo = QString("PSO %1 %2 %3 %4").arg(particleCount).arg(mutation).arg(particleConfidence).arg(swarmConfidence);
 	if(inertia)
@@ -108,6 +110,11 @@ void MaximizeInterfaceParticles::SaveParams(QTextStream &file)
 
 bool MaximizeInterfaceParticles::LoadParams(QString name, float value)
 {
+	if(!widget)
+	{
+		options.Set(name, value);
+		return true;
+	}
 	if(name.endsWith("adaptiveCheck")) params->adaptiveCheck->setChecked((bool)value);
 	if(name.endsWith("particleSpin")) params->particleSpin->setValue((int)value);
 	if(name.endsWith("mutationSpin")) params->mutationSpin->setValue(value);
@@ -31,6 +31,7 @@ class MaximizeInterfaceParticles : public QObject, public MaximizeInterface
 private:
 	QWidget *widget;
 	Ui::ParametersParticles *params;
+	ParameterMap options;
 public:
 	MaximizeInterfaceParticles();
 	// virtual functions to manage the algorithm creation
@@ -28,10 +28,9 @@ using namespace std;
 
 MaximizeDonut::MaximizeDonut()
 {
-	data = 0;
 	dim = 2;
 	maximum.resize(dim);
-	lastSigma.resize(dim,0);
+	lastSigma.resize(dim*dim,0);
 	FOR(d,dim) maximum[d] = rand()/(float)RAND_MAX;
 	variance = 0;
 	k = 10;
@@ -39,7 +38,6 @@ MaximizeDonut::MaximizeDonut()
 
 MaximizeDonut::~MaximizeDonut()
 {
-	KILL(data);
 }
 
 void MaximizeDonut::SetParams(int k, float variance, bool bAdaptive)
@@ -49,10 +47,10 @@ void MaximizeDonut::SetParams(int k, float variance, bool bAdaptive)
 	this->k = k;
 	this->bAdaptive = bAdaptive;
 	lastSigma = fvec();
-	lastSigma.resize(dim*(dim-1), 0);
+	lastSigma.resize(dim*dim, 0);
 	FOR(d,dim)
 	{
-		lastSigma[d] = variance;
+		lastSigma[d*dim + d] = variance;
 	}
 }
 
@@ -94,7 +92,7 @@ void MaximizeDonut::Draw(QPainter &painter)
 	{
 		sigma[0] = best[i].second.second[0];
 		sigma[1] = best[i].second.second[1];
-		sigma[2] = best[i].second.second[3];
+		sigma[2] = best[i].second.second[dim+1];
 		if(sigma[0] == sigma[0] && sigma[1] == sigma[1] && sigma[2] == sigma[2])
 		{
 			painter.setBrush(Qt::NoBrush);
@@ -107,7 +105,7 @@ void MaximizeDonut::Draw(QPainter &painter)
 	// and we draw the current search zone
 	sigma[0] = lastSigma[0];
 	sigma[1] = lastSigma[1];
-	sigma[2] = lastSigma[3];
+	sigma[2] = lastSigma[dim+1];
 	if(sigma[0] == sigma[0] && sigma[1] == sigma[1] && sigma[2] == sigma[2])
 	{
 		painter.setBrush(Qt::NoBrush);
@@ -118,18 +116,21 @@ void MaximizeDonut::Draw(QPainter &painter)
 	}
 }
 
-void MaximizeDonut::Train(float *dataMap, fVec size, fvec startingPoint)
+void MaximizeDonut::Train(const RewardSource &source, fVec size, fvec startingPoint)
 {
-	w = size.x;
-	h = size.y;
-	KILL(data);
+	SetReward(source, size);
+	if(lastSigma.size() != dim*dim)
+	{
+		float variance = lastSigma.size() ? lastSigma[0] : this->variance;
+		lastSigma = fvec();
+		lastSigma.resize(dim*dim, 0);
+		FOR(d,dim) lastSigma[d*dim + d] = variance;
+	}
 	best.clear();
 	history.clear();
 	historyValue.clear();
-	data = new float[w*h];
-	memcpy(data, dataMap, w*h*sizeof(float));
 	bConverged = false;
-	if(startingPoint.size())
+	if(startingPoint.size() == dim)
 	{
 		maximum = startingPoint;
 		float value = GetValue(startingPoint);
@@ -227,7 +228,7 @@ QImage MaximizeDonut::DrawMap()
 {
 	int size = 200;
 	QImage image(QSize(size,size), QImage::Format_ARGB32);
-	fvec sample; sample.resize(2);
+	fvec sample = maximum; // slice through the first two dimensions
 	FOR(i, size)
 	{
 		sample[0] = i/(float)size;
@@ -264,12 +265,24 @@ fvec MaximizeDonut::Test( const fvec &sample)
 
 	if(best.size() <= k)
 	{
-		while(best.size() < k)
+		// the missing samples are drawn first and evaluated as a single batch
+		// they come from the uniform branch of Generate, which does not look at best (no rejection),
+		// so they follow the same distribution (and random sequence) as when they were evaluated one at a time
+		int count = k - best.size();
+		fvec samples(count*dim);
+		fvec values(count);
+		FOR(i, count)
 		{
 			fvec randSample = Generate(newSample, lastSigma, true);
+			std::copy(randSample.begin(), randSample.end(), samples.begin() + i*dim);
+		}
+		if(count > 0) GetValues(&samples[0], count, &values[0]);
+		evaluations += count;
+		FOR(i, count)
+		{
+			fvec randSample(samples.begin() + i*dim, samples.begin() + (i+1)*dim);
 			visited.push_back(randSample);
-			float value = GetValue(randSample);
-			evaluations++;
+			float value = values[i];
 			if(bAdaptive)
 			{
 				FOR(d, dim) sigma[d*dim + d] = (1-value + 0.0001)*fingerprint;
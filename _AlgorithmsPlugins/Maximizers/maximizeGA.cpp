@@ -34,7 +34,6 @@ MaximizeGA::MaximizeGA()
 
 MaximizeGA::~MaximizeGA()
 {
-	KILL(data);
 	DEL(trainer);
 }
 
@@ -70,9 +69,10 @@ void MaximizeGA::Draw(QPainter &painter)
 	if(trainer)
 	{
 		// draw the current population
-		FOR(i, trainer->Population().size())
+		Population &individuals = trainer->Individuals();
+		FOR(i, individuals.Count())
 		{
-			fvec sample = trainer->Population()[i].ToSample();
+			const float *sample = individuals.Sample(i);
 			QPointF point(sample[0]*w, sample[1]*h);
 			painter.setBrush(Qt::green);
 			painter.drawEllipse(point, 3, 3);
@@ -84,15 +84,11 @@ void MaximizeGA::Draw(QPainter &painter)
 	painter.drawEllipse(point, 5, 5);
 }
 
-void MaximizeGA::Train(float *dataMap, fVec size, fvec startingPoint)
+void MaximizeGA::Train(const RewardSource &source, fVec size, fvec startingPoint)
 {
-	w = size.x;
-	h = size.y;
-	if(data) delete [] data;
-	data = new float[w*h];
-	memcpy(data, dataMap, w*h*sizeof(float));
+	SetReward(source, size);
 	bConverged = false;
-	if(startingPoint.size())
+	if(startingPoint.size() == dim)
 	{
 		maximum = startingPoint;
 		float value = GetValue(startingPoint);
@@ -102,7 +98,7 @@ void MaximizeGA::Train(float *dataMap, fVec size, fvec startingPoint)
 		//qDebug() << "Starting maximization at " << maximum[0] << " " << maximum[1];
 	}
 	DEL(trainer);
-	trainer = new GATrain(data, w, h, population, dim);
+	trainer = new GATrain(reward, population, dim);
 	trainer->AlphaMute(mutation);
 	trainer->AlphaCross(cross);
 	trainer->AlphaSurvivors(survival);
@@ -113,10 +109,8 @@ void MaximizeGA::Train(float *dataMap, fVec size, fvec startingPoint)
 fvec MaximizeGA::Test( const fvec &sample)
 {
 	if(bConverged) return maximum;
-	//FOR(i, trainer->Population().size()) visited.push_back(trainer->Population()[i].ToSample());
-	evaluations += trainer->Population().size();
-	trainer->NextGen();
-	maximum = trainer->Best().ToSample();
+	evaluations += trainer->NextGen();
+	maximum = trainer->Best();
 	maximumValue = trainer->BestFitness();
 	history.push_back(maximum);
 	historyValue.push_back(maximumValue);
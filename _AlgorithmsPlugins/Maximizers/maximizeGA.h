@@ -36,7 +36,7 @@ public:
 	void SetParams(double mutation, double cross, double survival, int population);
 
 	void Draw(QPainter &painter);
-	void Train(float *dataMap, fVec size, fvec startingPoint=fvec());
+	void Train(const RewardSource &source, fVec size, fvec startingPoint=fvec());
 	fvec Test( const fvec &sample);
 	fvec Test(const fVec &sample);
 	char *GetInfoString();
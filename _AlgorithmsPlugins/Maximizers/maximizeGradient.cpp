@@ -21,12 +21,12 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include "basicMath.h"
 #include "maximizeGradient.h"
 #include <QDebug>
+#include <algorithm>
 
 using namespace std;
 
 MaximizeGradient::MaximizeGradient()
 {
-	data = 0;
 	dim = 2;
 	maximum.resize(dim);
 	FOR(d,dim) maximum[d] = rand()/(float)RAND_MAX;
@@ -37,7 +37,6 @@ MaximizeGradient::MaximizeGradient()
 
 MaximizeGradient::~MaximizeGradient()
 {
-	KILL(data);
 }
 
 void MaximizeGradient::SetParams(float strength, bool adaptive)
@@ -73,15 +72,11 @@ void MaximizeGradient::Draw(QPainter &painter)
 	painter.drawEllipse(point, 5, 5);
 }
 
-void MaximizeGradient::Train(float *dataMap, fVec size, fvec startingPoint)
+void MaximizeGradient::Train(const RewardSource &source, fVec size, fvec startingPoint)
 {
-	w = size.x;
-	h = size.y;
-	if(data) delete [] data;
-	data = new float[w*h];
-	memcpy(data, dataMap, w*h*sizeof(float));
+	SetReward(source, size);
 	bConverged = false;
-	if(!startingPoint.size())
+	if(startingPoint.size() != dim)
 	{
 		startingPoint.resize(dim);
 		FOR(d, dim) startingPoint[d] = drand48();
@@ -104,59 +99,45 @@ fvec MaximizeGradient::Test( const fvec &sample)
 	newSample = sample;
 	if(!sample.size()) newSample = maximum;
 
-	int xIndex = newSample[0]*w;
-	int yIndex = newSample[1]*h;
-
 	float delta = 0.003;
-	float value = GetValue(newSample);
-	evaluations++;
-	// we compute the values of the gradient in the 9 directions around
-	float values[8];
-	fVec v[8];
-	int searchType = 1;
-	switch(searchType)
+	// the current sample and its two neighbours along each axis are evaluated as a single batch
+	int count = 1 + 2*dim;
+	probes.resize(count*dim);
+	probeValues.resize(count);
+	FOR(i, count) std::copy(newSample.begin(), newSample.end(), probes.begin() + i*dim);
+	FOR(d, dim)
 	{
-	case 2: // 8 directions
-		values[0] = GetValue(newSample + fVec(-delta	,-delta));
-		values[2] = GetValue(newSample + fVec(delta	,-delta));
-		values[5] = GetValue(newSample + fVec(-delta	,+delta));
-		values[7] = GetValue(newSample + fVec(delta	,+delta));
-		v[0] = fVec(-1,-1)*(values[0]-value);
-		v[2] = fVec( 1,-1)*(values[2]-value);
-		v[5] = fVec(-1, 1)*(values[5]-value);
-		v[7] = fVec( 1, 1)*(values[7]-value);
-		evaluations += 4;
-	case 1: // 4 directions
-		values[1] = GetValue(newSample + fVec(0		,-delta));
-		values[3] = GetValue(newSample + fVec(-delta	,0));
-		v[1] = fVec( 0,-1)*(values[1]-value);
-		v[3] = fVec(-1, 0)*(values[3]-value);
-		evaluations += 2;
-	case 0: // 2 directions
-		values[4] = GetValue(newSample + fVec(delta	,0));
-		values[6] = GetValue(newSample + fVec(0		,+delta));
-		v[4] = fVec( 1, 0)*(values[4]-value);
-		v[6] = fVec( 0, 1)*(values[6]-value);
-		evaluations += 2;
+		probes[(1 + 2*d)*dim + d] += delta;
+		probes[(2 + 2*d)*dim + d] -= delta;
 	}
-
-	fVec gradient;
-	FOR(i, 8) gradient += v[i];
-	gradient /= (float)(1<<(searchType+1));
+	GetValues(&probes[0], count, &probeValues[0]);
+	evaluations += count;
+	float value = probeValues[0];
+
+	// central differences, scaled as the sum over the 2*dim directions
+	fvec gradient; gradient.resize(dim, 0);
+	float norm = 0;
+	FOR(d, dim)
+	{
+		gradient[d] = (probeValues[1 + 2*d] - probeValues[2 + 2*d]) / (2*dim);
+		norm += gradient[d]*gradient[d];
+	}
+	norm = sqrtf(norm);
 	if(!adaptive) // we just use the strength as factor for moving
 	{
-		gradient.normalize();
-		gradient *= strength*0.1;
+		if(norm > 0) gradient *= strength*0.1f/norm;
 	}
 	else // we use the actual value of gradient to decide how much to move
 	{
-		gradient *= strength/delta*0.1;
+		gradient *= strength/delta*0.1f;
 	}
 
 	fvec oldSample = newSample;
 	newSample += gradient;
 
-	if(oldSample[0]*w == newSample[0]*w && oldSample[1]*h == newSample[1]*h) // we're not moving anymore!
+	bool bMoving = false;
+	FOR(d, dim) bMoving |= oldSample[d] != newSample[d];
+	if(!bMoving) // we're not moving anymore!
 	{
 		unmoving++;
 		if(unmoving > 10)
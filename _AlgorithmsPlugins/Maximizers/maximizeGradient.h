@@ -28,6 +28,8 @@ private:
 	float strength;
 	int unmoving;
 	bool adaptive;
+	fvec probes;		// finite difference samples, (1 + 2*dim) x dim
+	fvec probeValues;
 public:
 	MaximizeGradient();
 	~MaximizeGradient();
@@ -35,7 +37,7 @@ public:
 	void SetParams(float strength, bool adaptive);
 
 	void Draw(QPainter &painter);
-	void Train(float *dataMap, fVec size, fvec startingPoint=fvec());
+	void Train(const RewardSource &source, fVec size, fvec startingPoint=fvec());
 	fvec Test( const fvec &sample);
 	fvec Test(const fVec &sample);
 	char *GetInfoString();
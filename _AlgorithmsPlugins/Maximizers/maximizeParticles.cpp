@@ -34,7 +34,6 @@ MaximizeParticles::MaximizeParticles()
 
 MaximizeParticles::~MaximizeParticles()
 {
-	KILL(data);
 }
 
 void MaximizeParticles::SetParams(int particleCount, float variance, bool bAdaptive)
@@ -67,11 +66,11 @@ void MaximizeParticles::Draw(QPainter &painter)
 	}
 
 	// draw the current particles
-	FOR(i, particles.size())
+	FOR(i, particles.Count())
 	{
-		fvec sample = particles[i];
+		const float *sample = particles.Sample(i);
 		QPointF point(sample[0]*w, sample[1]*h);
-		int radius = 2 + weights[i]*5;
+		int radius = 2 + particles.Weights()[i]*5;
 		painter.setBrush(Qt::green);
 		painter.drawEllipse(point, radius, radius);
 	}
@@ -81,35 +80,21 @@ void MaximizeParticles::Draw(QPainter &painter)
 	painter.drawEllipse(point, 5, 5);
 }
 
-void MaximizeParticles::Train(float *dataMap, fVec size, fvec startingPoint)
+void MaximizeParticles::Train(const RewardSource &source, fVec size, fvec startingPoint)
 {
-	w = size.x;
-	h = size.y;
-	if(data) delete [] data;
-	data = new float[w*h];
-	memcpy(data, dataMap, w*h*sizeof(float));
+	SetReward(source, size);
 	bConverged = false;
-	if(startingPoint.size())
+	if(startingPoint.size() == dim)
 	{
 		maximum = startingPoint;
-		int xIndex = startingPoint[0]*w;
-		int yIndex = startingPoint[1]*h;
-		int index = min(w*h, max(0, yIndex*w + xIndex));
-		float value = data[index];
+		float value = GetValue(startingPoint);
 		maximumValue = value;
 		history.push_back(maximum);
 		historyValue.push_back(value);
 		//qDebug() << "Starting maximization at " << maximum[0] << " " << maximum[1];
 	}
-	particles.clear();
-	weights.clear();
-	fvec sample; sample.resize(dim);
-	FOR(i, particleCount)
-	{
-		FOR(d, dim) sample[d] = drand48();
-		particles.push_back(sample);
-		weights.push_back(1.f/particleCount);
-	}
+	particles.Resize(dim, particleCount);
+	particles.Randomize();
 	evaluations = 0;
 }
 
@@ -117,36 +102,22 @@ fvec MaximizeParticles::Test( const fvec &sample)
 {
 	if(bConverged) return maximum;
 
-	float decay = 0.2f;
-	float totalWeights= 0;
-	FOR(i, particleCount)
-	{
-		// first we guess the next pose for each particle
-		particles[i] += RandN(dim, 0, variance*variance);
-		// we compute the weights
-		weights[i] = weights[i] *(1-decay) + GetValue(particles[i])*decay;
-		totalWeights += weights[i];
-		evaluations++;
-		//visited.push_back(particles[i]);
-	}
+	// first we guess the next pose for each particle
+	float *samples = particles.Sample(0);
+	FOR(i, particleCount*dim) samples[i] += RandN(0.f, variance*variance);
 
-	// we sort the particles by weight
-	vector< pair<double, u32> > fits;
-	FOR(i, weights.size()) fits.push_back(pair<double, u32>(weights[i], i));
-	sort(fits.begin(), fits.end(), greater< pair<double,u32> >());
-	vector<fvec> newParticles;
-	fvec newWeights;
-	FOR(i, fits.size())
-	{
-		newParticles.push_back(particles[fits[i].second]);
-		newWeights.push_back(weights[fits[i].second]);
-	}
-	particles = newParticles;
-	weights = newWeights;
+	// we compute the weights, the whole population is evaluated at once
+	particles.Evaluate(reward);
+	evaluations += particleCount;
+	float decay = 0.2f;
+	float *fitness = particles.Fitness();
+	float *weights = particles.Weights();
+	FOR(i, particleCount) weights[i] = weights[i] *(1-decay) + fitness[i]*decay;
 
 	// we compute the result
-	maximum = particles[0];
-	maximumValue = weights[0];
+	int best = particles.Best(weights);
+	maximum = particles.ToSample(best);
+	maximumValue = weights[best];
 
 	if(bAdaptive)
 	{
@@ -154,51 +125,20 @@ fvec MaximizeParticles::Test( const fvec &sample)
 		variance = variance*(1-decay) + (1 - maximumValue*maximumValue)*0.1*decay;
 	}
 
-/*
-	maximum.clear();
-	maximum.resize(dim,0);
-	FOR(i, particleCount)
-	{
-		FOR(d, dim) maximum[d] = weights[i] * particles[i][d];
-	}
-*/
-
 	history.push_back(maximum);
 	historyValue.push_back(maximumValue);
 
-	// we normalize probabilities by weight value
-	double weightSum = 0;
-	FOR(i, weights.size())  weightSum += weights[i];
-	dvec probs;
-	double weightCounter = 0;
-	FOR(i, weights.size())
-	{
-		weightCounter += weights[i]/weightSum;
-		probs.push_back(weightCounter);
-	}
-
-	// we resample the particles
-	newParticles.clear();
-	newWeights.clear();
-	FOR(i, particleCount)
-	{
-		double r = drand48();
-		u32 j=0;
-		for (j=0; j<probs.size() && r > probs[j]; j++);
-		u32 index = j<probs.size() ? j : 0;
-		newParticles.push_back(particles[index]);
-		newWeights.push_back(weights[index]);
-	}
-	particles = newParticles;
-	weights = newWeights;
+	// we resample the particles by weight
+	particles.Resample();
 
 	// if particles have gone wild we resample them
 	float degeneracyThreshold = 0.000000001;
+	weights = particles.Weights();
 	FOR(i, particleCount)
 	{
 		if( weights[i] < degeneracyThreshold )
 		{
-			FOR(d, dim) particles[i][d] = drand48();
+			FOR(d, dim) particles.Sample(i)[d] = drand48();
 			weights[i] = 1.f / particleCount;
 		}
 	}
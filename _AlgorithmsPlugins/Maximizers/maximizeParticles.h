@@ -21,12 +21,12 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 
 #include <vector>
 #include "maximize.h"
+#include "population.h"
 
 class MaximizeParticles : public Maximizer
 {
 private:
-	std::vector<fvec> particles;
-	fvec weights;
+	Population particles;
 	int particleCount;
 	bool bAdaptive;
 	float variance;
@@ -37,7 +37,7 @@ public:
 	void SetParams(int particleCount, float variance, bool bAdaptive);
 
 	void Draw(QPainter &painter);
-	void Train(float *dataMap, fVec size, fvec startingPoint=fvec());
+	void Train(const RewardSource &source, fVec size, fvec startingPoint=fvec());
 	fvec Test( const fvec &sample);
 	fvec Test(const fVec &sample);
 	char *GetInfoString();
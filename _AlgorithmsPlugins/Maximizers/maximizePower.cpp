@@ -26,7 +26,6 @@ using namespace std;
 
 MaximizePower::MaximizePower()
 {
-	data = 0;
 	dim = 2;
 	maximum.resize(dim);
 	lastSigma.resize(dim,0);
@@ -37,7 +36,6 @@ MaximizePower::MaximizePower()
 
 MaximizePower::~MaximizePower()
 {
-	KILL(data);
 }
 
 void MaximizePower::SetParams(int k, float variance, bool bAdaptive)
@@ -94,18 +92,16 @@ void MaximizePower::Draw(QPainter &painter)
 	}
 }
 
-void MaximizePower::Train(float *dataMap, fVec size, fvec startingPoint)
+void MaximizePower::Train(const RewardSource &source, fVec size, fvec startingPoint)
 {
-	w = size.x;
-	h = size.y;
-	if(data) delete [] data;
+	SetReward(source, size);
+	lastSigma = fvec();
+	lastSigma.resize(dim, variance*variance);
 	best.clear();
 	history.clear();
 	historyValue.clear();
-	data = new float[w*h];
-	memcpy(data, dataMap, w*h*sizeof(float));
 	bConverged = false;
-	if(startingPoint.size())
+	if(startingPoint.size() == dim)
 	{
 		maximum = startingPoint;
 		float value = GetValue(startingPoint);
@@ -127,21 +123,28 @@ fvec MaximizePower::Test( const fvec &sample)
 	if(bAdaptive && best.size() <= k)
 	{
 		fvec sigma;sigma.resize(dim,variance);
-		while(best.size() < k)
+		// the missing samples are drawn first and evaluated as a single batch
+		int count = k - best.size();
+		fvec samples(count*dim);
+		fvec values(count);
+		FOR(i, count)
 		{
-			fvec randSample;randSample.resize(dim);
 			FOR(d, dim)
 			{
 				int tries = 64;
 				do
 				{
-					randSample[d] = newSample[d] + RandN(0.f, variance);
-				} while(randSample[d] < 0 || randSample[d] > 1.f || tries-- > 0);
+					samples[i*dim + d] = newSample[d] + RandN(0.f, variance);
+				} while(samples[i*dim + d] < 0 || samples[i*dim + d] > 1.f || tries-- > 0);
 			}
+		}
+		if(count > 0) GetValues(&samples[0], count, &values[0]);
+		evaluations += count;
+		FOR(i, count)
+		{
+			fvec randSample(samples.begin() + i*dim, samples.begin() + (i+1)*dim);
 			visited.push_back(randSample);
-			float value = GetValue(randSample);
-			evaluations++;
-			best.push_back(make_pair(value, make_pair(randSample, sigma)));
+			best.push_back(make_pair(values[i], make_pair(randSample, sigma)));
 		}
 		std::sort(best.begin(), best.end());
 	}
@@ -169,7 +172,7 @@ fvec MaximizePower::Test( const fvec &sample)
 
 	if(!bAdaptive)
 	{
-		fvec sigma; sigma.resize(2, variance);
+		fvec sigma; sigma.resize(dim, variance);
 		if(best.size() < k)
 		{
 			best.push_back(make_pair(value, make_pair(newSample, sigma)));
@@ -233,7 +236,7 @@ fvec MaximizePower::Test( const fvec &sample)
 		history.push_back(maximum);
 		historyValue.push_back(GetValue(maximum));
 
-		fvec sigma; sigma.resize(2, variance);
+		fvec sigma; sigma.resize(dim, variance);
 		FOR(d, dim) sigma[d] = varianceSum[d] / totalVarianceSum[d];
 		if(value > best[0].first)
 		{
@@ -39,7 +39,7 @@ public:
 	void SetParams(int k, float variance=0.2, bool bAdaptive=false);
 
 	void Draw(QPainter &painter);
-	void Train(float *dataMap, fVec size, fvec startingPoint=fvec());
+	void Train(const RewardSource &source, fVec size, fvec startingPoint=fvec());
 	fvec Test( const fvec &sample);
 	fvec Test(const fVec &sample);
 	char *GetInfoString();
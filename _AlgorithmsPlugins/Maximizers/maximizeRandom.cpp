@@ -26,7 +26,6 @@ using namespace std;
 
 MaximizeRandom::MaximizeRandom()
 {
-	data = 0;
 	dim = 2;
 	maximum.resize(dim);
 	FOR(d,dim) maximum[d] = rand()/(float)RAND_MAX;
@@ -35,7 +34,6 @@ MaximizeRandom::MaximizeRandom()
 
 MaximizeRandom::~MaximizeRandom()
 {
-	KILL(data);
 }
 
 void MaximizeRandom::SetParams(float variance)
@@ -82,15 +80,11 @@ void MaximizeRandom::Draw(QPainter &painter)
 	}
 }
 
-void MaximizeRandom::Train(float *dataMap, fVec size, fvec startingPoint)
+void MaximizeRandom::Train(const RewardSource &source, fVec size, fvec startingPoint)
 {
-	w = size.x;
-	h = size.y;
-	if(data) delete [] data;
-	data = new float[w*h];
-	memcpy(data, dataMap, w*h*sizeof(float));
+	SetReward(source, size);
 	bConverged = false;
-	if(startingPoint.size())
+	if(startingPoint.size() == dim)
 	{
 		maximum = startingPoint;
 		float value = GetValue(startingPoint);
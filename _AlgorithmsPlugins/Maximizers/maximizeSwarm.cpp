@@ -21,7 +21,6 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include "basicMath.h"
 #include "maximizeSwarm.h"
 #include <QDebug>
-#include <optimization_test_functions.h>
 
 using namespace std;
 
@@ -35,7 +34,6 @@ MaximizeSwarm::MaximizeSwarm()
 
 MaximizeSwarm::~MaximizeSwarm()
 {
-	KILL(data);
 }
 
 void MaximizeSwarm::SetParams(int particleCount, float mutation, bool inertia, float inertiaInit, float inertiaFinal, float particleConfidence, float swarmConfidence)
@@ -106,30 +104,20 @@ void MaximizeSwarm::Draw(QPainter &painter)
 	painter.drawEllipse(point, 5, 5);
 }
 
-//SINGLE OBJECTIVE OPTIMIZATION PROBLEMS
-Eigen::VectorXd rastragin(Eigen::VectorXd& x);
-Eigen::VectorXd schwefel(Eigen::VectorXd& x);
-Eigen::VectorXd griewangk(Eigen::VectorXd& x);
-Eigen::VectorXd griewangk_constrained(Eigen::VectorXd& x);
-Eigen::VectorXd f_1disolated(Eigen::VectorXd& x);
-Eigen::VectorXd f_1disolated2(Eigen::VectorXd& x);
+// the swarm evaluates the reward in the unit hypercube, one batch per iteration
+static void SwarmReward(const float *samples, int count, float *values, const void *reward)
+{
+	((const RewardSource *)reward)->Evaluate(samples, count, values);
+}
 
-void MaximizeSwarm::Train(float *dataMap, fVec size, fvec startingPoint)
+void MaximizeSwarm::Train(const RewardSource &source, fVec size, fvec startingPoint)
 {
-	w = size.x;
-	h = size.y;
-	if(data) delete [] data;
-	data = new float[w*h];
-	memcpy(data, dataMap, w*h*sizeof(float));
-	//FOR(i, w*h) data[i] = 1.f - data[i];
+	SetReward(source, size);
 	bConverged = false;
-	if(startingPoint.size())
+	if(startingPoint.size() == dim)
 	{
 		maximum = startingPoint;
-		int xIndex = startingPoint[0]*w;
-		int yIndex = startingPoint[1]*h;
-		int index = min(w*h, max(0, yIndex*w + xIndex));
-		float value = data[index];
+		float value = GetValue(startingPoint);
 		maximumValue = value;
 		history.push_back(maximum);
 		historyValue.push_back(1-value);
@@ -147,7 +135,7 @@ void MaximizeSwarm::Train(float *dataMap, fVec size, fvec startingPoint)
 	evaluations = 0;
 
 	pso = new PSO(dim,constraintCount,iterationCount,particleCount,Eigen::VectorXd::Constant(dim,0.),Eigen::VectorXd::Constant(dim,1.));
-	pso->SetData(data, w, h);
+	pso->SetReward(SwarmReward, reward);
 	pso->setProblemName("Data");
 	pso->setMutationProbability(mutation);
 	if(inertia)
@@ -167,7 +155,7 @@ fvec MaximizeSwarm::Test( const fvec &sample)
 	pso->optimizeOnce();
 	Eigen::MatrixXd current = pso->getOptimalSolutions();
 	Eigen::MatrixXd values = pso->getOptimalValues();
-	maximum.resize(2);
+	maximum.resize(dim);
 	FOR(d, dim) maximum[d] = (current(0,d) - pso->getLBound()(d))/(pso->getUBound()(d)-pso->getLBound()(d));
 	//qDebug() << "maximum: " << maximum[0] << " " << maximum[1];
 	maximumValue = values(0,0);
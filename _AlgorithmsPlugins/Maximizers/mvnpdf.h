@@ -5,16 +5,24 @@
 #include <mymaths.h>
 #include <fgmm/fgmm++.hpp>
 
+// sigma is the full dim x dim covariance matrix, fgmm keeps its upper triangle
+static void mvnGaussian(gaussian &gauss, const fvec &mean, const fvec &sigma)
+{
+	int dim = mean.size();
+	gaussian_init(&gauss,dim);
+	FOR(d, dim) gauss.mean[d] = mean[d];
+	int index = 0;
+	FOR(i, dim)
+	{
+		for(int j=i; j<dim; j++) gauss.covar->_[index++] = sigma[i*dim + j];
+	}
+}
+
 float mvnPdf(fvec query, fvec mean, fvec sigma)
 {
 	// we generate the new data
 	gaussian gauss;
-	gaussian_init(&gauss,2);
-	gauss.mean[0] = mean[0];
-	gauss.mean[1] = mean[1];
-	gauss.covar->_[0] = sigma[0];
-	gauss.covar->_[1] = sigma[1];
-	gauss.covar->_[2] = sigma[3];
+	mvnGaussian(gauss, mean, sigma);
 	invert_covar(&gauss);
 	float value = gaussian_pdf(&gauss, &query[0]);
 	gaussian_free(&gauss);
@@ -25,16 +33,11 @@ fvec mvnRandN(fvec mean, fvec sigma)
 {
 	// we generate the new data
 	gaussian gauss;
-	gaussian_init(&gauss,2);
-	gauss.mean[0] = mean[0];
-	gauss.mean[1] = mean[1];
-	gauss.covar->_[0] = sigma[0];
-	gauss.covar->_[1] = sigma[1];
-	gauss.covar->_[2] = sigma[3];
+	mvnGaussian(gauss, mean, sigma);
 	//invert_covar(&gauss);
 	smat_cholesky(gauss.covar, gauss.covar_cholesky);
 	fvec newSample;
-	newSample.resize(2,0);
+	newSample.resize(mean.size(),0);
 	gaussian_draw(&gauss, &newSample[0]);
 	gaussian_free(&gauss);
 	return newSample;
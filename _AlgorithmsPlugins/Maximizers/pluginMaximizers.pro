@@ -20,6 +20,7 @@ HEADERS +=	\
 			$$MLDEMOS/mymaths.h \
 			$$MLDEMOS/drawUtils.h \
 			$$MLDEMOS/optimization_test_functions.h \
+			$$MLDEMOS/rewardSource.h \
 			maximizeRandom.h \
 			maximizePower.h \
 			maximizeGA.h \
@@ -30,7 +31,7 @@ HEADERS +=	\
 			pluginMaximizers.h \
 			interfaceParticles.h \
 			interfaceGA.h \
-			gaPeon.h \
+			population.h \
 			gaTrainer.h \
 			mvnpdf.h \
 			interfaceBasic.h
@@ -40,6 +41,7 @@ SOURCES += 	\
 			$$MLDEMOS/datasetManager.cpp \
 			$$MLDEMOS/mymaths.cpp \
 			$$MLDEMOS/drawUtils.cpp \
+			$$MLDEMOS/rewardSource.cpp \
 			maximizeRandom.cpp \
 			maximizePower.cpp \
 			maximizeGA.cpp \
@@ -50,7 +52,7 @@ SOURCES += 	\
 			pluginMaximizers.cpp \
 			interfaceGA.cpp \
 			interfaceParticles.cpp \
-			gaPeon.cpp \
+			population.cpp \
 			gaTrainer.cpp \
 			interfaceBasic.cpp \
 
@@ -0,0 +1,126 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License,
+version 3 as published by the Free Software Foundation.
+
+This library is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#include <public.h>
+#include <basicMath.h>
+#include "population.h"
+#include <algorithm>
+
+using namespace std;
+
+Population::Population(int dim, int count)
+	: dim(0), count(0)
+{
+	Resize(dim, count);
+}
+
+void Population::Resize(int dim, int count)
+{
+	this->dim = dim;
+	this->count = count;
+	// resize never gives memory back, so shrinking and regrowing does not reallocate
+	samples.resize(dim*count, 0.f);
+	fitness.resize(count, 0.f);
+	weights.resize(count, count ? 1.f/count : 0.f);
+	buffer.resize(dim*count);
+	indices.resize(count);
+}
+
+void Population::Randomize(int start)
+{
+	for(int i=start*dim; i<count*dim; i++) samples[i] = drand48();
+	for(int i=start; i<count; i++)
+	{
+		fitness[i] = 0;
+		weights[i] = 1.f/count;
+	}
+}
+
+void Population::Swap(Population &other)
+{
+	std::swap(dim, other.dim);
+	std::swap(count, other.count);
+	samples.swap(other.samples);
+	fitness.swap(other.fitness);
+	weights.swap(other.weights);
+	buffer.swap(other.buffer);
+	indices.swap(other.indices);
+}
+
+void Population::Evaluate(const RewardSource *reward, int start)
+{
+	if(!reward || start >= count) return;
+	reward->Evaluate(&samples[start*dim], count-start, &fitness[start]);
+}
+
+int Population::Best(const float *values) const
+{
+	if(!values) values = &fitness[0];
+	int best = 0;
+	for(int i=1; i<count; i++) if(values[i] > values[best]) best = i;
+	return best;
+}
+
+void Population::Clamp()
+{
+	FOR(i, samples.size()) samples[i] = max(0.f, min(1.f, samples[i]));
+}
+
+void Population::Gather(const int *indices)
+{
+	FOR(i, count)
+	{
+		const float *source = &samples[indices[i]*dim];
+		std::copy(source, source+dim, &buffer[i*dim]);
+	}
+	samples.swap(buffer);
+	// fitness and weights go through the tail of the buffer (it is at least count long)
+	FOR(i, count) buffer[i] = fitness[indices[i]];
+	std::copy(buffer.begin(), buffer.begin()+count, fitness.begin());
+	FOR(i, count) buffer[i] = weights[indices[i]];
+	std::copy(buffer.begin(), buffer.begin()+count, weights.begin());
+}
+
+void Population::Resample()
+{
+	if(!count) return;
+	Systematic(&weights[0], count, count, &indices[0]);
+	Gather(&indices[0]);
+}
+
+void Population::Systematic(const float *weights, int size, int count, int *indices)
+{
+	if(!size || !count) return;
+	double sum = 0;
+	FOR(i, size) sum += weights[i];
+	if(sum <= 0) // degenerate weights, we fall back to uniform draws
+	{
+		FOR(i, count) indices[i] = (int)((i + drand48()) * size / count) % size;
+		return;
+	}
+	double step = sum / count;
+	double position = drand48()*step;
+	double cumulative = weights[0];
+	int j = 0;
+	FOR(i, count)
+	{
+		while(position > cumulative && j < size-1) cumulative += weights[++j];
+		indices[i] = j;
+		position += step;
+	}
+}
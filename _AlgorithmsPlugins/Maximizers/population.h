@@ -0,0 +1,68 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License,
+version 3 as published by the Free Software Foundation.
+
+This library is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#ifndef _POPULATION_H_
+#define _POPULATION_H_
+
+#include <vector>
+#include <public.h>
+#include <rewardSource.h>
+
+// set of candidate samples shared by the population-based maximizers (GA, particles, swarm)
+// samples are stored contiguously (count x dim, row-major) next to their fitness and weights
+// buffers are only reallocated when the population grows, never from one generation to the next
+class Population
+{
+	int dim, count;
+	fvec samples;
+	fvec fitness;
+	fvec weights;
+	fvec buffer;	// gather scratch
+	ivec indices;	// resampling scratch
+
+public:
+	Population(int dim=2, int count=0);
+	void Resize(int dim, int count);
+	void Randomize(int start=0); // uniform in the unit hypercube
+	void Swap(Population &other);
+
+	int Dim() const {return dim;};
+	int Count() const {return count;};
+	float *Sample(int i){return &samples[i*dim];};
+	const float *Sample(int i) const {return &samples[i*dim];};
+	fvec ToSample(int i) const {return fvec(samples.begin()+i*dim, samples.begin()+(i+1)*dim);};
+	float *Fitness(){return &fitness[0];};
+	float *Weights(){return &weights[0];};
+	const float *Fitness() const {return &fitness[0];};
+	const float *Weights() const {return &weights[0];};
+
+	// fitness of the samples in [start, count), evaluated in parallel
+	void Evaluate(const RewardSource *reward, int start=0);
+	// index of the largest value (fitness if values is NULL)
+	int Best(const float *values=0) const;
+	void Clamp(); // back into the unit hypercube
+	// replaces samples, fitness and weights by the ones at indices (which may repeat)
+	void Gather(const int *indices);
+	// count draws proportional to the weights, systematic resampling in O(count)
+	void Resample();
+
+	// draws count indices proportional to weights (all >= 0) with a single uniform offset, indices come out sorted
+	static void Systematic(const float *weights, int size, int count, int *indices);
+};
+
+#endif // _POPULATION_H_
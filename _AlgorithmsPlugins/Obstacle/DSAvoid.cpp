@@ -1,348 +1,401 @@
 #include <public.h>
 #include "DSAvoid.h"
+#include <iostream>
 
 DSAvoid::DSAvoid()
-	: dim(2), obs(0)
+	: dim(2), b_obstacle(false), b_contouring(false), num_obs(0), c_obs(0)
 {
 }
 
 DSAvoid::~DSAvoid()
 {
-	KILL(obs);
 }
 
 void DSAvoid::Clear()
 {
-	KILL(obs);
+	obs.clear();
+	num_obs = 0;
 }
 
-void DSAvoid::SetObstacles(std::vector< Obstacle > newObstacles)
+void DSAvoid::SetObstacles(const std::vector< Obstacle > &newObstacles)
 {
-	if(!obstacles.size() || obstacles.size() != newObstacles.size())
+	bool bChanged = !obstacles.size() || obstacles.size() != newObstacles.size();
+	// we want to know if something new was added
+	for(u32 i=0; i<obstacles.size() && !bChanged; i++) bChanged = obstacles[i] != newObstacles[i];
+	if(!bChanged && obs.size()) return;
+
+	obstacles = newObstacles;
+	obs.clear();
+	if(!obstacles.size())
 	{
-		obstacles = newObstacles;
-		KILL(obs);
+		num_obs = 0;
+		return;
 	}
-	else // we want to know if something new was added
+	FOR(i, obstacles.size())
 	{
-		FOR(i, obstacles.size())
-		{
-			if(obstacles[i] != newObstacles[i])
-			{
-				obstacles = newObstacles;
-				KILL(obs);
-				break;
-			}
-		}
-	}
-
-	if(!obs && obstacles.size())
-	{
-		obs = new DSObstacle[obstacles.size()];
-		FOR(i, obstacles.size())
-		{
-			obs[i] = DSObstacle(obstacles[i]);
-			//obs[i].Print();
-		}
-		num_obs = obstacles.size();
-
-		init(num_obs);
+		obs.push_back(DSObstacle(obstacles[i]));
+		//obs[i].Print();
 	}
+	num_obs = obstacles.size();
+	dim = obs[0].dim;
+	init(num_obs);
 }
 
 fvec DSAvoid::Avoid(fvec &x, fvec &xdot)
 {
-	if(!obstacles.size()) return xdot;
-	dim = 2;
-	Vector X(2), XDot(2);
+	if(!obstacles.size() || (int)x.size() < dim || (int)xdot.size() < dim) return xdot;
+	double X[3], XDot[3];
 	FOR(d, dim)
 	{
-		X(d) = x[d];
-		XDot(d) = xdot[d];
+		X[d] = x[d];
+		XDot[d] = xdot[d];
 	}
 
 	// we do the actual avoidance
-	Avoid(X,XDot);
+	Modulate(X,XDot);
 
 	fvec newXDot = xdot;
-	FOR(d,dim) newXDot[d] = XDot(d);
+	FOR(d,dim) newXDot[d] = XDot[d];
 	return newXDot;
 }
 
 fVec DSAvoid::Avoid(fVec &x, fVec &xdot)
 {
-	if(!obstacles.size()) return xdot;
-	dim = 2;
-	Vector X(2), XDot(2);
-	FOR(d, dim)
+	if(!obstacles.size() || dim != 2) return xdot;
+	double X[2], XDot[2];
+	FOR(d, 2)
 	{
-		X(d) = x[d];
-		XDot(d) = xdot[d];
+		X[d] = x[d];
+		XDot[d] = xdot[d];
 	}
 
 	// we do the actual avoidance
-	Avoid(X,XDot);
+	Modulate(X,XDot);
 
 	fVec newXDot = xdot;
-	FOR(d,dim) newXDot[d] = XDot(d);
+	FOR(d,2) newXDot[d] = XDot[d];
 	return newXDot;
 }
 
-
-DSObstacle::DSObstacle(Obstacle o)
+void DSAvoid::Avoid(const float *x, float *xdot, int count, int sampleDim)
 {
-	int dim = o.axes.size();
-
-	center.Resize(dim);
-
-	Rotation.Resize(dim,dim);
-	Rotation.Identity();
-
-	if(dim == 2)
+	if(!obstacles.size() || sampleDim < dim || count <= 0) return;
+	// every sample starts from a fresh (non-contouring) state, so they are independent
+#ifdef _OPENMP
+#pragma omp parallel if(count*num_obs > 4096)
+#endif
 	{
-		Rotation(0,0) = cos(o.angle);
-		Rotation(0,1) = -sin(o.angle);
-		Rotation(1,0) = sin(o.angle);
-		Rotation(1,1) = cos(o.angle);
+		DSAvoidWorkspace ws;
+		ws.Resize(num_obs);
+#ifdef _OPENMP
+#pragma omp for
+#endif
+		for(int i=0; i<count; i++)
+		{
+			double X[3], XDot[3];
+			bool bContouring = false;
+			FOR(d, dim)
+			{
+				X[d] = x[i*sampleDim + d];
+				XDot[d] = xdot[i*sampleDim + d];
+			}
+			if(dim == 3) Modulate<3>(X, XDot, bContouring, ws, false);
+			else Modulate<2>(X, XDot, bContouring, ws, false);
+			FOR(d, dim) xdot[i*sampleDim + d] = XDot[d];
+		}
 	}
+}
 
-	axes.Resize(dim);
-	axes.One();
-
-	power.Resize(dim);
-	power.One();
-
-	e_amp.Resize(dim+1);
-	e_amp.One();
-
-	safetyFactor.Resize(dim);
-	safetyFactor = safetyFactor.One();
+DSObstacle::DSObstacle(const Obstacle &o)
+{
+	dim = min((int)o.axes.size(), 3);
 
-	if (dim == 3){
-		E.Resize(3,4);
-	}else{
-		E.Resize(dim,dim);
+	FOR(i, 9) Rotation[i] = (i%4 == 0) ? 1 : 0;
+	if(dim == 2)
+	{
+		Rotation[0*3+0] = cos(o.angle);
+		Rotation[0*3+1] = -sin(o.angle);
+		Rotation[1*3+0] = sin(o.angle);
+		Rotation[1*3+1] = cos(o.angle);
 	}
-	E.Identity();
 
-	M.Resize(dim,dim);
-	M.Identity();
-
-	power = safetyFactor = center = axes = Vector(dim);
-	FOR(d,dim)
+	FOR(d, 4) e_amp[d] = 1;
+	FOR(d, 3)
 	{
-		axes(d) = o.axes[d];
-		center(d) = o.center[d];
-		power(d) = o.power[d];
-		safetyFactor(d) = o.repulsion[d];
+		axes[d] = d < dim ? o.axes[d] : 1;
+		center[d] = d < dim ? o.center[d] : 0;
+		power[d] = d < dim ? o.power[d] : 1;
+		safetyFactor[d] = d < dim ? o.repulsion[d] : 1;
+		ipower[d] = (power[d] == (int)power[d] && power[d] >= 1 && power[d] <= 16) ? (int)power[d] : -1;
 	}
 }
 
 DSObstacle::DSObstacle(int dim)
+	: dim(dim)
 {
-	center.Resize(dim);
-
-	Rotation.Resize(dim,dim);
-	Rotation.Identity();
-
-	axes.Resize(dim);
-	axes.One();
-
-	power.Resize(dim);
-	power.One();
-
-	e_amp.Resize(dim+1);
-	e_amp.One();
-
-	safetyFactor.Resize(dim);
-	safetyFactor = safetyFactor.One();
-
-	if (dim == 3){
-		E.Resize(3,4);
-	}else{
-		E.Resize(dim,dim);
+	FOR(i, 9) Rotation[i] = (i%4 == 0) ? 1 : 0;
+	FOR(d, 4) e_amp[d] = 1;
+	FOR(d, 3)
+	{
+		center[d] = 0;
+		axes[d] = power[d] = safetyFactor[d] = 1;
+		ipower[d] = 1;
 	}
-	E.Identity();
-
-	M.Resize(dim,dim);
-	M.Identity();
 }
 
 void DSObstacle::Print()
 {
 	std::cout << "Axes" << "\n";
-	axes.Print();
-	std::cout << "Center" << "\n";
-	center.Print();
-	std::cout << "Rotation" << "\n";
-	Rotation.Print();
+	FOR(d, dim) std::cout << axes[d] << " ";
+	std::cout << "\n" << "Center" << "\n";
+	FOR(d, dim) std::cout << center[d] << " ";
+	std::cout << "\n" << "Rotation" << "\n";
+	FOR(i, dim)
+	{
+		FOR(j, dim) std::cout << Rotation[i*3+j] << " ";
+		std::cout << "\n";
+	}
 	std::cout << "Power" << "\n";
-	power.Print();
-	std::cout << "Safety Factor" << "\n";
-	safetyFactor.Print();
-	std::cout << "E_amp" << "\n";
-	e_amp.Print();
-	std::cout << "E" << "\n";
-	E.Print();
-	std::cout << "M" << "\n";
-	M.Print();
+	FOR(d, dim) std::cout << power[d] << " ";
+	std::cout << "\n" << "Safety Factor" << "\n";
+	FOR(d, dim) std::cout << safetyFactor[d] << " ";
+	std::cout << "\n" << "E_amp" << "\n";
+	FOR(d, dim+1) std::cout << e_amp[d] << " ";
+	std::cout << "\n";
 }
 
+void DSAvoidWorkspace::Resize(int num_obs)
+{
+	Gamma.resize(num_obs);
+	nv.resize(num_obs*3);
+	M.resize(num_obs*9);
+	ind.resize(num_obs);
+}
 
 void DSAvoid::init(int num_obs)
 {
-	Gamma.Resize(num_obs);
-	Gamma.Zero();
-
-	x_t.Resize(dim); //dim is the dimension of DS, which for your case is 2
-	xd_old.Resize(dim);
-	vec_tmp.Resize(dim);
-	nv.Resize(dim);
-	e.Resize(dim);
+	workspace.Resize(num_obs);
 	b_contouring = false;
-	xd_contouring.Resize(dim);
-	R_transpose.Resize(dim,dim);
-	nv_rotated.Resize(dim);
-	mat_tmp3.Resize(dim,dim);
-	mat_tmp4.Resize(dim,dim);
-	ind.resize(num_obs);
-	if (dim == 3){
-		d.Resize(4);
-		D.Resize(4,4);
-		mat_tmp1.Resize(4,3);
-		mat_tmp2.Resize(4,3);
-	}else{
-		d.Resize(dim);
-		D.Resize(dim,dim);
-		mat_tmp1.Resize(dim,dim);
-		mat_tmp2.Resize(dim,dim);
-	}
 	c_obs = 0; //current obstacle number (used for changing the obstacle properties in DS_Command)
+}
 
+// inverse of a symmetric 3x3 matrix
+static inline void Invert3(const double S[3][3], double Si[3][3])
+{
+	double idet = 1.0/(S[0][0]*(S[1][1]*S[2][2]-S[1][2]*S[2][1])
+			- S[0][1]*(S[1][0]*S[2][2]-S[1][2]*S[2][0])
+			+ S[0][2]*(S[1][0]*S[2][1]-S[1][1]*S[2][0]));
+	Si[0][0] = (S[1][1]*S[2][2]-S[1][2]*S[2][1])*idet;
+	Si[0][1] = (S[0][2]*S[2][1]-S[0][1]*S[2][2])*idet;
+	Si[0][2] = (S[0][1]*S[1][2]-S[0][2]*S[1][1])*idet;
+	Si[1][0] = Si[0][1];
+	Si[1][1] = (S[0][0]*S[2][2]-S[0][2]*S[2][0])*idet;
+	Si[1][2] = (S[0][2]*S[1][0]-S[0][0]*S[1][2])*idet;
+	Si[2][0] = Si[0][2];
+	Si[2][1] = Si[1][2];
+	Si[2][2] = (S[0][0]*S[1][1]-S[0][1]*S[1][0])*idet;
 }
 
-bool DSAvoid::Avoid(Vector &x,Vector &xd)
+// x^n for small integer powers, pow otherwise
+static inline double IntPow(double x, int n, double p)
 {
-    xd_old = xd;
-
-    for (int i=0; i<num_obs;i++){
-		x.Sub(obs[i].center,vec_tmp);
-
-		obs[i].Rotation.Transpose(R_transpose);
-        R_transpose.Mult(vec_tmp,x_t); //x_t = R_transpose*vec_tmp;
-		x_t /= obs[i].axes;
-		x_t /= obs[i].safetyFactor;
-
-		nv = obs[i].power;
-		nv /= obs[i].axes;
-        for (int j=0;j<3;j++)
-			nv[j] *= pow(x_t[j],2.0*obs[i].power[j]-1.0);
-
-        // generating the matrix of the basis vector E. For example for a 2D model it simply is: E = [nv [-nv(2);nv(1)]];
-        obs[i].E.SetColumn(nv,0); //nv is in fact the normal vector of the tangential hyper-plane
-        for (int j=1;j<dim;j++){
-            obs[i].E(0,j) = nv[j];
-            obs[i].E(j,j) = -nv[0];
-        }
-
-        if (dim == 3){
-            obs[i].E(0,3) = 0;
-            obs[i].E(1,3) = nv(2);
-            obs[i].E(2,3) = -nv(1);
-        }
-
-        /* its equivalent in 3D
-            E(0,0) = nv(0);         E(0,1) = nv(1);         E(0,2) = nv(2);         E(0,3) = 0;
-            E(1,0) = nv(1);         E(1,1) = -nv(0);	E(1,2) = 0;		E(1,3) = nv(2);
-            E(2,0) = nv(2);         E(2,1) = 0;		E(2,2) = -nv(0);	E(2,3) = -nv(1);
-        */
-
-        Gamma[i] = 0;
-        for (int j=0;j<dim;j++)
-			Gamma[i] += pow(x_t[j],2.0*obs[i].power[j]);
-
-        d.One();
-
-		obs[i].Rotation.Mult(nv,nv_rotated); //obs[i].R*nv
-		/*
-        if (xd*nv_rotated < 0) //the obstacle is not passed yet
-            d[0] = -1.0; //0
-        else //the obstacle is already passed, no need to do anything
-            d[0] = 0.0;
-		*/
-		d[0] = -1.0; //0
+	if(n < 0) return pow(x, p);
+	double res = 1;
+	while(n--) res *= x;
+	return res;
+}
 
-        d /= Gamma[i]; //Computing eigen-values
+bool DSAvoid::Modulate(const double *x, double *xd)
+{
+	if(dim == 3) return Modulate<3>(x, xd, b_contouring, workspace, true);
+	return Modulate<2>(x, xd, b_contouring, workspace, true);
+}
+
+template<int DIM> bool DSAvoid::Modulate(const double *x, double *xd, bool &bContouring, DSAvoidWorkspace &ws, bool bVerbose) const
+{
+	// E has an extra basis vector in 3D to avoid the degenerate tangent plane
+	const int EC = DIM == 3 ? 4 : DIM;
+	double xd_old[DIM];
+	double d[EC] = {0};
+	FOR(j, DIM) xd_old[j] = xd[j];
+
+	for (int i=0; i<num_obs;i++){
+		const DSObstacle &o = obs[i];
+		const double *R = o.Rotation;
+		double vec_tmp[DIM], x_t[DIM];
+		FOR(j, DIM) vec_tmp[j] = x[j] - o.center[j];
+		FOR(j, DIM)
+		{
+			double v = 0;
+			FOR(l, DIM) v += R[l*3+j]*vec_tmp[l]; //x_t = R_transpose*vec_tmp;
+			x_t[j] = v / o.axes[j] / o.safetyFactor[j];
+		}
 
-        if (d[0] < -1){
-			d.One();
-			d[0] = (nv_rotated*xd < 0) ? -1.0 : 0.0;
-			xd.Zero();
+		double *nv = &ws.nv[i*3];
+		double Gamma = 0;
+		FOR(j, DIM)
+		{
+			nv[j] = o.power[j] / o.axes[j];
+			double xp = IntPow(x_t[j], o.ipower[j] > 0 ? 2*o.ipower[j]-1 : -1, 2.0*o.power[j]-1.0);
+			nv[j] *= xp;
+			Gamma += xp*x_t[j]; // pow(x_t[j],2.0*obs[i].power[j])
+		}
+		ws.Gamma[i] = Gamma;
+
+		//Computing eigen-values
+		FOR(j, EC) d[j] = 1.0/Gamma;
+		d[0] = -1.0/Gamma;
+		if (d[0] < -1){
+			FOR(j, DIM) xd[j] = 0;
 			return false;
-        }
-        d += 1; //+1 is for the identity matrix
-        D.Diag(d);
-
-        //obs[i].M = obs[i].R*(obs[i].E*D*obs[i].E.Inverse())*R_transpose;
-        if (dim == 3){
-            obs[i].E.MultTranspose2(obs[i].E,mat_tmp3);
-            mat_tmp3.SInverseSymmetric();
-            obs[i].E.TransposeMult(mat_tmp3,mat_tmp1);
-        }else
-            obs[i].E.Inverse(mat_tmp1);
-
-        D.Mult(mat_tmp1,mat_tmp2);
-        obs[i].E.Mult(mat_tmp2,mat_tmp3);
-		obs[i].Rotation.Mult(mat_tmp3,mat_tmp4);
-        mat_tmp4.Mult(R_transpose,obs[i].M);
-
-    } //end of for 0:num_obs-1
-
-    Gamma.Sort(&ind); //sorting Gamma decreasingly
-
-    //applying the modulation
-    for (int i=0 ; i<num_obs ; i++){
-        vec_tmp = xd;
-        obs[ind.at(i)].M.Mult(vec_tmp,xd); //xd = obs[ind.at(i)].M*vec_tmp;
-    }
-
-    i_end = ind.at(num_obs-1);
-
-
-    //to avoid instability if we numerically enters into the obstacle
-	obs[i_end].Rotation.Mult(nv,nv_rotated); //obs[i_end].R*nv
-    if (!b_contouring && d[0] < 0.01 && nv_rotated*xd_old < 0 && xd.Norm() < 0.05){ // Gamma(x_t) <= 1
-        b_contouring = true;
-		std::cout << "contouring started ... " << "\n";
-    }
-
-    if (b_contouring){
-        xd_contouring.Zero();
-
-        for (int i = 1; i<dim ; i++){
-            obs[i_end].E.GetColumn(i,e);
-            if (e[2] < 0) //shit
-				e *= -1;
-
-            if (e.Norm() > 0.0001)
-                e *= obs[i_end].e_amp[i]/e.Norm();
-			xd_contouring += e; //contouring
-        }
-
-        vec_tmp = xd_contouring;
-		obs[i_end].Rotation.Mult(vec_tmp,xd_contouring); //xd_contouring = obs[i_end].R * xd_contouring;
-        if (((xd_contouring*xd > 0) && xd.Norm() > 0.05) || nv_rotated*xd_old >= 0)  { //
-            b_contouring = false;
-			std::cout << "contouring stopped ... " << "\n";
-        }
-
-        xd = xd_contouring;
-    }
-
-    /*
-    if (xd.Norm()!=0)
-        xd *= xd_norm/xd.Norm();
-    */
+		}
+		FOR(j, EC) d[j] += 1; //+1 is for the identity matrix
+
+		// generating the matrix of the basis vector E. For example for a 2D model it simply is: E = [nv [-nv(2);nv(1)]];
+		/* its equivalent in 3D
+			E(0,0) = nv(0);         E(0,1) = nv(1);         E(0,2) = nv(2);         E(0,3) = 0;
+			E(1,0) = nv(1);         E(1,1) = -nv(0);	E(1,2) = 0;		E(1,3) = nv(2);
+			E(2,0) = nv(2);         E(2,1) = 0;		E(2,2) = -nv(0);	E(2,3) = -nv(1);
+		*/
+		double E[DIM][EC];
+		FOR(r, DIM) FOR(c, EC) E[r][c] = 0;
+		FOR(r, DIM) E[r][0] = nv[r]; //nv is in fact the normal vector of the tangential hyper-plane
+		for (int j=1;j<DIM;j++){
+			E[0][j] = nv[j];
+			E[j][j] = -nv[0];
+		}
+		if (DIM == 3){
+			E[1][EC-1] = nv[DIM-1];
+			E[DIM-1][EC-1] = -nv[1];
+		}
+
+		// Einv: the inverse of E in 2D, its pseudo-inverse E'*inv(E*E') in 3D
+		double Einv[EC][DIM];
+		if (DIM == 3){
+			double S[3][3], Si[3][3];
+			FOR(r, DIM) FOR(c, DIM)
+			{
+				S[r][c] = 0;
+				FOR(k, EC) S[r][c] += E[r][k]*E[c][k];
+			}
+			Invert3(S, Si);
+			FOR(r, EC) FOR(c, DIM)
+			{
+				Einv[r][c] = 0;
+				FOR(k, DIM) Einv[r][c] += E[k][r]*Si[k][c];
+			}
+		}else{
+			double idet = 1.0/(E[0][0]*E[1][1]-E[0][1]*E[1][0]);
+			Einv[0][0] = E[1][1]*idet;
+			Einv[0][1] = -E[0][1]*idet;
+			Einv[1][0] = -E[1][0]*idet;
+			Einv[1][1] = E[0][0]*idet;
+		}
+
+		//obs[i].M = obs[i].R*(obs[i].E*D*obs[i].E.Inverse())*R_transpose;
+		double A[DIM][DIM], RA[DIM][DIM];
+		FOR(r, DIM) FOR(c, DIM)
+		{
+			double v = 0;
+			FOR(k, EC) v += E[r][k]*d[k]*Einv[k][c];
+			A[r][c] = v;
+		}
+		FOR(r, DIM) FOR(c, DIM)
+		{
+			double v = 0;
+			FOR(k, DIM) v += R[r*3+k]*A[k][c];
+			RA[r][c] = v;
+		}
+		double *M = &ws.M[i*9];
+		FOR(r, DIM) FOR(c, DIM)
+		{
+			double v = 0;
+			FOR(k, DIM) v += RA[r][k]*R[c*3+k];
+			M[r*DIM+c] = v;
+		}
+	} //end of for 0:num_obs-1
+
+	//sorting Gamma decreasingly
+	int *ind = &ws.ind[0];
+	double *Gamma = &ws.Gamma[0];
+	FOR(i, num_obs) ind[i] = i;
+	for (int i=0; i<num_obs-1; i++){
+		int maxId = i;
+		for (int j=i+1; j<num_obs; j++) if (Gamma[maxId] < Gamma[j]) maxId = j;
+		if (maxId != i){
+			std::swap(Gamma[i], Gamma[maxId]);
+			std::swap(ind[i], ind[maxId]);
+		}
+	}
+
+	//applying the modulation
+	for (int i=0 ; i<num_obs ; i++){
+		const double *M = &ws.M[ind[i]*9];
+		double vec_tmp[DIM];
+		FOR(j, DIM) vec_tmp[j] = xd[j];
+		FOR(r, DIM)
+		{
+			double v = 0;
+			FOR(c, DIM) v += M[r*DIM+c]*vec_tmp[c];
+			xd[r] = v; //xd = obs[ind.at(i)].M*vec_tmp;
+		}
+	}
+
+	int i_end = ind[num_obs-1];
+
+	//to avoid instability if we numerically enters into the obstacle
+	//(nv and d are the ones of the last obstacle processed above)
+	const double *nv = &ws.nv[(num_obs-1)*3];
+	const double *R = obs[i_end].Rotation;
+	double nv_rotated[DIM], xd_norm = 0, nvxd_old = 0;
+	FOR(r, DIM)
+	{
+		nv_rotated[r] = 0;
+		FOR(c, DIM) nv_rotated[r] += R[r*3+c]*nv[c]; //obs[i_end].R*nv
+		nvxd_old += nv_rotated[r]*xd_old[r];
+		xd_norm += xd[r]*xd[r];
+	}
+	xd_norm = sqrt(xd_norm);
+	if (!bContouring && d[0] < 0.01 && nvxd_old < 0 && xd_norm < 0.05){ // Gamma(x_t) <= 1
+		bContouring = true;
+		if(bVerbose) std::cout << "contouring started ... " << "\n";
+	}
+
+	if (bContouring){
+		double contour[DIM], xd_contouring[DIM];
+		FOR(j, DIM) contour[j] = 0;
+		const double *nv_end = &ws.nv[i_end*3];
+
+		for (int i = 1; i<DIM ; i++){
+			double e[DIM]; // column i of E for the obstacle i_end
+			FOR(j, DIM) e[j] = 0;
+			e[0] = nv_end[i];
+			e[i] = -nv_end[0];
+			if (DIM > 2 && e[DIM > 2 ? 2 : 0] < 0) //shit
+				FOR(j, DIM) e[j] *= -1;
+
+			double norm = 0;
+			FOR(j, DIM) norm += e[j]*e[j];
+			norm = sqrt(norm);
+			if (norm > 0.0001)
+				FOR(j, DIM) e[j] *= obs[i_end].e_amp[i]/norm;
+			FOR(j, DIM) contour[j] += e[j]; //contouring
+		}
+
+		double dot = 0;
+		FOR(r, DIM)
+		{
+			xd_contouring[r] = 0;
+			FOR(c, DIM) xd_contouring[r] += R[r*3+c]*contour[c]; //xd_contouring = obs[i_end].R * xd_contouring;
+			dot += xd_contouring[r]*xd[r];
+		}
+		if ((dot > 0 && xd_norm > 0.05) || nvxd_old >= 0)  { //
+			bContouring = false;
+			if(bVerbose) std::cout << "contouring stopped ... " << "\n";
+		}
+
+		FOR(j, DIM) xd[j] = xd_contouring[j];
+	}
 
 	return true;
 }
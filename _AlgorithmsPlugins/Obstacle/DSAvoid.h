@@ -3,13 +3,10 @@
 #ifndef _DSAVOID_H_
 #define _DSAVOID_H_
 
-#include "MathLib/MathLib.h"
 #include <obstacles.h>
 
 #include <string>
 
-using namespace MathLib;
-
 #define MAX_LOG_TIME_SEC        120
 #define CYCLES_PER_SEC          500
 #define MAX_LOG_CYCLES          (MAX_LOG_TIME_SEC * CYCLES_PER_SEC)
@@ -17,21 +14,30 @@ static int num_obs_max = 5; //maximum number of obstacles
 //#define PI						3.141592653589793
 
 //stuffs for the obstacle avoidance
+//everything that does not depend on the query point is computed once in SetObstacles
 struct DSObstacle{
-	Vector			axes;		//the obstacle major axes
-	Vector			center;		//the center of the obstacle
-	Matrix			Rotation;		//the orientation matrix
-	Vector			power;		//Gamma is \sum( (x/a)^m )
-	Vector			safetyFactor;		//safety factor
-	Matrix			E;              //matrix of the basis vector
-	Matrix			M;              //dynamic modulation matrix (dim x dim)
-	Vector			e_amp;          //defining the amplitude of each basis vector (to avoid saddle/local minimum)
-	//Vector			origin_shift;   //transforming the real center of the obstacle
+	int				dim;
+	double			axes[3];		//the obstacle major axes
+	double			center[3];		//the center of the obstacle
+	double			Rotation[9];	//the orientation matrix (row-major 3x3, identity beyond dim)
+	double			power[3];		//Gamma is \sum( (x/a)^m )
+	int				ipower[3];		//the power if it is a (small) integer, -1 otherwise
+	double			safetyFactor[3];	//safety factor
+	double			e_amp[4];		//defining the amplitude of each basis vector (to avoid saddle/local minimum)
 	DSObstacle(int dim=2);
-	DSObstacle(Obstacle obstacle);
+	DSObstacle(const Obstacle &obstacle);
 	void Print();
 };
 
+//per-sample scratch of the modulation kernel, one per thread
+struct DSAvoidWorkspace{
+	std::vector<double> Gamma;
+	std::vector<double> nv;		//normal vector of each obstacle (num_obs x dim)
+	std::vector<double> M;		//dynamic modulation matrix of each obstacle (num_obs x dim x dim)
+	std::vector<int> ind;		//priority of obstacles after sorting them based on Gamma
+	void Resize(int num_obs);
+};
+
 class DSAvoid : public ObstacleAvoidance
 {
 public:
@@ -41,26 +47,22 @@ public:
 	void init(int num_obs);
 	fvec Avoid(fvec &x, fvec &xdot);
 	fVec Avoid(fVec &x, fVec &xdot);
-	void SetObstacles(std::vector< Obstacle > obstacles);
+	void Avoid(const float *x, float *xdot, int count, int dim);
+	void SetObstacles(const std::vector< Obstacle > &obstacles);
 
 protected:
-	bool Avoid(Vector &x,Vector &xd);
+	// modulates xd at x, returns false if x is inside an obstacle (xd is then zeroed)
+	// bContouring carries the contouring state from one call to the next
+	template<int DIM> bool Modulate(const double *x, double *xd, bool &bContouring, DSAvoidWorkspace &ws, bool bVerbose) const;
+	bool Modulate(const double *x, double *xd);
 	int dim;
-	DSObstacle*		obs; //to model the obstacle
-	Vector			x_t,d,nv,nv_rotated,e; //nv is the normal vector
-	Matrix			D;
+	std::vector<DSObstacle> obs; //to model the obstacle
 	bool			b_obstacle;  //check if the obstacle module is activated
 	bool			b_contouring; //shall we contour the obstacle
-	Vector			xd_contouring;
-	Vector			xd_old,vec_tmp;
-	int				i_end;
-	Vector			Gamma;
 	int				num_obs; //the number of obstacles
-	IndicesVector	ind; //a vector keeping the priority of obstacles after sorting them based on Gamma
 	int				c_obs; //current obstacle number (used for changing the obstacle properties in DS_Command)
-	string			Joint_Obstacles_File; //the file name that includes the properties of obstacles in the joint space
-	Matrix			R_transpose;
-	Matrix			mat_tmp0,mat_tmp1,mat_tmp2,mat_tmp3,mat_tmp4;
+	std::string		Joint_Obstacles_File; //the file name that includes the properties of obstacles in the joint space
+	DSAvoidWorkspace workspace;
 };
 
 #endif // _DSAVOID_H_
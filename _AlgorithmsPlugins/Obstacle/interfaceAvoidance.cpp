@@ -24,7 +24,7 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 using namespace std;
 
 PluginAvoid::PluginAvoid()
-	: widget(new QWidget())
+	: widget(ParameterMap::HasGUI() ? new QWidget() : 0)
 {
 }
 
@@ -0,0 +1,8 @@
+# ##########################
+# Configuration      #
+# ##########################
+NAME = benchOpenCV
+PLUGIN = mld_OpenCV
+MLPATH =../..
+
+include($$MLPATH/MLBench/benchPlugin.pri)
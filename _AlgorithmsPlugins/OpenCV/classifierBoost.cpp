@@ -21,10 +21,12 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include "basicMath.h"
 #include "classifierBoost.h"
 
+#define BOOST_STACK_LEARNERS 512 // learner responses of a single test fit on the stack up to this count
+
 using namespace std;
 
 ClassifierBoost::ClassifierBoost()
-: model(0), weakCount(0), scoreMultiplier(1.f)
+: weakCount(0), weakType(0), scoreMultiplier(1.f), currentLearnerType(-1)
 {
 	bSingleClass = false;
 	type = CLASS_BOOST;
@@ -32,172 +34,181 @@ ClassifierBoost::ClassifierBoost()
 
 ClassifierBoost::~ClassifierBoost()
 {
-	if(model) model->clear();
-	DEL(model);
 }
 
-vector<fvec> learners;
-int currentLearnerType = -1;
-
-void ClassifierBoost::Train( std::vector< fvec > samples, ivec labels )
+float BoostStumps::Score(const float *sample, float *f) const
 {
-	if(model)model->clear();
-	u32 sampleCnt = samples.size();
-	if(!sampleCnt) return;
-	DEL(model);
-	dim = samples[0].size();
-	u32 *perm = randPerm(sampleCnt);
+	if(!count) return 0;
+	const float *p = &projections[0];
+	switch(weakType)
+	{
+	case 0: // projection on the learner direction
+		for(int i=0; i<count; i++) f[i] = 0;
+		FOR(d, dim)
+		{
+			const float x = sample[d];
+			const float *pd = p + d*count;
+			for(int i=0; i<count; i++) f[i] += x*pd[i];
+		}
+		break;
+	case 1: // inside or outside the rectangle
+	{
+		const float *w = &widths[0];
+		for(int i=0; i<count; i++) f[i] = 1;
+		FOR(d, dim)
+		{
+			const float x = sample[d];
+			const float *pd = p + d*count;
+			const float *wd = w + d*count;
+			for(int i=0; i<count; i++) f[i] = (x < pd[i] || x > pd[i] + wd[i]) ? 0.f : f[i];
+		}
+	}
+		break;
+	default: // squared distance to the center, thresholds were squared accordingly
+		for(int i=0; i<count; i++) f[i] = 0;
+		FOR(d, dim)
+		{
+			const float x = sample[d];
+			const float *pd = p + d*count;
+			for(int i=0; i<count; i++) f[i] += (x-pd[i])*(x-pd[i]);
+		}
+		break;
+	}
+	const float *t = &thresholds[0], *l = &leftValues[0], *r = &rightValues[0];
+	float score = 0;
+	for(int i=0; i<count; i++) score += f[i] <= t[i] ? l[i] : r[i];
+	return score;
+}
 
+void ClassifierBoost::GenerateLearners(std::vector< fvec > &samples)
+{
 	int learnerCount = max((!weakType?360 : 1000), (int)weakCount);
-	if(currentLearnerType != weakType)
+	// rectangles depend on the data boundaries, the other learners can be reused
+	if(weakType != 1 && currentLearnerType == weakType && (int)learners.size() == learnerCount && learners[0].size() == (u32)dim) return;
+	srand(1); // so we always generate the same weak learner
+	learners.clear();
+	learners.resize(learnerCount);
+	// we generate a bunch of random directions as learners
+	if(weakType != 1) // random projection
 	{
-		srand(1); // so we always generate the same weak learner
-		learners.clear();
-		learners.resize(learnerCount);
-		// we generate a bunch of random directions as learners
-	//	srand(1);
-		if(weakType != 1) // random projection
+		if(dim==2)
 		{
-			if(dim==2)
+			FOR(i, learnerCount)
 			{
-				FOR(i, learnerCount)
+				learners[i].resize(dim);
+				if(!weakType)
 				{
-						learners[i].resize(dim);
-						if(!weakType)
-						{
-							float theta = i / (float)learnerCount * PIf;
-							//			float theta = rand()/(float)RAND_MAX*PIf;
-							learners[i][0] = cosf(theta);
-							learners[i][1] = sinf(theta);
-						}
-						else
-						{
-							learners[i][0] = rand()/(float)RAND_MAX;
-							learners[i][1] = rand()/(float)RAND_MAX;
-						}
+					float theta = i / (float)learnerCount * PIf;
+					learners[i][0] = cosf(theta);
+					learners[i][1] = sinf(theta);
 				}
-			}
-			else
-			{
-				FOR(i, learnerCount)
+				else
 				{
-					learners[i].resize(dim);
-					if(!weakType)
-					{
-						FOR(d, dim) learners[i][d] = rand()/(float)RAND_MAX*2. -1.;
-					}
-					else
-					{
-						FOR(d, dim) learners[i][d] = rand()/(float)RAND_MAX;
-					}
+					learners[i][0] = rand()/(float)RAND_MAX;
+					learners[i][1] = rand()/(float)RAND_MAX;
 				}
 			}
 		}
-		else // random rectangle
+		else
 		{
-			// we need to find the boundaries
-			float *xMin = new float[dim];
-			float *xMax = new float[dim];
-			FOR(i, samples.size())
+			FOR(i, learnerCount)
 			{
-				FOR(d,dim)
+				learners[i].resize(dim);
+				if(!weakType)
 				{
-					if(xMin[d] > samples[i][d]) xMin[d] = samples[i][d];
-					if(xMax[d] < samples[i][d]) xMax[d] = samples[i][d];
+					FOR(d, dim) learners[i][d] = rand()/(float)RAND_MAX*2. -1.;
 				}
-			}
-
-			FOR(i, learnerCount)
-			{
-				learners[i].resize(dim*2);
-				FOR(d, dim)
+				else
 				{
-					float x = (rand() / (float)RAND_MAX)*(xMax[d] - xMin[d]) + xMin[d]; // starting point
-					float l = (rand() / (float)RAND_MAX)*(xMax[d] - xMin[d]); // width
-					learners[i][2*d] = x;
-					learners[i][2*d+1] = l;
+					FOR(d, dim) learners[i][d] = rand()/(float)RAND_MAX;
 				}
 			}
-			delete [] xMin;
-			delete [] xMax;
 		}
-		currentLearnerType = weakType;
 	}
-
-	CvMat *trainSamples = cvCreateMat(sampleCnt, learnerCount, CV_32FC1);
-	CvMat *trainLabels = cvCreateMat(labels.size(), 1, CV_32FC1);
-	CvMat *sampleWeights = cvCreateMat(samples.size(), 1, CV_32FC1);
-
-	if(weakType != 1)
+	else // random rectangle
 	{
-		if(dim == 2)
+		// we need to find the boundaries
+		fvec xMin(dim, FLT_MAX), xMax(dim, -FLT_MAX);
+		FOR(i, samples.size())
 		{
-			FOR(i, sampleCnt)
+			FOR(d,dim)
 			{
-				FOR(j, learnerCount)
-				{
-					float val = 0;
-					if(!weakType)
-					{
-						val = samples[perm[i]][0]* learners[j][0] + samples[perm[i]][1]* learners[j][1];
-					}
-					else
-					{
-						val = sqrtf((samples[perm[i]][0] - learners[j][0])*(samples[perm[i]][0] - learners[j][0])+
-							(samples[perm[i]][1] - learners[j][1])*(samples[perm[i]][1] - learners[j][1]));
-					}
-					cvSetReal2D(trainSamples, i, j, val);
-				}
-				cvSet1D(trainLabels, i, cvScalar((float)labels[perm[i]]));
-				cvSet1D(sampleWeights, i, cvScalar(1));
+				if(xMin[d] > samples[i][d]) xMin[d] = samples[i][d];
+				if(xMax[d] < samples[i][d]) xMax[d] = samples[i][d];
 			}
-
 		}
-		else
+
+		FOR(i, learnerCount)
 		{
-			FOR(i, sampleCnt)
+			learners[i].resize(dim*2);
+			FOR(d, dim)
 			{
-				// project the sample in the direction of the learner 
-				fvec sample = samples[perm[i]];
-				FOR(j, learnerCount)
-				{
-					float val = 0;
-					if(!weakType) sample * learners[j];
-					else
-					{
-						FOR(d,dim) val += (sample[d] - learners[j][d])*(sample[d] - learners[j][d]);
-						val = sqrtf(val);
-					}
-					cvSetReal2D(trainSamples, i, j, val);
-				}
-				cvSet1D(trainLabels, i, cvScalar((float)labels[perm[i]]));
-				cvSet1D(sampleWeights, i, cvScalar(1));
+				float x = (rand() / (float)RAND_MAX)*(xMax[d] - xMin[d]) + xMin[d]; // starting point
+				float l = (rand() / (float)RAND_MAX)*(xMax[d] - xMin[d]); // width
+				learners[i][2*d] = x;
+				learners[i][2*d+1] = l;
 			}
 		}
 	}
-	else
+	currentLearnerType = weakType;
+}
+
+void ClassifierBoost::Train( std::vector< fvec > samples, ivec labels )
+{
+	u32 sampleCnt = samples.size();
+	if(!sampleCnt) return;
+	stumps.Clear();
+	dim = samples[0].size();
+	u32 *perm = randPerm(sampleCnt);
+
+	GenerateLearners(samples);
+	int learnerCount = learners.size();
+
+	CvMat *trainSamples = cvCreateMat(sampleCnt, learnerCount, CV_32FC1);
+	CvMat *trainLabels = cvCreateMat(labels.size(), 1, CV_32FC1);
+	CvMat *sampleWeights = cvCreateMat(samples.size(), 1, CV_32FC1);
+
+	// response of every learner on every sample, rows are filled in parallel
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for(int i=0; i<(int)sampleCnt; i++)
 	{
-		FOR(i, sampleCnt)
+		const fvec &sample = samples[perm[i]];
+		float *row = (float *)(trainSamples->data.ptr + i*trainSamples->step);
+		FOR(j, learnerCount)
 		{
-			// check if the sample is inside the recangle generated by the classifier
-			const fvec sample = samples[perm[i]];
-			FOR(j, learnerCount)
+			const fvec &learner = learners[j];
+			float val = 0;
+			if(!weakType) // projection
+			{
+				FOR(d, dim) val += sample[d]*learner[d];
+			}
+			else if(weakType == 1) // rectangle
 			{
-				float val = 1;
+				val = 1;
 				FOR(d, dim)
 				{
-					if(sample[d] < learners[j][2*d] || sample[d] > learners[j][2*d]+learners[j][2*d+1])
+					if(sample[d] < learner[2*d] || sample[d] > learner[2*d]+learner[2*d+1])
 					{
 						val = 0;
 						break;
 					}
 				}
-				cvSetReal2D(trainSamples, i, j, val);
 			}
-			cvSet1D(trainLabels, i, cvScalar((float)labels[perm[i]]));
-			cvSet1D(sampleWeights, i, cvScalar(1));
+			else // circle
+			{
+				FOR(d,dim) val += (sample[d] - learner[d])*(sample[d] - learner[d]);
+				val = sqrtf(val);
+			}
+			row[j] = val;
 		}
 	}
+	FOR(i, sampleCnt)
+	{
+		cvSet1D(trainLabels, i, cvScalar((float)labels[perm[i]]));
+		cvSet1D(sampleWeights, i, cvScalar(1));
+	}
 	delete [] perm;
 
 	CvMat *varType = cvCreateMat(trainSamples->width+1, 1, CV_8UC1);
@@ -210,111 +221,140 @@ void ClassifierBoost::Train( std::vector< fvec > samples, ivec labels )
 	int maxSplit = 1;
 	CvBoostParams params(CvBoost::GENTLE, weakCount, 0.95, maxSplit, false, NULL);
 	params.split_criteria = CvBoost::DEFAULT;
-	model = new CvBoost();
+	CvBoost *model = new CvBoost();
 	model->train(trainSamples, CV_ROW_SAMPLE, trainLabels, NULL, NULL, varType, NULL, params);
 
+	cvReleaseMat(&trainSamples);
+	cvReleaseMat(&trainLabels);
+	cvReleaseMat(&sampleWeights);
+	cvReleaseMat(&varType);
+
+	// we keep only the flattened stumps, the opencv trees are not needed anymore
+	Compile(model);
+	model->clear();
+	DEL(model);
+
 	scoreMultiplier = 1.f;
+	fvec batch(sampleCnt*dim), scores(sampleCnt);
+	FOR(i, sampleCnt)
+	{
+		FOR(d, dim) batch[i*dim + d] = samples[i][d];
+	}
+	TestBatch(&batch[0], &scores[0], sampleCnt, dim);
 	float maxScore=-FLT_MAX, minScore=FLT_MAX;
-	FOR(i, samples.size())
+	FOR(i, sampleCnt)
 	{
-		float score = Test(samples[i]);
-		if(score > maxScore) maxScore = score;
-		if(score < minScore) minScore = score;
+		if(scores[i] > maxScore) maxScore = scores[i];
+		if(scores[i] < minScore) minScore = scores[i];
 	}
 	if(minScore != maxScore)
 	{
 		scoreMultiplier = 1.f/(max(abs((double)maxScore),abs((double)minScore)))*5.f;
 	}
 
+	bFixedThreshold = false;
+	classSpan = 0.01f;
+}
+
+void ClassifierBoost::Compile(CvBoost *model)
+{
+	stumps.Clear();
+	if(!model) return;
 	CvSeq *predictors = model->get_weak_predictors();
+	if(!predictors) return;
 	int length = cvSliceLength(CV_WHOLE_SEQ, predictors);
-	features.clear();
+	int rows = dim;
+	stumps.weakType = weakType;
+	stumps.dim = dim;
+	stumps.count = length;
+	stumps.projections.resize(rows*length);
+	if(weakType == 1) stumps.widths.resize(rows*length);
+	stumps.thresholds.resize(length);
+	stumps.leftValues.resize(length);
+	stumps.rightValues.resize(length);
 	FOR(i, length)
 	{
 		CvBoostTree *predictor = *CV_SEQ_ELEM(predictors, CvBoostTree*, i);
-		CvDTreeSplit *split = predictor->get_root()->split;
-		features.push_back(split->var_idx);
+		const CvDTreeNode *root = predictor->get_root();
+		CvDTreeSplit *split = root->split;
+		int feature = split ? split->var_idx : 0;
+		const fvec &learner = learners[feature];
+		FOR(d, dim)
+		{
+			if(weakType == 1)
+			{
+				stumps.projections[d*length + i] = learner[2*d];
+				stumps.widths[d*length + i] = learner[2*d+1];
+			}
+			else stumps.projections[d*length + i] = learner[d];
+		}
+		if(!split || !root->left || !root->right) // degenerate tree, constant response
+		{
+			stumps.thresholds[i] = FLT_MAX;
+			stumps.leftValues[i] = stumps.rightValues[i] = root->value;
+			continue;
+		}
+		float threshold = split->ord.c;
+		float left = root->left->value, right = root->right->value;
+		if(split->inversed) std::swap(left, right);
+		// circles are scored on the squared distance
+		if(weakType == 2) threshold = threshold < 0 ? -1.f : threshold*threshold;
+		stumps.thresholds[i] = threshold;
+		stumps.leftValues[i] = left;
+		stumps.rightValues[i] = right;
 	}
-
-	cvReleaseMat(&trainSamples);
-	cvReleaseMat(&trainLabels);
-	cvReleaseMat(&sampleWeights);
-	cvReleaseMat(&varType);
-	trainSamples = 0;
-	trainLabels = 0;
-	sampleWeights = 0;
-	varType = 0;
-	bFixedThreshold = false;
-	classSpan = 0.01f;
 }
 
 float ClassifierBoost::Test( const fvec &sample )
 {
-	if(!model) return 0;
-	if(!learners.size()) return 0;
+	if(!stumps.count) return 0;
+	// local buffers, Test can be called from several threads
+	float stack[BOOST_STACK_LEARNERS];
+	fvec heap;
+	float *features = stack;
+	if(stumps.count > BOOST_STACK_LEARNERS)
+	{
+		heap.resize(stumps.count);
+		features = &heap[0];
+	}
+	if(sample.size() >= dim) return stumps.Score(&sample[0], features) * scoreMultiplier;
+	fvec padded(dim, 0);
+	FOR(d, sample.size()) padded[d] = sample[d];
+	return stumps.Score(&padded[0], features) * scoreMultiplier;
+}
 
-	CvMat *x = cvCreateMat(1, learners.size(), CV_32FC1);
-	if(weakType != 1)
+void ClassifierBoost::TestBatch(const float *samples, float *scores, int count, int dim)
+{
+	if(!stumps.count)
 	{
-		if(dim == 2)
-		{
-			FOR(i, features.size())
-			{
-				float val = 0;
-				if(!weakType)
-				{
-					val = sample[0] * learners[features[i]][0] + sample[1] * learners[features[i]][1];
-				}
-				else
-				{
-					val = sqrtf((sample[0] - learners[features[i]][0])*(sample[0] - learners[features[i]][0])+
-						(sample[1] - learners[features[i]][1])*(sample[1] - learners[features[i]][1]));
-				}
-				cvSetReal2D(x, 0, features[i], val);
-			}
-		}
-		else
+		FOR(i, count) scores[i] = 0;
+		return;
+	}
+	int trainDim = this->dim;
+	fvec padded;
+	if(dim != trainDim)
+	{
+		// the samples are padded or cut to the training dimension
+		padded.assign(count*trainDim, 0);
+		FOR(i, count)
 		{
-			FOR(i, features.size())
-			{
-				float val = 0;
-				if(!weakType) sample * learners[features[i]];
-				else
-				{
-					FOR(d,dim) val += (sample[d] - learners[features[i]][d])*(sample[d] - learners[features[i]][d]);
-					val = sqrtf(val);
-				}
-				cvSetReal2D(x, 0, features[i], val);
-			}
+			FOR(d, min(dim, trainDim)) padded[i*trainDim + d] = samples[i*dim + d];
 		}
+		samples = &padded[0];
 	}
-	else
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
 	{
-		FOR(i, features.size())
+		fvec features(stumps.count);
+#ifdef _OPENMP
+#pragma omp for
+#endif
+		for(int i=0; i<count; i++)
 		{
-			int val = 1;
-			FOR(d, dim)
-			{
-				if(sample[d] < learners[features[i]][2*d] ||
-					sample[d] > learners[features[i]][2*d]+learners[features[i]][2*d+1])
-				{
-					val = 0;
-					break;
-				}
-			}
-			cvSetReal2D(x, 0, features[i], val);
+			scores[i] = stumps.Score(samples + i*trainDim, &features[0]) * scoreMultiplier;
 		}
 	}
-
-	// allocate memory for weak learner output
-	int length = cvSliceLength(CV_WHOLE_SEQ, model->get_weak_predictors());
-	CvMat *weakResponses = cvCreateMat(length, 1, CV_32FC1);
-	float y = model->predict(x, NULL, weakResponses, CV_WHOLE_SEQ);
-	double score = cvSum(weakResponses).val[0] * scoreMultiplier;
-
-	cvReleaseMat(&weakResponses);
-	cvReleaseMat(&x);
-	return score;
 }
 
 void ClassifierBoost::SetParams( u32 weakCount, int weakType )
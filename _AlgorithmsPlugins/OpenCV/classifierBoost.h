@@ -23,19 +23,45 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include "classifier.h"
 #include "basicOpenCV.h"
 
+// weak learners selected by the boosting, flattened once training is done
+// projections are stored dimension-major (projections[d*count + i]) so that scoring a sample
+// is a straight loop over the learners for each dimension
+class BoostStumps
+{
+public:
+	int weakType; // 0: random projection, 1: random rectangle, 2: random circle
+	int dim;
+	int count;
+	fvec projections; // directions, circle centers, or rectangle starts (dim rows)
+	fvec widths; // rectangle widths (dim rows)
+	fvec thresholds; // response goes left if feature <= threshold
+	fvec leftValues, rightValues;
+
+	BoostStumps() : weakType(0), dim(0), count(0){};
+	void Clear(){count = 0; projections.clear(); widths.clear(); thresholds.clear(); leftValues.clear(); rightValues.clear();};
+	// features must hold count floats, used as scratch space
+	float Score(const float *sample, float *features) const;
+};
+
 class ClassifierBoost : public Classifier
 {
 private:
-	CvBoost *model;
 	u32 weakCount;
-	int weakType; // 0: random projection, 1: random rectangle
+	int weakType; // 0: random projection, 1: random rectangle, 2: random circle
 	float scoreMultiplier;
-	ivec features;
+	std::vector<fvec> learners;
+	int currentLearnerType;
+	BoostStumps stumps;
+
+	void GenerateLearners(std::vector< fvec > &samples);
+	void Compile(CvBoost *model);
 public:
 	ClassifierBoost();
 	~ClassifierBoost();
 	void Train(std::vector< fvec > samples, ivec labels);
 	float Test(const fvec &sample);
+	// samples is count x dim (row-major), evaluated across threads
+	void TestBatch(const float *samples, float *scores, int count, int dim);
 	char *GetInfoString();
 	void SetParams(u32 weakCount, int weakType);
 };
@@ -22,7 +22,8 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include "classifierMLP.h"
 
 ClassifierMLP::ClassifierMLP()
-: functionType(1), neuronCount(2), mlp(0), alpha(0), beta(0)
+: functionType(1), neuronCount(2), mlp(0), alpha(0), beta(0),
+  method(NeuralNetwork::TRAIN_ADAM), maxEpochs(500), batchSize(32), learningRate(0.01f)
 {
 	type = CLASS_MLP;
 }
@@ -39,63 +40,65 @@ void ClassifierMLP::Train(std::vector< fvec > samples, ivec labels)
 	DEL(mlp);
 	dim = samples[0].size();
 
-	CvMat *layers;
-//	if(neuronCount == 3) neuronCount = 2; // don't ask me why but 3 neurons mess up everything...
-
-	if(!layerCount || neuronCount < 2)
-	{
-		layers = cvCreateMat(2,1,CV_32SC1);
-		cvSet1D(layers, 0, cvScalar(dim));
-		cvSet1D(layers, 1, cvScalar(1));
-	}
-	else
+	ivec layers;
+	layers.push_back(dim);
+	if(layerCount && neuronCount >= 2)
 	{
-		layers = cvCreateMat(2+layerCount,1,CV_32SC1);
-		cvSet1D(layers, 0, cvScalar(dim));
-		cvSet1D(layers, layerCount+1, cvScalar(1));
-		FOR(i, layerCount) cvSet1D(layers, i+1, cvScalar(neuronCount));
+		FOR(i, layerCount) layers.push_back(neuronCount);
 	}
+	layers.push_back(1);
 
-	u32 *perm = randPerm(sampleCnt);
-
-	CvMat *trainSamples = cvCreateMat(sampleCnt, dim, CV_32FC1);
-	CvMat *trainLabels = cvCreateMat(labels.size(), 1, CV_32FC1);
-	CvMat *sampleWeights = cvCreateMat(samples.size(), 1, CV_32FC1);
+	// contiguous copy of the training data
+	fvec trainSamples(sampleCnt*dim);
+	fvec trainLabels(sampleCnt);
 	FOR(i, sampleCnt)
 	{
-		FOR(d, dim) cvSetReal2D(trainSamples, i, d, samples[perm[i]][d]);
-		cvSet1D(trainLabels, i, cvScalar(labels[perm[i]]));
-		cvSet1D(sampleWeights, i, cvScalar(1));
+		FOR(d, dim) trainSamples[i*dim + d] = samples[i][d];
+		trainLabels[i] = labels[i];
 	}
 
-	delete [] perm;
-
-	int activationFunction = functionType == 2 ? CvANN_MLP::GAUSSIAN : functionType ? CvANN_MLP::SIGMOID_SYM : CvANN_MLP::IDENTITY;
-
-
-	mlp = new CvANN_MLP();
-	mlp->create(layers, activationFunction, alpha, beta);
-
-	CvANN_MLP_TrainParams params;
-	params.term_crit = cvTermCriteria(CV_TERMCRIT_ITER | CV_TERMCRIT_EPS, 1000, 0.001);
-	mlp->train(trainSamples, trainLabels, sampleWeights, 0, params);
-	cvReleaseMat(&trainSamples);
-	cvReleaseMat(&trainLabels);
-	cvReleaseMat(&sampleWeights);
-	cvReleaseMat(&layers);
+	mlp = new NeuralNetwork();
+	mlp->Create(layers, functionType, alpha, beta);
+	mlp->method = method;
+	mlp->maxEpochs = maxEpochs;
+	mlp->batchSize = batchSize;
+	mlp->learningRate = learningRate;
+	mlp->Train(&trainSamples[0], &trainLabels[0], sampleCnt);
 }
 
 float ClassifierMLP::Test( const fvec &sample)
 {
 	if(!mlp) return 0;
-	float *_input = new float[dim];
-	FOR(d, dim) _input[d] = sample[d];
-	CvMat input = cvMat(1,dim,CV_32FC1, _input);
-	float _output[1];
-	CvMat output = cvMat(1,1,CV_32FC1, _output);
-	mlp->predict(&input, &output);
-	delete [] _input;
-	return _output[0];
+	float output = 0;
+	if(sample.size() >= dim) mlp->Predict(&sample[0], &output);
+	else
+	{
+		fvec input(dim, 0);
+		FOR(d, sample.size()) input[d] = sample[d];
+		mlp->Predict(&input[0], &output);
+	}
+	return output;
+}
+
+void ClassifierMLP::TestBatch(const float *samples, float *scores, int count, int dim)
+{
+	if(!mlp)
+	{
+		FOR(i, count) scores[i] = 0;
+		return;
+	}
+	if(dim == this->dim)
+	{
+		mlp->Predict(samples, count, scores);
+		return;
+	}
+	// the samples are padded or cut to the training dimension
+	fvec inputs(count*this->dim, 0);
+	FOR(i, count)
+	{
+		FOR(d, min(dim, (int)this->dim)) inputs[i*this->dim + d] = samples[i*dim + d];
+	}
+	mlp->Predict(&inputs[0], count, scores);
 }
 
 void ClassifierMLP::SetParams(u32 functionType, u32 neuronCount, u32 layerCount, f32 alpha, f32 beta)
@@ -107,6 +110,14 @@ void ClassifierMLP::SetParams(u32 functionType, u32 neuronCount, u32 layerCount,
 	this->beta = beta; 
 }
 
+void ClassifierMLP::SetTrainingParams(int method, int maxEpochs, int batchSize, float learningRate)
+{
+	this->method = method;
+	this->maxEpochs = maxEpochs;
+	this->batchSize = batchSize;
+	this->learningRate = learningRate;
+}
+
 char *ClassifierMLP::GetInfoString()
 {
 	char *text = new char[1024];
@@ -21,7 +21,7 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 
 #include <vector>
 #include "classifier.h"
-#include "basicOpenCV.h"
+#include "neuralNetwork.h"
 
 class ClassifierMLP : public Classifier
 {
@@ -30,14 +30,18 @@ private:
 	u32 neuronCount;
 	u32 layerCount;
 	float alpha, beta;
-	CvANN_MLP *mlp;
+	int method, maxEpochs, batchSize;
+	float learningRate;
+	NeuralNetwork *mlp;
 public:
 	ClassifierMLP();
 	~ClassifierMLP();
 	void Train(std::vector< fvec > samples, ivec labels);
 	float Test( const fvec &sample);
+	void TestBatch(const float *samples, float *scores, int count, int dim);
 	char *GetInfoString();
 	void SetParams(u32 functionType, u32 neuronCount, u32 layerCount, f32 alpha, f32 beta);
+	void SetTrainingParams(int method, int maxEpochs, int batchSize, float learningRate);
 };
 
 #endif // _CLASSIFIER_MLP_H_
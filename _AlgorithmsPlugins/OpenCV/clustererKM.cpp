@@ -24,7 +24,7 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 using namespace std;
 
 ClustererKM::ClustererKM()
-: beta(1), clusters(1), bSoft(false), bGmm(false), kmeans(0)
+: beta(1), clusters(1), bSoft(false), bGmm(false), power(2), iterations(100), miniBatch(0), kmeans(0)
 {
 	type = CLUS_KM;
 }
@@ -49,6 +49,9 @@ void ClustererKM::Train(std::vector< fvec > samples)
 	kmeans->SetGMM(bGmm);
 	kmeans->SetBeta(beta);
 	kmeans->SetPower(power);
+	kmeans->SetMaxIterations(iterations);
+	if(miniBatch) kmeans->SetMiniBatch(miniBatch, 0);
+	else kmeans->SetMiniBatch(1024);
 
 	if(!bGmm && !bSoft) kmeans->Update();
 	else
@@ -56,10 +59,11 @@ void ClustererKM::Train(std::vector< fvec > samples)
 		kmeans->Update(bInit);
 	}
 
-	if(!bIterative)
+	// hard k-means already runs until convergence
+	if(!bIterative && (bSoft || bGmm))
 	{
-		int iterations = 20;
-		FOR(i, iterations) kmeans->Update();
+		int passes = 20;
+		FOR(i, passes) kmeans->Update();
 	}
 }
 
@@ -87,11 +91,13 @@ fvec ClustererKM::Test( const fVec &sample)
 	return res;
 }
 
-void ClustererKM::SetParams(u32 clusters, int method, float beta, int power)
+void ClustererKM::SetParams(u32 clusters, int method, float beta, int power, int iterations, int miniBatch)
 {
 	this->clusters = clusters;
 	this->beta = beta;
 	this->power = power;
+	this->iterations = iterations;
+	this->miniBatch = miniBatch;
 	switch(method)
 	{
 	case 0:
@@ -119,6 +125,8 @@ char *ClustererKM::GetInfoString()
 	if(!bSoft && !bGmm) sprintf(text, "%sK-Means\n", text);
 	else if(bSoft) sprintf(text, "%sSoft K-Means (beta: %.3f)\n", text, beta);
 	else sprintf(text, "%sGMM\n", text);
+	sprintf(text, "%sIterations: %d\n", text, iterations);
+	if(miniBatch) sprintf(text, "%sMini-batch: %d\n", text, miniBatch);
 
 	sprintf(text, "%sMetric: ", text);
 	switch(power)
@@ -31,6 +31,8 @@ private:
 	bool bSoft;
 	bool bGmm;
 	int power;
+	int iterations;
+	int miniBatch; // samples per mini-batch iteration, 0 uses the whole dataset (unless it is huge)
 
 public:
 	KMeansCluster *kmeans;
@@ -41,7 +43,7 @@ public:
 	fvec Test( const fVec &sample);
 	char *GetInfoString();
 
-	void SetParams(u32 clusters, int method, float beta, int power);
+	void SetParams(u32 clusters, int method, float beta, int power, int iterations=100, int miniBatch=0);
 };
 
 #endif // _CLUSTERER_KM_H_
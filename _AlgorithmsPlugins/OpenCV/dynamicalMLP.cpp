@@ -24,7 +24,8 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 using namespace std;
 
 DynamicalMLP::DynamicalMLP()
-: functionType(1), neuronCount(2), mlp(0), alpha(0), beta(0)
+: functionType(1), neuronCount(2), mlp(0), alpha(0), beta(0),
+  method(NeuralNetwork::TRAIN_ADAM), maxEpochs(500), batchSize(32), learningRate(0.01f)
 {
 	type = DYN_MLP;
 }
@@ -41,62 +42,40 @@ void DynamicalMLP::Train(std::vector< std::vector<fvec> > trajectories, ivec lab
 	if(!count) return;
 	dim = trajectories[0][0].size()/2;
 	// we forget about time and just push in everything
-	vector<fvec> samples;
-	FOR(i, trajectories.size())
-	{
-		FOR(j, trajectories[i].size())
-		{
-			samples.push_back(trajectories[i][j]);
-		}
-	}
-	u32 sampleCnt = samples.size();
+	u32 sampleCnt = 0;
+	FOR(i, trajectories.size()) sampleCnt += trajectories[i].size();
 	if(!sampleCnt) return;
 	DEL(mlp);
 
-	CvMat *layers;
-	//	if(neuronCount == 3) neuronCount = 2; // don't ask me why but 3 neurons mess up everything...
-
-	if(!layerCount || neuronCount < 2)
-	{
-		layers = cvCreateMat(2,1,CV_32SC1);
-		cvSet1D(layers, 0, cvScalar(dim));
-		cvSet1D(layers, 1, cvScalar(dim));
-	}
-	else
+	ivec layers;
+	layers.push_back(dim);
+	if(layerCount && neuronCount >= 2)
 	{
-		layers = cvCreateMat(2+layerCount,1,CV_32SC1);
-		cvSet1D(layers, 0, cvScalar(dim));
-		cvSet1D(layers, layerCount+1, cvScalar(dim));
-		FOR(i, layerCount) cvSet1D(layers, i+1, cvScalar(neuronCount));
+		FOR(i, layerCount) layers.push_back(neuronCount);
 	}
+	layers.push_back(dim);
 
-	u32 *perm = randPerm(sampleCnt);
-
-	CvMat *trainSamples = cvCreateMat(sampleCnt, dim, CV_32FC1);
-	CvMat *trainOutputs = cvCreateMat(sampleCnt, dim, CV_32FC1);
-	CvMat *sampleWeights = cvCreateMat(samples.size(), 1, CV_32FC1);
-	FOR(i, sampleCnt)
+	// contiguous copy of positions and velocities
+	fvec trainSamples(sampleCnt*dim);
+	fvec trainOutputs(sampleCnt*dim);
+	u32 index = 0;
+	FOR(i, trajectories.size())
 	{
-		FOR(j, dim) cvSetReal2D(trainSamples, i, j, samples[perm[i]][j]);
-		FOR(j,dim) cvSetReal2D(trainOutputs, i, j, samples[perm[i]][dim+j]);
-		cvSet1D(sampleWeights, i, cvScalar(1));
+		FOR(j, trajectories[i].size())
+		{
+			FOR(d, dim) trainSamples[index*dim + d] = trajectories[i][j][d];
+			FOR(d, dim) trainOutputs[index*dim + d] = trajectories[i][j][dim + d];
+			index++;
+		}
 	}
 
-	delete [] perm;
-
-	int activationFunction = functionType == 2 ? CvANN_MLP::GAUSSIAN : functionType ? CvANN_MLP::SIGMOID_SYM : CvANN_MLP::IDENTITY;
-
-
-	mlp = new CvANN_MLP();
-	mlp->create(layers, activationFunction, alpha, beta);
-
-	CvANN_MLP_TrainParams params;
-	params.term_crit = cvTermCriteria(CV_TERMCRIT_ITER | CV_TERMCRIT_EPS, 1000, 0.001);
-	mlp->train(trainSamples, trainOutputs, sampleWeights, 0, params);
-	cvReleaseMat(&trainSamples);
-	cvReleaseMat(&trainOutputs);
-	cvReleaseMat(&sampleWeights);
-	cvReleaseMat(&layers);
+	mlp = new NeuralNetwork();
+	mlp->Create(layers, functionType, alpha, beta);
+	mlp->method = method;
+	mlp->maxEpochs = maxEpochs;
+	mlp->batchSize = batchSize;
+	mlp->learningRate = learningRate;
+	mlp->Train(&trainSamples[0], &trainOutputs[0], sampleCnt);
 }
 
 std::vector<fvec> DynamicalMLP::Test( const fvec &sample, const int count)
@@ -107,41 +86,60 @@ std::vector<fvec> DynamicalMLP::Test( const fvec &sample, const int count)
 	FOR(i, count) res[i].resize(dim,0);
 	if(!mlp) return res;
 
-	float *_input = new float[dim];
-	CvMat input = cvMat(1,dim,CV_32FC1, _input);
-	float *_output = new float[dim];
-	CvMat output = cvMat(1,dim,CV_32FC1, _output);
-	fvec velocity; velocity.resize(dim,0);
+	int inDim = mlp->InputDim(), outDim = min((int)dim, mlp->OutputDim());
+	fvec input(inDim, 0), output(mlp->OutputDim(), 0);
 	FOR(i, count)
 	{
 		res[i] = start;
-		start += velocity*dT;
-		FOR(d, dim) _input[d] = start[d];
-		mlp->predict(&input, &output);
-		FOR(d, dim) velocity[d] = _output[d];
+		FOR(d, outDim) start[d] += output[d]*dT;
+		FOR(d, min((int)dim, inDim)) input[d] = start[d];
+		mlp->Predict(&input[0], &output[0]);
 	}
-	delete [] _input;
-	delete [] _output;
 	return res;
 }
 
 fvec DynamicalMLP::Test( const fvec &sample)
 {
 	int dim = sample.size();
-	fvec res(2);
+	fvec res(dim);
 	if(!mlp) return res;
-	float *_input = new float[dim];
-	FOR(d, dim) _input[d] = sample[d];
-	CvMat input = cvMat(1,dim,CV_32FC1, _input);
-	float *_output = new float[dim];
-	CvMat output = cvMat(1,dim,CV_32FC1, _output);
-	mlp->predict(&input, &output);
-	FOR(d,dim) res[d] = _output[d];
-	delete [] _input;
-	delete [] _output;
+	int inDim = mlp->InputDim();
+	if(dim >= inDim && dim == mlp->OutputDim()) mlp->Predict(&sample[0], &res[0]);
+	else
+	{
+		fvec input(inDim, 0), output(mlp->OutputDim());
+		FOR(d, min(dim, inDim)) input[d] = sample[d];
+		mlp->Predict(&input[0], &output[0]);
+		FOR(d, min(dim, mlp->OutputDim())) res[d] = output[d];
+	}
 	return res;
 }
 
+void DynamicalMLP::TestBatch(const float *samples, float *velocities, int count, int dim)
+{
+	if(!mlp)
+	{
+		FOR(i, count*dim) velocities[i] = 0;
+		return;
+	}
+	int inDim = mlp->InputDim(), outDim = mlp->OutputDim();
+	if(dim == inDim && dim == outDim)
+	{
+		mlp->Predict(samples, count, velocities);
+		return;
+	}
+	fvec inputs(count*inDim, 0), outputs(count*outDim);
+	FOR(i, count)
+	{
+		FOR(d, min(dim, inDim)) inputs[i*inDim + d] = samples[i*dim + d];
+	}
+	mlp->Predict(&inputs[0], count, &outputs[0]);
+	FOR(i, count)
+	{
+		FOR(d, dim) velocities[i*dim + d] = d < (u32)outDim ? outputs[i*outDim + d] : 0.f;
+	}
+}
+
 void DynamicalMLP::SetParams(u32 functionType, u32 neuronCount, u32 layerCount, f32 alpha, f32 beta)
 {
 	this->functionType = functionType;
@@ -152,6 +150,14 @@ void DynamicalMLP::SetParams(u32 functionType, u32 neuronCount, u32 layerCount,
 }
 
 
+void DynamicalMLP::SetTrainingParams(int method, int maxEpochs, int batchSize, float learningRate)
+{
+	this->method = method;
+	this->maxEpochs = maxEpochs;
+	this->batchSize = batchSize;
+	this->learningRate = learningRate;
+}
+
 char *DynamicalMLP::GetInfoString()
 {
 	char *text = new char[1024];
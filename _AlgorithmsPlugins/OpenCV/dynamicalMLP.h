@@ -21,7 +21,7 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 
 #include <vector>
 #include "dynamical.h"
-#include "basicOpenCV.h"
+#include "neuralNetwork.h"
 
 class DynamicalMLP : public Dynamical
 {
@@ -30,16 +30,21 @@ private:
 	u32 neuronCount;
 	u32 layerCount;
 	float alpha, beta;
-	CvANN_MLP *mlp;
+	int method, maxEpochs, batchSize;
+	float learningRate;
+	NeuralNetwork *mlp;
 public:
 	DynamicalMLP();
 	~DynamicalMLP();
 	void Train(std::vector< std::vector<fvec> > trajectories, ivec labels);
 	std::vector<fvec> Test( const fvec &sample, const int count);
 	fvec Test( const fvec &sample);
+	// the whole batch goes through the network's batched prediction
+	void TestBatch(const float *samples, float *velocities, int count, int dim);
 	char *GetInfoString();
 
 	void SetParams(u32 functionType, u32 neuronCount, u32 layerCount, f32 alpha, f32 beta);
+	void SetTrainingParams(int method, int maxEpochs, int batchSize, float learningRate);
 };
 
 #endif // _DYNAMICAL_MLP_H_
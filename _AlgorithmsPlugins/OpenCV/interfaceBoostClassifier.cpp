@@ -26,21 +26,23 @@ using namespace std;
 ClassBoost::ClassBoost()
 {
 	params = new Ui::ParametersBoost();
+	widget = 0;
+	if(!ParameterMap::HasGUI()) return;
 	params->setupUi(widget = new QWidget());
 }
 
 void ClassBoost::SetParams(Classifier *classifier)
 {
 	if(!classifier) return;
-	int weakCount = params->boostCountSpin->value();
-	int weakType = params->boostLearnerType->currentIndex();
+	int weakCount = widget ? params->boostCountSpin->value() : options.Get("boostCount", 1);
+	int weakType = widget ? params->boostLearnerType->currentIndex() : options.Get("boostType", 0);
 	((ClassifierBoost *)classifier)->SetParams(weakCount, weakType);
 }
 
 QString ClassBoost::GetAlgoString()
 {
-	int weakCount = params->boostCountSpin->value();
-	int weakType = params->boostLearnerType->currentIndex();
+	int weakCount = widget ? params->boostCountSpin->value() : options.Get("boostCount", 1);
+	int weakType = widget ? params->boostLearnerType->currentIndex() : options.Get("boostType", 0);
 	QString algo = QString("Boost %1").arg(weakCount);
 	switch(weakType)
 	{
@@ -70,32 +72,21 @@ void ClassBoost::DrawModel(Canvas *canvas, QPainter &painter, Classifier *classi
 	painter.setRenderHint(QPainter::Antialiasing, true);
 
 	int posClass = 1;
-	bool bUseMinMax = false;
-	if(classifier->type == CLASS_BOOST ||
-		classifier->type == CLASS_LINEAR ||
-		classifier->type == CLASS_MLP) bUseMinMax = true;
-
-	float resMin = FLT_MAX;
-	float resMax = -FLT_MAX;
-	if(bUseMinMax)
+	// all the samples are scored in one batch
+	std::vector<fvec> samples = canvas->data->GetSamples();
+	if(!samples.size()) return;
+	int dim = samples[0].size();
+	fvec batch(samples.size()*dim), responses(samples.size());
+	FOR(i, samples.size())
 	{
-		// TODO: get the min and max for all samples
-		std::vector<fvec> samples = canvas->data->GetSamples();
-		FOR(i, samples.size())
-		{
-			float val = classifier->Test(samples[i]);
-			if(val > resMax) resMax = val;
-			if(val < resMin) resMin = val;
-		}
-		if(resMin == resMax) resMin -= 3;
+		FOR(d, dim) batch[i*dim + d] = samples[i][d];
 	}
-	FOR(i, canvas->data->GetCount())
+	classifier->TestBatch(&batch[0], &responses[0], samples.size(), dim);
+	FOR(i, samples.size())
 	{
-		fvec sample = canvas->data->GetSample(i);
 		int label = canvas->data->GetLabel(i);
-		QPointF point = canvas->toCanvasCoords(canvas->data->GetSample(i));
-		float response = classifier->Test(sample);
-		if(response > 0)
+		QPointF point = canvas->toCanvasCoords(samples[i]);
+		if(responses[i] > 0)
 		{
 			if(label == posClass) Canvas::drawSample(painter, point, 9, 1);
 			else Canvas::drawCross(painter, point, 6, 2);
@@ -129,6 +120,11 @@ void ClassBoost::SaveParams(QTextStream &file)
 
 bool ClassBoost::LoadParams(QString name, float value)
 {
+	if(!widget)
+	{
+		options.Set(name, value);
+		return true;
+	}
 	if(name.endsWith("boostCount")) params->boostCountSpin->setValue((int)value);
 	if(name.endsWith("boostType")) params->boostLearnerType->setCurrentIndex((int)value);
 	return true;
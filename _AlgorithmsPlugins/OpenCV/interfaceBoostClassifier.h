@@ -31,6 +31,7 @@ class ClassBoost : public QObject, public ClassifierInterface
 private:
 	QWidget *widget;
 	Ui::ParametersBoost *params;
+	ParameterMap options;
 public:
 	ClassBoost();
 	// virtual functions to manage the algorithm creation
@@ -27,19 +27,23 @@ using namespace std;
 ClustKM::ClustKM()
 {
 	params = new Ui::ParametersKM();
+	widget = 0;
+	if(!ParameterMap::HasGUI()) return;
 	params->setupUi(widget = new QWidget());
 }
 
 void ClustKM::SetParams(Clusterer *clusterer)
 {
 	if(!clusterer) return;
-	int clusters = params->kmeansClusterSpin->value();
-	int power = params->kmeansNormSpin->value();
-	int metrictype = params->kmeansNormCombo->currentIndex();
-	float beta = params->kmeansBetaSpin->value();
-	int method = params->kmeansMethodCombo->currentIndex();
+	int clusters = widget ? params->kmeansClusterSpin->value() : options.Get("kmeansCluster", 2);
+	int power = widget ? params->kmeansNormSpin->value() : options.Get("kmeansPower", 3);
+	int metrictype = widget ? params->kmeansNormCombo->currentIndex() : options.Get("kmeansNormCombo", 2);
+	float beta = widget ? params->kmeansBetaSpin->value() : options.Get("kmeansBeta", 10.f);
+	int method = widget ? params->kmeansMethodCombo->currentIndex() : options.Get("kmeansMethod", 0);
+	int iterations = widget ? params->kmeansIterationSpin->value() : options.Get("kmeansIteration", 100);
+	int miniBatch = widget ? params->kmeansBatchSpin->value() : options.Get("kmeansBatch", 0);
 	if (metrictype < 3) power = metrictype;
-	((ClustererKM *)clusterer)->SetParams(clusters, method, beta, power);
+	((ClustererKM *)clusterer)->SetParams(clusters, method, beta, power, iterations, miniBatch);
 }
 
 Clusterer *ClustKM::GetClusterer()
@@ -109,6 +113,8 @@ void ClustKM::SaveOptions(QSettings &settings)
 	settings.setValue("kmeansMethod", params->kmeansMethodCombo->currentIndex());
 	settings.setValue("kmeansPower", params->kmeansNormSpin->value());
 	settings.setValue("kmeansNormCombo", params->kmeansNormCombo->currentIndex());
+	settings.setValue("kmeansIteration", params->kmeansIterationSpin->value());
+	settings.setValue("kmeansBatch", params->kmeansBatchSpin->value());
 }
 
 bool ClustKM::LoadOptions(QSettings &settings)
@@ -118,6 +124,8 @@ bool ClustKM::LoadOptions(QSettings &settings)
 	if(settings.contains("kmeansMethod")) params->kmeansMethodCombo->setCurrentIndex(settings.value("kmeansMethod").toInt());
 	if(settings.contains("kmeansPower")) params->kmeansNormSpin->setValue(settings.value("kmeansPower").toFloat());
 	if(settings.contains("kmeansNormCombo")) params->kmeansNormCombo->setCurrentIndex(settings.value("kmeansNormCombo").toInt());
+	if(settings.contains("kmeansIteration")) params->kmeansIterationSpin->setValue(settings.value("kmeansIteration").toInt());
+	if(settings.contains("kmeansBatch")) params->kmeansBatchSpin->setValue(settings.value("kmeansBatch").toInt());
 	return true;
 }
 
@@ -128,14 +136,23 @@ void ClustKM::SaveParams(QTextStream &file)
 	file << "clusterOptions" << ":" << "kmeansMethod" << " " << params->kmeansMethodCombo->currentIndex() << "\n";
 	file << "clusterOptions" << ":" << "kmeansPower" << " " << params->kmeansNormSpin->value() << "\n";
 	file << "clusterOptions" << ":" << "kmeansNormCombo" << " " << params->kmeansNormCombo->currentIndex() << "\n";
+	file << "clusterOptions" << ":" << "kmeansIteration" << " " << params->kmeansIterationSpin->value() << "\n";
+	file << "clusterOptions" << ":" << "kmeansBatch" << " " << params->kmeansBatchSpin->value() << "\n";
 }
 
 bool ClustKM::LoadParams(QString name, float value)
 {
+	if(!widget)
+	{
+		options.Set(name, value);
+		return true;
+	}
 	if(name.endsWith("kmeansBeta")) params->kmeansBetaSpin->setValue(value);
 	if(name.endsWith("kmeansCluster")) params->kmeansClusterSpin->setValue((int)value);
 	if(name.endsWith("kmeansMethod")) params->kmeansMethodCombo->setCurrentIndex((int)value);
 	if(name.endsWith("kmeansPower")) params->kmeansNormSpin->setValue((int)value);
 	if(name.endsWith("kmeansNormCombo")) params->kmeansNormCombo->setCurrentIndex((int)value);
+	if(name.endsWith("kmeansIteration")) params->kmeansIterationSpin->setValue((int)value);
+	if(name.endsWith("kmeansBatch")) params->kmeansBatchSpin->setValue((int)value);
 	return true;
 }
@@ -31,6 +31,7 @@ class ClustKM : public QObject, public ClustererInterface
 private:
 	QWidget *widget;
 	Ui::ParametersKM *params;
+	ParameterMap options;
 public:
 	ClustKM();
 	// virtual functions to manage the algorithm creation
@@ -26,28 +26,36 @@ using namespace std;
 ClassMLP::ClassMLP()
 {
 	params = new Ui::ParametersMLP();
+	widget = 0;
+	if(!ParameterMap::HasGUI()) return;
 	params->setupUi(widget = new QWidget());
 }
 
 void ClassMLP::SetParams(Classifier *classifier)
 {
 	if(!classifier) return;
-	float alpha = params->mlpAlphaSpin->value();
-	float beta = params->mlpBetaSpin->value();
-	int layers = params->mlpLayerSpin->value();
-	int neurons = params->mlpNeuronSpin->value();
-	int activation = params->mlpFunctionCombo->currentIndex()+1; // 1: sigmoid, 2: gaussian
+	float alpha = widget ? params->mlpAlphaSpin->value() : options.Get("mlpAlpha", 10.f);
+	float beta = widget ? params->mlpBetaSpin->value() : options.Get("mlpBeta", 1.f);
+	int layers = widget ? params->mlpLayerSpin->value() : options.Get("mlpLayer", 1);
+	int neurons = widget ? params->mlpNeuronSpin->value() : options.Get("mlpNeuron", 2);
+	int activation = (widget ? params->mlpFunctionCombo->currentIndex() : options.Get("mlpFunction", 0)) + 1; // 1: sigmoid, 2: gaussian
 
 	((ClassifierMLP *)classifier)->SetParams(activation, neurons, layers, alpha, beta);
+
+	int method = widget ? params->mlpTrainCombo->currentIndex() : options.Get("mlpTrain", 1); // 0: sgd, 1: adam
+	int epochs = widget ? params->mlpEpochSpin->value() : options.Get("mlpEpoch", 500);
+	int batchSize = widget ? params->mlpBatchSpin->value() : options.Get("mlpBatch", 32);
+	float learningRate = widget ? params->mlpRateSpin->value() : options.Get("mlpRate", 0.01f);
+	((ClassifierMLP *)classifier)->SetTrainingParams(method, epochs, batchSize, learningRate);
 }
 
 QString ClassMLP::GetAlgoString()
 {
-	float alpha = params->mlpAlphaSpin->value();
-	float beta = params->mlpBetaSpin->value();
-	int layers = params->mlpLayerSpin->value();
-	int neurons = params->mlpNeuronSpin->value();
-	int activation = params->mlpFunctionCombo->currentIndex()+1; // 1: sigmoid, 2: gaussian
+	float alpha = widget ? params->mlpAlphaSpin->value() : options.Get("mlpAlpha", 10.f);
+	float beta = widget ? params->mlpBetaSpin->value() : options.Get("mlpBeta", 1.f);
+	int layers = widget ? params->mlpLayerSpin->value() : options.Get("mlpLayer", 1);
+	int neurons = widget ? params->mlpNeuronSpin->value() : options.Get("mlpNeuron", 2);
+	int activation = (widget ? params->mlpFunctionCombo->currentIndex() : options.Get("mlpFunction", 0)) + 1; // 1: sigmoid, 2: gaussian
 
 	QString algo = QString("MLP %1 %2 %3 %4 %5").arg(neurons).arg(layers).arg(activation==1 ? "S" : "G").arg(alpha).arg(beta);
 	return algo;
@@ -65,28 +73,21 @@ void ClassMLP::DrawModel(Canvas *canvas, QPainter &painter, Classifier *classifi
 	if(!classifier || !canvas) return;
 	painter.setRenderHint(QPainter::Antialiasing, true);
 	int posClass = 1;
-	bool bUseMinMax = true;
-	float resMin = FLT_MAX;
-	float resMax = -FLT_MAX;
-	if(bUseMinMax)
+	// all the samples go through the network at once
+	std::vector<fvec> samples = canvas->data->GetSamples();
+	if(!samples.size()) return;
+	int dim = samples[0].size();
+	fvec batch(samples.size()*dim), responses(samples.size());
+	FOR(i, samples.size())
 	{
-		// TODO: get the min and max for all samples
-		std::vector<fvec> samples = canvas->data->GetSamples();
-		FOR(i, samples.size())
-		{
-			float val = classifier->Test(samples[i]);
-			if(val > resMax) resMax = val;
-			if(val < resMin) resMin = val;
-		}
-		if(resMin == resMax) resMin -= 3;
+		FOR(d, dim) batch[i*dim + d] = samples[i][d];
 	}
-	FOR(i, canvas->data->GetCount())
+	classifier->TestBatch(&batch[0], &responses[0], samples.size(), dim);
+	FOR(i, samples.size())
 	{
-		fvec sample = canvas->data->GetSample(i);
 		int label = canvas->data->GetLabel(i);
-		QPointF point = canvas->toCanvasCoords(canvas->data->GetSample(i));
-		float response = classifier->Test(sample);
-		if(response > 0)
+		QPointF point = canvas->toCanvasCoords(samples[i]);
+		if(responses[i] > 0)
 		{
 			if(label == posClass) Canvas::drawSample(painter, point, 9, 1);
 			else Canvas::drawCross(painter, point, 6, 2);
@@ -106,6 +107,10 @@ void ClassMLP::SaveOptions(QSettings &settings)
 	settings.setValue("mlpBeta", params->mlpBetaSpin->value());
 	settings.setValue("mlpLayer", params->mlpLayerSpin->value());
 	settings.setValue("mlpFunction", params->mlpFunctionCombo->currentIndex());
+	settings.setValue("mlpTrain", params->mlpTrainCombo->currentIndex());
+	settings.setValue("mlpEpoch", params->mlpEpochSpin->value());
+	settings.setValue("mlpBatch", params->mlpBatchSpin->value());
+	settings.setValue("mlpRate", params->mlpRateSpin->value());
 }
 
 bool ClassMLP::LoadOptions(QSettings &settings)
@@ -115,6 +120,10 @@ bool ClassMLP::LoadOptions(QSettings &settings)
 	if(settings.contains("mlpBeta")) params->mlpBetaSpin->setValue(settings.value("mlpBeta").toFloat());
 	if(settings.contains("mlpLayer")) params->mlpLayerSpin->setValue(settings.value("mlpLayer").toFloat());
 	if(settings.contains("mlpFunction")) params->mlpFunctionCombo->setCurrentIndex(settings.value("mlpFunction").toInt());
+	if(settings.contains("mlpTrain")) params->mlpTrainCombo->setCurrentIndex(settings.value("mlpTrain").toInt());
+	if(settings.contains("mlpEpoch")) params->mlpEpochSpin->setValue(settings.value("mlpEpoch").toInt());
+	if(settings.contains("mlpBatch")) params->mlpBatchSpin->setValue(settings.value("mlpBatch").toInt());
+	if(settings.contains("mlpRate")) params->mlpRateSpin->setValue(settings.value("mlpRate").toFloat());
 	return true;
 }
 
@@ -125,14 +134,27 @@ void ClassMLP::SaveParams(QTextStream &file)
 	file << "classificationOptions" << ":" << "mlpBeta" << " " << params->mlpBetaSpin->value() << "\n";
 	file << "classificationOptions" << ":" << "mlpLayer" << " " << params->mlpLayerSpin->value() << "\n";
 	file << "classificationOptions" << ":" << "mlpFunction" << " " << params->mlpFunctionCombo->currentIndex() << "\n";
+	file << "classificationOptions" << ":" << "mlpTrain" << " " << params->mlpTrainCombo->currentIndex() << "\n";
+	file << "classificationOptions" << ":" << "mlpEpoch" << " " << params->mlpEpochSpin->value() << "\n";
+	file << "classificationOptions" << ":" << "mlpBatch" << " " << params->mlpBatchSpin->value() << "\n";
+	file << "classificationOptions" << ":" << "mlpRate" << " " << params->mlpRateSpin->value() << "\n";
 }
 
 bool ClassMLP::LoadParams(QString name, float value)
 {
+	if(!widget)
+	{
+		options.Set(name, value);
+		return true;
+	}
 	if(name.endsWith("mlpNeuron")) params->mlpNeuronSpin->setValue((int)value);
 	if(name.endsWith("mlpAlpha")) params->mlpAlphaSpin->setValue(value);
 	if(name.endsWith("mlpBeta")) params->mlpBetaSpin->setValue(value);
 	if(name.endsWith("mlpLayer")) params->mlpLayerSpin->setValue((int)value);
 	if(name.endsWith("mlpFunction")) params->mlpFunctionCombo->setCurrentIndex((int)value);
+	if(name.endsWith("mlpTrain")) params->mlpTrainCombo->setCurrentIndex((int)value);
+	if(name.endsWith("mlpEpoch")) params->mlpEpochSpin->setValue((int)value);
+	if(name.endsWith("mlpBatch")) params->mlpBatchSpin->setValue((int)value);
+	if(name.endsWith("mlpRate")) params->mlpRateSpin->setValue(value);
 	return true;
 }
@@ -31,6 +31,7 @@ class ClassMLP : public QObject, public ClassifierInterface
 private:
 	QWidget *widget;
 	Ui::ParametersMLP *params;
+	ParameterMap options;
 public:
 	ClassMLP();
 	// virtual functions to manage the algorithm creation
@@ -31,6 +31,7 @@ class DynamicMLP : public QObject, public DynamicalInterface
 private:
 	QWidget *widget;
 	Ui::ParametersMLPDynamic *params;
+	ParameterMap options;
 public:
 	DynamicMLP();
 	// virtual functions to manage the algorithm creation
@@ -26,28 +26,36 @@ using namespace std;
 RegrMLP::RegrMLP()
 {
 	params = new Ui::ParametersMLPRegress();
+	widget = 0;
+	if(!ParameterMap::HasGUI()) return;
 	params->setupUi(widget = new QWidget());
 }
 
 void RegrMLP::SetParams(Regressor *regressor)
 {
 	if(!regressor) return;
-	float alpha = params->mlpAlphaSpin->value();
-	float beta = params->mlpBetaSpin->value();
-	int layers = params->mlpLayerSpin->value();
-	int neurons = params->mlpNeuronSpin->value();
-	int activation = params->mlpFunctionCombo->currentIndex()+1; // 1: sigmoid, 2: gaussian
+	float alpha = widget ? params->mlpAlphaSpin->value() : options.Get("mlpAlpha", 10.f);
+	float beta = widget ? params->mlpBetaSpin->value() : options.Get("mlpBeta", 1.f);
+	int layers = widget ? params->mlpLayerSpin->value() : options.Get("mlpLayer", 1);
+	int neurons = widget ? params->mlpNeuronSpin->value() : options.Get("mlpNeuron", 2);
+	int activation = (widget ? params->mlpFunctionCombo->currentIndex() : options.Get("mlpFunction", 0)) + 1; // 1: sigmoid, 2: gaussian
 
 	((RegressorMLP *)regressor)->SetParams(activation, neurons, layers, alpha, beta);
+
+	int method = widget ? params->mlpTrainCombo->currentIndex() : options.Get("mlpTrain", 1); // 0: sgd, 1: adam
+	int epochs = widget ? params->mlpEpochSpin->value() : options.Get("mlpEpoch", 500);
+	int batchSize = widget ? params->mlpBatchSpin->value() : options.Get("mlpBatch", 32);
+	float learningRate = widget ? params->mlpRateSpin->value() : options.Get("mlpRate", 0.01f);
+	((RegressorMLP *)regressor)->SetTrainingParams(method, epochs, batchSize, learningRate);
 }
 
 QString RegrMLP::GetAlgoString()
 {
-	float alpha = params->mlpAlphaSpin->value();
-	float beta = params->mlpBetaSpin->value();
-	int layers = params->mlpLayerSpin->value();
-	int neurons = params->mlpNeuronSpin->value();
-	int activation = params->mlpFunctionCombo->currentIndex()+1; // 1: sigmoid, 2: gaussian
+	float alpha = widget ? params->mlpAlphaSpin->value() : options.Get("mlpAlpha", 10.f);
+	float beta = widget ? params->mlpBetaSpin->value() : options.Get("mlpBeta", 1.f);
+	int layers = widget ? params->mlpLayerSpin->value() : options.Get("mlpLayer", 1);
+	int neurons = widget ? params->mlpNeuronSpin->value() : options.Get("mlpNeuron", 2);
+	int activation = (widget ? params->mlpFunctionCombo->currentIndex() : options.Get("mlpFunction", 0)) + 1; // 1: sigmoid, 2: gaussian
 
 	QString algo = QString("MLP %1 %2 %3 %4 %5").arg(neurons).arg(layers).arg(activation==1 ? "S" : "G").arg(alpha).arg(beta);
 	return algo;
@@ -97,6 +105,10 @@ void RegrMLP::SaveOptions(QSettings &settings)
 	settings.setValue("mlpBeta", params->mlpBetaSpin->value());
 	settings.setValue("mlpLayer", params->mlpLayerSpin->value());
 	settings.setValue("mlpFunction", params->mlpFunctionCombo->currentIndex());
+	settings.setValue("mlpTrain", params->mlpTrainCombo->currentIndex());
+	settings.setValue("mlpEpoch", params->mlpEpochSpin->value());
+	settings.setValue("mlpBatch", params->mlpBatchSpin->value());
+	settings.setValue("mlpRate", params->mlpRateSpin->value());
 }
 
 bool RegrMLP::LoadOptions(QSettings &settings)
@@ -106,6 +118,10 @@ bool RegrMLP::LoadOptions(QSettings &settings)
 	if(settings.contains("mlpBeta")) params->mlpBetaSpin->setValue(settings.value("mlpBeta").toFloat());
 	if(settings.contains("mlpLayer")) params->mlpLayerSpin->setValue(settings.value("mlpLayer").toFloat());
 	if(settings.contains("mlpFunction")) params->mlpFunctionCombo->setCurrentIndex(settings.value("mlpFunction").toInt());
+	if(settings.contains("mlpTrain")) params->mlpTrainCombo->setCurrentIndex(settings.value("mlpTrain").toInt());
+	if(settings.contains("mlpEpoch")) params->mlpEpochSpin->setValue(settings.value("mlpEpoch").toInt());
+	if(settings.contains("mlpBatch")) params->mlpBatchSpin->setValue(settings.value("mlpBatch").toInt());
+	if(settings.contains("mlpRate")) params->mlpRateSpin->setValue(settings.value("mlpRate").toFloat());
 	return true;
 }
 
@@ -116,14 +132,27 @@ void RegrMLP::SaveParams(QTextStream &file)
 	file << "regressionOptions" << ":" << "mlpBeta" << " " << params->mlpBetaSpin->value() << "\n";
 	file << "regressionOptions" << ":" << "mlpLayer" << " " << params->mlpLayerSpin->value() << "\n";
 	file << "regressionOptions" << ":" << "mlpFunction" << " " << params->mlpFunctionCombo->currentIndex() << "\n";
+	file << "regressionOptions" << ":" << "mlpTrain" << " " << params->mlpTrainCombo->currentIndex() << "\n";
+	file << "regressionOptions" << ":" << "mlpEpoch" << " " << params->mlpEpochSpin->value() << "\n";
+	file << "regressionOptions" << ":" << "mlpBatch" << " " << params->mlpBatchSpin->value() << "\n";
+	file << "regressionOptions" << ":" << "mlpRate" << " " << params->mlpRateSpin->value() << "\n";
 }
 
 bool RegrMLP::LoadParams(QString name, float value)
 {
+	if(!widget)
+	{
+		options.Set(name, value);
+		return true;
+	}
 	if(name.endsWith("mlpNeuron")) params->mlpNeuronSpin->setValue((int)value);
 	if(name.endsWith("mlpAlpha")) params->mlpAlphaSpin->setValue(value);
 	if(name.endsWith("mlpBeta")) params->mlpBetaSpin->setValue(value);
 	if(name.endsWith("mlpLayer")) params->mlpLayerSpin->setValue((int)value);
 	if(name.endsWith("mlpFunction")) params->mlpFunctionCombo->setCurrentIndex((int)value);
+	if(name.endsWith("mlpTrain")) params->mlpTrainCombo->setCurrentIndex((int)value);
+	if(name.endsWith("mlpEpoch")) params->mlpEpochSpin->setValue((int)value);
+	if(name.endsWith("mlpBatch")) params->mlpBatchSpin->setValue((int)value);
+	if(name.endsWith("mlpRate")) params->mlpRateSpin->setValue(value);
 	return true;
 }
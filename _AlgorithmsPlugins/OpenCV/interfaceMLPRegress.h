@@ -31,6 +31,7 @@ class RegrMLP : public QObject, public RegressorInterface
 private:
 	QWidget *widget;
 	Ui::ParametersMLPRegress *params;
+	ParameterMap options;
 public:
 	RegrMLP();
 	// virtual functions to manage the algorithm creation
@@ -19,6 +19,7 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 *********************************************************************/
 #include <stdio.h>
 #include <vector>
+#include <string.h>
 #include "public.h"
 #include "basicMath.h"
 #include "basicOpenCV.h"
@@ -27,9 +28,44 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 
 using namespace std;
 
+// turns the output of Distance into the corresponding norm
+static inline float Root(float d, int power)
+{
+	if(power == 0 || power == 1) return d;
+	if(power > 2) return powf(d, 1.f/power);
+	return sqrtf(d);
+}
+
+// uniform index that also covers datasets larger than RAND_MAX
+static inline int RandomIndex(int count)
+{
+	return (int)((((u64)rand()*((u64)RAND_MAX+1)) + (u64)rand()) % (u64)count);
+}
+
+// lower triangular L such that L*L' = S, returns false if S is not positive definite
+static bool Cholesky(const double *S, double *L, int dim)
+{
+	FOR(i, dim*dim) L[i] = 0;
+	FOR(i, dim)
+	{
+		FOR(j, i+1)
+		{
+			double sum = S[i*dim+j];
+			FOR(k, j) sum -= L[i*dim+k]*L[j*dim+k];
+			if(i == j)
+			{
+				if(sum <= 0) return false;
+				L[i*dim+i] = sqrt(sum);
+			}
+			else L[i*dim+j] = sum / L[j*dim+j];
+		}
+	}
+	return true;
+}
 
 KMeansCluster::KMeansCluster(u32 cnt)
-: clusters(cnt), sigma(NULL), pi(NULL), bGMM(false), bSoft(false), beta(1), dim(2), power(2)
+: beta(1), clusters(cnt), bSoft(false), dim(2), power(2), maxIterations(100), miniBatchSize(1024), miniBatchThreshold(1000000),
+  count(0), bGMM(false)
 {
 	ResetClusters();
 }
@@ -39,228 +75,149 @@ KMeansCluster::~KMeansCluster()
 	Clear();
 }
 
-float KMeansCluster::Distance( fvec a, fvec b )
+float KMeansCluster::Distance(const float *a, const float *b) const
 {
-	fvec dif = a-b;
 	float d = 0;
 	if(power == 0) // infinite distance
 	{
-		FOR(i, dif.size()) d = max(d, abs(dif[i]));
+		FOR(i, dim) d = max(d, fabsf(a[i]-b[i]));
 	}
 	else if(power == 1) // manhattan distance
 	{
-		FOR(i, dif.size()) d += abs(dif[i]);
-	}
-	else if(power == 2)
-	{
-		d = dif*dif;
+		FOR(i, dim) d += fabsf(a[i]-b[i]);
 	}
 	else if(power > 2)
 	{
-		FOR(i, dif.size())
+		FOR(i, dim)
 		{
-			float p = abs(dif[i]);
+			float p = fabsf(a[i]-b[i]);
 			float p2 = 1;
 			FOR(j, power) p2 *= p;
 			d += p2;
 		}
 	}
+	else // squared euclidean distance
+	{
+		FOR(i, dim) d += (a[i]-b[i])*(a[i]-b[i]);
+	}
 	return d;
 }
 
-float KMeansCluster::Distance2( fvec a, fvec b )
+float KMeansCluster::Metric(const float *a, const float *b) const
 {
-	float d = 0;
-	if(power == 0) // infinite distance
-	{
-		d = max(abs(a[0]-b[0]), abs(a[1]-b[1]));
-	}
-	else if(power == 1) // manhattan distance
-	{
-		d = abs(a[0]-b[0]) + abs(a[1]-b[1]);
-	}
-	else if(power == 2)
-	{
-		float d0 = a[0]-b[0];
-		float d1 = a[1]-b[1];
-		d = d0*d0 + d1*d1;
-	}
-	else if(power > 2)
+	return Root(Distance(a, b), power);
+}
+
+int KMeansCluster::Assign(const float *sample, float &closest, float &second) const
+{
+	float d1 = FLT_MAX, d2 = FLT_MAX;
+	int best = 0;
+	const float *c = &centers[0];
+	FOR(j, clusters)
 	{
-		float d0 = abs(a[0]-b[0]);
-		float d1 = abs(a[1]-b[1]);
-		float p0 = 1;
-		float p1 = 1;
-		FOR(j, power)
+		float d = Distance(sample, c + j*dim);
+		if(d < d1)
 		{
-			p0 *= d0;
-			p1 *= d1;
+			d2 = d1;
+			d1 = d;
+			best = j;
 		}
-		d = p0 + p1;
+		else if(d < d2) d2 = d;
 	}
-	return d;
+	closest = Root(d1, power);
+	second = d2 == FLT_MAX ? FLT_MAX : Root(d2, power);
+	return best;
+}
+
+void KMeansCluster::UpdateMeans()
+{
+	means.resize(clusters);
+	FOR(j, clusters) means[j] = fvec(centers.begin() + j*dim, centers.begin() + (j+1)*dim);
 }
 
 void KMeansCluster::Update(bool bEStep)
 {
-	bool bSuperposed = false;
+	if(!clusters || !count) return;
 	FOR(i, clusters)
 	{
 		FOR(j,i)
 		{
-			if(means[i] == means[j]) // we have 2 superposed clusters
+			if(!memcmp(&centers[i*dim], &centers[j*dim], dim*sizeof(float))) // we have 2 superposed clusters
 			{
-				// we replace it with a new one
-				FOR(d,means[i].size()) means[i][d] = rand()/(float)RAND_MAX;
-				//bSuperposed = true;
+				// we replace it with a random sample
+				int index = RandomIndex(count);
+				FOR(d, dim) centers[i*dim + d] = data[index*dim + d];
 				break;
 			}
 		}
 	}
-	if(bSuperposed) ResetClusters();
 
-	if(bGMM)
-	{
-		GMMClustering(points, means, sigma, pi, clusters, bEStep);
-	}
-	else
-	{
-		if(!bSoft) KmeansClustering(points, means, clusters);
-		else SoftKmeansClustering(points, means, clusters, beta, bEStep);
-	}
-	FOR(i, clusters)
-	{
-		float mindist = 1;
-		u32 closest = 0;
-		FOR(p, points.size())
-		{
-			float d = (points[p].point - means[i])*(points[p].point - means[i]);
-			if (d < mindist)
-			{
-				mindist = d;
-				closest = p;
-			}
-		}
-		closestIndices[i] = closest;
-	}
+	if(bGMM) GMMClustering(bEStep);
+	else if(bSoft) SoftKmeansClustering(bEStep);
+	else if(count > miniBatchThreshold) MiniBatchClustering();
+	else KmeansClustering();
+	UpdateMeans();
 }
 
 void KMeansCluster::Draw(IplImage *image)
 {
-	if(!points.size()) return;
-	if (!bSoft && !bGMM) {
-		// used for overlay colors
-		float over[6][3] = {{0,0,1},{1,0,0},{0,1,0},{0.5f,0,0.5f},{0,0.5f,0.5f},{0.5f,0.5f,0}};
-		// and now lets draw them points!
-		FOR(i, points.size()){
-			u32 cluster = points[i].cluster;
-
-			register u32 index = ((u32)(points[i].point[0]*image->width) + (u32)(points[i].point[1]*image->height)*image->width)*3;
-			FOR(c,3){
-				//u8 color = RGB(image, index + c);
-				u8 color = 255;
-//				RGB(image, index + c) = (u8)(color);
-				//RGB(image, index + c) = (u8)(color*over[cluster%6][c]);
-			}
-		}
-	}
-	else {
-		// used for overlay colors
-		float over[6][3] = {{0,0,1},{1,0,0},{0,1,0},{0.5f,0,0.5f},{0,0.5f,0.5f},{0.5f,0.5f,0}};
-		// and now lets draw them points!
-		FOR(i, points.size()){
-			register u32 index = ((u32)(points[i].point[0]*image->width) + (u32)(points[i].point[1]*image->height)*image->width)*3;
-			FOR(c,3){
-				//u8 color = RGB(image, index + c);
-				u8 color = 255;
-				float colorSum = 0;
-				FOR(cl, clusters){
-					colorSum += points[i].weights[cl]*over[cl%6][c];
-				}
-//				RGB(image, index + c) = u8(color*colorSum);
-			}
-		}
-	}
-
-	FOR(i, clusters){
-		if(i<points.size()) {draw_cross(image, cvPoint((u32)(means[i][0]*image->width), (u32)(means[i][1]*image->height)),CV_RGB(255,255,255),4);}
-//		cvCircle(image, cvPoint((u32)(points[closestIndices[i]].point.x*image->width), (u32)(points[closestIndices[i]].point.y*image->height)), 4, CV_RGB(0,255,0), 1, CV_AA);
+	FOR(i, clusters)
+	{
+		draw_cross(image, cvPoint((u32)(means[i][0]*image->width), (u32)(means[i][1]*image->height)),CV_RGB(255,255,255),4);
 	}
 }
 
 void KMeansCluster::DrawMap(IplImage *image)
 {
-	if(!points.size()) return;
-	if (!bSoft && !bGMM) {
-		// and now lets draw them points!
-		fvec dists;
-		dists.resize(clusters);
-		FOR(i, image->width*image->height)
+	if(!count) return;
+	fvec point(dim, 0), res(clusters);
+	FOR(i, image->width*image->height)
+	{
+		point[0] = (i%image->width)/(float)image->width;
+		point[1] = (i/image->width)/(float)image->height;
+		Test(point, res);
+		CvScalar color = cvScalarAll(0);
+		FOR(j, clusters)
 		{
-			fvec point;
-			point.push_back((i%image->width)/(float)image->width);
-			point.push_back((i/image->width)/(float)image->height);
-			FOR(j, clusters) dists[j] = SquareNorm(point, means[j]);
-			u32 cluster = FindSmallest(dists);
-
-			register u32 index = ((u32)(point[0]*image->width) + (u32)(point[1]*image->height)*image->width)*3;
-
-			CvScalar color = CV::color[(cluster+1)% CV::colorCnt];
-			cvSet1D(image, i, color);
+			CvScalar col = CV::color[(j+1)% CV::colorCnt];
+			FOR(c,3) color.val[c] += col.val[c]*res[j];
 		}
+		cvSet1D(image, i, color);
 	}
-	else {
-		// and now lets draw them points!
-		f32 *dists = new f32[clusters];
-		f32 *weights = new f32[clusters];
-		FOR(i, image->width*image->height)
-		{
-			fvec point;
-			point.push_back((i%image->width)/(float)image->width);
-			point.push_back((i/image->width)/(float)image->height);
-			f32 sum = 0;
-			FOR(j, clusters)
-			{
-				dists[j] = expf(-beta * sqrt((means[j] - point)*(means[j] - point)));
-				sum += dists[j];
-			}
-			FOR(j, clusters) weights[j] = dists[j] / sum;
-
-			register u32 index = ((u32)(point[0]*image->width) + (u32)(point[1]*image->height)*image->width)*3;
-			CvScalar color = cvScalarAll(0);
-			FOR(j, clusters)
-			{
-				CvScalar col = CV::color[(j+1)% CV::colorCnt];
-				FOR(c,3) color.val[c] += col.val[c]*weights[j];
-			}			
-			cvSet1D(image, i, color);
-		}
-	}
-	/*
-	FOR(i, clusters){
-		if(i<points.size()) {draw_cross(image, cvPoint((u32)(means[i].x*image->width), (u32)(means[i].y*image->height)),CV_RGB(255,255,255),4);}
-		cvCircle(image, cvPoint((u32)(points[closestIndices[i]].point.x*image->width), (u32)(points[closestIndices[i]].point.y*image->height)), 4, CV_RGB(0,255,0), 1, CV_AA);
-	}
-	*/
 }
 
-
 void KMeansCluster::AddPoint(fvec point)
 {
-	if(point.size() != dim) dim = point.size();
-	ClusterPoint cpoint;
-	cpoint.point = point;
-	points.push_back(cpoint);
+	if(!count) dim = point.size();
+	point.resize(dim, 0);
+	data.insert(data.end(), point.begin(), point.end());
+	labels.push_back(0);
+	count++;
 }
 
 void KMeansCluster::AddPoints(std::vector<fvec> points)
 {
+	if(!points.size()) return;
+	if(!count) dim = points[0].size();
+	data.reserve(data.size() + points.size()*dim);
+	labels.reserve(labels.size() + points.size());
 	FOR(i, points.size()) AddPoint(points[i]);
 }
 
+void KMeansCluster::SetPoint(u32 index, fvec point)
+{
+	if(index >= (u32)count) return;
+	FOR(d, min((int)point.size(), dim)) data[index*dim + d] = point[d];
+}
+
 void KMeansCluster::Clear()
 {
-	points.clear();
+	count = 0;
+	data.clear();
+	labels.clear();
+	weights.clear();
+	upper.clear();
+	lower.clear();
 }
 
 void KMeansCluster::SetClusters(u32 clusters)
@@ -273,527 +230,504 @@ void KMeansCluster::ResetClusters()
 {
 	srand((u32)cvGetTickCount());
 
-	KILL(pi);
-	if(sigma) FOR(i, clusters) KILL(sigma[i]);
-	KILL(sigma);
 	if(!clusters) return;
-	means.resize(clusters);
-	pi = new double[clusters];
-	sigma = new double *[clusters];
+	centers.resize(clusters*dim);
 	closestIndices.resize(clusters);
-	FOR(i,clusters){
-		means[i].resize(dim);
-		if(!points.size())
+	if(!count)
+	{
+		FOR(i, clusters*dim) centers[i] = float(rand())/RAND_MAX;
+		FOR(i, clusters) closestIndices[i] = 0;
+	}
+	else SeedClusters();
+	pi.assign(clusters, 1./clusters);
+	sigma.assign(clusters*dim*dim, 0.05);
+	FOR(i, clusters) FOR(d, dim) sigma[(i*dim + d)*dim + d] = 0.1;
+	UpdateMeans();
+}
+
+// k-means++: each new center is drawn with a probability proportional to its distance to the closest existing center
+void KMeansCluster::SeedClusters()
+{
+	fvec nearest(count, FLT_MAX);
+	int index = RandomIndex(count);
+	FOR(j, clusters)
+	{
+		if(j)
 		{
-			FOR(d,dim)
+			double sum = 0;
+			FOR(i, count) sum += nearest[i];
+			if(sum > 0 && j < (u32)count)
 			{
-				means[i][d] = float(rand())/RAND_MAX;
+				double r = (rand() + rand()/((double)RAND_MAX+1)) / ((double)RAND_MAX+1) * sum;
+				index = count-1;
+				FOR(i, count)
+				{
+					r -= nearest[i];
+					if(r <= 0 && nearest[i] > 0)
+					{
+						index = i;
+						break;
+					}
+				}
 			}
-			closestIndices[i] = 0;
+			else index = RandomIndex(count);
 		}
-		else
+		float *center = &centers[j*dim];
+		FOR(d, dim) center[d] = data[index*dim + d];
+		closestIndices[j] = index;
+		if(j+1 == clusters) break;
+#ifdef _OPENMP
+#pragma omp parallel for if(count*dim > 65536)
+#endif
+		for(int i=0; i<count; i++)
 		{
-			int index = rand()%points.size();
-			means[i] = points[index].point;
-			closestIndices[i] = index;
+			float d = Distance(&data[i*dim], center);
+			if(d < nearest[i]) nearest[i] = d;
 		}
-		pi[i] = 1.f/clusters;
-		sigma[i] = new double[4];
-		sigma[i][0] = sigma[i][3] = 0.1;
-		sigma[i][1] = sigma[i][2] = 0.05;
 	}
 }
 
 ivec KMeansCluster::GetClosestPoints()
 {
+	if(!count) return closestIndices;
+	closestIndices.resize(clusters);
+	FOR(j, clusters)
+	{
+		float minDist = FLT_MAX;
+		FOR(i, count)
+		{
+			float d = Distance(&data[i*dim], &centers[j*dim]);
+			if(d < minDist)
+			{
+				minDist = d;
+				closestIndices[j] = i;
+			}
+		}
+	}
 	return closestIndices;
 }
 
-inline float fastExp(const float x)
-{
-	if(-x>90) return 0;
-	else return expf(x);
-}
-
-void KMeansCluster::Test( fvec sample, fvec &res )
+void KMeansCluster::Test( const fvec &sample, fvec &res )
 {
 	if(res.size() != clusters) res.resize(clusters);
+	if(!clusters) return;
+	const float *x = &sample[0];
+	fvec padded;
+	if(sample.size() < (u32)dim)
+	{
+		padded = sample;
+		padded.resize(dim, 0);
+		x = &padded[0];
+	}
 	if(bSoft)
 	{
-		fvec distances;
-		distances.resize(clusters);
 		// compute the distance to each clusters
-		float distanceSum = 0;
-		if(dim==2)
-		{
-			for (int j=0;j<clusters;j++){
-				float d0 = means[j][0] - sample[0];
-				float d1 = means[j][1] - sample[1];
-				
-				distances[j] = fastExp(-beta * sqrtf(d0*d0 + d1*d1));
-				distanceSum += distances[j];
-			}
-		}
-		else
+		float minDist = FLT_MAX;
+		FOR(j, clusters)
 		{
-			for (int j=0;j<clusters;j++){
-				distances[j] = fastExp(-beta * sqrtf((means[j] - sample)*(means[j] - sample)));
-				distanceSum += distances[j];
-			}
+			const float *c = &centers[j*dim];
+			float d = 0;
+			FOR(k, dim) d += (x[k]-c[k])*(x[k]-c[k]);
+			res[j] = sqrtf(d);
+			minDist = min(minDist, res[j]);
 		}
-
 		// compute the weights for each cluster
-		for (int j=0;j<clusters;j++){
-			res[j] = distances[j] / float(distanceSum);
+		float distanceSum = 0;
+		FOR(j, clusters)
+		{
+			res[j] = expf(-beta * (res[j] - minDist));
+			distanceSum += res[j];
 		}
+		FOR(j, clusters) res[j] /= distanceSum;
 	}
 	else
 	{
-		FOR(d, res.size()) res[d] = 0;
-		int minIndex = 0;
-		float minDist = FLT_MAX;
-		if(dim==2)
-		{
-			FOR(j, clusters)
-			{
-				float distance = Distance2(sample, means[j]);
-				if(distance < minDist)
-				{
-					minIndex = j;
-					minDist = distance;
-				}
-			}
-		}
-		else
-		{
-			FOR(j, clusters)
-			{
-				float distance = Distance(sample, means[j]);
-				if(distance < minDist)
-				{
-					minIndex = j;
-					minDist = distance;
-				}
-			}
-		}
-		res[minIndex] = 1;
+		FOR(j, clusters) res[j] = 0;
+		float closest, second;
+		res[Assign(x, closest, second)] = 1;
 	}
 }
 
-
 /**
-* performs the K-mean clustering algorithm
+* performs the K-mean clustering algorithm (Hamerly's variant)
 *
-* @param points[]  : each element of this array contains two elements
-*                    point, a fvec with the coordinates of the points
-*                    cluster, the number of the cluster the point belongs to
-* @param nbPoints  : number of point in the array
-* @param oldMeans  : array of fvec containing the old positions of the cluster centers
-* @param nbCluster : number of clusters
-* @param limits    : boundaries of the values for the points coordinates (default is the image size [320x240])
+* each sample keeps an upper bound on the distance to its center and a lower bound on the distance
+* to the second closest one. When the upper bound is below both the lower bound and half the distance
+* from its center to the closest other center, the sample cannot change cluster and is skipped.
+* Iterations stop when no sample changes cluster or after maxIterations.
 *
 */
-
-void KMeansCluster::KmeansClustering(std::vector<ClusterPoint> &points, vector<fvec> &oldMeans, int nbClusters)
+void KMeansCluster::KmeansClustering()
 {
-	// check that we didnt try to use zero clusters
-	nbClusters = !nbClusters ? 1 : nbClusters;
-
-	if((u32)nbClusters > points.size()) nbClusters = points.size();
-
-	// new means (centers) for the clusters
-	vector<fvec>means;
-	means.resize(nbClusters);
-
-	// used to check all the distances from the current point to each cluster
-	fvec distances;
-	distances.resize(nbClusters);
-
-	means = oldMeans;
-
-	int nbPoints = points.size();
-
-	// did at least one point move from one cluster to another ?
-	bool bSomethingChanged = true;
-
-	// the kmeans loop
-	while(bSomethingChanged){
-		bSomethingChanged = false;
+	int k = clusters;
+	upper.resize(count);
+	lower.resize(count);
+	labels.resize(count);
+	bool bParallel = count*k*dim > 65536;
+
+#ifdef _OPENMP
+#pragma omp parallel for if(bParallel)
+#endif
+	for(int i=0; i<count; i++)
+	{
+		labels[i] = Assign(&data[i*dim], upper[i], lower[i]);
+	}
 
-		//classify the points into clusters
-		for (register int i=0; i<nbPoints; i++){
-			// compute the distance to each clusters
-			for (register int j=0;j<nbClusters;j++){
-				distances[j] = Distance(points[i].point, means[j]);
+	fvec oldCenters, drift(k), halfSeparation(k);
+	std::vector<double> sums(k*dim);
+	ivec counts(k);
+	FOR(it, maxIterations)
+	{
+		// compute the new means, each thread accumulates its own sums
+		oldCenters = centers;
+		FOR(j, k*dim) sums[j] = 0;
+		FOR(j, k) counts[j] = 0;
+#ifdef _OPENMP
+#pragma omp parallel if(bParallel)
+#endif
+		{
+			std::vector<double> localSums(k*dim, 0);
+			ivec localCounts(k, 0);
+#ifdef _OPENMP
+#pragma omp for nowait
+#endif
+			for(int i=0; i<count; i++)
+			{
+				const float *x = &data[i*dim];
+				double *s = &localSums[labels[i]*dim];
+				FOR(d, dim) s[d] += x[d];
+				localCounts[labels[i]]++;
 			}
-
-			// find the closest cluster
-			if (points[i].cluster != FindSmallest(distances)){
-				bSomethingChanged = true;
-				points[i].cluster = FindSmallest(distances);
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+			{
+				FOR(j, k*dim) sums[j] += localSums[j];
+				FOR(j, k) counts[j] += localCounts[j];
 			}
 		}
-
-		//compute the new means for each cluster
-		Mean(points, means, nbClusters);
-	}
-
-	oldMeans = means;
-}
-
-
-/**
-* returns the square distance between two points
-*
-* @param p1 : the first point
-* @param p2 : the second one
-* @return   : the distance
-*
-*       note: if this function is more than a couple of lines long,
-*             you're doing something wrong!
-*/
-float SquareNorm(fvec p1, fvec p2)
-{
-	return p1*p2;
-}
-
-
-/**
-* returns the index of the smallest value in the array
-*
-* @param values   : the array containing the distances
-* @param nbValues : the length of the array
-* @return   : the index of the smallest distance in the array
-*
-*/
-int FindSmallest(fvec values)
-{
-
-	// initialize the minimum value and index to the first values in the array
-	int minIndex = 0;
-	float minValue = values[0];
-
-	// go through the array and get the smallest value
-	for (int i=0; i<values.size(); i++){
-		if (values[i]<minValue){
-			minIndex = i;
-			minValue = values[i];
+		float maxDrift = 0;
+		FOR(j, k)
+		{
+			// empty clusters keep their previous position
+			if(counts[j]) FOR(d, dim) centers[j*dim + d] = (float)(sums[j*dim + d] / counts[j]);
+			drift[j] = Metric(&oldCenters[j*dim], &centers[j*dim]);
+			maxDrift = max(maxDrift, drift[j]);
+		}
+		FOR(j, k)
+		{
+			float s = FLT_MAX;
+			FOR(l, k) if(l != j) s = min(s, Metric(&centers[j*dim], &centers[l*dim]));
+			halfSeparation[j] = s*0.5f;
 		}
-	}
-
-	return minIndex;
-}
-
-/**
-* computes the means for each cluster
-*
-* @param points     : the array containing the cluster points
-* @param nbPoints   : the length of the points array
-* @param means      : the array containing the means for the clusters, will be modified by the function
-* @param nbClusters : the number of clusters (also = length of the means array)
-*
-*/
-void KMeansCluster::Mean(std::vector<ClusterPoint> &points, vector<fvec> &means, int nbClusters)
-{
-	// counters to know how many points went into each cluster
-	int *nbPointInCluster = new int[nbClusters];
-
-	// reinitialize the center for each cluster
-	for(int k = 0; k < nbClusters; k++){
-		FOR(d,dim) means[k][d] = 0;
-		nbPointInCluster[k] = 0;
-	}
-
-	// sum the points
-	for (register int i = 0; (u32)i<points.size(); i++){
-		means[points[i].cluster] += points[i].point;
-		nbPointInCluster[points[i].cluster] += 1;
-	}
 
-	// normalize by the number of points added to each cluster
-	for(int k = 0; k < nbClusters; k++){
-		if (nbPointInCluster[k]){
-			means[k] /= (float)nbPointInCluster[k];
+		// reassign the samples whose bounds do not rule out a change of cluster
+		int changed = 0;
+#ifdef _OPENMP
+#pragma omp parallel for reduction(+:changed) if(bParallel)
+#endif
+		for(int i=0; i<count; i++)
+		{
+			int a = labels[i];
+			upper[i] += drift[a];
+			lower[i] -= maxDrift;
+			float bound = max(halfSeparation[a], lower[i]);
+			if(upper[i] <= bound) continue;
+			upper[i] = Metric(&data[i*dim], &centers[a*dim]);
+			if(upper[i] <= bound) continue;
+			int b = Assign(&data[i*dim], upper[i], lower[i]);
+			if(b != a)
+			{
+				labels[i] = b;
+				changed++;
+			}
 		}
+		if(!changed) break;
 	}
-
-	// delete the unused memory
-	delete [] nbPointInCluster;
 }
 
-
-// computes the means for each cluster
-void KMeansCluster::SoftMean(std::vector<ClusterPoint> &points, vector<fvec> &means, int nbClusters)
+// Sculley's mini-batch k-means: each center moves towards the samples of the batch it attracts,
+// with a learning rate decreasing with the number of samples it has seen
+void KMeansCluster::MiniBatchClustering()
 {
-	// counters to know how many points went into each cluster
-	float *weightsOfPointsInCluster = new float[nbClusters];
-
-	// reinitialize the center for each cluster
-	for(int k = 0; k < nbClusters; k++){
-		FOR(d,dim) means[k][d] = 0;
-		weightsOfPointsInCluster[k] = 0;
-	}
-
-	// sum the points, for each cluster use the point's weight
-	for (unsigned int i = 0; i<points.size(); i++){
-		for(int k = 0; k<nbClusters; k++){
-			means[k] += points[i].point * points[i].weights[k];
-			weightsOfPointsInCluster[k] += points[i].weights[k];
+	int k = clusters;
+	int batch = min(miniBatchSize, count);
+	ivec seen(k, 0), batchIndices(batch), batchLabels(batch);
+	labels.resize(count);
+	FOR(it, maxIterations)
+	{
+		FOR(b, batch) batchIndices[b] = RandomIndex(count);
+#ifdef _OPENMP
+#pragma omp parallel for if(batch*k*dim > 65536)
+#endif
+		for(int b=0; b<batch; b++)
+		{
+			float closest, second;
+			batchLabels[b] = Assign(&data[batchIndices[b]*dim], closest, second);
 		}
-	}
-
-	// normalize by the weights of the points added to each cluster
-	for(int k = 0; k < nbClusters; k++){
-		if (weightsOfPointsInCluster[k] != 0){
-			means[k] /= weightsOfPointsInCluster[k];
+		FOR(b, batch)
+		{
+			int j = batchLabels[b];
+			float eta = 1.f / (++seen[j]);
+			float *c = &centers[j*dim];
+			const float *x = &data[batchIndices[b]*dim];
+			FOR(d, dim) c[d] += eta*(x[d] - c[d]);
 		}
 	}
-
-	// delete the unused memory
-	delete [] weightsOfPointsInCluster;
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for(int i=0; i<count; i++)
+	{
+		float closest, second;
+		labels[i] = Assign(&data[i*dim], closest, second);
+	}
 }
 
-
 /**
 * performs the Soft K-mean clustering algorithm
 *
-* @param points[]  : each element of this array contains two elements
-*                    point, a fvec with the coordinates of the points
-*                    weights, the weights of influence of the point on each cluster
-* @param nbPoints  : number of point in the array
-* @param oldMeans  : array of fvec containing the old positions of the cluster centers
-* @param nbCluster : number of clusters
-* @param limits    : boundaries of the values for the points coordinates (default is the image size [320x240])
-* @param beta      : soft boundary stiffness (sigma = 1 / sqrt(beta))
+* the weights of influence of each sample on each cluster are stored in weights (count x clusters)
+* beta is the soft boundary stiffness (sigma = 1 / sqrt(beta))
+* if bEStep is true only the weights are computed and the means are left untouched
 *
 */
-
-void KMeansCluster::SoftKmeansClustering(std::vector<ClusterPoint> &points, vector<fvec> &oldMeans, int nbClusters, float beta, bool bEStep)
+void KMeansCluster::SoftKmeansClustering(bool bEStep)
 {
-	// check that we didnt try to use zero clusters
-	nbClusters = !nbClusters ? 1 : nbClusters;
-
-	if((unsigned int)nbClusters > points.size()) nbClusters = points.size();
-
-	// contains the means for each cluster
-	vector<fvec>means;
-	means.resize(nbClusters);
-
-	// used to check all the distances from the current point to each cluster
-	fvec distances;
-	distances.resize(nbClusters);
-
-	// Random number generation for initial means of clusters
-	// initialize the random seed with the current cpu time
-	srand((u32)cvGetTickCount());
-
-	means = oldMeans;
-
-	int nbPoints = points.size();
-
-	// initialize the points weights
-	for (int i=0; i < nbPoints; i++)
+	int k = clusters;
+	weights.resize(count*k);
+	std::vector<double> sums(k*dim, 0), mass(k, 0);
+#ifdef _OPENMP
+#pragma omp parallel if(count*k*dim > 65536)
+#endif
 	{
-		KILL(points[i].weights);
-		points[i].weights = new float[nbClusters];
-		FOR(j, nbClusters) points[i].weights[j] = 0;
-	}
-
-	//classify the points into clusters
-	for (int i=0; i<nbPoints; i++){
-		fvec point = points[i].point;
-		// compute the distance to each clusters
-		float distanceSum = 0;
-		for (int j=0;j<nbClusters;j++){
-			distances[j] = expf(-beta * sqrtf((means[j] - point)*(means[j] - point)));
-			distanceSum += distances[j];
+		std::vector<double> localSums(k*dim, 0), localMass(k, 0);
+		fvec distances(k);
+#ifdef _OPENMP
+#pragma omp for nowait
+#endif
+		for(int i=0; i<count; i++)
+		{
+			const float *x = &data[i*dim];
+			float *w = &weights[i*k];
+			// compute the distance to each clusters
+			float minDist = FLT_MAX;
+			FOR(j, k)
+			{
+				const float *c = &centers[j*dim];
+				float d = 0;
+				FOR(l, dim) d += (x[l]-c[l])*(x[l]-c[l]);
+				distances[j] = sqrtf(d);
+				minDist = min(minDist, distances[j]);
+			}
+			// compute the weights for each cluster
+			float distanceSum = 0;
+			FOR(j, k)
+			{
+				w[j] = expf(-beta * (distances[j] - minDist));
+				distanceSum += w[j];
+			}
+			FOR(j, k) w[j] /= distanceSum;
+			if(bEStep) continue;
+			FOR(j, k)
+			{
+				double *s = &localSums[j*dim];
+				FOR(l, dim) s[l] += w[j]*x[l];
+				localMass[j] += w[j];
+			}
 		}
-
-		// compute the weights for each cluster
-		for (int j=0;j<nbClusters;j++){
-			points[i].weights[j] = distances[j] / float(distanceSum);
+		if(!bEStep)
+		{
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+			{
+				FOR(j, k*dim) sums[j] += localSums[j];
+				FOR(j, k) mass[j] += localMass[j];
+			}
 		}
 	}
+	if(bEStep) return;
 
-	if(!bEStep)
+	//compute the new means for each cluster
+	FOR(j, k)
 	{
-		//compute the new means for each cluster
-		SoftMean(points, means, nbClusters);
+		if(mass[j] == 0) continue;
+		FOR(d, dim) centers[j*dim + d] = (float)(sums[j*dim + d] / mass[j]);
 	}
-
-	oldMeans = means;
 }
 
-void KMeansCluster::GMMClustering(std::vector<ClusterPoint> &points, vector<fvec> &oldMeans, double **oldSigma, double*oldPi, int nbClusters, bool bEStep)
+/**
+* performs one EM step of a gaussian mixture with full covariance matrices
+*
+* if bEStep is true the responsibilities are initialized by assigning the samples
+* to each cluster in turn, otherwise they are computed from the current model
+*
+*/
+void KMeansCluster::GMMClustering(bool bEStep)
 {
-	// check that we didnt try to use zero clusters
-	nbClusters = !nbClusters ? 1 : nbClusters;
-
-	if((unsigned int)nbClusters > points.size()) nbClusters = points.size();
-
-	// contains the means for each cluster
-	vector<fvec>means;
-	means.resize(nbClusters);
-	double *pi = new double[nbClusters];
-	double **sigma = new double *[nbClusters];
-	FOR(i, nbClusters)
-	{
-		sigma[i] = new double[4];
-		sigma[i][0] = sigma[i][3] = 0.1f;
-		sigma[i][1] = sigma[i][2] = 0;
-	}
-
-	// used to check all the distances from the current point to each cluster
-	double *distances = new double[nbClusters];
-
-	// Random number generation for initial means of clusters
-	// initialize the random seed with the current cpu time
-	srand((u32)cvGetTickCount());
-
-	// initialize the means as the old values
-	// divide by [320x240] to avoid numerical precision problems
-	// WARNING: from now on the values will go from 0 to 1
-	for (int i=0; i<nbClusters; i++){
-		means[i] = oldMeans[i];
-	}
-	for (int i=0; i<nbClusters; i++){
-		pi[i] = oldPi[i];
-	}
-	for (int i=0; i<nbClusters; i++){
-		for (int j=0; j<4; j++) sigma[i][j] = oldSigma[i][j];
-	}
-
-	int nbPoints = points.size();
-
+	int k = clusters;
+	int dd = dim*dim;
+	weights.resize(count*k);
+	bool bParallel = count*k*dd > 65536;
 
 	if(bEStep)
 	{
-		// initialize the points weights
-		u32 cnt = 0;
-		for (int i=0; i < nbPoints; i++)
+		FOR(i, count)
 		{
-			KILL(points[i].weights);
-			points[i].weights = new float[nbClusters];
-			FOR(j, nbClusters) points[i].weights[j] = 0;
-			points[i].weights[cnt++%nbClusters] = 1.f;
+			FOR(j, k) weights[i*k + j] = 0;
+			weights[i*k + i%k] = 1.f;
 		}
 	}
-
-	if(!bEStep)
+	else
 	{
-		if(points[0].weights == NULL)
+		// log of the normalization term of each gaussian
+		std::vector<double> chol(k*dd), logNorm(k);
+		FOR(j, k)
 		{
-			// initialize the points weights
-			for (int i=0; i < nbPoints; i++)
+			double *L = &chol[j*dd];
+			if(pi[j] <= 0 || !Cholesky(&sigma[j*dd], L, dim))
 			{
-				KILL(points[i].weights);
-				points[i].weights = new float[nbClusters];
-				FOR(j, nbClusters) points[i].weights[j] = 0;
+				logNorm[j] = -HUGE_VAL;
+				continue;
 			}
+			double logDet = 0;
+			FOR(d, dim) logDet += 2*log(L[d*dim + d]);
+			logNorm[j] = log(pi[j]) - 0.5*(logDet + dim*log(2*(double)PIf));
 		}
 
 		//classify the points into clusters
-		u32 flipper=0;
-		for (int i=0; i<nbPoints; i++){
-			fvec point = points[i].point;
-			// compute the distance to each clusters
-			double distanceSum = 0;
-			for (int j=0;j<nbClusters;j++){
-				fvec a = (point - means[j]);
-				double *s = sigma[j];
-				double sdet = s[0]*s[3] - s[1]*s[2];
-				double sinv[4] = {s[3], -s[1], -s[2], s[0]};
-				FOR(k,4) sinv[k] /= sdet;
-
-				double b = a[0]*a[0]*sinv[0] + a[0]*a[1]*(sinv[1]+sinv[2]) + a[1]*a[1]*sinv[3];
-				b *= -0.5;
-				double dist = exp(b);
-				dist /= sqrt(sdet);
-				distances[j] = pi[j]*dist;
-				distances[j] /= 2*(double)PIf;
-				distanceSum += distances[j];
-			}
-
-			// compute the weights for each cluster
-			if(distanceSum != distanceSum)
+#ifdef _OPENMP
+#pragma omp parallel if(bParallel)
+#endif
+		{
+			std::vector<double> y(dim), logp(k);
+#ifdef _OPENMP
+#pragma omp for
+#endif
+			for(int i=0; i<count; i++)
 			{
-				FOR(j, nbClusters) points[i].weights[j] = 0;
-				points[i].weights[flipper++%nbClusters] = 1;
-			}
-			else
-				for (int j=0;j<nbClusters;j++){
-					points[i].weights[j] = (float)(distances[j] / distanceSum);
+				const float *x = &data[i*dim];
+				double maxLog = -HUGE_VAL;
+				FOR(j, k)
+				{
+					if(logNorm[j] == -HUGE_VAL)
+					{
+						logp[j] = -HUGE_VAL;
+						continue;
+					}
+					// solve L*y = x - mu, the mahalanobis distance is then y'*y
+					const double *L = &chol[j*dd];
+					const float *mu = &centers[j*dim];
+					double maha = 0;
+					FOR(d, dim)
+					{
+						double v = x[d] - mu[d];
+						FOR(l, d) v -= L[d*dim + l]*y[l];
+						y[d] = v / L[d*dim + d];
+						maha += y[d]*y[d];
+					}
+					logp[j] = logNorm[j] - 0.5*maha;
+					if(logp[j] > maxLog) maxLog = logp[j];
+				}
+				float *w = &weights[i*k];
+				double sum = 0;
+				if(maxLog != -HUGE_VAL)
+				{
+					FOR(j, k)
+					{
+						logp[j] = exp(logp[j] - maxLog);
+						sum += logp[j];
+					}
 				}
+				// compute the weights for each cluster
+				if(!(sum > 0))
+				{
+					FOR(j, k) w[j] = 0;
+					w[i%k] = 1;
+				}
+				else FOR(j, k) w[j] = (float)(logp[j] / sum);
+			}
 		}
 	}
 
-	//compute the new means for each cluster
-	for (int i=0; i<nbClusters; i++)
+	//compute the new means and priors for each cluster
+	std::vector<double> sums(k*dim, 0), mass(k, 0);
+#ifdef _OPENMP
+#pragma omp parallel if(bParallel)
+#endif
 	{
-		fvec mean;
-		mean.resize(2,0);
-		float respTotal = 0;
-		for (int j=0; j<nbPoints; j++)
+		std::vector<double> localSums(k*dim, 0), localMass(k, 0);
+#ifdef _OPENMP
+#pragma omp for nowait
+#endif
+		for(int i=0; i<count; i++)
 		{
-			mean += points[j].point * points[j].weights[i];
-			respTotal += points[j].weights[i];
+			const float *x = &data[i*dim];
+			const float *w = &weights[i*k];
+			FOR(j, k)
+			{
+				if(w[j] == 0) continue;
+				double *s = &localSums[j*dim];
+				FOR(d, dim) s[d] += w[j]*x[d];
+				localMass[j] += w[j];
+			}
 		}
-		means[i] = mean / respTotal;
-	}
-
-	//compute the new prior for each cluster
-	float respTotal = 0;
-	for (int i=0; i<nbClusters; i++)
-	{
-		float resp = 0;
-		for (int j=0; j<nbPoints; j++)
+#ifdef _OPENMP
+#pragma omp critical
+#endif
 		{
-			resp += points[j].weights[i];
+			FOR(j, k*dim) sums[j] += localSums[j];
+			FOR(j, k) mass[j] += localMass[j];
 		}
-		respTotal += resp;
-		pi[i] = resp;
 	}
-	for (int i=0; i<nbClusters; i++)
+	double massTotal = 0;
+	FOR(j, k) massTotal += mass[j];
+	FOR(j, k)
 	{
-		pi[i] /= respTotal;
+		pi[j] = massTotal > 0 ? mass[j] / massTotal : 1./k;
+		if(mass[j] == 0) continue;
+		FOR(d, dim) centers[j*dim + d] = (float)(sums[j*dim + d] / mass[j]);
 	}
 
 	//compute the new sigma for each cluster
-	for (int i=0; i<nbClusters; i++)
+	std::vector<double> covs(k*dd, 0);
+#ifdef _OPENMP
+#pragma omp parallel if(bParallel)
+#endif
 	{
-		float sums[3];
-		float resp = 0;
-		for (int j=0; j<3; j++) sums[j] = 0;
-		for (int j=0; j<nbPoints; j++)
+		std::vector<double> localCovs(k*dd, 0), diff(dim);
+#ifdef _OPENMP
+#pragma omp for nowait
+#endif
+		for(int i=0; i<count; i++)
 		{
-			float r = points[j].weights[i];
-			if(r==0) continue;
-			fvec diff = points[j].point - means[i];
-			sums[0] += r*(diff[0]*diff[0]);
-			sums[1] += r*(diff[0]*diff[1]);
-			sums[2] += r*(diff[1]*diff[1]);
-			resp += r;
+			const float *x = &data[i*dim];
+			const float *w = &weights[i*k];
+			FOR(j, k)
+			{
+				if(w[j] == 0) continue;
+				FOR(d, dim) diff[d] = x[d] - centers[j*dim + d];
+				double *c = &localCovs[j*dd];
+				FOR(d, dim) FOR(l, d+1) c[d*dim + l] += w[j]*diff[d]*diff[l];
+			}
+		}
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+		{
+			FOR(j, k*dd) covs[j] += localCovs[j];
 		}
-		for (int j=0; j<3; j++) sums[j] /= resp;
-		sigma[i][0] = sums[0];
-		sigma[i][1] = sigma[i][2] = sums[1];
-		sigma[i][3] = sums[2];
-	}
-
-	// we copy the new values into the old ones
-	for (int i=0; i<nbClusters; i++){
-		oldMeans[i] = means[i];
-	}
-	for (int i=0; i<nbClusters; i++){
-		oldPi[i] = pi[i];
 	}
-	for (int i=0; i<nbClusters; i++){
-		for (int j=0; j<4; j++) oldSigma[i][j] = sigma[i][j];
+	FOR(j, k)
+	{
+		if(mass[j] == 0) continue;
+		double *s = &sigma[j*dd];
+		const double *c = &covs[j*dd];
+		FOR(d, dim)
+		{
+			FOR(l, d+1) s[d*dim + l] = s[l*dim + d] = c[d*dim + l] / mass[j];
+			s[d*dim + d] += 1e-6; // keeps the matrix invertible on degenerate clusters
+		}
 	}
-
-	// we delete the memory we used
-	delete [] distances;
-	delete [] pi;
-	for (int i=0; i<nbClusters; i++) delete [] sigma[i];
-	delete [] sigma;
 }
@@ -22,39 +22,37 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include <vector>
 #include "basicOpenCV.h"
 
-struct ClusterPoint{
-	fvec point;
-	u32 cluster;
-	float *weights;
-	ClusterPoint() : point(0,0), cluster(0), weights(NULL){};
-	~ClusterPoint()
-	{
-		if(weights) delete [] weights;
-		weights=0;
-	};
-};
-
-inline float SquareNorm(fvec p1, fvec p2);
-inline int FindSmallest(fvec values);
-inline void Mean(std::vector<ClusterPoint>, std::vector<fvec> means, int nbClusters);
-inline void SoftMean(std::vector<ClusterPoint> &points, std::vector<fvec> means, int nbClusters);
-
-
+// k-means, soft k-means and gmm on a contiguous (count x dim, row-major) copy of the data
+// hard k-means is seeded with k-means++ and uses Hamerly's bounds to skip most distance computations
+// datasets larger than miniBatchThreshold are clustered with mini-batch updates instead
 class KMeansCluster
 {
 private:
 	float beta;
 	u32 clusters;
 	bool bSoft;
-	std::vector<fvec> means;
-	std::vector<ClusterPoint> points;
-	ivec closestIndices;
 	int dim;
 	int power;
+	int maxIterations;
+	int miniBatchSize;
+	int miniBatchThreshold;
+
+	std::vector<fvec> means;
+	ivec closestIndices;
+
+	// data, labels and responsibilities (count x clusters) are stored contiguously
+	int count;
+	fvec data;
+	ivec labels;
+	fvec weights;
+	fvec centers; // clusters x dim
+
+	// hamerly bounds
+	fvec upper, lower;
 
 	bool bGMM;
-	double **sigma;
-	double *pi;
+	std::vector<double> sigma; // clusters x dim x dim
+	std::vector<double> pi;
 
 public:
 	KMeansCluster(u32 cnt=1);
@@ -65,9 +63,9 @@ public:
 	void DrawMap(IplImage *image);
 
 	void Clear();
-	void Test(fvec sample, fvec &res);
+	void Test(const fvec &sample, fvec &res);
 
-	void SetPoint(u32 index, fvec point){if(index<points.size()) points[index].point = point;};
+	void SetPoint(u32 index, fvec point);
 
 	void AddPoint(fvec sample);
 	void AddPoints(std::vector<fvec> points);
@@ -80,22 +78,27 @@ public:
 	u32 GetClusters(){return clusters;};
 	void ResetClusters();
 
-	inline float Distance(fvec a, fvec b);
-	inline float Distance2(fvec a, fvec b);
+	// metric selected by power, returns the p-th power of the norm (squared for the euclidean norm)
+	inline float Distance(const float *a, const float *b) const;
+	// proper metric (the norm itself), used for the triangle inequality bounds
+	inline float Metric(const float *a, const float *b) const;
 
 	void SetSoft(bool soft){bSoft = soft;};
 	void SetBeta(float b){beta = b > 0 ? b : 0.01f;};
 	void SetGMM(bool gmm){bGMM = gmm;};
 	void SetPower(int p){power = p;};
+	void SetMaxIterations(int iterations){maxIterations = max(1, iterations);};
+	void SetMiniBatch(int batchSize, int threshold=1000000){miniBatchSize = max(1, batchSize); miniBatchThreshold = threshold;};
 	float GetBeta(){return beta;};
 
 private:
-	void Mean(std::vector<ClusterPoint> &points, std::vector<fvec> &means, int nbClusters);
-	void SoftMean(std::vector<ClusterPoint> &points, std::vector<fvec> &means, int nbClusters);
-	void KmeansClustering(std::vector<ClusterPoint> &points, std::vector<fvec> &oldMeans, int nbClusters);
-	void SoftKmeansClustering(std::vector<ClusterPoint> &points, std::vector<fvec> &oldMeans, int nbClusters, float beta, bool bEStep);
-	void GMMClustering(std::vector<ClusterPoint> &points, std::vector<fvec> &oldMeans, double **oldSigma, double*oldPi, int nbClusters, bool bEStep);
-
+	void SeedClusters();
+	void UpdateMeans();
+	int Assign(const float *sample, float &closest, float &second) const;
+	void KmeansClustering();
+	void MiniBatchClustering();
+	void SoftKmeansClustering(bool bEStep);
+	void GMMClustering(bool bEStep);
 };
 
 #endif // _KMEANS_H_
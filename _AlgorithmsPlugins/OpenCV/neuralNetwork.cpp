@@ -0,0 +1,398 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Library General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <float.h>
+#include "neuralNetwork.h"
+
+using namespace std;
+
+#define NN_PREDICT_BLOCK 64 // rows evaluated together in a batch prediction
+#define NN_STACK_WIDTH 256 // widest layer whose single-sample buffers fit on the stack
+
+// out (count x nOut) = in (count x nIn) * W^T + b
+static void Dense(const float *in, int count, int nIn, const float *W, const float *b, int nOut, float *out)
+{
+#ifdef _OPENMP
+#pragma omp parallel for if(count*nIn*nOut > 65536)
+#endif
+	for(int i=0; i<count; i++)
+	{
+		const float *x = in + i*nIn;
+		float *y = out + i*nOut;
+		for(int j=0; j<nOut; j++)
+		{
+			const float *w = W + j*nIn;
+			float s = 0;
+			for(int k=0; k<nIn; k++) s += w[k]*x[k];
+			y[j] = s + b[j];
+		}
+	}
+}
+
+static void Activate(const float *z, float *a, int length, int activation, float alpha, float beta)
+{
+	switch(activation)
+	{
+	case NeuralNetwork::SIGMOID_SYM:
+	{
+		// beta*(1-exp(-alpha*x))/(1+exp(-alpha*x)) == beta*tanh(alpha*x/2)
+		float halfAlpha = alpha*0.5f;
+		for(int i=0; i<length; i++) a[i] = beta*tanhf(halfAlpha*z[i]);
+	}
+		break;
+	case NeuralNetwork::GAUSSIAN:
+		for(int i=0; i<length; i++) a[i] = beta*expf(-alpha*z[i]*z[i]);
+		break;
+	default:
+		if(a != z) memcpy(a, z, length*sizeof(float));
+		break;
+	}
+}
+
+// d *= f'(z), using the already computed activation a = f(z)
+static void Derivate(const float *z, const float *a, float *d, int length, int activation, float alpha, float beta)
+{
+	switch(activation)
+	{
+	case NeuralNetwork::SIGMOID_SYM:
+	{
+		float k = alpha/(2*beta), b2 = beta*beta;
+		for(int i=0; i<length; i++) d[i] *= k*(b2 - a[i]*a[i]);
+	}
+		break;
+	case NeuralNetwork::GAUSSIAN:
+		for(int i=0; i<length; i++) d[i] *= -2*alpha*z[i]*a[i];
+		break;
+	default:
+		break;
+	}
+}
+
+NeuralNetwork::NeuralNetwork()
+: method(TRAIN_ADAM), maxEpochs(500), batchSize(32), learningRate(0.01f), tolerance(1e-3f),
+  activation(SIGMOID_SYM), alpha(0), beta(0), maxWidth(0)
+{
+}
+
+void NeuralNetwork::Create(const ivec &layers, int activation, float alpha, float beta)
+{
+	this->layers = layers;
+	this->activation = activation;
+	// same defaults as the opencv implementation we replace
+	if(activation == SIGMOID_SYM)
+	{
+		if(fabs(alpha) < FLT_EPSILON) alpha = 2.f/3.f;
+		if(fabs(beta) < FLT_EPSILON) beta = 1.7159f;
+	}
+	else if(activation == GAUSSIAN)
+	{
+		if(fabs(alpha) < FLT_EPSILON) alpha = 1.f;
+		if(fabs(beta) < FLT_EPSILON) beta = 1.f;
+	}
+	this->alpha = alpha;
+	this->beta = beta;
+
+	int layerCount = layers.size();
+	wOffset.resize(max(layerCount-1,0));
+	bOffset.resize(max(layerCount-1,0));
+	int wCount = 0, bCount = 0;
+	maxWidth = 0;
+	FOR(l, layerCount) maxWidth = max(maxWidth, layers[l]);
+	FOR(l, layerCount-1)
+	{
+		wOffset[l] = wCount;
+		bOffset[l] = bCount;
+		wCount += layers[l+1]*layers[l];
+		bCount += layers[l+1];
+	}
+	weights.assign(wCount, 0);
+	biases.assign(bCount, 0);
+	int nIn = InputDim(), nOut = OutputDim();
+	inMean.assign(nIn, 0);
+	inScale.assign(nIn, 1);
+	outMean.assign(nOut, 0);
+	outScale.assign(nOut, 1);
+}
+
+void NeuralNetwork::Forward(int count)
+{
+	int layerCount = layers.size();
+	FOR(l, layerCount-1)
+	{
+		Dense(&a[l][0], count, layers[l], &weights[wOffset[l]], &biases[bOffset[l]], layers[l+1], &z[l+1][0]);
+		if(l < layerCount-2) Activate(&z[l+1][0], &a[l+1][0], count*layers[l+1], activation, alpha, beta);
+		else Activate(&z[l+1][0], &a[l+1][0], count*layers[l+1], IDENTITY, alpha, beta);
+	}
+}
+
+float NeuralNetwork::Backward(const float *target, int count)
+{
+	int L = layers.size()-1;
+	int nOut = layers[L];
+	float error = 0;
+	float *d = &delta[L][0];
+	const float *y = &a[L][0];
+	FOR(i, count*nOut)
+	{
+		float e = y[i] - target[i];
+		error += e*e;
+		d[i] = e / count;
+	}
+
+	for(int l=L-1; l>=0; l--)
+	{
+		int nI = layers[l], nO = layers[l+1];
+		const float *dO = &delta[l+1][0];
+		const float *aI = &a[l][0];
+		float *gW = &gradW[wOffset[l]];
+		float *gB = &gradB[bOffset[l]];
+		// each output neuron owns its row of the gradient, no reduction needed across threads
+#ifdef _OPENMP
+#pragma omp parallel for if(count*nI*nO > 65536)
+#endif
+		for(int j=0; j<nO; j++)
+		{
+			float *g = gW + j*nI;
+			float gb = 0;
+			for(int k=0; k<nI; k++) g[k] = 0;
+			for(int i=0; i<count; i++)
+			{
+				float dj = dO[i*nO + j];
+				const float *x = aI + i*nI;
+				for(int k=0; k<nI; k++) g[k] += dj*x[k];
+				gb += dj;
+			}
+			gB[j] = gb;
+		}
+		if(!l) break;
+
+		// propagate the error to the previous layer
+		const float *W = &weights[wOffset[l]];
+		float *dI = &delta[l][0];
+#ifdef _OPENMP
+#pragma omp parallel for if(count*nI*nO > 65536)
+#endif
+		for(int i=0; i<count; i++)
+		{
+			float *di = dI + i*nI;
+			const float *dOi = dO + i*nO;
+			for(int k=0; k<nI; k++) di[k] = 0;
+			for(int j=0; j<nO; j++)
+			{
+				const float *w = W + j*nI;
+				float dj = dOi[j];
+				for(int k=0; k<nI; k++) di[k] += dj*w[k];
+			}
+		}
+		Derivate(&z[l][0], &a[l][0], dI, count*nI, activation, alpha, beta);
+	}
+	return error;
+}
+
+void NeuralNetwork::Update(int step)
+{
+	if(method == TRAIN_SGD)
+	{
+		FOR(i, weights.size()) weights[i] -= learningRate*gradW[i];
+		FOR(i, biases.size()) biases[i] -= learningRate*gradB[i];
+		return;
+	}
+	// adam
+	const float beta1 = 0.9f, beta2 = 0.999f, eps = 1e-8f;
+	float c1 = 1.f/(1.f - powf(beta1, (float)step));
+	float c2 = 1.f/(1.f - powf(beta2, (float)step));
+	int wCount = weights.size();
+	float *w = &weights[0], *g = &gradW[0], *m = &mW[0], *v = &vW[0];
+	for(int i=0; i<wCount; i++)
+	{
+		m[i] = beta1*m[i] + (1-beta1)*g[i];
+		v[i] = beta2*v[i] + (1-beta2)*g[i]*g[i];
+		w[i] -= learningRate*(m[i]*c1) / (sqrtf(v[i]*c2) + eps);
+	}
+	int bCount = biases.size();
+	w = &biases[0], g = &gradB[0], m = &mB[0], v = &vB[0];
+	for(int i=0; i<bCount; i++)
+	{
+		m[i] = beta1*m[i] + (1-beta1)*g[i];
+		v[i] = beta2*v[i] + (1-beta2)*g[i]*g[i];
+		w[i] -= learningRate*(m[i]*c1) / (sqrtf(v[i]*c2) + eps);
+	}
+}
+
+float NeuralNetwork::Train(const float *inputs, const float *outputs, int count)
+{
+	int layerCount = layers.size();
+	if(!count || layerCount < 2) return 0;
+	int nIn = InputDim(), nOut = OutputDim();
+
+	// standardize inputs and outputs
+	FOR(d, nIn)
+	{
+		double mean = 0, var = 0;
+		FOR(i, count) mean += inputs[i*nIn + d];
+		mean /= count;
+		FOR(i, count) var += (inputs[i*nIn + d]-mean)*(inputs[i*nIn + d]-mean);
+		var /= count;
+		inMean[d] = mean;
+		inScale[d] = var > FLT_EPSILON ? 1.f/sqrt(var) : 1.f;
+	}
+	FOR(d, nOut)
+	{
+		double mean = 0, var = 0;
+		FOR(i, count) mean += outputs[i*nOut + d];
+		mean /= count;
+		FOR(i, count) var += (outputs[i*nOut + d]-mean)*(outputs[i*nOut + d]-mean);
+		var /= count;
+		outMean[d] = mean;
+		outScale[d] = var > FLT_EPSILON ? sqrt(var) : 1.f;
+	}
+
+	// xavier initialization
+	FOR(l, layerCount-1)
+	{
+		float range = sqrtf(6.f/(layers[l] + layers[l+1]));
+		FOR(i, layers[l]*layers[l+1]) weights[wOffset[l] + i] = (rand()/(float)RAND_MAX*2.f - 1.f)*range;
+		FOR(i, layers[l+1]) biases[bOffset[l] + i] = 0;
+	}
+
+	int batch = max(1, min(batchSize, count));
+	z.resize(layerCount);
+	a.resize(layerCount);
+	delta.resize(layerCount);
+	FOR(l, layerCount)
+	{
+		z[l].assign(batch*layers[l], 0);
+		a[l].assign(batch*layers[l], 0);
+		delta[l].assign(batch*layers[l], 0);
+	}
+	gradW.assign(weights.size(), 0);
+	gradB.assign(biases.size(), 0);
+	mW.assign(weights.size(), 0);
+	vW.assign(weights.size(), 0);
+	mB.assign(biases.size(), 0);
+	vB.assign(biases.size(), 0);
+	fvec target(batch*nOut);
+
+	uvec order(count);
+	FOR(i, count) order[i] = i;
+
+	float bestLoss = FLT_MAX, loss = 0;
+	int step = 0, stalled = 0;
+	FOR(epoch, maxEpochs)
+	{
+		// fisher-yates shuffle
+		for(int i=count-1; i>0; i--) std::swap(order[i], order[rand()%(i+1)]);
+		loss = 0;
+		for(int start=0; start<count; start += batch)
+		{
+			int n = min(batch, count-start);
+			FOR(i, n)
+			{
+				int index = order[start+i];
+				const float *x = inputs + index*nIn;
+				const float *t = outputs + index*nOut;
+				float *ax = &a[0][i*nIn];
+				float *tx = &target[i*nOut];
+				FOR(d, nIn) ax[d] = (x[d] - inMean[d])*inScale[d];
+				FOR(d, nOut) tx[d] = (t[d] - outMean[d])/outScale[d];
+			}
+			Forward(n);
+			loss += Backward(&target[0], n);
+			Update(++step);
+		}
+		loss /= count*nOut;
+		if(loss < bestLoss*(1.f - tolerance))
+		{
+			bestLoss = loss;
+			stalled = 0;
+		}
+		else if(++stalled >= 10) break;
+	}
+
+	// we release the training buffers
+	z.clear(); a.clear(); delta.clear();
+	gradW.clear(); gradB.clear(); mW.clear(); vW.clear(); mB.clear(); vB.clear();
+	return loss;
+}
+
+void NeuralNetwork::Predict(const float *input, float *output) const
+{
+	int layerCount = layers.size();
+	if(IsEmpty()) return;
+	float stack[2*NN_STACK_WIDTH];
+	fvec heap;
+	float *x = stack;
+	if(maxWidth > NN_STACK_WIDTH)
+	{
+		heap.resize(2*maxWidth);
+		x = &heap[0];
+	}
+	float *y = x + maxWidth;
+	int nIn = InputDim(), nOut = OutputDim();
+	FOR(d, nIn) x[d] = (input[d] - inMean[d])*inScale[d];
+	FOR(l, layerCount-1)
+	{
+		Dense(x, 1, layers[l], &weights[wOffset[l]], &biases[bOffset[l]], layers[l+1], y);
+		if(l < layerCount-2) Activate(y, y, layers[l+1], activation, alpha, beta);
+		std::swap(x, y);
+	}
+	FOR(d, nOut) output[d] = x[d]*outScale[d] + outMean[d];
+}
+
+void NeuralNetwork::Predict(const float *inputs, int count, float *outputs) const
+{
+	int layerCount = layers.size();
+	if(IsEmpty() || !count) return;
+	int nIn = InputDim(), nOut = OutputDim();
+	int blocks = (count + NN_PREDICT_BLOCK - 1) / NN_PREDICT_BLOCK;
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+	{
+		fvec buffer0(NN_PREDICT_BLOCK*maxWidth), buffer1(NN_PREDICT_BLOCK*maxWidth);
+#ifdef _OPENMP
+#pragma omp for
+#endif
+		for(int b=0; b<blocks; b++)
+		{
+			int start = b*NN_PREDICT_BLOCK;
+			int n = min(NN_PREDICT_BLOCK, count - start);
+			float *x = &buffer0[0], *y = &buffer1[0];
+			FOR(i, n)
+			{
+				const float *in = inputs + (start+i)*nIn;
+				FOR(d, nIn) x[i*nIn + d] = (in[d] - inMean[d])*inScale[d];
+			}
+			FOR(l, layerCount-1)
+			{
+				Dense(x, n, layers[l], &weights[wOffset[l]], &biases[bOffset[l]], layers[l+1], y);
+				if(l < layerCount-2) Activate(y, y, n*layers[l+1], activation, alpha, beta);
+				std::swap(x, y);
+			}
+			FOR(i, n)
+			{
+				float *out = outputs + (start+i)*nOut;
+				FOR(d, nOut) out[d] = x[i*nOut + d]*outScale[d] + outMean[d];
+			}
+		}
+	}
+}
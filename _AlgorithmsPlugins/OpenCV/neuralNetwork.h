@@ -0,0 +1,77 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License,
+version 3 as published by the Free Software Foundation.
+
+This library is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#ifndef _NEURAL_NETWORK_H_
+#define _NEURAL_NETWORK_H_
+
+#include <vector>
+#include "types.h"
+
+// feed-forward perceptron used by the MLP classifier, regressor and dynamical system
+// weights are stored contiguously, one row-major (outputs x inputs) matrix per layer
+// the hidden layers use the selected activation, the output layer is linear
+// (CvANN_MLP also squashed the output layer, which capped what the regressors could reach)
+// inputs and outputs are standardized internally
+class NeuralNetwork
+{
+public:
+	enum {IDENTITY=0, SIGMOID_SYM=1, GAUSSIAN=2};
+	enum {TRAIN_SGD=0, TRAIN_ADAM=1};
+
+	// training parameters
+	int method;
+	int maxEpochs;
+	int batchSize;
+	float learningRate;
+	float tolerance; // relative loss improvement under which we stop
+
+private:
+	ivec layers; // neurons per layer, input and output layers included
+	int activation;
+	float alpha, beta;
+	fvec weights, biases;
+	ivec wOffset, bOffset;
+	fvec inMean, inScale, outMean, outScale;
+	int maxWidth;
+
+	// mini-batch buffers, sized on Train
+	std::vector<fvec> z, a, delta;
+	fvec gradW, gradB, mW, vW, mB, vB;
+
+	void Forward(int count);
+	float Backward(const float *target, int count);
+	void Update(int step);
+
+public:
+	NeuralNetwork();
+	void Create(const ivec &layers, int activation=SIGMOID_SYM, float alpha=0, float beta=0);
+	// inputs is count x InputDim, outputs is count x OutputDim, both row-major. Returns the final training loss
+	float Train(const float *inputs, const float *outputs, int count);
+	// single sample, the forward buffers are on the stack (unless the layers are very wide) so that
+	// both predictions can be called concurrently once the network is trained
+	void Predict(const float *input, float *output) const;
+	// batch of samples, row-major, evaluated in blocks across threads
+	void Predict(const float *inputs, int count, float *outputs) const;
+
+	int InputDim() const {return layers.size() ? layers[0] : 0;};
+	int OutputDim() const {return layers.size() ? layers[layers.size()-1] : 0;};
+	int LayerCount() const {return layers.size();};
+	bool IsEmpty() const {return weights.empty();};
+};
+
+#endif // _NEURAL_NETWORK_H_
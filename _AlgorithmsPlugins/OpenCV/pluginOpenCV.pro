@@ -68,6 +68,7 @@ HEADERS +=	\
 			dynamicalMLP.h \
 			clustererKM.h \
 			kmeans.h \
+			neuralNetwork.h \
 			interfaceMLPClassifier.h \
 			interfaceKMCluster.h \
 			interfaceBoostClassifier.h \
@@ -86,6 +87,7 @@ SOURCES += 	\
 			dynamicalMLP.cpp \
 			clustererKM.cpp \
 			kmeans.cpp \
+			neuralNetwork.cpp \
 			interfaceMLPClassifier.cpp \
 			interfaceKMCluster.cpp \
 			interfaceBoostClassifier.cpp \
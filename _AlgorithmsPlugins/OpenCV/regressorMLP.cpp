@@ -22,7 +22,8 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include "regressorMLP.h"
 
 RegressorMLP::RegressorMLP()
-: functionType(1), neuronCount(2), mlp(0), alpha(0), beta(0)
+: functionType(1), neuronCount(2), mlp(0), alpha(0), beta(0),
+  method(NeuralNetwork::TRAIN_ADAM), maxEpochs(500), batchSize(32), learningRate(0.01f)
 {
 	type = REGR_MLP;
 }
@@ -39,50 +40,30 @@ void RegressorMLP::Train(std::vector< fvec > samples, ivec labels)
 	DEL(mlp);
 	dim = samples[0].size()-1;
 
-	CvMat *layers;
-	//	if(neuronCount == 3) neuronCount = 2; // don't ask me why but 3 neurons mess up everything...
-
-	if(!layerCount || neuronCount < 2)
-	{
-		layers = cvCreateMat(2,1,CV_32SC1);
-		cvSet1D(layers, 0, cvScalar(dim));
-		cvSet1D(layers, 1, cvScalar(1));
-	}
-	else
+	ivec layers;
+	layers.push_back(dim);
+	if(layerCount && neuronCount >= 2)
 	{
-		layers = cvCreateMat(2+layerCount,1,CV_32SC1);
-		cvSet1D(layers, 0, cvScalar(dim));
-		cvSet1D(layers, layerCount+1, cvScalar(1));
-		FOR(i, layerCount) cvSet1D(layers, i+1, cvScalar(neuronCount));
+		FOR(i, layerCount) layers.push_back(neuronCount);
 	}
+	layers.push_back(1);
 
-	u32 *perm = randPerm(sampleCnt);
-
-	CvMat *trainSamples = cvCreateMat(sampleCnt, dim, CV_32FC1);
-	CvMat *trainOutputs = cvCreateMat(sampleCnt, 1, CV_32FC1);
-	CvMat *sampleWeights = cvCreateMat(samples.size(), 1, CV_32FC1);
+	// contiguous copy of the training data
+	fvec trainSamples(sampleCnt*dim);
+	fvec trainOutputs(sampleCnt);
 	FOR(i, sampleCnt)
 	{
-		FOR(j, dim) cvSetReal2D(trainSamples, i, j, samples[perm[i]][j]);
-		cvSet1D(trainOutputs, i, cvScalar(samples[perm[i]][dim]));
-		cvSet1D(sampleWeights, i, cvScalar(1));
+		FOR(d, dim) trainSamples[i*dim + d] = samples[i][d];
+		trainOutputs[i] = samples[i][dim];
 	}
 
-	delete [] perm;
-
-	int activationFunction = functionType == 2 ? CvANN_MLP::GAUSSIAN : functionType ? CvANN_MLP::SIGMOID_SYM : CvANN_MLP::IDENTITY;
-
-
-	mlp = new CvANN_MLP();
-	mlp->create(layers, activationFunction, alpha, beta);
-
-	CvANN_MLP_TrainParams params;
-	params.term_crit = cvTermCriteria(CV_TERMCRIT_ITER | CV_TERMCRIT_EPS, 1000, 0.001);
-	mlp->train(trainSamples, trainOutputs, sampleWeights, 0, params);
-	cvReleaseMat(&trainSamples);
-	cvReleaseMat(&trainOutputs);
-	cvReleaseMat(&sampleWeights);
-	cvReleaseMat(&layers);
+	mlp = new NeuralNetwork();
+	mlp->Create(layers, functionType, alpha, beta);
+	mlp->method = method;
+	mlp->maxEpochs = maxEpochs;
+	mlp->batchSize = batchSize;
+	mlp->learningRate = learningRate;
+	mlp->Train(&trainSamples[0], &trainOutputs[0], sampleCnt);
 }
 
 fvec RegressorMLP::Test( const fvec &sample)
@@ -90,18 +71,37 @@ fvec RegressorMLP::Test( const fvec &sample)
 	fvec res;
 	res.resize(2);
 	if(!mlp) return res;
-	float *_input = new float[dim];
-	FOR(d, sample.size()) _input[d] = sample[d];
-	for(int d=sample.size(); d<dim; d++) _input[d] = 0;
-	CvMat input = cvMat(1,dim,CV_32FC1, _input);
-	float _output[1];
-	CvMat output = cvMat(1,1,CV_32FC1, _output);
-	mlp->predict(&input, &output);
-	res[0] = _output[0];
-	delete [] _input;
+	if(sample.size() >= dim) mlp->Predict(&sample[0], &res[0]);
+	else
+	{
+		fvec input(dim, 0);
+		FOR(d, sample.size()) input[d] = sample[d];
+		mlp->Predict(&input[0], &res[0]);
+	}
 	return res;
 }
 
+void RegressorMLP::TestBatch(const float *samples, float *outputs, int count, int dim)
+{
+	if(!mlp)
+	{
+		FOR(i, count) outputs[i] = 0;
+		return;
+	}
+	if(dim == this->dim)
+	{
+		mlp->Predict(samples, count, outputs);
+		return;
+	}
+	// the samples usually carry their target in the last dimension: they are cut (or padded) to the inputs
+	fvec inputs(count*this->dim, 0);
+	FOR(i, count)
+	{
+		FOR(d, min(dim, (int)this->dim)) inputs[i*this->dim + d] = samples[i*dim + d];
+	}
+	mlp->Predict(&inputs[0], count, outputs);
+}
+
 void RegressorMLP::SetParams(u32 functionType, u32 neuronCount, u32 layerCount, f32 alpha, f32 beta)
 {
 	this->functionType = functionType;
@@ -112,6 +112,14 @@ void RegressorMLP::SetParams(u32 functionType, u32 neuronCount, u32 layerCount,
 }
 
 
+void RegressorMLP::SetTrainingParams(int method, int maxEpochs, int batchSize, float learningRate)
+{
+	this->method = method;
+	this->maxEpochs = maxEpochs;
+	this->batchSize = batchSize;
+	this->learningRate = learningRate;
+}
+
 char *RegressorMLP::GetInfoString()
 {
 	char *text = new char[1024];
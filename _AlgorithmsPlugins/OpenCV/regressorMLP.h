@@ -21,7 +21,7 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 
 #include <vector>
 #include "regressor.h"
-#include "basicOpenCV.h"
+#include "neuralNetwork.h"
 
 class RegressorMLP : public Regressor
 {
@@ -30,15 +30,19 @@ private:
 	u32 neuronCount;
 	u32 layerCount;
 	float alpha, beta;
-	CvANN_MLP *mlp;
+	int method, maxEpochs, batchSize;
+	float learningRate;
+	NeuralNetwork *mlp;
 public:
 	RegressorMLP();
 	~RegressorMLP();
 	void Train(std::vector< fvec > samples, ivec labels);
 	fvec Test( const fvec &sample);
+	void TestBatch(const float *samples, float *outputs, int count, int dim);
 	char *GetInfoString();
 
 	void SetParams(u32 functionType, u32 neuronCount, u32 layerCount, f32 alpha, f32 beta);
+	void SetTrainingParams(int method, int maxEpochs, int batchSize, float learningRate);
 };
 
 #endif // _REGRESSOR_MLP_H_
@@ -0,0 +1,8 @@
+# ##########################
+# Configuration      #
+# ##########################
+NAME = benchProjections
+PLUGIN = mld_Projections
+MLPATH =../..
+
+include($$MLPATH/MLBench/benchPlugin.pri)
@@ -22,51 +22,156 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include "classifierLinear.h"
 #include "JnS/Matutil.h"
 #include "JnS/JnS.h"
+#include <Eigen/Dense>
 #include <QDebug>
 
 using namespace std;
+using namespace Eigen;
+
+// samples are accumulated by blocks, stored one dimension per row so that each covariance entry is a contiguous dot product
+#define COVARIANCE_BLOCK 256
+// number of samples copied at once when streaming over the dataset
+#define STREAMING_CHUNK 4096
+// jade builds the full fourth-order cumulant tensor (dim^4), above this we use shibbs (dim^3)
+#define JADE_MAX_DIM 16
+
+// adds the centered outer products of up to COVARIANCE_BLOCK samples to scatter (upper triangle only)
+// block is a dim x COVARIANCE_BLOCK buffer
+static void AccumulateScatter(const float *data, int size, int dim, const double *mean, double *block, double *scatter)
+{
+	FOR(i, size)
+	{
+		const float *x = data + i*dim;
+		FOR(d, dim) block[d*COVARIANCE_BLOCK + i] = x[d] - mean[d];
+	}
+	FOR(d, dim)
+	{
+		const double *a = block + d*COVARIANCE_BLOCK;
+		for(int e=d; e<dim; e++)
+		{
+			const double *c = block + e*COVARIANCE_BLOCK;
+			double sum = 0;
+			for(int i=0; i<size; i++) sum += a[i]*c[i];
+			scatter[d*dim + e] += sum;
+		}
+	}
+}
 
-void ClassifierLinear::Train( std::vector< fvec > samples, ivec labels )
+void CovarianceAccumulator::Add(const float *data, int count)
 {
-	if(!samples.size()) return;
+	if(!count) return;
+	// mean and scatter of the chunk, then merged with the running values
+	CovarianceAccumulator chunk(dim);
+	chunk.count = count;
+	FOR(i, count) FOR(d, dim) chunk.mean[d] += data[i*dim + d];
+	FOR(d, dim) chunk.mean[d] /= count;
+	std::vector<double> block(dim*COVARIANCE_BLOCK);
+	for(int start=0; start<count; start+=COVARIANCE_BLOCK)
+	{
+		AccumulateScatter(data + start*dim, min(COVARIANCE_BLOCK, count-start), dim, &chunk.mean[0], &block[0], &chunk.scatter[0]);
+	}
+	Merge(chunk);
+}
 
-	switch(linearType)
+void CovarianceAccumulator::Merge(const CovarianceAccumulator &other)
+{
+	if(!other.count) return;
+	if(!count)
 	{
-	case 0:
-		TrainPCA(samples, labels);
-		break;
-	case 1:
-		TrainLDA(samples, labels, false);
-		break;
-	case 2:
-		TrainLDA(samples, labels);
-		break;
-	case 3:
-		TrainICA(samples, labels);
-		break;
+		*this = other;
+		return;
 	}
+	double total = count + other.count;
+	double weight = count*other.count/total;
+	std::vector<double> delta(dim);
+	FOR(d, dim) delta[d] = other.mean[d] - mean[d];
+	FOR(d, dim)
+	{
+		for(int e=d; e<dim; e++) scatter[d*dim + e] += other.scatter[d*dim + e] + weight*delta[d]*delta[e];
+	}
+	FOR(d, dim) mean[d] += delta[d]*other.count/total;
+	count = total;
+}
 
-	vector<fvec> projected; projected.resize(samples.size());
-	FOR(i, samples.size())
+void CovarianceAccumulator::GetCovariance(std::vector<double> &covar) const
+{
+	covar.assign(dim*dim, 0);
+	if(!count) return;
+	FOR(d, dim)
 	{
-		projected[i] = Project(samples[i]);
+		for(int e=d; e<dim; e++)
+		{
+			covar[d*dim + e] = covar[e*dim + d] = scatter[d*dim + e] / count;
+		}
 	}
+}
 
-	int dim = samples[0].size();
-	meanPos.resize(dim,0);
-	meanNeg.resize(dim,0);
-	int cntPos=0, cntNeg=0;
-	FOR(i, samples.size())
+static fvec SampleMean(const float *data, int count, int dim)
+{
+	std::vector<double> sum(dim, 0);
+	FOR(i, count)
+	{
+		const float *x = data + i*dim;
+		FOR(d, dim) sum[d] += x[d];
+	}
+	fvec mean(dim, 0);
+	if(count) FOR(d, dim) mean[d] = (float)(sum[d] / count);
+	return mean;
+}
+
+void ClassifierLinear::Train( std::vector< fvec > samples, ivec labels )
+{
+	if(!samples.size()) return;
+
+	if(TrainInPlace(samples, labels, ivec())) return;
+
+	dim = samples[0].size();
+	int count = samples.size();
+
+	// the contiguous copy is released before the class means are computed
 	{
-		if(labels[i]==1)
+		fvec data(count*dim);
+		FOR(i, count) FOR(d, dim) data[i*dim + d] = samples[i][d];
+
+		switch(linearType)
 		{
-			FOR(d,dim) meanPos[d] += projected[i][d];
-			cntPos++;
+		case 0:
+			TrainPCA(data, labels);
+			break;
+		case 1:
+			TrainLDA(data, labels, false);
+			break;
+		case 2:
+			TrainLDA(data, labels);
+			break;
+		case 3:
+			TrainICA(data, labels);
+			break;
 		}
-		else
+	}
+
+	// class means in the projected space, computed by chunks
+	meanPos.assign(dim,0);
+	meanNeg.assign(dim,0);
+	int cntPos=0, cntNeg=0;
+	fvec chunk(min(count, STREAMING_CHUNK)*dim), projected(chunk.size());
+	for(int start=0; start<count; start+=STREAMING_CHUNK)
+	{
+		int size = min(STREAMING_CHUNK, count-start);
+		FOR(i, size) FOR(d, dim) chunk[i*dim + d] = samples[start+i][d];
+		Project(&chunk[0], size, &projected[0]);
+		FOR(i, size)
 		{
-			FOR(d,dim) meanNeg[d] += projected[i][d];
-			cntNeg++;
+			if(labels[start+i]==1)
+			{
+				FOR(d,dim) meanPos[d] += projected[i*dim + d];
+				cntPos++;
+			}
+			else
+			{
+				FOR(d,dim) meanNeg[d] += projected[i*dim + d];
+				cntNeg++;
+			}
 		}
 	}
 	FOR(d,dim)
@@ -75,13 +180,30 @@ void ClassifierLinear::Train( std::vector< fvec > samples, ivec labels )
 		if(cntNeg) meanNeg[d] /= cntNeg;
 	}
 	bUsesDrawTimer = false;
+	SetResponseRange(samples, ivec());
+}
+
+bool ClassifierLinear::TrainInPlace(const std::vector< fvec > &samples, const ivec &labels, const ivec &indices)
+{
+	if(linearType != 6) return false;
+	if(!samples.size()) return true;
+	dim = samples[0].size();
+	TrainStreamingPCA(samples, labels, indices);
+	bUsesDrawTimer = false;
+	SetResponseRange(samples, indices);
+	return true;
+}
+
+void ClassifierLinear::SetResponseRange(const std::vector< fvec > &samples, const ivec &indices)
+{
 	minResponse = FLT_MAX;
 	maxResponse = -FLT_MAX;
 	float minResp = FLT_MAX;
 	float maxResp = -FLT_MAX;
-	FOR(i, samples.size())
+	int count = indices.size() ? indices.size() : samples.size();
+	FOR(i, count)
 	{
-		float response = Test(samples[i]);
+		float response = Test(samples[indices.size() ? indices[i] : i]);
 		if(minResp > response) minResp = response;
 		if(maxResp < response) maxResp = response;
 	}
@@ -97,10 +219,11 @@ void ClassifierLinear::Train( std::vector< fvec > samples, ivec labels )
 float ClassifierLinear::Test(const fvec &sample )
 {
 	float response = 0;
-	if(linearType < 3) // pca, lda, fisher
+	if(IsDirectional()) // pca, lda, fisher
 	{
-		fVec point(sample[0] - meanAll[0], sample[1] - meanAll[1]);
-		float estimate = W*point;
+		float estimate = 0;
+		int sampleDim = min((u32)sample.size(), (u32)W.size());
+		FOR(d, sampleDim) estimate += W[d]*(sample[d] - meanAll[d]);
 		response = -(estimate - threshold);
 	}
 	else
@@ -144,356 +267,358 @@ char *ClassifierLinear::GetInfoString()
 	case 3:
 		sprintf(text, "%sICA\n", text);
 		break;
+	case 6:
+		sprintf(text, "%sStreaming PCA\n", text);
+		break;
 	default:
 		sprintf(text, "%sNaive Bayes\n", text);
 		break;
 	}
-	if(linearType == 3) // ica
+	// we only show the first few dimensions
+	int shown = min((int)dim, 6);
+	if(linearType == 3 && Transf) // ica
 	{
-		sprintf(text, "%sUnmixing matrix:\n\t%.3f %.3f\n\t%.3f %.3f", text, Transf[0], Transf[1], Transf[2], Transf[3]);
+		sprintf(text, "%sUnmixing matrix:\n", text);
+		FOR(i, shown)
+		{
+			sprintf(text, "%s\t", text);
+			FOR(j, shown) sprintf(text, "%s%.3f ", text, Transf[i*dim + j]);
+			sprintf(text, "%s%s\n", text, shown < (int)dim ? "..." : "");
+		}
 	}
-	else if(linearType < 3)
+	else if(IsDirectional())
 	{
-		sprintf(text, "%sProjection Direction:\n\t%.3f %.3f\n", text, W.x, W.y);
+		sprintf(text, "%sProjection Direction:\n\t", text);
+		FOR(d, min(shown, (int)W.size())) sprintf(text, "%s%.3f ", text, W[d]);
+		sprintf(text, "%s%s\n", text, shown < (int)dim ? "..." : "");
 	}
 	return text;
 }
 
-void Invert(double *sigma, double *invSigma)
-{
-	double det = sigma[0]*sigma[3] - sigma[1]*sigma[2];
-	if(det == 0) return; // non inversible
-	invSigma[0] = sigma[3] / det;
-	invSigma[1] = -sigma[1] / det;
-	invSigma[2] = -sigma[2] / det;
-	invSigma[3] = sigma[0] / det;
-}
-
 fvec ClassifierLinear::InvProject(const fvec &sample)
 {
 	fvec newSample = sample;
-	if(linearType == 3) // ica
-	{
-		if(!Transf) return newSample;
-		double iTransf[4];
-		Invert(Transf, iTransf);
-		double *Data = new double[2];
-		Data[0] = sample[0];
-		Data[1] = sample[1];
-		//                Data[0] = sample[0]-meanPos[0];
-		//                Data[1] = sample[1]-meanPos[1];
-		Transform (Data, iTransf, 2, 1);
-		newSample[0] = Data[0]+meanPos[0];
-		newSample[1] = Data[1]+meanPos[1];
-	}
+	if(linearType != 3 || !Transf || sample.size() != dim) return newSample;
+	InvProject(&sample[0], 1, &newSample[0]);
 	return newSample;
 }
 
-fvec ClassifierLinear::Project(const fvec &sample)
+void ClassifierLinear::InvProject(const float *samples, int count, float *result) const
 {
-	fvec newSample = sample;
-	if(linearType == 3) // ica
+	if(linearType != 3 || !Transf || invTransf.size() != dim*dim)
 	{
-		if(!Transf) return newSample;
-		double *Data = new double[2];
-		Data[0] = sample[0]-meanAll[0];
-		Data[1] = sample[1]-meanAll[1];
-		Transform (Data, Transf, 2, 1);
-		newSample[0] = Data[0];
-		newSample[1] = Data[1];
-		//		newSample[0] = Data[0]+meanPos[0];
-		//		newSample[1] = Data[1]+meanPos[1];
+		if(result != samples) FOR(i, count*dim) result[i] = samples[i];
+		return;
 	}
-	else if(linearType < 3) // pca, lda, fisher
+#ifdef _OPENMP
+#pragma omp parallel if(count*dim*dim > 65536)
+#endif
 	{
-		fVec mean(meanAll[0], meanAll[1]);
-		fVec point(sample[0], sample[1]);
-		float dot = W*(point-mean);
-		fVec proj(dot*W.x, dot*W.y);
-		//proj += cvVec2(.5f,.5f);
-		proj += mean;
-		newSample[0] = proj.x;
-		newSample[1] = proj.y;
+		std::vector<double> x(dim);
+#ifdef _OPENMP
+#pragma omp for
+#endif
+		for(int i=0; i<count; i++)
+		{
+			const float *y = samples + i*dim;
+			float *out = result + i*dim;
+			FOR(d, dim) x[d] = y[d];
+			FOR(d, dim)
+			{
+				double sum = 0;
+				FOR(j, dim) sum += invTransf[d + j*dim]*x[j];
+				out[d] = (float)sum + meanPos[d];
+			}
+		}
 	}
-	return newSample;
 }
 
-void ClassifierLinear::SetParams( u32 linearType )
+fvec ClassifierLinear::Project(const fvec &sample)
 {
-	this->linearType = linearType;
-	if(linearType == 1 || linearType == 2) bSingleClass = false;
-	else bSingleClass = true;
+	fvec newSample = sample;
+	if((linearType > 3 && !IsDirectional()) || !meanAll.size()) return newSample;
+	if(linearType == 3 && !Transf) return newSample;
+	// missing dimensions are taken at the mean, extra ones are left untouched
+	fvec x = meanAll;
+	FOR(d, min((u32)sample.size(), dim)) x[d] = sample[d];
+	fvec projected(dim);
+	Project(&x[0], 1, &projected[0]);
+	FOR(d, min((u32)sample.size(), dim)) newSample[d] = projected[d];
+	return newSample;
 }
 
-void ClassifierLinear::TrainPCA(std::vector< fvec > samples, const ivec &labels)
+void ClassifierLinear::Project(const float *samples, int count, float *projected) const
 {
-	u32 dim = 2;
-
-	meanAll.resize(dim,0);
-	float **sigma = NULL;
-
-	FOR(i, samples.size())
+	if(linearType == 3 && Transf) // ica
 	{
-		meanAll += samples[i];
+#ifdef _OPENMP
+#pragma omp parallel if(count*dim*dim > 65536)
+#endif
+		{
+			std::vector<double> x(dim);
+#ifdef _OPENMP
+#pragma omp for
+#endif
+			for(int i=0; i<count; i++)
+			{
+				const float *sample = samples + i*dim;
+				float *out = projected + i*dim;
+				FOR(d, dim) x[d] = sample[d] - meanAll[d];
+				FOR(d, dim)
+				{
+					double sum = 0;
+					FOR(j, dim) sum += Transf[d + j*dim]*x[j];
+					out[d] = (float)sum;
+				}
+			}
+		}
 	}
-	meanAll /= samples.size();
-
-	fvec mean;
-	mean.resize(dim,0);
-
-	// we want zero mean samples
-	FOR(i, samples.size()) samples[i] -= meanAll;
-
-	GetCovariance(samples, mean, &sigma);
-
-	float invSigma1[2][2] = {{sigma[1][1],-sigma[0][1]},{-sigma[0][1],sigma[0][0]}};
-	FOR(i,2)
+	else if(IsDirectional() && W.size() == dim) // pca, lda, fisher
 	{
-		FOR(j,2)
+#ifdef _OPENMP
+#pragma omp parallel for if(count*dim > 65536)
+#endif
+		for(int i=0; i<count; i++)
 		{
-			invSigma1[i][j] /= sigma[0][0]*sigma[1][1] - sigma[0][1]*sigma[1][0];
+			const float *sample = samples + i*dim;
+			float *out = projected + i*dim;
+			float dot = 0;
+			FOR(d, dim) dot += W[d]*(sample[d] - meanAll[d]);
+			FOR(d, dim) out[d] = meanAll[d] + dot*W[d];
 		}
 	}
-
-	float determinant = (invSigma1[1][1]+invSigma1[0][0])*(invSigma1[1][1]+invSigma1[0][0])-4.0f*(invSigma1[0][0]*invSigma1[1][1]-invSigma1[1][0]*invSigma1[0][1]);
-	float eigenvalue1, eigenvalue2;
-	if (determinant > 0){
-		eigenvalue1 = (invSigma1[1][1] + invSigma1[0][0] + sqrtf(determinant)) / 2.0f;
-		eigenvalue2 = (invSigma1[1][1] + invSigma1[0][0] - sqrtf(determinant)) / 2.0f;
-	}else{
-		printf("determinant is not positive during calculation of eigenvalues !!");
-		return;
-	}
-	fVec e1, e2, tmp;
-
-	if(invSigma1[0][0] - eigenvalue1 != 0)
-		e1.x = -invSigma1[0][1]/(invSigma1[0][0]-eigenvalue1);
-	else e1.x = 0;
-	e1.y = 1.0;
-
-	if(invSigma1[0][0] - eigenvalue2 != 0)
-		e2.x = -invSigma1[0][1]/(invSigma1[0][0]-eigenvalue2);
-	else e2.x = 0;
-	e2.y = 1.0;
-
-	// swap the eigens
-	if (eigenvalue1 < eigenvalue2)
+	else if(projected != samples)
 	{
-		fVec tmp = e1;
-		e1 = e2;
-		e2 = tmp;
-		float lambda = eigenvalue1;
-		eigenvalue1 = eigenvalue2;
-		eigenvalue2 = lambda;
+		FOR(i, count*dim) projected[i] = samples[i];
 	}
+}
 
-	e1=e1.normalize();
-	e2=e2.normalize();
+void ClassifierLinear::SetParams( u32 linearType )
+{
+	this->linearType = linearType;
+	if(linearType == 1 || linearType == 2) bSingleClass = false;
+	else bSingleClass = true;
+}
 
-	W = e2;
-	if(W.x < 0) W *= -1;
+void ClassifierLinear::TrainPCA(const fvec &data, const ivec &labels)
+{
+	int count = data.size() / dim;
+	meanAll = SampleMean(&data[0], count, dim);
 
-	W = W.normalize();
+	std::vector<double> sigma;
+	GetCovariance(&data[0], count, meanAll, sigma);
 
-	KILL(sigma);
+	SetPrincipalComponents(sigma);
+}
 
-	float threshold = 0;
-	bool inverted = false;
-	// we do the actual classification
-	u32 steps = 1000;
-	u32 minError = samples.size();
-	for( int c=0; c<steps; c++)
-	{
-		u32 error = 0;
-		u32 negError = 0;
-		float thresh = 1.f / steps * c;
-		FOR(i, samples.size())
+void ClassifierLinear::TrainStreamingPCA(const std::vector< fvec > &samples, const ivec &labels, const ivec &indices)
+{
+	int count = indices.size() ? indices.size() : samples.size();
+	int chunks = (count + STREAMING_CHUNK-1) / STREAMING_CHUNK;
+	// each thread accumulates its own chunks, the partial results are merged at the end
+	CovarianceAccumulator total(dim);
+	std::vector<double> sumPos(dim, 0), sumNeg(dim, 0);
+	int cntPos = 0, cntNeg = 0;
+#ifdef _OPENMP
+#pragma omp parallel if(chunks > 1)
+#endif
+	{
+		CovarianceAccumulator local(dim);
+		std::vector<double> localPos(dim, 0), localNeg(dim, 0);
+		int localCntPos = 0, localCntNeg = 0;
+		fvec chunk(min(count, STREAMING_CHUNK)*dim);
+#ifdef _OPENMP
+#pragma omp for nowait
+#endif
+		for(int c=0; c<chunks; c++)
 		{
-			fVec point(samples[i][0], samples[i][1]);
-			float estimate = W*point;
-			if(labels[i])
-			{
-				if (estimate < thresh) error++;
-				else negError++;
-			}
-			else
+			int start = c*STREAMING_CHUNK;
+			int size = min(STREAMING_CHUNK, count-start);
+			FOR(i, size)
 			{
-				if (estimate >= thresh) error++;
-				else negError++;
+				int index = indices.size() ? indices[start+i] : start+i;
+				float *x = &chunk[i*dim];
+				FOR(d, dim) x[d] = samples[index][d];
+				if(labels[index] == 1)
+				{
+					FOR(d, dim) localPos[d] += x[d];
+					localCntPos++;
+				}
+				else
+				{
+					FOR(d, dim) localNeg[d] += x[d];
+					localCntNeg++;
+				}
 			}
+			local.Add(&chunk[0], size);
 		}
-		if(minError > min(negError, error))
+#ifdef _OPENMP
+#pragma omp critical
+#endif
 		{
-			inverted = negError > error;
-			minError = min(negError, error);
-			threshold = thresh;
+			total.Merge(local);
+			FOR(d, dim)
+			{
+				sumPos[d] += localPos[d];
+				sumNeg[d] += localNeg[d];
+			}
+			cntPos += localCntPos;
+			cntNeg += localCntNeg;
 		}
 	}
+	meanAll.resize(dim);
+	FOR(d, dim) meanAll[d] = (float)total.mean[d];
+	std::vector<double> sigma;
+	total.GetCovariance(sigma);
+	SetPrincipalComponents(sigma);
 
-	float error = minError / (f32)samples.size();
+	// the projection is affine, the class means in projected space are the projections of the class means
+	fvec means(2*dim), projected(2*dim);
+	FOR(d, dim)
+	{
+		means[d] = cntPos ? (float)(sumPos[d] / cntPos) : 0.f;
+		means[dim+d] = cntNeg ? (float)(sumNeg[d] / cntNeg) : 0.f;
+	}
+	Project(&means[0], 2, &projected[0]);
+	meanPos.assign(dim, 0);
+	meanNeg.assign(dim, 0);
+	if(cntPos) meanPos.assign(projected.begin(), projected.begin() + dim);
+	if(cntNeg) meanNeg.assign(projected.begin() + dim, projected.end());
 }
 
-void ClassifierLinear::TrainLDA(std::vector< fvec > samples, const ivec &labels, bool bFisher)
+void ClassifierLinear::SetPrincipalComponents(std::vector<double> &sigma)
 {
-	// we reduce the problem to a one vs many classification
-	u32 dim = 2;
-
-	meanAll.resize(dim,0);
-	FOR(i, samples.size()) meanAll += samples[i];
-	meanAll /= samples.size();
-	FOR(i, samples.size()) samples[i] -= meanAll;
-
-	vector<fvec> positives, negatives;
-	FOR(i, samples.size())
+	// eigen returns the eigenvalues in increasing order
+	SelfAdjointEigenSolver<MatrixXd> solver(Map<MatrixXd>(&sigma[0], dim, dim));
+	eigenValues.resize(dim);
+	eigenVectors.resize(dim);
+	FOR(i, dim)
 	{
-		if(labels[i]==1) positives.push_back(samples[i]);
-		else negatives.push_back(samples[i]);
+		int index = dim-1-i;
+		eigenValues[i] = (float)solver.eigenvalues()(index);
+		eigenVectors[i].resize(dim);
+		FOR(d, dim) eigenVectors[i][d] = (float)solver.eigenvectors()(d, index);
 	}
 
-	fvec mean1, mean2;
-	mean1.resize(dim,0);
-	mean2.resize(dim,0);
-	float **sigma1 = NULL;
-	float **sigma2 = NULL;
+	W = eigenVectors[0];
+	if(W[0] < 0) W *= -1;
+}
 
-	FOR(i, positives.size())
-	{
-		FOR(j,dim)
-		{
-			mean1[j] += positives[i][j];
-		}
-	}
-	mean1 /= (float)positives.size();
+void ClassifierLinear::TrainLDA(const fvec &data, const ivec &labels, bool bFisher)
+{
+	// we reduce the problem to a one vs many classification
+	int count = data.size() / dim;
+	meanAll = SampleMean(&data[0], count, dim);
 
-	FOR(i, negatives.size())
+	fvec positives, negatives;
+	positives.reserve(data.size());
+	FOR(i, count)
 	{
-		FOR(j,dim)
-		{
-			mean2[j] += negatives[i][j];
-		}
+		fvec &target = labels[i]==1 ? positives : negatives;
+		target.insert(target.end(), data.begin() + i*dim, data.begin() + (i+1)*dim);
 	}
-	mean2 /= (float)negatives.size();
+	int posCount = positives.size() / dim, negCount = negatives.size() / dim;
+	W.assign(dim, 0);
+	W[0] = 1;
+	if(!posCount || !negCount) return;
 
-	if(bFisher)
-	{
-		GetCovariance(positives, mean1, &sigma1);
-		GetCovariance(negatives, mean2, &sigma2);
-	}
-	else
-	{
-		vector<fvec> posnegs;
-		FOR(i, positives.size()) posnegs.push_back(positives[i] - mean1);
-		FOR(i, negatives.size()) posnegs.push_back(negatives[i] - mean2);
-		fvec zero;
-		zero.resize(dim,0);
-		GetCovariance(posnegs, zero, &sigma1);
-		sigma2 = sigma1;
-	}
+	fvec mean1 = SampleMean(&positives[0], posCount, dim);
+	fvec mean2 = SampleMean(&negatives[0], negCount, dim);
 
-	float sigma[2][2] = {{sigma1[0][0]+sigma2[0][0], sigma1[0][1]+sigma2[0][1]},{sigma1[1][0]+sigma2[1][0], sigma1[1][1]+sigma2[1][1]}};
-	float invSigma[2][2] = {{sigma[1][1],-sigma[1][0]},{-sigma[0][1],sigma[0][0]}};
-	FOR(i,2)
+	std::vector<double> sigma1, sigma2;
+	GetCovariance(&positives[0], posCount, mean1, sigma1);
+	GetCovariance(&negatives[0], negCount, mean2, sigma2);
+
+	MatrixXd sigma(dim, dim);
+	FOR(i, dim)
 	{
-		FOR(j,2)
+		FOR(j, dim)
 		{
-			invSigma[i][j] /= sigma[0][0]*sigma[1][1] - sigma[0][1]*sigma[1][0];
+			if(bFisher) sigma(i,j) = sigma1[i*dim + j] + sigma2[i*dim + j];
+			else sigma(i,j) = 2*(sigma1[i*dim + j]*posCount + sigma2[i*dim + j]*negCount) / count; // pooled covariance
 		}
 	}
-
-	float dM[2] = {mean2[0] - mean1[0],mean2[1] - mean1[1]};
-	float w[2] = { invSigma[0][0]*dM[0] + invSigma[0][1]*dM[1] , invSigma[1][0]*dM[0] + invSigma[1][1]*dM[1] };
-
-	float n = sqrtf(w[0]*w[0] + w[1]*w[1]);
-	w[0] /= n; w[1] /= n;
-
-	float c = w[0]*(mean1[0]+mean2[0])/2 + w[0]*(mean1[1]+mean2[1])/2;
-	W = fVec(w[0], w[1]);
-	W = W.normalize();
-
-	if(sigma1 == sigma2)
-	{
-		KILL(sigma1);
-	}
-	else
-	{
-		KILL(sigma1);
-		KILL(sigma2);
-	}
+	// a small ridge keeps the system solvable when the samples do not span every dimension
+	double ridge = sigma.trace() / dim * 1e-6;
+	if(ridge <= 0) ridge = 1e-6;
+	FOR(i, dim) sigma(i,i) += ridge;
+
+	VectorXd dM(dim);
+	FOR(d, dim) dM(d) = mean2[d] - mean1[d];
+	VectorXd w = sigma.ldlt().solve(dM);
+	double n = w.norm();
+	if(n == 0 || n != n) return;
+	FOR(d, dim) W[d] = (float)(w(d) / n);
 }
 
-void ClassifierLinear::GetCovariance(const vector<fvec> &samples, const fvec &mean, float ***covar)
+void ClassifierLinear::GetCovariance(const float *data, int count, const fvec &mean, std::vector<double> &covar)
 {
 	int dim = mean.size();
-	float **cov = (*covar);
-	if(!cov)
-	{
-		cov = new float*[dim];
-		FOR(i, dim) cov[i] = new float[dim];
-		(*covar) = cov;
+	covar.assign(dim*dim, 0);
+	if(!count) return;
+	int blocks = (count + COVARIANCE_BLOCK-1) / COVARIANCE_BLOCK;
+	std::vector<double> center(mean.begin(), mean.end());
+#ifdef _OPENMP
+#pragma omp parallel if(count*dim*dim > 65536)
+#endif
+	{
+		std::vector<double> local(dim*dim, 0), block(dim*COVARIANCE_BLOCK);
+#ifdef _OPENMP
+#pragma omp for nowait
+#endif
+		for(int b=0; b<blocks; b++)
+		{
+			int start = b*COVARIANCE_BLOCK;
+			AccumulateScatter(data + start*dim, min(COVARIANCE_BLOCK, count - start), dim, &center[0], &block[0], &local[0]);
+		}
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+		{
+			FOR(i, dim*dim) covar[i] += local[i];
+		}
 	}
-	FOR(i, dim)
+	FOR(d, dim)
 	{
-		FOR(j,dim)
+		for(int e=d; e<dim; e++)
 		{
-			cov[i][j] = 0;
+			covar[d*dim + e] /= count;
+			covar[e*dim + d] = covar[d*dim + e];
 		}
 	}
-
-	for (u32 i=0;i<samples.size();i++){
-		float dX = samples[i][0] - mean[0];
-		float dY = samples[i][1] - mean[1];
-		cov[0][0] += dX*dX;
-		cov[1][1] += dY*dY;
-		cov[0][1] += dX*dY;
-	}
-	cov[0][0] /= (float)samples.size();
-	cov[1][1] /= (float)samples.size();
-	cov[0][1] /= (float)samples.size();
-	cov[1][0] = cov[0][1];
 }
 
-void ClassifierLinear::TrainICA(std::vector< fvec > samples, const ivec &labels )
+void ClassifierLinear::TrainICA(const fvec &data, const ivec &labels )
 {
-	u32 dim = 2;
-	meanAll.resize(dim,0);
-	float **sigma = NULL;
-	FOR(i, samples.size())
-	{
-		meanAll += samples[i];
-	}
-	meanAll /= samples.size();
-
-	const int nbsensors = samples[0].size();
-	const int nbsamples = samples.size(); 
+	const int nbsensors = dim;
+	const int nbsamples = data.size() / dim;
+	meanAll = SampleMean(&data[0], nbsamples, dim);
 
-	if(!Transf)
-	{
-		if ((Transf = (double *) calloc(nbsensors*nbsensors, sizeof(double))) == NULL) OutOfMemory() ;
-	}
-	double *Data, *Mixing, *Global;
+	if(Transf) free(Transf);
+	if ((Transf = (double *) calloc(nbsensors*nbsensors, sizeof(double))) == NULL) OutOfMemory() ;
+	double *Data;
 	if ((Data   = (double *) calloc(nbsensors*nbsamples, sizeof(double))) == NULL) OutOfMemory() ;
-	if ((Mixing = (double *) calloc(nbsensors*nbsensors, sizeof(double))) == NULL) OutOfMemory() ;
-	if ((Global = (double *) calloc(nbsensors*nbsensors, sizeof(double))) == NULL) OutOfMemory() ;
 
-	FOR(i, samples.size())
+	FOR(i, nbsamples)
 	{
-		Data[i*nbsensors + 0] = samples[i][0] - meanAll[0];
-		Data[i*nbsensors + 1] = samples[i][1] - meanAll[1];
-
-		//		Data[i*nbsensors + 0] = rand()/(float)RAND_MAX/5.;
-		//		Data[i*nbsensors + 1] = 1 - rand()/(float)RAND_MAX/5.;
+		FOR(d, nbsensors) Data[i*nbsensors + d] = data[i*nbsensors + d] - meanAll[d];
 	}
 
-	Identity(Mixing, nbsensors) ;   Mixing[0] = 2.0 ;
-	Jade(Transf, Data, nbsensors, nbsamples ) ; 
-	//Shibbs(Transf, Data, nbsensors, nbsamples ) ;
+	if(nbsensors <= JADE_MAX_DIM) Jade(Transf, Data, nbsensors, nbsamples ) ;
+	else Shibbs(Transf, Data, nbsensors, nbsamples ) ;
 
 	FOR(i,nbsensors*nbsensors) Transf[i] /= 10;
 
 	free(Data);
-	//	free(Transf);  
-	free(Mixing);
-	free(Global);
 
-	W = fVec(Transf[0], Transf[2]);
+	// the mixing matrix is kept for the inverse projection
+	Map<MatrixXd> unmixing(Transf, nbsensors, nbsensors);
+	invTransf.resize(nbsensors*nbsensors);
+	Map<MatrixXd> mixing(&invTransf[0], nbsensors, nbsensors);
+	FullPivLU<MatrixXd> lu(unmixing);
+	if(lu.isInvertible()) mixing = lu.inverse();
+	else mixing.setIdentity();
+
+	W.resize(dim);
+	FOR(d, dim) W[d] = Transf[d*nbsensors];
 }
@@ -24,6 +24,42 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include "classifier.h"
 #include "basicMath.h"
 
+/**
+ * @brief Mean and covariance accumulated in a single pass over chunks of samples
+ *
+ * Accumulators filled on separate threads (or separate parts of a dataset) can be merged
+ * using the pairwise update of Chan et al., so the samples never need to be in memory at once
+ */
+class CovarianceAccumulator
+{
+public:
+	int dim; /**< dimension of the samples */
+	double count; /**< number of accumulated samples */
+	std::vector<double> mean; /**< running mean (dim) */
+	std::vector<double> scatter; /**< sum of the centered outer products (dim x dim, row-major) */
+
+	CovarianceAccumulator(int dim=0) : dim(dim), count(0), mean(dim, 0), scatter(dim*dim, 0) {};
+	/**
+	 * @brief Add a chunk of samples
+	 *
+	 * @param data samples, stored contiguously (count x dim)
+	 * @param count number of samples
+	 */
+	void Add(const float *data, int count);
+	/**
+	 * @brief Merge the samples accumulated by another accumulator into this one
+	 *
+	 * @param other
+	 */
+	void Merge(const CovarianceAccumulator &other);
+	/**
+	 * @brief Get the covariance of the accumulated samples
+	 *
+	 * @param covar output covariance (dim x dim, row-major)
+	 */
+	void GetCovariance(std::vector<double> &covar) const;
+};
+
 /**
  * @brief Linear Projections with Naive Bayes Classification
  *
@@ -33,41 +69,73 @@ class ClassifierLinear : public Classifier
 private:
 	fvec meanAll, meanPos, meanNeg; /**< TODO */
 	int linearType; /**< TODO */
-	fVec W; /**< TODO */
+	fvec W; /**< projection direction (dim) */
 	int threshold; /**< TODO */
-	double* Transf; /**< TODO */
+	double* Transf; /**< ICA unmixing matrix (dim x dim, column-major) */
+	std::vector<double> invTransf; /**< ICA mixing matrix (dim x dim, column-major) */
+	fvec eigenValues; /**< PCA eigenvalues, in decreasing order */
+	std::vector<fvec> eigenVectors; /**< PCA principal directions, same order as eigenValues */
 	float minResponse, maxResponse;
 
 	/**
-	 * @brief Take the input samples and return its mean and covariance
+	 * @brief Compute the covariance of the input samples around the given mean
 	 *
-	 * @param samples
+	 * @param data samples, stored contiguously (count x dim)
+	 * @param count number of samples
 	 * @param mean
-	 * @param covar
+	 * @param covar output covariance (dim x dim, row-major)
 	 */
-	void GetCovariance(const std::vector<fvec> &samples, const fvec &mean, float ***covar);
+	void GetCovariance(const float *data, int count, const fvec &mean, std::vector<double> &covar);
 	/**
 	 * @brief Perform Principal Component Analysis on the input samples, and store the obtained components in W
 	 *
-	 * @param samples
+	 * @param data samples, stored contiguously (count x dim)
 	 * @param labels
 	 */
-	void TrainPCA(std::vector< fvec > samples, const ivec &labels);
+	void TrainPCA(const fvec &data, const ivec &labels);
 	/**
 	 * @brief Perform Linear Discriminant Analysis on the input samples, and store the obtained components in W
 	 *
-	 * @param samples
+	 * @param data samples, stored contiguously (count x dim)
 	 * @param labels
 	 * @param bFisher Use Fisher-LDA instead of standard LDA
 	 */
-	void TrainLDA(std::vector< fvec > samples, const ivec &labels, bool bFisher=true);
+	void TrainLDA(const fvec &data, const ivec &labels, bool bFisher=true);
 	/**
 	 * @brief Perform Independent Component Analysis on the input samples, and store the obtained components in Transf
 	 *
-	 * @param samples
+	 * @param data samples, stored contiguously (count x dim)
 	 * @param labels
 	 */
-	void TrainICA(std::vector< fvec > samples, const ivec &labels);
+	void TrainICA(const fvec &data, const ivec &labels);
+	/**
+	 * @brief Perform Principal Component Analysis in a single pass over chunks of samples
+	 *
+	 * The samples are read where they are, one chunk at a time, and the class means are gathered in the same pass
+	 *
+	 * @param samples
+	 * @param labels same size as samples
+	 * @param indices training samples, all of them if empty
+	 */
+	void TrainStreamingPCA(const std::vector< fvec > &samples, const ivec &labels, const ivec &indices);
+	/**
+	 * @brief Compute the range of the responses on the training samples, used to normalize Test
+	 *
+	 * @param samples
+	 * @param indices training samples, all of them if empty
+	 */
+	void SetResponseRange(const std::vector< fvec > &samples, const ivec &indices);
+	/**
+	 * @brief Sort the eigenvectors of the covariance matrix by decreasing eigenvalue, and store the first one in W
+	 *
+	 * @param sigma covariance matrix (dim x dim, row-major)
+	 */
+	void SetPrincipalComponents(std::vector<double> &sigma);
+	/**
+	 * @brief Whether the current method projects the samples on the single direction W (pca, lda, fisher)
+	 *
+	 */
+	bool IsDirectional() const {return linearType < 3 || linearType == 6;};
 
 public:
 	/**
@@ -75,6 +143,7 @@ public:
 	 *
 	 */
 	ClassifierLinear() : threshold(0), linearType(0), Transf(0) {type = CLASS_LINEAR; bUsesDrawTimer = false;};
+	~ClassifierLinear(){if(Transf) free(Transf);};
 	/**
 	 * @brief Perform the training, by gather the training parameters from the ui, and then training the corresponding classifier
 	 *
@@ -82,6 +151,18 @@ public:
 	 * @param labels
 	 */
 	void Train(std::vector< fvec > samples, ivec labels);
+	/**
+	 * @brief Perform the training without copying the samples, only available for the streaming PCA
+	 *
+	 * Memory stays within one chunk of samples on top of the dataset, which is read twice:
+	 * once for the covariance and the class means, once for the range of the responses
+	 *
+	 * @param samples
+	 * @param labels same size as samples
+	 * @param indices training samples, all of them if empty
+	 * @return false if the current method needs its own copy of the samples (use Train)
+	 */
+	bool TrainInPlace(const std::vector< fvec > &samples, const ivec &labels, const ivec &indices);
 	/**
 	 * @brief Test a single sample using the current method selected
 	 *
@@ -99,12 +180,28 @@ public:
 	 * @param sample
 	 */
 	fvec Project(const fvec &sample);
+	/**
+	 * @brief Project a batch of samples into local space
+	 *
+	 * @param samples input samples, stored contiguously (count x dim)
+	 * @param count number of samples
+	 * @param projected output, same layout as samples
+	 */
+	void Project(const float *samples, int count, float *projected) const;
 	/**
 	 * @brief Project the input sample from local space back to world space
 	 *
 	 * @param sample
 	 */
 	fvec InvProject(const fvec &sample);
+	/**
+	 * @brief Project a batch of samples from local space back to world space
+	 *
+	 * @param samples input samples, stored contiguously (count x dim)
+	 * @param count number of samples
+	 * @param result output, same layout as samples
+	 */
+	void InvProject(const float *samples, int count, float *result) const;
 	/**
 	 * @brief Set the algorithm parameters from the ui
 	 *
@@ -119,11 +216,23 @@ public:
 	 */
 	fvec GetMean(bool positive=true){return positive ? meanPos : meanNeg;};
 	/**
-	 * @brief
+	 * @brief Get the projection direction
+	 *
+	 * @return fvec
+	 */
+	fvec GetW(){return W;};
+	/**
+	 * @brief Get the PCA principal directions, sorted by decreasing eigenvalue
 	 *
-	 * @return fVec
+	 * @return std::vector<fvec>
+	 */
+	std::vector<fvec> GetEigenVectors(){return eigenVectors;};
+	/**
+	 * @brief Get the PCA eigenvalues, in decreasing order
+	 *
+	 * @return fvec
 	 */
-	fVec GetW(){return W;};
+	fvec GetEigenValues(){return eigenValues;};
 	/**
 	 * @brief
 	 *
@@ -27,12 +27,14 @@ using namespace std;
 ClassProjections::ClassProjections()
 {
 	params = new Ui::ParametersProjections();
-	params->setupUi(widget = new QWidget());
+	widget = 0;
 	projectionWindow = NULL;
 	canvas = NULL;
 	classifier = NULL;
 	classifierType = 0;
 	bDataIsFromCanvas = false;
+	if(!ParameterMap::HasGUI()) return;
+	params->setupUi(widget = new QWidget());
 	connect(params->projectionButton, SIGNAL(clicked()), this, SLOT(ShowProjection()));
 	connect(params->toCanvasButton, SIGNAL(clicked()), this, SLOT(SendToCanvas()));
 }
@@ -40,21 +42,21 @@ ClassProjections::ClassProjections()
 void ClassProjections::SetParams(Classifier *classifier)
 {
 	if(!classifier) return;
-	int type = params->linearTypeCombo->currentIndex();
+	int type = widget ? params->linearTypeCombo->currentIndex() : options.Get("linearType", 0);
 	classifierType = type;
 	if(type != 4) ((ClassifierLinear *)classifier)->SetParams(type);
 	else
 	{
-		int kernelType = params->kernelTypeCombo->currentIndex();
-		float kernelWidth = params->kernelWidthSpin->value();
-		int kernelDegree = params->kernelDegSpin->value();
+		int kernelType = widget ? params->kernelTypeCombo->currentIndex() : options.Get("kernelType", 2);
+		float kernelWidth = widget ? params->kernelWidthSpin->value() : options.Get("kernelWidth", 0.1f);
+		int kernelDegree = widget ? params->kernelDegSpin->value() : options.Get("kernelDeg", 2);
 		((ClassifierKPCA *)classifier)->SetParams(kernelType, kernelDegree, kernelWidth);
 	}
 }
 
 QString ClassProjections::GetAlgoString()
 {
-	int type = params->linearTypeCombo->currentIndex();
+	int type = widget ? params->linearTypeCombo->currentIndex() : options.Get("linearType", 0);
 	switch(type)
 	{
 	case 0:
@@ -75,12 +77,15 @@ QString ClassProjections::GetAlgoString()
 	case 5:
 		return "Naive Bayes";
 		break;
+	case 6:
+		return "Streaming PCA";
+		break;
 	}
 }
 
 Classifier *ClassProjections::GetClassifier()
 {
-	int type = params->linearTypeCombo->currentIndex();
+	int type = widget ? params->linearTypeCombo->currentIndex() : options.Get("linearType", 0);
 	if(type == 4)
 	{
 		classifier = new ClassifierKPCA();
@@ -104,7 +109,7 @@ void ClassProjections::DrawInfo(Canvas *canvas, QPainter &painter, Classifier *c
 	if(linear->GetType()==3) // ICA
 	{
 	}
-	else if(linear->GetType() < 3) // PCA, LDA, Fisher
+	else if(linear->GetType() < 3 || linear->GetType() == 6) // PCA, LDA, Fisher
 	{
 		fvec pt[5];
 		QPointF point[4];
@@ -134,7 +139,7 @@ void ClassProjections::DrawModel(Canvas *canvas, QPainter &painter, Classifier *
 	if(bUseMinMax)
 	{
 		// TODO: get the min and max for all samples
-		std::vector<fvec> samples = canvas->data->GetSamples();
+		const std::vector<fvec> &samples = canvas->data->Samples();
 		FOR(i, samples.size())
 		{
 			float val = classifier->Test(samples[i]);
@@ -184,7 +189,7 @@ void ClassProjections::ShowProjection()
 	QPainter painter(&projectionPixmap);
 	painter.setRenderHint(QPainter::Antialiasing, true);
 
-	if(classifierType < 3) // PCA, LDA, Fisher
+	if(classifierType < 3 || classifierType == 6) // PCA, LDA, Fisher
 	{
 		fvec pt[5];
 		QPointF point[4];
@@ -393,6 +398,11 @@ void ClassProjections::SaveParams(QTextStream &file)
 
 bool ClassProjections::LoadParams(QString name, float value)
 {
+	if(!widget)
+	{
+		options.Set(name, value);
+		return true;
+	}
 	if(name.endsWith("linearType")) params->linearTypeCombo->setCurrentIndex((int)value);
 	if(name.endsWith("kernelDeg")) params->kernelDegSpin->setValue((int)value);
 	if(name.endsWith("kernelType")) params->kernelTypeCombo->setCurrentIndex((int)value);
@@ -32,6 +32,7 @@ class ClassProjections : public QObject, public ClassifierInterface
 private:
 	QWidget *widget;
 	Ui::ParametersProjections *params;
+	ParameterMap options;
 	QLabel *projectionWindow;
 	Canvas *canvas;
 	Classifier *classifier;
@@ -5,6 +5,66 @@
 
 #include <QtGui>
 
+/* x'*M*x for a row-major n x n matrix M, this is the mahalanobis term of every gaussian
+ * evaluation in Compute_J. The sizes used by 2d and 3d models (n = 2,3,4,6) are unrolled.
+*/
+template<int N> static inline double QuadForm(const REALTYPE *M, const REALTYPE *x)
+{
+    double res = 0;
+    for (int i=0; i<N; i++){
+        double s = 0;
+        for (int l=0; l<N; l++)
+            s += M[i*N+l]*x[l];
+        res += s*x[i];
+    }
+    return res;
+}
+
+static inline double QuadForm(const REALTYPE *M, const REALTYPE *x, int n)
+{
+    switch(n){
+    case 2: return QuadForm<2>(M,x);
+    case 3: return QuadForm<3>(M,x);
+    case 4: return QuadForm<4>(M,x);
+    case 6: return QuadForm<6>(M,x);
+    }
+    double res = 0;
+    for (int i=0; i<n; i++){
+        double s = 0;
+        for (int l=0; l<n; l++)
+            s += M[i*n+l]*x[l];
+        res += s*x[i];
+    }
+    return res;
+}
+
+/* m += w*x and S += w*x*x' for a n-dimensional sample x */
+template<int N> static inline void AddMoments(double *m, double *S, const REALTYPE *x, double w)
+{
+    for (int i=0; i<N; i++){
+        double wx = w*x[i];
+        m[i] += wx;
+        for (int l=0; l<N; l++)
+            S[i*N+l] += wx*x[l];
+    }
+}
+
+static inline void AddMoments(double *m, double *S, const REALTYPE *x, double w, int n)
+{
+    switch(n){
+    case 2: AddMoments<2>(m,S,x,w); return;
+    case 3: AddMoments<3>(m,S,x,w); return;
+    case 4: AddMoments<4>(m,S,x,w); return;
+    case 6: AddMoments<6>(m,S,x,w); return;
+    }
+    for (int i=0; i<n; i++){
+        double wx = w*x[i];
+        m[i] += wx;
+        for (int l=0; l<n; l++)
+            S[i*n+l] += wx*x[l];
+    }
+}
+
 
 double NLOpt_Compute_J(unsigned nPar, const double *x, double *grad, void *f_data)
 {
@@ -59,6 +119,16 @@ SEDS::SEDS()
     Options.SEDS_Ver = 2;
     d = 0;
     nData = 0;
+    K = 0;
+    Sigma = 0;
+    Sigma_x = Sigma_xdx = L = L_x = A = invSigma = invSigma_x = B_Inv = 0;
+    Pxi = h = Mu_x = Mu_xd = 0;
+}
+
+SEDS::~SEDS()
+{
+    release_value();
+    delete [] Sigma;
 }
 
 
@@ -504,12 +574,25 @@ void SEDS::preprocess_sigma(){
     }
 }
 
+void SEDS::release_value(){
+    delete [] Pxi; Pxi = 0;
+    delete [] h; h = 0;
+    delete [] A; A = 0;
+    delete [] invSigma_x; invSigma_x = 0;
+    delete [] Sigma_xdx; Sigma_xdx = 0;
+    delete [] Mu_x; Mu_x = 0;
+    delete [] Mu_xd; Mu_xd = 0;
+    delete [] invSigma; invSigma = 0;
+    delete [] B_Inv; B_Inv = 0;
+    delete [] L; L = 0;
+    delete [] Sigma_x; Sigma_x = 0;
+    delete [] L_x; L_x = 0;
+}
+
 bool SEDS::initialize_value(){
-    tmpData = new Matrix[K];
+    release_value();
     Pxi = new Vector[K];
     h = new Vector[K];
-    h_tmp = new Vector[K];
-    prob.Resize(nData);
     Pxi_Priors.Resize(nData); //a vector representing Pxi*Priors
 
     A = new Matrix[K];
@@ -530,15 +613,17 @@ bool SEDS::initialize_value(){
 
     sum_dp.Resize(K);
 
-    if (Options.objective)
-        tmp_mat.Resize(2*d,nData);
-    else
-        tmp_mat.Resize(d,nData);
+    //flat copies of the component parameters and the per component moments used by Compute_J
+    int dim = Options.objective ? 2*d : d;
+    compMu.resize(K*dim);
+    compInvSigma.resize(K*dim*dim);
+    compDen.resize(K);
+    compA.resize(Options.objective ? 0 : K*d*d);
+    moments.resize(K*(1 + dim + dim*dim + (Options.objective ? 0 : d*d)));
 
     for(int k=0; k<K; k++) {
         Pxi[k] = Vector(nData);
         h[k] = Vector(nData);
-        h_tmp[k] = Vector(nData);
         invSigma_x[k]=Matrix(d,d);
         Sigma_xdx[k]=Matrix(d,d);
         invSigma[k]=Matrix(2*d,2*d);
@@ -550,10 +635,8 @@ bool SEDS::initialize_value(){
     if (Options.objective){ //likelihood objective function
         rSrs.Resize(2*d,2*d);
         L = new Matrix[K];
-        for(int k=0; k<K; k++){
-            tmpData[k] = Matrix(2*d,nData);
+        for(int k=0; k<K; k++)
             L[k] = Matrix(2*d,2*d);
-        }
     }else{ //mse objective function
         rSrs.Resize(d,d);
         Sigma_x = new Matrix[K];
@@ -562,7 +645,6 @@ bool SEDS::initialize_value(){
         Xd = Data.GetMatrix(d,2*d-1,0,nData-1);
         Xd_hat.Resize(d,nData);
         for(int k=0; k<K; k++){
-            tmpData[k] = Matrix(d,nData);
             L_x[k] = Matrix(d,d);
             Sigma_x[k] = Matrix(d,d);
         }
@@ -636,27 +718,35 @@ void SEDS::PaintData(std::vector<float> data)
 /* Running optimization solver to find the optimal values for the model.
  * The result will be saved in the variable p
 */
-bool SEDS::Optimize(){
+bool SEDS::Optimize(bool bWarmStart){
     displayData.clear();
     /*string str = "test.txt";
     loadModel(str.c_str());
     str = "data.txt";
     loadData(str.c_str());*/
     initialize_value();
-    preprocess_sigma();
 
     if (K==1)
         Options.perior_opt = false;
 
-    if (Options.objective){
+    if (Options.objective)
         nPar = Options.perior_opt*K + Options.mu_opt*K*d + Options.sigma_x_opt*K*d*(d+1) + K*d*d + (Options.SEDS_Ver-1)*d*d;
-        p.Resize(nPar); //a vector of parameters
-        GMM_2_Parameters_Likelihood(p);
-    }else{
+    else
         nPar = Options.perior_opt*K + Options.mu_opt*K*d + Options.sigma_x_opt*K*d*(d+1)/2 + K*d*d + (Options.SEDS_Ver-1)*d*d;
-        p.Resize(nPar); //a vector of parameters
-        GMM_2_Parameters_MSE(p);
-    }
+
+    //a warm start keeps the previous parameters (they also hold the lyapunov matrix),
+    //and the previous sigmas already satisfy the stability conditions
+    bWarmStart = bWarmStart && (int)p.Size() == nPar;
+    if (!bWarmStart)
+        preprocess_sigma();
+
+    Vector p0(nPar); //a vector of parameters
+    if (Options.objective)
+        GMM_2_Parameters_Likelihood(p0);
+    else
+        GMM_2_Parameters_MSE(p0);
+    if (!bWarmStart)
+        p = p0;
     nCtr = K*d + (Options.SEDS_Ver-1)*d;
 
     //-running NLOpt--------------------------------------------------------------------------------------
@@ -716,6 +806,7 @@ bool SEDS::Optimize(){
     }
 
     CheckConstraints(A);
+    return true;
 }
 
 
@@ -724,94 +815,127 @@ bool SEDS::Optimize(){
 /* This function computes the sensitivity of Cost function w.r.t. optimization parameters.
  * The result is saved in the Vector dJ. The returned value of function is J.
  * Don't mess with this function. Very sensitive and a bit complicated!
+ *
+ * All the data-dependent terms of the gradient are contractions of the centered data with
+ * the responsibilities, so they are gathered once per component in a single (threaded) pass:
+ * w = sum(wt), m = sum(wt*x), S = sum(wt*x*x') and, for the mse, G = sum(h*(xd_hat-xd)*x'),
+ * where wt is h for the likelihood and h_tmp for the mse. Each parameter then costs O(d^3)
+ * instead of a pass over the whole dataset.
 */
-double SEDS::Compute_J(Vector pp, Vector& dJ) //compute the objective function and derivative w.r.t parameters (updated in vector dJ)
+double SEDS::Compute_J(const Vector &pp, Vector& dJ) //compute the objective function and derivative w.r.t parameters (updated in vector dJ)
 {
-    double J = Compute_J(pp); //computing the cost function
+    double J = Compute_J(pp); //computing the cost function (this also fills Pxi, h and the component workspaces)
+
+    const REALTYPE *p_pp = pp.Array();
+    const int dim = Options.objective ? 2*d : d;
+    const int stride = 1 + dim + dim*dim + (Options.objective ? 0 : d*d);
+    const REALTYPE *p_X = Options.objective ? Data.Array() : X.Array();
+    const REALTYPE *p_Xd = Options.objective ? 0 : Xd.Array();
+    const REALTYPE *p_Xd_hat = Options.objective ? 0 : Xd_hat.Array();
+    std::vector<REALTYPE*> p_h(K);
+    for (int k=0; k<K; k++)
+        p_h[k] = h[k].Array();
+
+    for (unsigned int i=0; i<moments.size(); i++)
+        moments[i] = 0;
+
+#ifdef _OPENMP
+#pragma omp parallel if(nData*K*dim*dim > 65536)
+#endif
+    {
+        std::vector<double> local(K*stride, 0.0);
+        std::vector<REALTYPE> diff(dim), err(d);
+#ifdef _OPENMP
+#pragma omp for
+#endif
+        for (int j=0; j<nData; j++){
+            if (!Options.objective){
+                for (int i=0; i<d; i++)
+                    err[i] = p_Xd_hat[i*nData+j] - p_Xd[i*nData+j];
+            }
+            for (int k=0; k<K; k++){
+                double *mk = &local[k*stride];
+                const REALTYPE *mu = &compMu[k*dim];
+                for (int i=0; i<dim; i++)
+                    diff[i] = p_X[i*nData+j] - mu[i];
+
+                double wt = p_h[k][j];
+                if (!Options.objective){ //h_tmp = h.*sum((A*x-xd_hat).*(xd_hat-xd))
+                    const REALTYPE *a = &compA[k*d*d];
+                    double *g = mk + 1 + dim + dim*dim;
+                    double sum = 0;
+                    for (int i=0; i<d; i++){
+                        double ax = 0;
+                        for (int l=0; l<d; l++)
+                            ax += a[i*d+l]*p_X[l*nData+j];
+                        sum += (ax - p_Xd_hat[i*nData+j])*err[i];
+                        for (int l=0; l<d; l++)
+                            g[i*d+l] += wt*err[i]*p_X[l*nData+j];
+                    }
+                    wt *= sum;
+                }
+                mk[0] += wt;
+                AddMoments(mk+1, mk+1+dim, &diff[0], wt, dim);
+            }
+        }
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+        {
+            for (int i=0; i<K*stride; i++)
+                moments[i] += local[i];
+        }
+    }
 
     int counter_mu = Options.perior_opt*K; //the index at which mu should start
     int counter_sigma = counter_mu + Options.mu_opt*K*d; //the index at which sigma should start
     int counter_A = counter_sigma + Options.sigma_x_opt*K*d*(d+1)/2; //the index at which A should start
 
-
     for(int i=0; i<d; i++)
         tmp_A(i,i) = 1;
 
     double det_term;
-    double term,sum;
     Vector dJ_dMu_k(d);
-    int ind_start,ind_max_col;
-
-    if (Options.sigma_x_opt){
-        ind_start = 0;
-        ind_max_col = 2*d;
-    }else{
-        ind_start = d;
-        ind_max_col = d;
-    }
+    Vector m_k(dim);
+    Matrix S_k(dim,dim), G_k(d,d);
+    int ind_max_col = Options.sigma_x_opt ? 2*d : d;
 
     dJ.Zero();
     for(int k=0; k<K; k++){
+        const double *mk = &moments[k*stride];
+        double w_k = mk[0];
+        m_k.Set(mk+1,dim);
+        S_k.Set(mk+1+dim,dim,dim);
+        if (!Options.objective)
+            G_k.Set(mk+1+dim+dim*dim,d,d);
+
         //sensitivity wrt Priors
         if (Options.perior_opt && Options.objective){ //likelihood
-            dJ[k] = -exp(-pp[k])*Priors[k]*sum_dp[k];
+            dJ[k] = -exp(-p_pp[k])*Priors[k]*sum_dp[k];
             /*
             h[k] = Pxi[k]*Priors[k]/Pxi_Priors;
             dJ(k)=-exp(pp(k))/Priors[k]*((h[k]-Priors[k]).Sum());
             */
-        }else if (!Options.objective){
-            sum = 0;
-            double tmp_dbl;
-            h_tmp[k].Zero();
-            tmp_mat = A[k]*X;
-            REALTYPE *p_tmp_mat = tmp_mat.Array();
-            REALTYPE *p_Xd_hat = Xd_hat.Array();
-            REALTYPE *p_Xd = Xd.Array();
-
-            for (int i=0; i<d; i++){
-                REALTYPE *p_h_tmp = h_tmp[k].Array();
-                REALTYPE *p_h = h[k].Array();
-                for (int j=0; j<nData; j++){
-                    tmp_dbl = *(p_h++) * (*(p_tmp_mat++)-*p_Xd_hat) * (*(p_Xd_hat++)-*(p_Xd++));
-                    *(p_h_tmp++) += tmp_dbl;
-                    sum += tmp_dbl;
-                }
-            }
-            if (Options.perior_opt)
-                dJ[k] = exp(-pp[k])*Priors[k]*sum;
-                /*
-                h_tmp[k] = h[k]^(((A[k]*X-Xd_hat)^(Xd_hat-Xd)).SumRow()); //This vector is common in all dJ computation.
-                Thus, I defined it as a variable to save some computation power
-                dJ(k)= h_tmp[k].Sum();	//derivative of priors(k) w.r.t. p(k)
-                */
+        }else if (Options.perior_opt){ //mse
+            dJ[k] = exp(-p_pp[k])*Priors[k]*w_k;
+            /*
+            h_tmp[k] = h[k]^(((A[k]*X-Xd_hat)^(Xd_hat-Xd)).SumRow());
+            dJ(k)= h_tmp[k].Sum();	//derivative of priors(k) w.r.t. p(k)
+            */
         }
 
         if (Options.mu_opt)
         {
             if (Options.objective){ //likelihood
                 tmp_A.InsertSubMatrix(0,d,A[k].Transpose(),0,d,0,d); // eq to Matlab [eye(2) A(:,:,i)']
-                dJ_dMu_k=-((tmp_A*invSigma[k])*tmpData[k])*h[k];
-                dJ.InsertSubVector(counter_mu,dJ_dMu_k,0,d);
-                counter_mu += d;
+                dJ_dMu_k = (tmp_A*invSigma[k])*m_k; // = -((tmp_A*invSigma[k])*tmpData[k])*h[k]
+                dJ_dMu_k *= -1;
             }
             else{ //mse
-                tmp_mat = invSigma_x[k]*tmpData[k];
-                REALTYPE *p_tmp_mat = tmp_mat.Array();
-                REALTYPE *p_dJ = &dJ(counter_mu);
-
-                for (int i=0; i<d; i++){
-                    REALTYPE *p_h_tmp = h_tmp[k].Array();
-                    for (int j=0; j<nData; j++)
-                        *p_dJ += *(p_tmp_mat++) * (*(p_h_tmp++));
-                    p_dJ++;
-                    counter_mu++;
-                }
-
-                /*
-                dJ_dMu_k = (tmpData[k]*invSigma_x[k]).Transpose()*h_tmp[k];
-                dJ.InsertSubVector(K+k*d,dJ_dMu_k,0,d);
-                */
+                dJ_dMu_k = invSigma_x[k]*m_k; // = (tmpData[k]*invSigma_x[k]).Transpose()*h_tmp[k]
             }
+            dJ.InsertSubVector(counter_mu,dJ_dMu_k,0,d);
+            counter_mu += d;
         }
 
         //sensitivity wrt sigma
@@ -829,34 +953,18 @@ double SEDS::Compute_J(Vector pp, Vector& dJ) //compute the objective function a
                     rSrs = rSrs*L[k].Transpose() + L[k]*rSrs.Transpose();
 
                     rAvrs = (-A[k] * rSrs.GetMatrix(0,d-1,0,d-1)+ rSrs.GetMatrix(d,2*d-1,0,d-1))*invSigma_x[k] * Mu_x[k];
-                    tmp_mat = (invSigma[k]*(rSrs*invSigma[k]))*tmpData[k];
                     double tmp_dbl = (-0.5)*det_term*(invSigma[k]*rSrs).Trace();
                     Vector tmp_vec = invSigma[k].GetMatrix(0,2*d-1,d,2*d-1)*rAvrs;
 
-                    REALTYPE *p_tmp_mat = tmp_mat.Array();
-                    REALTYPE *p_tmpData = tmpData[k].Array();
-                    sum = 0;
-
-                    for (int i=0; i<2*d; i++){
-                        REALTYPE *p_h = h[k].Array();
-                        for (int j=0; j<nData; j++){
-                            sum -= (0.5 * (*p_tmp_mat++) * (*p_tmpData) +
-                                    (i==0)*tmp_dbl + //derivative with respect to det Sigma which is in the numenator
-                                    (*p_tmpData++) * tmp_vec[i]) * (*p_h++); //since Mu_xi_d = A*Mu_xi, thus we should consider its effect here
-                        }
-                    }
-                    dJ(counter_sigma) = sum;
-                    counter_sigma++;
-                    j++;
-
                     /*
-                    Vector tmp_vec = (((invSigma[k]*(rSrs*invSigma[k]))*tmpData[k])^tmpData[k]).SumRow();
-
-                    dJ(K+K*d+k*d*(2*d+1)+i_c-1) = ( tmp_vec*0.5 +
-                                                  (-0.5)*det_term*(invSigma[k]*rSrs).Trace() + //derivative with respect to det Sigma which is in the numenator
-                                                  tmpData[k].Transpose()*(invSigma[k].GetMatrix(0,2*d-1,d,2*d-1)*rAvrs)) //since Mu_xi_d = A*Mu_xi, thus we should consider its effect here
-                                                  *h[k]*(-1);
+                    dJ = -sum((0.5*(invSigma*rSrs*invSigma*x).*x + tmp_dbl + x.*tmp_vec)*h)
+                    with sum_j h_j*x_j'*M*x_j = trace(M*S)
                     */
+                    dJ(counter_sigma) = -(0.5*((invSigma[k]*(rSrs*invSigma[k]))*S_k).Trace() + //derivative w.r.t. Sigma in exponential
+                                          tmp_dbl*w_k + //derivative with respect to det Sigma which is in the numenator
+                                          tmp_vec.Dot(m_k)); //since Mu_xi_d = A*Mu_xi, thus we should consider its effect here
+                    counter_sigma++;
+                    j++;
                 }
             }
         }else{ //mse
@@ -867,51 +975,15 @@ double SEDS::Compute_J(Vector pp, Vector& dJ) //compute the objective function a
                         rSrs(j,i)=1;
                         rSrs = rSrs*L_x[k].Transpose() + L_x[k]*rSrs.Transpose();
 
-                        tmp_mat = (invSigma_x[k]*rSrs*invSigma_x[k])*tmpData[k];
                         double tmp_dbl = -(invSigma_x[k]*rSrs).Trace();
-
-                        REALTYPE *p_tmp_mat = tmp_mat.Array();
-                        REALTYPE *p_tmpData = tmpData[k].Array();
-                        sum = 0;
-
-                        for (int ii=0; ii<d; ii++){
-                            REALTYPE *p_h_tmp = h_tmp[k].Array();
-                            for (int jj=0; jj<nData; jj++){
-                                sum +=  (*p_h_tmp++) * ((*p_tmp_mat++) * (*p_tmpData++) //derivative w.r.t. Sigma in exponential
-                                                              + (ii == 0)*tmp_dbl); //derivative with respect to det Sigma which is in the numenator
-
-                                //the above term (i==0) is just to sum temp_dbl once
-                            }
-                        }
-                        dJ(counter_sigma) = 0.5*sum;
+                        dJ(counter_sigma) = 0.5*(((invSigma_x[k]*rSrs*invSigma_x[k])*S_k).Trace() //derivative w.r.t. Sigma in exponential
+                                                 + tmp_dbl*w_k); //derivative with respect to det Sigma which is in the numenator
                         counter_sigma++;
-
-                        /*
-                        dJ(K+K*d+k*d*(2*d+1)+i_c-1) =  0.5*(
-                                                        ((((invSigma_x[k]*rSrs*invSigma_x[k]*tmpData[k])^tmpData[k]).SumRow()  + //derivative w.r.t. Sigma in exponential
-                                                        -det_term*(invSigma_x[k]*rSrs.GetMatrix(0,d-1,0,d-1)).Trace())^h_tmp[k]/2) //derivative with respect to det Sigma which is in the numenator
-                                                         ).Sum();
-                        */
                     }
 
-                    sum = 0;
-                    rSrs.Zero();
-                    rSrs(j,i)=1;
-                    tmp_mat = rSrs*X;
-                    REALTYPE *p_tmp_mat = tmp_mat.Array();
-                    REALTYPE *p_Xd_hat = Xd_hat.Array();
-                    REALTYPE *p_Xd = Xd.Array();
-
-                    for (int ii=0; ii<d; ii++){
-                        REALTYPE *p_h = h[k].Array();
-                        for (int jj=0; jj<nData; jj++){
-                            sum += *(p_h++) * (*(p_tmp_mat++)) * (*(p_Xd_hat++) - *(p_Xd++));
-                        }
-                    }
-                    dJ(counter_A) = sum;
-                    counter_A++;
                     // dJ(counter_A) = sum(sum((rSrs*x).*dJdxd).*h(:,k)');  %derivative of A
-
+                    dJ(counter_A) = G_k(j,i);
+                    counter_A++;
                 }
             }
         }
@@ -926,144 +998,101 @@ double SEDS::Compute_J(Vector pp, Vector& dJ) //compute the objective function a
  * The result is saved in the Vector dJ. The returned value of function is J.
  * Don't mess with this function. Very sensitive and a bit complicated!
 */
-double SEDS::Compute_J(Vector pp){
+double SEDS::Compute_J(const Vector &pp){
 
-    double J = 0;
     if (Options.objective){
         Parameters_2_GMM_Likelihood(pp);
     }else{
         Parameters_2_GMM_MSE(pp);
     }
 
-    //computing likelihood:
-    Pxi_Priors.Zero();
-
+    //the likelihood uses the joint [x;xd] gaussians, the mse only their x marginals
+    const int dim = Options.objective ? 2*d : d;
+    const REALTYPE *p_X = Options.objective ? Data.Array() : X.Array();
+    REALTYPE *p_Xd = Options.objective ? 0 : Xd.Array();
+    REALTYPE *p_Xd_hat = Options.objective ? 0 : Xd_hat.Array();
+    REALTYPE *p_Pxi_Priors = Pxi_Priors.Array();
+    std::vector<REALTYPE*> p_Pxi(K), p_h(K);
 
     for (int k=0; k<K; k++){
-        int d_tmp;
-        double tmp_den;
-        REALTYPE *p_X;
-
-        if (Options.objective){ //likelihod
-            tmp_den = sqrt(pow(2*M_PI,2*d)*fabs(detSigma[k])+DBL_MIN);
-            d_tmp = 2*d;
-            p_X = Data.Array();
-        }
+        Matrix &iS = Options.objective ? invSigma[k] : invSigma_x[k];
+        memcpy(&compInvSigma[k*dim*dim], iS.Array(), dim*dim*sizeof(REALTYPE));
+        for (int i=0; i<dim; i++)
+            compMu[k*dim+i] = Mu(i,k);
+        if (Options.objective) //likelihod
+            compDen[k] = sqrt(pow(2*M_PI,2*d)*fabs(detSigma[k])+DBL_MIN);
         else{ //mse
-            tmp_den = sqrt(pow(2*M_PI,d)*fabs(detSigma_x[k])+DBL_MIN);
-            d_tmp = d;
-            p_X = X.Array();
-        }
-
-        REALTYPE *p_tmpData = tmpData[k].Array();
-        for(int j=0; j<d_tmp; j++){
-            double tmp_dbl = Mu(j,k);
-            for(int i=0; i<nData; i++)
-                *p_tmpData++ = (*p_X++) - tmp_dbl;
+            compDen[k] = sqrt(pow(2*M_PI,d)*fabs(detSigma_x[k])+DBL_MIN);
+            memcpy(&compA[k*d*d], A[k].Array(), d*d*sizeof(REALTYPE));
         }
+        p_Pxi[k] = Pxi[k].Array();
+        p_h[k] = h[k].Array();
+        sum_dp[k] = 0;
+    }
 
-        if (Options.objective){ //likelihod
-            tmp_mat = invSigma[k]*tmpData[k];
-        }
-        else{ //mse
-            tmp_mat = invSigma_x[k]*tmpData[k];
-        }
+    double J = 0;
+#ifdef _OPENMP
+#pragma omp parallel if(nData*K*dim*dim > 65536)
+#endif
+    {
+        std::vector<REALTYPE> diff(dim), xd(d);
+        std::vector<double> local_dp(K, 0.0);
+        double local_J = 0;
+#ifdef _OPENMP
+#pragma omp for
+#endif
+        for (int j=0; j<nData; j++){
+            //computing likelihood
+            double pxi_priors = 0;
+            for (int k=0; k<K; k++){
+                const REALTYPE *mu = &compMu[k*dim];
+                for (int i=0; i<dim; i++)
+                    diff[i] = p_X[i*nData+j] - mu[i];
+                double pxi = exp(-0.5*QuadForm(&compInvSigma[k*dim*dim], &diff[0], dim))/compDen[k];
+                p_Pxi[k][j] = pxi;
+                pxi_priors += pxi*Priors[k];
+            }
+            p_Pxi_Priors[j] = pxi_priors;
 
-        REALTYPE *p_tmp_mat = tmp_mat.Array();
-        REALTYPE *p_Pxi = Pxi[k].Array();
-        REALTYPE *p_Pxi_Priors = Pxi_Priors.Array();
-        p_tmpData = tmpData[k].Array();
-        prob.Zero();
-
-        for(int i=0; i<d_tmp; i++){
-            REALTYPE *p_prob = prob.Array();
-            for(int j=0; j<nData; j++){
-                if (i<d_tmp-1){
-                    *p_prob++ += (*p_tmp_mat++) * (*p_tmpData++);
+            //computing GMR
+            if (Options.objective){ //likelihood
+                for (int k=0; k<K; k++){
+                    double hk = p_Pxi[k][j]/pxi_priors*Priors[k];
+                    p_h[k][j] = hk;
+                    local_dp[k] += hk - Priors[k];
                 }
-                else{
-                    *p_prob += (*p_tmp_mat++) * (*p_tmpData++);
-                    *p_Pxi = exp(-0.5*(*p_prob++))/tmp_den;
-                    *(p_Pxi_Priors++) += (*p_Pxi++)*Priors[k];
+                local_J -= log(pxi_priors);
+            }else{ //mse, Xd_hat = sum_k h_k*A_k*x
+                for (int i=0; i<d; i++)
+                    xd[i] = 0;
+                for (int k=0; k<K; k++){
+                    double hk = p_Pxi[k][j]/pxi_priors*Priors[k];
+                    p_h[k][j] = hk;
+                    const REALTYPE *a = &compA[k*d*d];
+                    for (int i=0; i<d; i++){
+                        double ax = 0;
+                        for (int l=0; l<d; l++)
+                            ax += a[i*d+l]*p_X[l*nData+j];
+                        xd[i] += hk*ax;
+                    }
                 }
-            }
-        }
-        /*
-        for(int j=0; j<d; j++)
-            tmpData[k].SetRow(Mu(j,k),j);
-
-        tmpData[k]=X-tmpData[k]; // remove centers from data
-
-        prob = ((invSigma_x[k]*tmpData[k])^tmpData[k]).SumRow();//cf the expontential in gaussian pdf
-
-        double tmp_den = sqrt(pow(2*M_PI,d)*fabs(detSigma_x[k])+DBL_MIN);
-
-        for(int j=0; j<nData; j++){
-            Pxi[k][j] = exp(-0.5*prob[j])/tmp_den;
-            Pxi_Priors[j] += Pxi[k][j]*Priors[k];
-        }
-        */
-    }
-
-    //computing GMR
-    if (Options.objective){ //likelihood
-        for (int k=0; k<K; k++){
-            REALTYPE *p_h = h[k].Array();
-            REALTYPE *p_Pxi = Pxi[k].Array();
-            REALTYPE *p_Pxi_Priors = Pxi_Priors.Array();
-            sum_dp[k] = 0;
-
-            for (int j=0; j<nData; j++){
-                *p_h = (*p_Pxi++)/(*p_Pxi_Priors++)*Priors[k];
-                sum_dp[k] += (*p_h++) - Priors[k];
-            }
-        }
-    }else{
-        for (int k=0; k<K; k++){
-            tmp_mat = A[k]*X;
-            REALTYPE *p_tmp_mat = tmp_mat.Array();
-            REALTYPE *p_Xd_hat = Xd_hat.Array();
-            REALTYPE *p_Pxi = Pxi[k].Array();
-            REALTYPE *p_Pxi_Priors = Pxi_Priors.Array();
-
-            for(int i=0; i<d; i++)
-            {
-                REALTYPE *p_h = h[k].Array();
-
-                for(int j=0; j<nData; j++){
-                    if (i==0)
-                        *p_h = *(p_Pxi++)/(*(p_Pxi_Priors++)) * Priors[k];
-                    if (k==0)
-                        *(p_Xd_hat++) = *(p_h++) * (*p_tmp_mat++);
-                    else
-                        *(p_Xd_hat++) += *(p_h++) * (*p_tmp_mat++);
+                for (int i=0; i<d; i++){
+                    p_Xd_hat[i*nData+j] = xd[i];
+                    double e = xd[i] - p_Xd[i*nData+j];
+                    local_J += 0.5*e*e;
                 }
             }
-
-            /*
-            h[k] = Pxi[k]*Priors[k]/Pxi_Priors;
-            if (k==0)
-                Xd_hat = Vector_Multiply(tmp_mul,h[k])^(A[k]*X);
-            else
-                Xd_hat += Vector_Multiply(tmp_mul,h[k])^(A[k]*X);
-            */
+        }
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+        {
+            J += local_J;
+            for (int k=0; k<K; k++)
+                sum_dp[k] += local_dp[k];
         }
     }
 
-    //calc J
-    if (Options.objective) {//likelihood
-        REALTYPE *p_Pxi_Priors = Pxi_Priors.Array();
-        for(int i=0; i<nData ; i++)
-            J -= log(*p_Pxi_Priors++);
-    }
-    else{
-        REALTYPE *p_Xd_hat = Xd_hat.Array();
-        REALTYPE *p_Xd = Xd.Array();
-        for(int i=0; i<d ; i++)
-            for(int j=0; j<nData ; j++)
-                J += 0.5 * ((*p_Xd_hat) - (*p_Xd)) * ((*p_Xd_hat++) - (*p_Xd++));
-        //J = 0.5*((Xd_hat-Xd)^(Xd_hat-Xd)).Sum();
-    }
     J /= nData;
     return J;
 }
@@ -1368,8 +1397,9 @@ bool SEDS::GMM_2_Parameters_Likelihood(Vector &p){ //this is used to transform G
 }
 
 /* Transforming the vector of optimization's parameters into a GMM model.*/
-bool SEDS::Parameters_2_GMM_Likelihood(Vector pp){ //this is used to unpack the parameters in p after optimization, to reconstruct the
+bool SEDS::Parameters_2_GMM_Likelihood(const Vector &pp){ //this is used to unpack the parameters in p after optimization, to reconstruct the
     //GMM-parameters in their ususal form: Priors, Mu and Sigma.
+    const REALTYPE *p_pp = pp.Array();
 
     double sum=0;
     Vector col(2*d); // a temporary vector needed below
@@ -1378,10 +1408,10 @@ bool SEDS::Parameters_2_GMM_Likelihood(Vector pp){ //this is used to unpack the
     int counter_sigma = counter_mu + Options.mu_opt*K*d; //the index at which sigma should start
     int counter_C = counter_sigma + K*d*d + Options.sigma_x_opt*K*d*(d+1);
 
-    for (int k=0; k<K; k=k++){
+    for (int k=0; k<K; k++){
         //constructing Priors
         if (Options.perior_opt){
-            Priors[k] = 1.0/(1.0+exp(-pp[k])); //extract the Priors from correspondng position in optimization vector
+            Priors[k] = 1.0/(1.0+exp(-p_pp[k])); //extract the Priors from correspondng position in optimization vector
             sum += Priors[k];
         }
 
@@ -1390,7 +1420,7 @@ bool SEDS::Parameters_2_GMM_Likelihood(Vector pp){ //this is used to unpack the
             for(int j=0; j<2*d; j++){ //for all dimensions
                 col.Zero();
                 for(int i=j; i<2*d; i++){
-                    col(i)=pp(counter_sigma);
+                    col(i)=p_pp[counter_sigma];
                     counter_sigma++;
                 }
                 L[k].SetColumn(col, j);
@@ -1398,7 +1428,7 @@ bool SEDS::Parameters_2_GMM_Likelihood(Vector pp){ //this is used to unpack the
         }else{
             for(int j=0; j<d; j++){ //for all dimensions
                 for(int i=0; i<d; i++){
-                    L[k](i+d,j) = pp(counter_sigma);
+                    L[k](i+d,j) = p_pp[counter_sigma];
                     counter_sigma++;
                 }
             }
@@ -1488,8 +1518,9 @@ bool SEDS::GMM_2_Parameters_MSE(Vector &p){ //this is used to transform GMM to t
 
 
 /* Transforming the vector of optimization's parameters into a GMM model.*/
-bool SEDS::Parameters_2_GMM_MSE(Vector pp){ //this is used to unpack the parameters in p after optimization, to reconstruct the
+bool SEDS::Parameters_2_GMM_MSE(const Vector &pp){ //this is used to unpack the parameters in p after optimization, to reconstruct the
     //GMM-parameters in their ususal form: Priors, Mu and Sigma.
+    const REALTYPE *p_pp = pp.Array();
 
     Vector col(d); // a temporary vector needed below
     int counter_mu = Options.perior_opt*K; //the index at which mu should start
@@ -1497,20 +1528,20 @@ bool SEDS::Parameters_2_GMM_MSE(Vector pp){ //this is used to unpack the paramet
     int counter_A = counter_sigma + Options.sigma_x_opt*K*d*(d+1)/2; //the index at which A should start
     int counter_C = counter_A + K*d*d;
 
-    for (int k=0; k<K; k=k++){
+    for (int k=0; k<K; k++){
         //constructing Priors
         if (Options.perior_opt)
-            Priors[k] = 1.0/(1.0+exp(-pp[k]));
+            Priors[k] = 1.0/(1.0+exp(-p_pp[k]));
 
         //reconstructing Sigma
         for(int j=0; j<d; j++){ //for all dimensions
             col.Zero();
             for(int i=0; i<d; i++){
                 if (i>=j && Options.sigma_x_opt){
-                    col(i)=pp(counter_sigma);
+                    col(i)=p_pp[counter_sigma];
                     counter_sigma++;
                 }
-                A[k](i,j) = pp(counter_A);
+                A[k](i,j) = p_pp[counter_A];
                 counter_A++;
             }
             if (Options.sigma_x_opt)
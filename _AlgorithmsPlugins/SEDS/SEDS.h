@@ -4,6 +4,7 @@
 #include <sstream>
 #include <fstream>
 #include <float.h>
+#include <vector>
 #include <MathLib/MathLib.h>
 #include <nlopt/nlopt.hpp>
 using namespace MathLib;
@@ -36,6 +37,7 @@ public:
     options Options;
     //constructor
     SEDS();
+    ~SEDS();
 
     /* Parsing the input commands to the solver */
     bool Parse_Input(int argc, char **argv, char** file_data, char** file_model, char** file_output);
@@ -102,16 +104,19 @@ public:
 
     /* Running optimization solver to find the optimal values for the model.
      * The result will be saved in the variable p
+     * bWarmStart: start from the current content of p (e.g. the result of a previous run
+     * on a subset of the data) instead of the parameters derived from the GMM. The GMM
+     * (Priors, Mu, Sigma) must be the one p was optimized into, and it is used as is.
      */
-    bool Optimize();
+    bool Optimize(bool bWarmStart = false);
 
     /* This function computes the sensitivity of Cost function w.r.t. optimization parameters.
      * The result is saved in the Vector dJ. The returned value of function is J.
      * Don't mess with this function. Very sensitive and a bit complicated!
      */
-    double Compute_J(Vector p, Vector &dJ);
+    double Compute_J(const Vector &p, Vector &dJ);
 
-    double Compute_J(Vector p);
+    double Compute_J(const Vector &p);
 
     void Compute_Constraints(Vector &c);
 
@@ -122,12 +127,18 @@ public:
 protected:
     //These are temporary variable that are used during optimization
     Vector detSigma_x,detSigma;
-    MathLib::Matrix X,Xd,Xd_hat,*Sigma_x,*Sigma_xdx,*L,*L_x,*tmpData, *A, *invSigma, *invSigma_x, tmp_A, B, *B_Inv, dc;
-    MathLib::Matrix rSrs, rArs, rBrs, tmp_mat;
-    Vector prob, *Pxi, *h_tmp, *h, *Mu_x, *Mu_xd, rAvrs, c, sum_dp;
+    MathLib::Matrix X,Xd,Xd_hat,*Sigma_x,*Sigma_xdx,*L,*L_x, *A, *invSigma, *invSigma_x, tmp_A, B, *B_Inv, dc;
+    MathLib::Matrix rSrs, rArs, rBrs;
+    Vector *Pxi, *h, *Mu_x, *Mu_xd, rAvrs, c, sum_dp;
     Vector Pxi_Priors; //a vector representing Pxi*Priors
 
+    //flat per component workspaces reused across Compute_J calls: centers, inverse covariances,
+    //gaussian normalization terms, dynamics (mse only) and the weighted moments for the gradient
+    std::vector<REALTYPE> compMu, compInvSigma, compDen, compA;
+    std::vector<double> moments;
+
     bool initialize_value();
+    void release_value();
 
     /* This function ensures that the initial guess of sigma satisfies the stability conditions
     */
@@ -144,12 +155,12 @@ protected:
     bool GMM_2_Parameters_Likelihood(Vector &p);
 
     /* Transforming the vector of optimization's parameters into a GMM model.*/
-    bool Parameters_2_GMM_Likelihood(Vector pp); //when optimization is done, use this to correctly extract Priors, mu and sigma for model
+    bool Parameters_2_GMM_Likelihood(const Vector &pp); //when optimization is done, use this to correctly extract Priors, mu and sigma for model
 
     /* Transforming the GMM model into the vector of optimization's parameters.*/
     bool GMM_2_Parameters_MSE(Vector &p);
 
     /* Transforming the vector of optimization's parameters into a GMM model.*/
-    bool Parameters_2_GMM_MSE(Vector pp); //when optimization is done, use this to correctly extract Priors, mu and sigma for model
+    bool Parameters_2_GMM_MSE(const Vector &pp); //when optimization is done, use this to correctly extract Priors, mu and sigma for model
 };
 #endif
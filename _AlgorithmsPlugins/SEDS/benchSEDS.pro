@@ -0,0 +1,8 @@
+# ##########################
+# Configuration      #
+# ##########################
+NAME = benchSEDS
+PLUGIN = mld_SEDS
+MLPATH =../..
+
+include($$MLPATH/MLBench/benchPlugin.pri)
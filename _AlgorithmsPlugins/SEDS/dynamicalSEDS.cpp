@@ -23,10 +23,8 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 
 using namespace std;
 
-Gmm *DynamicalSEDS::globalGMM = 0;
-
 DynamicalSEDS::DynamicalSEDS()
-	: gmm(0),seds(0), data(0), nbClusters(2), penalty(1), bPrior(true), bMu(true), bSigma(true), objectiveType(1),
+	: gmm(0),seds(0), warmStart(0), nbClusters(2), penalty(1), bPrior(true), bMu(true), bSigma(true), objectiveType(1),
 	  maxIteration(100), maxMinorIteration(2), constraintCriterion(0), resizeFactor(500.f)
 {
 	type = DYN_SEDS;
@@ -36,7 +34,62 @@ DynamicalSEDS::DynamicalSEDS()
 
 DynamicalSEDS::~DynamicalSEDS()
 {
-    if(gmm != globalGMM) DEL(gmm);
+	DEL(gmm);
+	DEL(seds);
+}
+
+// FNV-1a over the first 'count' samples of a dim x stride buffer
+static u32 SampleChecksum(const REALTYPE *data, u32 count, u32 stride, u32 dim)
+{
+	u32 hash = 2166136261u;
+	FOR(d, dim)
+	{
+		const unsigned char *bytes = (const unsigned char *)(data + d*stride);
+		FOR(i, count*sizeof(REALTYPE))
+		{
+			hash ^= bytes[i];
+			hash *= 16777619u;
+		}
+	}
+	return hash;
+}
+
+bool DynamicalSEDS::CanWarmStart(const REALTYPE *data, u32 sampleCount)
+{
+	if(!warmStart || !warmStart->sampleCount || !warmStart->p.Size()) return false;
+	if(warmStart->nbClusters != (int)nbClusters || warmStart->dim != (int)dim) return false;
+	if(warmStart->objectiveType != objectiveType || warmStart->bPrior != bPrior ||
+	   warmStart->bMu != bMu || warmStart->bSigma != bSigma || warmStart->resizeFactor != resizeFactor) return false;
+	// retraining on the same data is a request for a fresh initialization
+	if(warmStart->sampleCount >= sampleCount) return false;
+	return warmStart->checksum == SampleChecksum(data, warmStart->sampleCount, sampleCount, dim);
+}
+
+void DynamicalSEDS::StoreWarmStart(const REALTYPE *data, u32 sampleCount)
+{
+	if(!warmStart) return;
+	warmStart->nbClusters = nbClusters;
+	warmStart->dim = dim;
+	warmStart->objectiveType = objectiveType;
+	warmStart->bPrior = bPrior;
+	warmStart->bMu = bMu;
+	warmStart->bSigma = bSigma;
+	warmStart->resizeFactor = resizeFactor;
+	warmStart->sampleCount = sampleCount;
+	warmStart->checksum = SampleChecksum(data, sampleCount, sampleCount, dim);
+	warmStart->priors.resize(nbClusters);
+	warmStart->means.resize(nbClusters*dim);
+	warmStart->sigmas.resize(nbClusters*dim*dim);
+	FOR(i, nbClusters)
+	{
+		warmStart->priors[i] = seds->Priors(i);
+		FOR(d, dim) warmStart->means[i*dim + d] = seds->Mu(d, i);
+		FOR(d1, dim)
+		{
+			FOR(d2, dim) warmStart->sigmas[(i*dim + d1)*dim + d2] = seds->Sigma[i](d1, d2);
+		}
+	}
+	warmStart->p = seds->p;
 }
 
 void DynamicalSEDS::Train(std::vector< std::vector<fvec> > trajectories, ivec labels)
@@ -46,43 +99,57 @@ void DynamicalSEDS::Train(std::vector< std::vector<fvec> > trajectories, ivec la
 	if(!count) return;
 	dim = trajectories[0][0].size();
 	// we forget about time and just push in everything
-	vector<fvec> samples;
 	endpoint = trajectories[0][trajectories[0].size()-1];
 	endpointFast = dim >= 2 ? fVec(endpoint[0], endpoint[1]) : fVec();
 	FOR(d,dim/2) endpoint[d+dim/2] = 0;
+	u32 sampleCount = 0;
+	FOR(i, trajectories.size()) sampleCount += trajectories[i].size();
+	if(!sampleCount) return;
+
+	nbClusters = min((int)nbClusters, (int)sampleCount);
+
+	DEL(seds);
+	seds = new SEDS();
+
+	// the samples go straight into the (dim x sampleCount) seds data matrix, which is
+	// the only copy of the data we keep
+	seds->Data.Resize(dim, sampleCount, false);
+	REALTYPE *ddata = seds->Data.Array();
+	u32 index = 0;
 	FOR(i, trajectories.size())
 	{
 		FOR(j, trajectories[i].size())
 		{
-			samples.push_back(trajectories[i][j] - endpoint);
+			FOR(d, dim) ddata[d*sampleCount + index] = (trajectories[i][j][d] - endpoint[d])*resizeFactor;
+			index++;
 		}
 	}
-	if(!samples.size()) return;
-
-	bool bKeepInitialization = false;
-
-	nbClusters = min((int)nbClusters, (int)samples.size());
-	KILL(data);
-	data = new float[samples.size()*dim];
-	double *ddata = new REALTYPE[samples.size()*dim];
-	FOR(i, samples.size())
-	{
-		FOR(j, dim) data[i*dim + j] = samples[i][j]*resizeFactor;
-		FOR(j, dim) ddata[j*samples.size() + i] = samples[i][j]*resizeFactor;
-	}
 
-	if(globalGMM && bKeepInitialization && globalGMM->nstates == nbClusters)
+	bool bWarmStart = CanWarmStart(ddata, sampleCount);
+	DEL(gmm);
+	gmm = new Gmm(nbClusters, dim);
+	if(bWarmStart)
 	{
-		gmm = globalGMM;
+		// demonstrations were only appended: we restart from the previous solution
+		FOR(i, nbClusters)
+		{
+			fgmm_set_prior(gmm->c_gmm, i, warmStart->priors[i]);
+			fgmm_set_mean(gmm->c_gmm, i, &warmStart->means[i*dim]);
+			fgmm_set_covar(gmm->c_gmm, i, &warmStart->sigmas[i*dim*dim]);
+		}
+		seds->p = warmStart->p;
 	}
 	else
 	{
-		// first learn the model with gmm
-		DEL(gmm);
-		gmm = new Gmm(nbClusters, dim);
-		gmm->init(data, samples.size(), 2); // kmeans initialization
-		gmm->em(data, samples.size(), 1e-4, COVARIANCE_FULL);
-		globalGMM = gmm;
+		// first learn the model with gmm, which wants the samples interleaved
+		float *data = new float[sampleCount*dim];
+		FOR(i, sampleCount)
+		{
+			FOR(d, dim) data[i*dim + d] = ddata[d*sampleCount + i];
+		}
+		gmm->init(data, sampleCount, 2); // kmeans initialization
+		gmm->em(data, sampleCount, 1e-4, COVARIANCE_FULL);
+		delete [] data;
 	}
 
 	//gmm->initRegression(dim/2);
@@ -94,11 +161,11 @@ void DynamicalSEDS::Train(std::vector< std::vector<fvec> > trajectories, ivec la
  file.open("last-data.txt");
  if(file.is_open())
  {
-  FOR(i, samples.size())
+  FOR(i, sampleCount)
   {
    FOR(j, dim)
    {
-	file << ddata[j*samples.size() + i] << " ";
+	file << ddata[j*sampleCount + i] << " ";
    }
    file << std::endl;
   }
@@ -106,12 +173,6 @@ void DynamicalSEDS::Train(std::vector< std::vector<fvec> > trajectories, ivec la
  }
  */
 	// then optimize with seds
-	DEL(seds);
-	seds = new SEDS();
-
-	// fill in the data
-	//seds->Data.Resize(dim, samples.size());
-	seds->Data = Matrix(ddata, dim, samples.size());
 
 	// fill in the current model
 	seds->Priors.Resize(nbClusters);
@@ -130,7 +191,7 @@ void DynamicalSEDS::Train(std::vector< std::vector<fvec> > trajectories, ivec la
 			}
 		}
 	}
-	seds->nData = samples.size();
+	seds->nData = sampleCount;
 	seds->d = dim/2;
 	seds->K = nbClusters;
 
@@ -141,7 +202,8 @@ void DynamicalSEDS::Train(std::vector< std::vector<fvec> > trajectories, ivec la
 	seds->Options.objective = objectiveType;
 	seds->Options.constraintCriterion = constraintCriterion;
 
-        seds->Optimize();
+	seds->Optimize(bWarmStart);
+	StoreWarmStart(ddata, sampleCount);
 
 	// and we copy the values back to the source
 	float *mu = new float[dim];
@@ -162,7 +224,6 @@ void DynamicalSEDS::Train(std::vector< std::vector<fvec> > trajectories, ivec la
 	}
 	delete [] sigma;
 	delete [] mu;
-	delete [] ddata;
 	gmm->initRegression(dim/2);
 
 	/*seds->Mu.Print();
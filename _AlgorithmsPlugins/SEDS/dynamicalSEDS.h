@@ -20,13 +20,28 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include "SEDS.h"
 #include "fgmm/fgmm++.hpp"
 
+// result of a SEDS run, kept to initialize the next one when demonstrations are only appended
+// the gmm is in the scaled, endpoint-centered space used for training
+struct SEDSWarmStart
+{
+	int nbClusters, dim, objectiveType;
+	bool bPrior, bMu, bSigma;
+	float resizeFactor;
+	u32 sampleCount; // samples used in the previous run
+	u32 checksum; // hash of those samples
+	fvec priors, means, sigmas; // means: dim per component, sigmas: dim*dim per component
+	Vector p; // optimized seds parameters
+	SEDSWarmStart() : nbClusters(0), dim(0), objectiveType(0), bPrior(false), bMu(false), bSigma(false),
+		resizeFactor(0), sampleCount(0), checksum(0){}
+};
+
 class DynamicalSEDS : public Dynamical
 {
 public:
-    static Gmm *globalGMM;
     Gmm *gmm;
     SEDS *seds;
 	float resizeFactor;
+	SEDSWarmStart *warmStart; // not owned, 0 for cold runs only
 private:
     u32 nbClusters;
     float penalty;
@@ -37,7 +52,8 @@ private:
     int maxIteration;
     int maxMinorIteration;
     int constraintCriterion;
-    float *data;
+    bool CanWarmStart(const REALTYPE *data, u32 sampleCount);
+    void StoreWarmStart(const REALTYPE *data, u32 sampleCount);
 public:
     fvec endpoint;
     fVec endpointFast;
@@ -51,6 +67,8 @@ public:
 
     void SetParams(int clusters, bool bPrior, bool bMu, bool bSigma, int objectiveType,
                    int maxIteration, int constraintCriterion);
+    // the next runs start from (and update) the given initialization when possible
+    void SetWarmStart(SEDSWarmStart *warmStart){this->warmStart = warmStart;};
 };
 
 #endif // _DYNAMICAL_SEDS_H_
@@ -27,6 +27,8 @@ using namespace std;
 DynamicSEDS::DynamicSEDS()
 {
 	params = new Ui::ParametersSEDS();
+	widget = 0;
+	if(!ParameterMap::HasGUI()) return;
 	params->setupUi(widget = new QWidget());
 	connect(params->sedsConstraintCombo, SIGNAL(currentIndexChanged(int)), this, SLOT(OptionsChanged()));
 }
@@ -41,13 +43,13 @@ void DynamicSEDS::SetParams(Dynamical *dynamical)
 {
 	if(!dynamical) return;
 
-	int clusters = params->sedsCount->value();
-	bool bPrior = params->sedsCheckPrior->isChecked();
-	bool bMu = params->sedsCheckMu->isChecked();
-	bool bSigma = params->sedsCheckSigma->isChecked();
-	int objectiveType = params->sedsObjectiveCombo->currentIndex();
-	int maxIteration = params->iterationCount->value();
-	int constraintCriterion = params->sedsConstraintCombo->currentIndex();
+	int clusters = widget ? params->sedsCount->value() : options.Get("sedsCount", 1);
+	bool bPrior = widget ? params->sedsCheckPrior->isChecked() : options.Get("sedsPrior", 1);
+	bool bMu = widget ? params->sedsCheckMu->isChecked() : options.Get("sedsMu", 1);
+	bool bSigma = widget ? params->sedsCheckSigma->isChecked() : options.Get("sedsSigma", 1);
+	int objectiveType = widget ? params->sedsObjectiveCombo->currentIndex() : options.Get("sedsObjective", 0);
+	int maxIteration = widget ? params->iterationCount->value() : options.Get("iterationCount", 500);
+	int constraintCriterion = widget ? params->sedsConstraintCombo->currentIndex() : options.Get("sedsConstraintCombo", 0);
 
 	((DynamicalSEDS *)dynamical)->SetParams(clusters, bPrior, bMu, bSigma, objectiveType, maxIteration, constraintCriterion);
 
@@ -61,6 +63,7 @@ Dynamical *DynamicSEDS::GetDynamical()
 {
 	DynamicalSEDS *dynamical = new DynamicalSEDS();
 	SetParams(dynamical);
+	dynamical->SetWarmStart(&warmStart);
 	return dynamical;
 }
 
@@ -144,6 +147,11 @@ void DynamicSEDS::SaveParams(QTextStream &file)
 
 bool DynamicSEDS::LoadParams(QString name, float value)
 {
+	if(!widget)
+	{
+		options.Set(name, value);
+		return true;
+	}
 	if(name.endsWith("sedsCount")) params->sedsCount->setValue((int)value);
 	//if(name.endsWith("sedsPenalty")) params->sedsPenaltySpin->setValue(value);
 	if(name.endsWith("sedsObjective")) params->sedsObjectiveCombo->setCurrentIndex((int)value);
@@ -31,6 +31,8 @@ class DynamicSEDS : public QObject, public DynamicalInterface
 private:
 	QWidget *widget;
 	Ui::ParametersSEDS *params;
+	ParameterMap options;
+	SEDSWarmStart warmStart; // last trained model, reused when demonstrations are appended
 public:
 	DynamicSEDS();
 	// virtual functions to manage the algorithm creation
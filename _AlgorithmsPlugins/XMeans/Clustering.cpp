@@ -2,6 +2,8 @@
 #include <limits>
 #include <boost/foreach.hpp>
 #include <map>
+#include <algorithm>
+#include <math.h>
 using namespace std;
 namespace AG
 {
@@ -29,134 +31,209 @@ void operator /= (Vect &a, const float b)
 	for(int i=0; i<a.size(); i++) a[i] /= b;
 }
 
-bool diameterInf(Vect x, double maxDist, double *limits)
+// grows the bounding box (limits: low/high for each dimension) to include x
+// if the box would become larger than maxDist along any dimension, the box is left untouched and false is returned
+static inline bool diameterInf(const float *x, int dim, double maxDist, double *limits)
 {
-	int dim = x.size();
-	double *newLimits = new double[dim*2];
-	memcpy(newLimits, limits, sizeof(double)*dim*2);
-
 	bool bInside = true;
 	for (int d=0; d < dim; d++)
 	{
-		double dLow = limits[2*d];
-		double dHigh = limits[2*d+1];
-		if(dLow > x[d] || dHigh < x[d])
+		double xd = x[d];
+		if(xd < limits[2*d])
 		{
+			if(limits[2*d+1] - xd > maxDist) return false;
+			bInside = false;
+		}
+		else if(xd > limits[2*d+1])
+		{
+			if(xd - limits[2*d] > maxDist) return false;
 			bInside = false;
-			break;
 		}
 	}
 	if(bInside) return true;
-
-	bool bOk = true;
 	for (int d=0; d < dim; d++)
 	{
-		double xd = x[d];
-		double dLow = min(xd, limits[d*2]);
-		double dHigh = max(xd, limits[d*2+1]);
-		if(dHigh - dLow > maxDist)
+		if(x[d] < limits[2*d]) limits[2*d] = x[d];
+		if(x[d] > limits[2*d+1]) limits[2*d+1] = x[d];
+	}
+	return true;
+}
+
+// uniform grid over the first (up to 3) dimensions, with cells at least max_diameter wide
+// so that every sample within max_diameter of a seed lies in the seed's cell or in one of its neighbours
+struct QTGrid
+{
+	int dim, gridDim;
+	int cells[3];
+	double origin[3], cellSize[3];
+	std::vector<int> cellStart, cellSamples, sampleCell;
+
+	QTGrid(const float *samples, int count, int dim, double max_diameter)
+	: dim(dim), gridDim(min(dim, 3))
+	{
+		int maxCells = (int)pow((double)max(count, 4096), 1./gridDim);
+		int cellCount = 1;
+		for(int g=0; g<gridDim; g++)
 		{
-			bOk = false;
-			break;
+			double low = samples[g], high = samples[g];
+			for(int i=1; i<count; i++)
+			{
+				low = min(low, (double)samples[i*dim + g]);
+				high = max(high, (double)samples[i*dim + g]);
+			}
+			cellSize[g] = max(max_diameter, (high - low) / maxCells);
+			if(cellSize[g] <= 0) cellSize[g] = 1;
+			origin[g] = low;
+			cells[g] = min(maxCells, (int)((high - low) / cellSize[g]) + 1);
+			cellCount *= cells[g];
+		}
+		// counting sort of the samples by cell
+		sampleCell.resize(count);
+		cellStart.assign(cellCount+1, 0);
+		for(int i=0; i<count; i++)
+		{
+			sampleCell[i] = Cell(samples + i*dim);
+			cellStart[sampleCell[i]+1]++;
 		}
-		newLimits[2*d] = dLow;
-		newLimits[2*d+1] = dHigh;
+		for(int c=0; c<cellCount; c++) cellStart[c+1] += cellStart[c];
+		cellSamples.resize(count);
+		std::vector<int> fill(cellStart.begin(), cellStart.end()-1);
+		for(int i=0; i<count; i++) cellSamples[fill[sampleCell[i]]++] = i; // samples stay sorted within each cell
 	}
 
-	if(bOk) memcpy(limits, newLimits, sizeof(double)*dim*2);
-	delete [] newLimits;
-	return bOk;
-}
+	int Coord(const float *x, int g) const
+	{
+		int c = (int)((x[g] - origin[g]) / cellSize[g]);
+		return max(0, min(cells[g]-1, c));
+	}
 
-bool diameter2(Vect x, double maxDist, std::vector<Vect> clust, Vect sum, int count)
-{
-	int dim = x.size();
-	maxDist = maxDist*maxDist;
-	// we keep the center of the cluster
-	Vect center = sum + x;
-	center /= count + 1;
+	int Cell(const float *x) const
+	{
+		int cell = 0;
+		for(int g=gridDim-1; g>=0; g--) cell = cell*cells[g] + Coord(x, g);
+		return cell;
+	}
 
-	double dist = 0;
-	for (int d=0; d < dim; d++) dist += (x[d]-center[d])*(x[d]-center[d]);
-	if(dist > maxDist) return false;
+	// appends the samples in the 3^gridDim cells around x
+	void Neighbours(const float *x, std::vector<int> &result) const
+	{
+		int c[3] = {0,0,0}, low[3] = {0,0,0}, high[3] = {0,0,0};
+		for(int g=0; g<gridDim; g++)
+		{
+			int coord = Coord(x, g);
+			low[g] = max(0, coord-1);
+			high[g] = min(cells[g]-1, coord+1);
+		}
+		for(c[2]=low[2]; c[2]<=high[2]; c[2]++)
+		{
+			for(c[1]=low[1]; c[1]<=high[1]; c[1]++)
+			{
+				for(c[0]=low[0]; c[0]<=high[0]; c[0]++)
+				{
+					int cell = 0;
+					for(int g=gridDim-1; g>=0; g--) cell = cell*cells[g] + c[g];
+					result.insert(result.end(), cellSamples.begin() + cellStart[cell], cellSamples.begin() + cellStart[cell+1]);
+				}
+			}
+		}
+	}
+};
 
-	for (int i=0; i<clust.size(); i++)
+// candidate cluster seeded on sample i: the unassigned samples are added in index order as long
+// as the bounding box of the cluster stays within max_diameter along every dimension
+static int qt_candidate(const float *samples, int dim, double max_diameter, const QTGrid &grid,
+						const std::vector<bool> &assigned, int i, std::vector<int> &members, std::vector<int> &neighbours, std::vector<double> &limits)
+{
+	const float *x = samples + i*dim;
+	members.clear();
+	neighbours.clear();
+	grid.Neighbours(x, neighbours);
+	std::sort(neighbours.begin(), neighbours.end());
+	for(int d=0; d<dim; d++) limits[2*d] = limits[2*d+1] = x[d];
+	members.push_back(i);
+	for(int n=0; n<neighbours.size(); n++)
 	{
-		double dist = 0;
-		for (int d=0; d<dim; d++) dist += (clust[i][d]-center[d])*(clust[i][d]-center[d]);
-		if(dist > maxDist) return false;
+		int j = neighbours[n];
+		if(j == i || assigned[j]) continue;
+		if(diameterInf(samples + j*dim, dim, max_diameter, &limits[0])) members.push_back(j);
 	}
-	return true;
+	return members.size();
 }
 
-Clusters qt_clustering(VectorSpace & vs, double max_diameter, int minCount)
+Clusters qt_clustering(const float *samples, int count, int dim, double max_diameter, int minCount)
 {
-	Clusters clusters(vs.size(), std::numeric_limits<index>::max());  // assign all the vectors to no cluster
+	Clusters clusters(count, std::numeric_limits<index>::max());  // assign all the vectors to no cluster
+	if(!count) return clusters;
+	QTGrid grid(samples, count, dim, max_diameter);
+	std::vector<bool> assigned(count, false);
+	std::vector<char> dirty(count, 1);
+	std::vector<int> sizes(count, 0);
+	std::vector<int> members, neighbours, toUpdate;
+	std::vector<double> limits(dim*2);
 	int assignedCount = 0;
 	int clusterId = 0;
-	int count = vs.size();
-	int dim = vs[0].size();
-	while(assignedCount < vs.size())
+	while(assignedCount < count)
 	{
-		std::vector < std::vector<Vect> > clusts;
-		std::vector < std::vector<int> > clustsIdx;
-		clusts.resize(vs.size());
-		clustsIdx.resize(vs.size());
-		double *limits = new double[dim*2];
-		int skipped = 0;
-		int docId_i = 0;
-		BOOST_FOREACH(Vect d_i, vs)         // foreach document
+		// only the candidates that could have lost a sample are rebuilt
+		toUpdate.clear();
+		for(int i=0; i<count; i++) if(!assigned[i] && dirty[i]) toUpdate.push_back(i);
+#ifdef _OPENMP
+#pragma omp parallel if(toUpdate.size() > 64)
+#endif
 		{
-			if (clusters[docId_i] != std::numeric_limits<index>::max())
-			{
-				skipped++;
-				docId_i++;
-				continue; // sample taken already
-			}
-			for(int d=0; d<dim; d++)
+			std::vector<int> localMembers, localNeighbours;
+			std::vector<double> localLimits(dim*2);
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 16)
+#endif
+			for(int u=0; u<(int)toUpdate.size(); u++)
 			{
-				limits[2*d] = d_i[d];
-				limits[2*d+1] = d_i[d];
+				int i = toUpdate[u];
+				sizes[i] = qt_candidate(samples, dim, max_diameter, grid, assigned, i, localMembers, localNeighbours, localLimits);
+				dirty[i] = 0;
 			}
-			std::vector<Vect> &clust = clusts[docId_i];
-			std::vector<int> &clustIdx = clustsIdx[docId_i];
-			clust.push_back(d_i);
-			clustIdx.push_back(docId_i);
+		}
 
-			for(index docId_j = 0; docId_j < vs.size(); docId_j++)
-			{
-				if(docId_j == docId_i) continue;
-				if (clusters[docId_j] != std::numeric_limits<index>::max()) continue; // sample taken already
-				if(diameterInf(vs[docId_j], max_diameter, limits))
-				{
-					clust.push_back(vs[docId_j]);
-					clustIdx.push_back(docId_j);
-				}
-			}
-			docId_i++;
-		} // foreach document
-		delete [] limits;
 		// find the cluster with the maximum count
-		int maxIndex = 0, maxCnt = 0;
-		for(int i=0; i<clustsIdx.size(); i++)
+		int maxIndex = -1, maxCnt = 0;
+		for(int i=0; i<count; i++)
 		{
-			if(maxCnt < clustsIdx[i].size())
+			if(assigned[i]) continue;
+			if(maxCnt < sizes[i])
 			{
 				maxIndex = i;
-				maxCnt = clustsIdx[i].size();
+				maxCnt = sizes[i];
 			}
 		}
-		std::cout << "maximum cluster: " << maxIndex << " with " << maxCnt << " samples"<< std::endl;
-		if(maxCnt < minCount) break;
-		for(int i=0; i<clustsIdx[maxIndex].size(); i++)
+		if(maxIndex < 0 || maxCnt < minCount) break;
+		qt_candidate(samples, dim, max_diameter, grid, assigned, maxIndex, members, neighbours, limits);
+		for(int m=0; m<members.size(); m++)
 		{
-			int index = clustsIdx[maxIndex][i];
+			int index = members[m];
 			clusters[index] = clusterId;
+			assigned[index] = true;
+			// candidates around the removed samples need to be rebuilt
+			neighbours.clear();
+			grid.Neighbours(samples + index*dim, neighbours);
+			for(int n=0; n<neighbours.size(); n++) dirty[neighbours[n]] = 1;
 		}
 		clusterId++;
 		assignedCount += maxCnt;
 	}
 	return clusters;
+}
+
+Clusters qt_clustering(VectorSpace & vs, double max_diameter, int minCount)
+{
+	int count = vs.size();
+	if(!count) return Clusters();
+	int dim = vs[0].size();
+	std::vector<float> samples(count*dim);
+	for(int i=0; i<count; i++)
+	{
+		for(int d=0; d<dim; d++) samples[i*dim + d] = vs[i](d);
+	}
+	return qt_clustering(&samples[0], count, dim, max_diameter, minCount);
 };
 }; /* Clustering */
 };
@@ -14,6 +14,8 @@ namespace AG
 		typedef std::vector<index> Clusters;
 
 		Clusters qt_clustering(VectorSpace & vs, double max_diameter, int minCount);
+		// samples is count x dim, row-major
+		Clusters qt_clustering(const float *samples, int count, int dim, double max_diameter, int minCount);
 	};
 };
 #endif
@@ -0,0 +1,8 @@
+# ##########################
+# Configuration      #
+# ##########################
+NAME = benchXMeans
+PLUGIN = mld_XMeans
+MLPATH =../..
+
+include($$MLPATH/MLBench/benchPlugin.pri)
@@ -29,27 +29,22 @@ using namespace AG::Data;
 void ClustererQTClust::Train(std::vector< fvec > samples)
 {
 	if(!samples.size()) return;
-	int dim = samples[0].size();
+	dim = samples[0].size();
 
 	this->samples = samples;
 	centers.clear();
 	centerCnt.clear();
 
-	VectorSpace vs;
-	Clusters clusters;
+	int count = samples.size();
+	fvec data(count*dim);
+	FOR(s, count) FOR(i, dim) data[s*dim + i] = samples[s][i];
 
-	FOR(s, samples.size())
-	{
-		Vect v(dim);
-		FOR(i, dim) v(i) = samples[s][i];
-		vs.push_back(v);
-	}
-
-	clusters = qt_clustering(vs, distance, minCount);
+	Clusters clusters = qt_clustering(&data[0], count, dim, distance, minCount);
 	this->clusters.resize(samples.size());
 	FOR(i, clusters.size())
 	{
 		this->clusters[i] = clusters[i];
+		if(this->clusters[i] < 0) continue; // outliers do not have a center
 		if(centerCnt.count(clusters[i]))
 		{
 			centers[clusters[i]] += samples[i];
@@ -61,10 +56,12 @@ void ClustererQTClust::Train(std::vector< fvec > samples)
 			centerCnt[clusters[i]] = 1;
 		}
 	}
+	centerData.clear();
 	for(map<int,int>::iterator it = centerCnt.begin(); it != centerCnt.end(); it++)
 	{
 		int key = it->first;
 		centers[key] /= it->second;
+		centerData.insert(centerData.end(), centers[key].begin(), centers[key].end());
 	}
 }
 
@@ -72,14 +69,29 @@ fvec ClustererQTClust::Test( const fvec &sample)
 {
 	fvec res;
 	res.resize(centers.size(),0);
+	if(!res.size()) return res;
+	// the sample goes to the closest cluster center
+	int closest = 0;
+	float minDist = FLT_MAX;
+	int sampleDim = min((int)sample.size(), (int)dim);
+	FOR(c, res.size())
+	{
+		const float *center = &centerData[c*dim];
+		float dist = 0;
+		FOR(d, sampleDim) dist += (sample[d]-center[d])*(sample[d]-center[d]);
+		if(dist < minDist)
+		{
+			minDist = dist;
+			closest = c;
+		}
+	}
+	res[closest] = 1;
 	return res;
 }
 
 fvec ClustererQTClust::Test( const fVec &sample)
 {
-	fvec res;
-	res.resize(centers.size(),0);
-	return res;
+	return Test((fvec)sample);
 }
 
 void ClustererQTClust::SetParams(double distance, int minCount)
@@ -34,9 +34,9 @@ public:
 private:
 	double distance;
 	int minCount;
-	float *data;
+	fvec centerData; // cluster centers, contiguous
 public:
-	ClustererQTClust() : data(0), distance(0.6), minCount(2){};
+	ClustererQTClust() : distance(0.6), minCount(2){};
 	void Train(std::vector< fvec > samples);
 	fvec Test( const fvec &sample);
 	fvec Test( const fVec &sample);
@@ -27,14 +27,16 @@ using namespace std;
 ClustQTClust::ClustQTClust()
 {
 	params = new Ui::ParametersQTClust();
+	widget = 0;
+	if(!ParameterMap::HasGUI()) return;
 	params->setupUi(widget = new QWidget());
 }
 
 void ClustQTClust::SetParams(Clusterer *clusterer)
 {
 	if(!clusterer) return;
-	double distance = params->minDistanceSpin->value();
-	int minCount = params->minSampleCount->value();
+	double distance = widget ? params->minDistanceSpin->value() : options.Get("minDistanceSpin", 0.1f);
+	int minCount = widget ? params->minSampleCount->value() : options.Get("minSampleCount", 0);
 
 	((ClustererQTClust *)clusterer)->SetParams(distance, minCount);
 }
@@ -109,6 +111,11 @@ void ClustQTClust::SaveParams(QTextStream &file)
 
 bool ClustQTClust::LoadParams(QString name, float value)
 {
+	if(!widget)
+	{
+		options.Set(name, value);
+		return true;
+	}
 	if(name.endsWith("minDistanceSpin")) params->minDistanceSpin->setValue((double)value);
 	if(name.endsWith("minSampleCount")) params->minSampleCount->setValue((int)value);
 	return true;
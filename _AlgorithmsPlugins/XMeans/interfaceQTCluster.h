@@ -31,6 +31,7 @@ class ClustQTClust : public QObject, public ClustererInterface
 private:
 	QWidget *widget;
 	Ui::ParametersQTClust *params;
+	ParameterMap options;
 public:
 	ClustQTClust();
 	// virtual functions to manage the algorithm creation
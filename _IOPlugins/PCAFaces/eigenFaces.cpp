@@ -3,34 +3,40 @@
 #include "basicOpenCV.h"
 #include "eigenFaces.h"
 
+// faces are projected by blocks of this many (one matrix product per block)
+#define PROJECTION_BLOCK 256
+
 EigenFaces::EigenFaces()
 {
+	dim = 0;
+	trainCnt = 0;
+	faceSize = cvSize(0,0);
 	eigenValues = NULL;
 	eigenVectors = NULL;
 	avgImage = NULL;
 	mapImage = NULL;
 	bUseColor = false;
+	bMahalanobis = true;
 }
 
 EigenFaces::~EigenFaces()
 {
 	if(eigenValues) cvReleaseMat(&eigenValues);
-	FOR(i, dim) IMKILL(eigenVectors[i]);
+	if(eigenVectors) FOR(i, dim) IMKILL(eigenVectors[i]);
 	KILL(eigenVectors);
 	IMKILL(avgImage);
 	IMKILL(mapImage);
-	FOR(i, projections.size()) delete [] projections[i];
-	projections.clear();
 }
 
 std::vector<float *> EigenFaces::GetProjections(int dim, bool bNormalized)
 {
-	if(!dim || dim >= this->dim) return projections;
 	std::vector <float *> result;
-	FOR(i, projections.size())
+	if(!eigenVectors) return result;
+	if(!dim || dim > this->dim) dim = this->dim;
+	FOR(i, classes.size())
 	{
 		float *r = new float[dim];
-		FOR(j, dim) r[j] = projections[i][j];
+		FOR(j, dim) r[j] = GetProjection(i)[j];
 		result.push_back(r);
 	}
 
@@ -63,6 +69,91 @@ std::vector<float *> EigenFaces::GetProjections(int dim, bool bNormalized)
 	return result;
 }
 
+// converts a face to the format the model was learned on (8 bit, single channel, faceSize)
+IplImage *EigenFaces::Prepare(IplImage *face)
+{
+	CvSize size = cvSize(faceSize.width / (bUseColor ? 3 : 1), faceSize.height);
+	IplImage *resized = NULL;
+	if(face->width != size.width || face->height != size.height)
+	{
+		resized = cvCreateImage(size, face->depth, face->nChannels);
+		cvResize(face, resized, CV_INTER_CUBIC);
+		face = resized;
+	}
+	IplImage *prepared;
+	if(!bUseColor)
+	{
+		if(face->nChannels == 3)
+		{
+			prepared = cvCreateImage(faceSize, 8, 1);
+			cvCvtColor(face, prepared, CV_BGR2GRAY);
+			cvEqualizeHist(prepared, prepared);
+		}
+		else prepared = cvCloneImage(face);
+	}
+	else
+	{
+		prepared = cvCreateImage(faceSize, 8, 1);
+		if(face->nChannels == 3)
+		{
+			FOR(j, faceSize.width*faceSize.height) prepared->imageData[j] = face->imageData[j];
+		}
+		else
+		{
+			FOR(j, faceSize.width*faceSize.height) prepared->imageData[j] = face->imageData[j/3];
+		}
+	}
+	IMKILL(resized);
+	return prepared;
+}
+
+// computes the projections of prepared faces on the eigenvectors
+// this is what cvEigenDecomposite does one face at a time, here the mean-centered faces of a block are
+// gathered in a single matrix and projected with one product against the contiguous eigenvectors
+void EigenFaces::Project(IplImage **faces, int count, float *projections)
+{
+	if(!count || !dim) return;
+	int pixels = faceSize.width*faceSize.height;
+	std::vector<float> block(min(count, PROJECTION_BLOCK)*pixels);
+	CvMat eigens = cvMat(dim, pixels, CV_32FC1, &basis[0]);
+	for(int start=0; start<count; start += PROJECTION_BLOCK)
+	{
+		int blockCount = min(PROJECTION_BLOCK, count-start);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+		for(int i=0; i<blockCount; i++)
+		{
+			IplImage *face = faces[start + i];
+			float *row = &block[i*pixels];
+			FOR(y, faceSize.height)
+			{
+				unsigned char *src = (unsigned char *)face->imageData + y*face->widthStep;
+				const float *avg = &mean[y*faceSize.width];
+				float *dst = row + y*faceSize.width;
+				FOR(x, faceSize.width) dst[x] = src[x] - avg[x];
+			}
+		}
+		CvMat centered = cvMat(blockCount, pixels, CV_32FC1, &block[0]);
+		CvMat projected = cvMat(blockCount, dim, CV_32FC1, projections + start*dim);
+		cvGEMM(&centered, &eigens, 1, NULL, 0, &projected, CV_GEMM_B_T);
+	}
+}
+
+// adds the training faces of the gallery, starting from row first, to the nearest neighbour index
+void EigenFaces::Index(int first)
+{
+	std::vector<float> points;
+	for(int i=first; i<(int)classes.size(); i++)
+	{
+		if(!isTraining[i]) continue;
+		float *projection = GetProjection(i);
+		FOR(d, dim) points.push_back(projection[d]*weights[d]);
+		indexed.push_back(i);
+	}
+	if(points.size()) index.Insert(&points[0], points.size()/dim);
+}
+
 void EigenFaces::Learn(std::vector<IplImage *> faces, std::vector<int> classes, std::vector<bool> isTrainingData, bool bColor)
 {
 	if(!faces.size() || !faces[0]) return;
@@ -73,6 +164,10 @@ void EigenFaces::Learn(std::vector<IplImage *> faces, std::vector<int> classes,
 		delete [] eigenVectors;
 		eigenVectors = NULL;
 	}
+	dim = 0;
+	gallery.clear();
+	index.Clear(0);
+	indexed.clear();
 
 	bUseColor = bColor;
 
@@ -92,46 +187,20 @@ void EigenFaces::Learn(std::vector<IplImage *> faces, std::vector<int> classes,
 	CvTermCriteria calcLimit;
 	CvSize res = cvGetSize(faces[0]);
 	if(bUseColor) res.width *= 3;
+	faceSize = res;
 	trainCnt = this->classes.size();
-	
-	IplImage **allFaces = new IplImage *[this->classes.size()];
-	int cnt = 0;
-	FOR(i, faces.size())
-	{
-		//if(classes[i] == 0) continue;
-		if(!bUseColor)
-		{
-			if(faces[i]->nChannels == 3)
-			{
-				allFaces[cnt] = cvCreateImage(res,8,1);
-				cvCvtColor(faces[i], allFaces[cnt], CV_BGR2GRAY);
-				cvEqualizeHist(allFaces[cnt], allFaces[cnt]);
-			}
-			else allFaces[cnt] = cvCloneImage(faces[i]);
-		}
-		else
-		{
-			allFaces[cnt] = cvCreateImage(res, 8, 1);
-			if(faces[i]->nChannels == 3)
-			{
-				FOR(j, res.width*res.height) allFaces[cnt]->imageData[j] = faces[i]->imageData[j];
-			}
-			else
-			{
-				allFaces[cnt] = cvCreateImage(res, 8, 1);
-				FOR(j, res.width*res.height) allFaces[cnt]->imageData[j] = faces[i]->imageData[j/3];
-			}
-		}
-		cnt++;
-	}
-
 	FOR(i, isTraining.size()) if(!isTraining[i]) trainCnt--;
+	if(trainCnt < 2) return;
+
+	std::vector<IplImage *> allFaces(this->classes.size());
+	FOR(i, allFaces.size()) allFaces[i] = Prepare(faces[i]);
+
 	dim = trainCnt - 1;
 	IplImage **faceArray = new IplImage *[trainCnt];
-	cnt = 0;
+	int cnt = 0;
 	FOR(i, isTraining.size()) if(isTraining[i])
 	{
-		faceArray[cnt++] = cvCloneImage(allFaces[i]);
+		faceArray[cnt++] = allFaces[i];
 	}
 	eigenVectors = new IplImage *[dim];
 	FOR(i, dim) eigenVectors[i] = cvCreateImage(res, IPL_DEPTH_32F, 1);
@@ -145,54 +214,79 @@ void EigenFaces::Learn(std::vector<IplImage *> faces, std::vector<int> classes,
 	calcLimit = cvTermCriteria(CV_TERMCRIT_ITER, dim, 0.0001);
 
 	cvCalcEigenObjects(trainCnt, (void *)faceArray, (void *)eigenVectors, CV_EIGOBJ_NO_CALLBACK, 0, 0, &calcLimit, avgImage, eigenValues->data.fl);
+	KILL(faceArray);
 
-	// we compute the projections for recognition purposes
-	FOR(i, projections.size()) delete [] projections[i];
-	projections.clear();
-	FOR(i, this->classes.size())
+	// we keep the eigenvectors and average face in contiguous buffers for the projections
+	basis.resize(dim*res.width*res.height);
+	mean.resize(res.width*res.height);
+	FOR(y, res.height)
 	{
-		float *proj = new float[dim];
-		cvEigenDecomposite(allFaces[i], dim, eigenVectors, 0, 0, avgImage, proj);
-		projections.push_back(proj);
+		FOR(i, dim)
+		{
+			float *src = (float *)(eigenVectors[i]->imageData + y*eigenVectors[i]->widthStep);
+			FOR(x, res.width) basis[(i*res.height + y)*res.width + x] = src[x];
+		}
+		float *src = (float *)(avgImage->imageData + y*avgImage->widthStep);
+		FOR(x, res.width) mean[y*res.width + x] = src[x];
+	}
+	// the index compares the projections scaled by the inverse standard deviation of each component
+	weights.resize(dim);
+	FOR(i, dim)
+	{
+		float eigenValue = eigenValues->data.fl[i];
+		if(!bMahalanobis) weights[i] = 1.f;
+		else weights[i] = eigenValue > FLT_EPSILON ? 1.f / sqrtf(eigenValue) : 0.f;
 	}
-	FOR(i, trainCnt) cvReleaseImage(&faceArray[i]);
-	KILL(faceArray);
-	FOR(i, this->classes.size()) cvReleaseImage(&allFaces[i]);
-	KILL(allFaces);
-}
 
-void EigenFaces::Recognize(IplImage *face)
-{
-	if(!face) return;
-	float *projected = new float[dim];
-	cvEigenDecomposite(face, dim, eigenVectors, 0, 0, avgImage, projected);
-	int nearest = FindNearestNeighbor(projected);
+	// we compute the projections for recognition purposes
+	index.Clear(dim);
+	gallery.resize(allFaces.size()*dim);
+	Project(&allFaces[0], allFaces.size(), &gallery[0]);
+	Index(0);
+	FOR(i, allFaces.size()) IMKILL(allFaces[i]);
 }
 
-int EigenFaces::FindNearestNeighbor(float *candidate)
+void EigenFaces::Add(std::vector<IplImage *> faces, std::vector<int> classes, bool bTraining)
 {
-	double minDist = DBL_MAX;
-	int train = 0, nearest = 0;
-	bool bMahalanobis = true;
-
-	FOR(train, trainCnt)
+	if(!eigenVectors || !faces.size()) return;
+	int first = this->classes.size();
+	std::vector<IplImage *> prepared(faces.size());
+	FOR(i, faces.size())
 	{
-		double dist = 0;
-		FOR(i, dim)
-		{
-			float d = candidate[i] - projections[train][i];
-			dist += d*d;
-			if(bMahalanobis) dist /= eigenValues->data.fl[i];
-		}
-
-		if(dist < minDist)
-		{
-			minDist = dist;
-			nearest = train;
-		}
+		prepared[i] = Prepare(faces[i]);
+		this->classes.push_back(i < classes.size() ? classes[i] : 0);
+		isTraining.push_back(bTraining);
 	}
+	gallery.resize(this->classes.size()*dim);
+	Project(&prepared[0], prepared.size(), GetProjection(first));
+	Index(first);
+	FOR(i, prepared.size()) IMKILL(prepared[i]);
+}
+
+int EigenFaces::Recognize(IplImage *face)
+{
+	if(!face) return -1;
+	return Recognize(std::vector<IplImage *>(1, face))[0];
+}
 
-	return nearest;
+// returns the class of the nearest training face for each face (-1 if the model has not been learned)
+std::vector<int> EigenFaces::Recognize(std::vector<IplImage *> faces)
+{
+	int count = faces.size();
+	std::vector<int> result(count, -1);
+	if(!eigenVectors || !index.GetCount() || !count) return result;
+
+	std::vector<IplImage *> prepared(count);
+	FOR(i, count) prepared[i] = Prepare(faces[i]);
+	std::vector<float> projections(count*dim);
+	Project(&prepared[0], count, &projections[0]);
+	FOR(i, count) IMKILL(prepared[i]);
+
+	FOR(i, count) FOR(d, dim) projections[i*dim + d] *= weights[d];
+	std::vector<int> nearest(count);
+	index.Nearest(&projections[0], count, &nearest[0]);
+	FOR(i, count) result[i] = this->classes[indexed[nearest[i]]];
+	return result;
 }
 
 void eigen_on_mouse( int event, int x, int y, int flags, void* param )
@@ -201,7 +295,7 @@ void eigen_on_mouse( int event, int x, int y, int flags, void* param )
 	IplImage *avgImage = (IplImage *)(((int *)param)[1]);
 	int dim = (*(int *)(((int *)param)[2]));
 	float *maxes = (float *)(((int *)param)[3]);
-	std::vector<float *> *projections = (std::vector<float *> *)(((int *)param)[4]);
+	std::vector<float> *gallery = (std::vector<float> *)(((int *)param)[4]);
 	float size = maxes[4];
 	int e1 = ((int *)param)[5];
 	int e2 = ((int *)param)[6];
@@ -218,16 +312,16 @@ void eigen_on_mouse( int event, int x, int y, int flags, void* param )
 	/*
 	int closest = 0;
 	float dist = FLT_MAX;
-	FOR(i, projections->size())
+	FOR(i, gallery->size()/dim)
 	{
-		float d = sqrtf(powf(c1-projections->at(i)[e1],2) + powf(c2-projections->at(i)[e2],2));
+		float d = sqrtf(powf(c1-gallery->at(i*dim+e1),2) + powf(c2-gallery->at(i*dim+e2),2));
 		if(d < dist)
 		{
 			dist = d;
 			closest = i;
 		}
 	}
-	FOR(i, dim) coords[i] = projections->at(closest)[i];
+	FOR(i, dim) coords[i] = gallery->at(closest*dim+i);
 	*/
 	coords[e1] = c1;
 	coords[e2] = c2;
@@ -356,10 +450,11 @@ void EigenFaces::Draw(bool bMonochrome, int e1, int e2)
 
 	FOR(i, trainCnt)
 	{
-		if(minX > projections[i][e1]) minX = projections[i][e1];
-		if(maxX < projections[i][e1]) maxX = projections[i][e1];
-		if(minY > projections[i][e2]) minY = projections[i][e2];
-		if(maxY < projections[i][e2]) maxY = projections[i][e2];
+		float *projection = GetProjection(i);
+		if(minX > projection[e1]) minX = projection[e1];
+		if(maxX < projection[e1]) maxX = projection[e1];
+		if(minY > projection[e2]) minY = projection[e2];
+		if(maxY < projection[e2]) maxY = projection[e2];
 	}
 	dX = maxX - minX;
 	dY = maxY - minY;
@@ -370,9 +465,10 @@ void EigenFaces::Draw(bool bMonochrome, int e1, int e2)
 	cvZero(mapImage);
 	const int radius = 3;
 	
-	FOR(i, projections.size())
+	FOR(i, classes.size())
 	{
-		cvVec2 v((projections[i][e1] - minX)/dX, (projections[i][e2] - minY)/dY);
+		float *projection = GetProjection(i);
+		cvVec2 v((projection[e1] - minX)/dX, (projection[e2] - minY)/dY);
 		CvPoint point = (v*((float)size-edge*2) + cvVec2((f32)edge, (f32)edge)).to2d();
 		if(!isTraining[i])
 		{
@@ -393,7 +489,7 @@ void EigenFaces::Draw(bool bMonochrome, int e1, int e2)
 	eigparams[1] = (intptr_t)((void *)avgImage);
 	eigparams[2] = (intptr_t)((void *)&dim);
 	eigparams[3] = (intptr_t)((void *)maxes);
-	eigparams[4] = (intptr_t)((void *)&projections);
+	eigparams[4] = (intptr_t)((void *)&gallery);
 	eigparams[5] = (intptr_t) e1;
 	eigparams[6] = (intptr_t) e2;
 
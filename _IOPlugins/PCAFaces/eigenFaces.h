@@ -2,32 +2,47 @@
 #define _EIGEN_FACES_H_
 
 #include <vector>
+#include "faceIndex.h"
 
 class EigenFaces
 {
 private:
 	int dim;
 	int trainCnt;
+	CvSize faceSize; // resolution of the faces as they are projected (color faces are laid flat, 3x as wide)
 	IplImage **eigenVectors;
 	IplImage *avgImage;
 	CvMat *eigenValues;
-	std::vector<float *> projections;
+	std::vector<float> basis; // eigenvectors stored contiguously (dim x pixels)
+	std::vector<float> mean; // average face
+	std::vector<float> weights; // scaling of each component for the nearest neighbour search
+	std::vector<float> gallery; // projections of all the faces seen so far (count x dim)
+	FaceIndex index; // weighted projections of the training faces
+	std::vector<int> indexed; // gallery row of each point in the index
 	std::vector<int> classes;
 	std::vector<bool> isTraining;
 	bool bUseColor;
 
-	int FindNearestNeighbor(float *candidate);
+	IplImage *Prepare(IplImage *face);
+	void Project(IplImage **faces, int count, float *projections);
+	void Index(int first);
 
 public:
+	bool bMahalanobis;
+
 	EigenFaces();
 	~EigenFaces();
 	void Learn(std::vector<IplImage *> faces, std::vector<int> classes, std::vector<bool> isTrainingData=std::vector<bool>(), bool bColor = true);
-	void Recognize(IplImage *face);
+	void Add(std::vector<IplImage *> faces, std::vector<int> classes, bool bTraining=true);
+	int Recognize(IplImage *face);
+	std::vector<int> Recognize(std::vector<IplImage *> faces);
 	void Draw(bool bMonochrome=false, int e1 = 0, int e2 = 1);
 	void DrawEigenVals();
 	std::vector<IplImage *> GetEigenVectorsImages();
 
 	std::vector<float *> GetProjections(int dim = 0, bool bNormalized=false);
+	float *GetProjection(int i){return &gallery[i*dim];};
+	int GetCount(){return classes.size();};
 	std::vector<int> GetClasses(){return classes;};
 	IplImage **GetVectors(){return eigenVectors;};
 	int GetVectorCount(){return dim;};
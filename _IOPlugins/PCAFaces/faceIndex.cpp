@@ -0,0 +1,210 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License,
+version 3 as published by the Free Software Foundation.
+
+This library is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#include "public.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include "faceIndex.h"
+
+// below this many queries the batch is not worth spreading over threads
+#define PARALLEL_SIZE 64
+
+struct SplitCompare
+{
+	const float *points;
+	int dim, split;
+	SplitCompare(const float *points, int dim, int split) : points(points), dim(dim), split(split){};
+	bool operator()(int a, int b) const {return points[a*dim + split] < points[b*dim + split];};
+};
+
+FaceIndex::FaceIndex(int dim)
+	: dim(dim), root(-1), eps(0)
+{
+}
+
+void FaceIndex::Clear(int dim)
+{
+	this->dim = dim;
+	points.clear();
+	nodes.clear();
+	root = -1;
+}
+
+int FaceIndex::Build(int *indices, int count)
+{
+	if(count <= 0) return -1;
+	// we split along the dimension with the largest spread
+	int split = 0;
+	float spread = -1.f;
+	FOR(d, dim)
+	{
+		float minV = FLT_MAX, maxV = -FLT_MAX;
+		FOR(i, count)
+		{
+			float v = points[indices[i]*dim + d];
+			if(v < minV) minV = v;
+			if(v > maxV) maxV = v;
+		}
+		if(maxV - minV > spread)
+		{
+			spread = maxV - minV;
+			split = d;
+		}
+	}
+	int mid = count/2;
+	std::nth_element(indices, indices + mid, indices + count, SplitCompare(&points[0], dim, split));
+	int node = indices[mid];
+	nodes[node].split = split;
+	nodes[node].value = points[node*dim + split];
+	nodes[node].size = count;
+	nodes[node].left = Build(indices, mid);
+	nodes[node].right = Build(indices + mid + 1, count - mid - 1);
+	return node;
+}
+
+void FaceIndex::Collect(int node, std::vector<int> &indices) const
+{
+	if(node == -1) return;
+	indices.push_back(node);
+	Collect(nodes[node].left, indices);
+	Collect(nodes[node].right, indices);
+}
+
+void FaceIndex::Rebuild()
+{
+	std::vector<int> indices(nodes.size());
+	FOR(i, indices.size()) indices[i] = i;
+	root = indices.size() ? Build(&indices[0], indices.size()) : -1;
+}
+
+int FaceIndex::Insert(const float *point)
+{
+	int index = nodes.size();
+	points.insert(points.end(), point, point + dim);
+	Node node;
+	node.split = 0;
+	node.value = point[0];
+	node.left = node.right = -1;
+	node.size = 1;
+	nodes.push_back(node);
+	if(root == -1)
+	{
+		root = index;
+		return index;
+	}
+
+	std::vector<int> path;
+	int parent = root;
+	while(true)
+	{
+		path.push_back(parent);
+		Node &p = nodes[parent];
+		p.size++;
+		int &child = point[p.split] < p.value ? p.left : p.right;
+		if(child == -1)
+		{
+			child = index;
+			nodes[index].split = (p.split + 1) % dim;
+			nodes[index].value = point[nodes[index].split];
+			break;
+		}
+		parent = child;
+	}
+
+	// sequences of similar faces can degrade the tree into a list: when the new point ends up too deep
+	// we rebalance the highest subtree on its path in which one child holds most of the points
+	int balanced = 0;
+	for(int n=nodes.size(); n; n >>= 1) balanced++;
+	if((int)path.size() < 2*balanced) return index;
+	path.push_back(index);
+	FOR(i, path.size()-1)
+	{
+		if(nodes[path[i+1]].size*10 <= nodes[path[i]].size*7) continue;
+		std::vector<int> indices;
+		Collect(path[i], indices);
+		int subtree = Build(&indices[0], indices.size());
+		if(!i) root = subtree;
+		else if(nodes[path[i-1]].left == path[i]) nodes[path[i-1]].left = subtree;
+		else nodes[path[i-1]].right = subtree;
+		return index;
+	}
+	Rebuild();
+	return index;
+}
+
+void FaceIndex::Insert(const float *points, int count)
+{
+	if(count <= 0) return;
+	// large batches are cheaper to add in one go and rebalance than one by one
+	if(count >= (int)nodes.size())
+	{
+		this->points.insert(this->points.end(), points, points + count*dim);
+		Node node;
+		node.split = 0;
+		node.value = 0;
+		node.left = node.right = -1;
+		node.size = 1;
+		nodes.resize(nodes.size() + count, node);
+		Rebuild();
+		return;
+	}
+	FOR(i, count) Insert(points + i*dim);
+}
+
+void FaceIndex::Search(int node, const float *query, float scale, int &nearest, float &distance) const
+{
+	if(node == -1) return;
+	const float *p = &points[node*dim];
+	float d = 0;
+	// partial distance: we stop accumulating as soon as we are further than the current best
+	for(int i=0; i<dim && d < distance; i++)
+	{
+		float v = query[i] - p[i];
+		d += v*v;
+	}
+	if(d < distance)
+	{
+		distance = d;
+		nearest = node;
+	}
+	const Node &n = nodes[node];
+	float diff = query[n.split] - n.value;
+	Search(diff < 0 ? n.left : n.right, query, scale, nearest, distance);
+	if(diff*diff*scale < distance) Search(diff < 0 ? n.right : n.left, query, scale, nearest, distance);
+}
+
+int FaceIndex::Nearest(const float *query, float *distance) const
+{
+	int nearest = -1;
+	float dist = FLT_MAX;
+	Search(root, query, (1.f + eps)*(1.f + eps), nearest, dist);
+	if(distance) *distance = dist;
+	return nearest;
+}
+
+void FaceIndex::Nearest(const float *queries, int count, int *nearest, float *distances) const
+{
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16) if(count >= PARALLEL_SIZE)
+#endif
+	for(int i=0; i<count; i++)
+	{
+		nearest[i] = Nearest(queries + i*dim, distances ? distances + i : 0);
+	}
+}
@@ -0,0 +1,64 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License,
+version 3 as published by the Free Software Foundation.
+
+This library is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#ifndef _FACE_INDEX_H_
+#define _FACE_INDEX_H_
+
+#include <vector>
+
+// nearest neighbour index over the face projections
+// points are stored contiguously (count x dim) and organised in a kd-tree where every node holds one point,
+// insertions descend the tree and hang the new point under a leaf, when this makes the tree too deep the
+// largest unbalanced subtree along the way is rebuilt (balanced on the dimension of largest spread)
+// queries are read-only and can run concurrently, eps > 0 allows (1+eps)-approximate answers
+class FaceIndex
+{
+	struct Node
+	{
+		int split; // dimension along which the children are separated
+		float value;
+		int left, right;
+		int size; // number of points in the subtree
+	};
+
+	int dim;
+	std::vector<float> points;
+	std::vector<Node> nodes; // nodes[i] holds points[i*dim]
+	int root;
+
+	int Build(int *indices, int count);
+	void Collect(int node, std::vector<int> &indices) const;
+	void Search(int node, const float *query, float scale, int &nearest, float &distance) const;
+
+public:
+	float eps;
+
+	FaceIndex(int dim=0);
+	void Clear(int dim);
+	void Rebuild();
+	int Insert(const float *point);
+	void Insert(const float *points, int count);
+	int Nearest(const float *query, float *distance=0) const;
+	void Nearest(const float *queries, int count, int *nearest, float *distances=0) const;
+
+	int GetCount() const {return nodes.size();};
+	int GetDim() const {return dim;};
+	const float *Point(int i) const {return &points[i*dim];};
+};
+
+#endif // _FACE_INDEX_H_
@@ -62,6 +62,7 @@ HEADERS +=	PCAFaces.h \
 			basicOpenCV.h \
 			cameraGrabber.h \
 			eigenFaces.h \
+			faceIndex.h \
 			projector.h \
 			widget.h
 
@@ -70,5 +71,6 @@ SOURCES += 	PCAFaces.cpp \
 			basicOpenCV.cpp \
 			cameraGrabber.cpp \
 			eigenFaces.cpp \
+			faceIndex.cpp \
 			projector.cpp \
 			widget.cpp
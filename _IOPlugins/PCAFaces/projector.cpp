@@ -31,7 +31,7 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 using namespace std;
 
 Projector::Projector( Ui::PCAFacesDialog *options )
-	: options(options), image(0), display(0), samples(0), start(QPoint(-1,-1)), grabber(0), bFromWebcam(true), timerID(0)
+	: options(options), image(0), display(0), samples(0), start(QPoint(-1,-1)), grabber(0), bFromWebcam(true), timerID(0), learned(0)
 {
 	imageWindow = new QNamedWindow("image", false, options->imageWidget);
 	samplesWindow = new QNamedWindow("samples", false, options->dataWidget);
@@ -114,9 +114,14 @@ pair<vector<fvec>,ivec> Projector::GetData()
 
 	// we want at least one class to be 0, to avoid problems afterwards
 	//FixLabels(sm);
-	// we do the data projection here
-	EigenFaces eig;
-	eig.Learn(sm.GetSamples(), sm.GetLabels());
+	// we do the data projection here, the model is kept to recognize the faces added afterwards
+	// faces added one at a time are projected on the current basis, which is learned again
+	// only when the dataset has changed otherwise or has doubled since it was learned
+	if(!learned || sm.GetCount() > 2*learned)
+	{
+		eig.Learn(sm.GetSamples(), sm.GetLabels());
+		learned = sm.GetCount();
+	}
 	vector<float *> projections = eig.GetProjections(max(e1,e2)+1, true);
 	if(!projections.size()) return data;
 	// the projections are normalized on a space 0-1, we want to add a bit of edges
@@ -278,6 +283,7 @@ void Projector::DatasetClick(QMouseEvent *event)
 	{
 		sm.RemoveSample(index);
 	}
+	learned = 0;
 	RefreshDataset();
 }
 
@@ -345,6 +351,7 @@ void Projector::DropDataset(QDropEvent *event)
 			if (!file.open(QIODevice::ReadOnly)) return;
 			file.close();
 			sm.Load(filename.toAscii());
+			learned = 0;
 			RefreshDataset();
 		}
 	}
@@ -426,6 +433,12 @@ void Projector::AddImage()
 	if(rect.x+rect.width > image->width) rect.width = image->width - rect.x;
 	if(rect.y+rect.height > image->height) rect.height= image->height - rect.y;
 	sm.AddSample(image, rect);
+	// the new face starts with the class of the closest face in the current projection
+	// and joins the gallery and index of the model without learning the eigenbasis again
+	int last = sm.GetCount()-1;
+	int label = eig.Recognize(sm.GetSample(last));
+	if(label != -1) sm.SetLabel(last, label);
+	if(learned) eig.Add(vector<IplImage *>(1, sm.GetSample(last)), vector<int>(1, sm.GetLabel(last)));
 	RefreshDataset();
 }
 
@@ -438,6 +451,7 @@ void Projector::LoadDataset()
 	if (!file.open(QIODevice::ReadOnly)) return;
 	file.close();
 	sm.Load(filename.toAscii());
+	learned = 0;
 	RefreshDataset();
 }
 
@@ -464,12 +478,14 @@ void Projector::AddDataset()
 	SampleManager newSm;
 	newSm.Load(filename.toAscii());
 	sm.AddSamples(newSm);
+	learned = 0;
 	RefreshDataset();
 }
 
 void Projector::ClearDataset()
 {
 	sm.Clear();
+	learned = 0;
 	RefreshDataset();
 }
 
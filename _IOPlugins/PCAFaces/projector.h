@@ -44,6 +44,7 @@ class Projector : public QObject
 	CameraGrabber *grabber;
 	QMutex imageMutex;
 	int timerID;
+	int learned; // samples the eigenbasis was learned on, 0 when it must be learned again
 
 	void mouseCallBack(int x,int y,int flags,int params);
 
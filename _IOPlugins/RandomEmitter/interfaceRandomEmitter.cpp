@@ -17,60 +17,110 @@ License along with this library; if not, write to the Free
 Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 *********************************************************************/
 #include "interfaceRandomEmitter.h"
-#include <QDebug>
+#include <algorithm>
 using namespace std;
 
+#define REPORT_PERIOD 1000 // ms
+
 RandomEmitter::RandomEmitter()
-: ThreadID(0)
+: gui(0), guiDialog(0), generator(0), ingested(0), lastIngested(0), lastSent(0), lastReport(0)
 {
+	qRegisterMetaType<SampleBatch>("SampleBatch");
+	qRegisterMetaType<ivec>("ivec");
+	qRegisterMetaType< std::vector<ipair> >("std::vector<ipair>");
+	connect(&reportTimer, SIGNAL(timeout()), this, SLOT(Report()));
 }
 
 RandomEmitter::~RandomEmitter()
 {
 	Stop();
+	DEL(generator);
+	if(gui && guiDialog) guiDialog->hide();
 }
 
 void RandomEmitter::Start()
 {
-	qDebug() << "Starting threadID: " << ThreadID;
-	if(ThreadID) return; // we're already running
-	ThreadID = startTimer(100);
+	if(!generator)
+	{
+		gui = new Ui::RandomEmitterDialog();
+		gui->setupUi(guiDialog = new QDialog());
+		connect(gui->restartButton, SIGNAL(clicked()), this, SLOT(Restart()));
+		connect(gui->closeButton, SIGNAL(clicked()), this, SLOT(Closing()));
+		generator = new LoadGenerator();
+		// the batches are emitted from the generator thread and reach the application through a queued connection
+		connect(generator, SIGNAL(Batch(SampleBatch, ivec, std::vector<ipair>)), this, SIGNAL(AppendData(SampleBatch, ivec, std::vector<ipair>)));
+	}
+	guiDialog->show();
+	Restart();
 }
 
 void RandomEmitter::Stop()
 {
-	qDebug() << "Stopping threadID: " << ThreadID;
-	if(!ThreadID) return; // we're not running anymore
-	killTimer(ThreadID);
-	ThreadID = 0;
+	reportTimer.stop();
+	if(generator) generator->Stop();
+	emit SetCapacity(0);
+	if(guiDialog) guiDialog->hide();
 }
 
-void RandomEmitter::timerEvent(QTimerEvent *event)
+void RandomEmitter::Closing()
 {
-	// we generate a bunch of samples
-	vector<fvec> samples;
-	ivec labels;
-	int count = 200;
-	samples.resize(count*2);
-	labels.resize(count*2);
+	emit(Done(this));
+}
 
-	fvec sample;
-	sample.resize(2);
-	FOR(i, count)
-	{
-		sample[0] = (rand() / (float)RAND_MAX -0.5) * 0.7;
-		sample[1] = (rand() / (float)RAND_MAX -0.5) * 0.7;
-		samples[i] = sample;
-		labels[i] = 0;
-	}
-	FOR(i, count)
+void RandomEmitter::Restart()
+{
+	if(!generator) return;
+	LoadParameters params;
+	params.rate = gui->rateSpin->value();
+	params.dim = gui->dimSpin->value();
+	params.classes = gui->classSpin->value();
+	params.spread = gui->spreadSpin->value();
+	params.drift = gui->driftSpin->value();
+	params.trajectoryLength = gui->trajectorySpin->value();
+	params.window = gui->windowSpin->value();
+	emit SetCapacity(gui->capacitySpin->value());
+	latencies.clear();
+	ingested = lastIngested = lastSent = lastReport = 0;
+	generator->Start(params);
+	reportTimer.start(REPORT_PERIOD);
+}
+
+void RandomEmitter::DataAppended(SampleBatch samples)
+{
+	qint64 latency;
+	if(!generator || !generator->Acknowledge(samples, latency)) return; // not one of ours
+	latencies.push_back(latency/1000.f);
+	ingested += samples.count;
+}
+
+void RandomEmitter::Report()
+{
+	if(!generator) return;
+	qint64 now = generator->Elapsed(), sent = generator->Sent();
+	float seconds = max(1e-6f, (now - lastReport)/1e6f);
+	float sentRate = (sent - lastSent)/seconds;
+	float ingestRate = (ingested - lastIngested)/seconds;
+	lastReport = now;
+	lastSent = sent;
+	lastIngested = ingested;
+	QString text = QString("sent: %1 samples/s\ningested: %2 samples/s").arg(sentRate, 0, 'f', 0).arg(ingestRate, 0, 'f', 0);
+	if(latencies.size())
 	{
-		sample[0] = (rand() / (float)RAND_MAX-0.5) * 0.7 + 0.3;
-		sample[1] = (rand() / (float)RAND_MAX-0.5) * 0.7 + 0.3;
-		samples[count + i] = sample;
-		labels[count + i] = 1;
+		// latency percentiles of the batches ingested since the last report
+		int count = latencies.size();
+		float percentiles[] = {0.5f, 0.95f, 0.99f};
+		float values[3];
+		FOR(i, 3)
+		{
+			int index = min(count-1, (int)(percentiles[i]*count));
+			nth_element(latencies.begin(), latencies.begin()+index, latencies.end());
+			values[i] = latencies[index];
+		}
+		float maxLatency = *max_element(latencies.begin(), latencies.end());
+		text += QString("\nlatency (ms): p50 %1, p95 %2, p99 %3, max %4").arg(values[0], 0, 'f', 2).arg(values[1], 0, 'f', 2).arg(values[2], 0, 'f', 2).arg(maxLatency, 0, 'f', 2);
+		latencies.clear();
 	}
-	emit(SetData(samples, labels, vector<ipair>()));
+	if(gui) gui->statsLabel->setText(text);
 }
 
 void RandomEmitter::FetchResults(std::vector<fvec> results)
@@ -21,7 +21,9 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 
 #include <vector>
 #include <interfaces.h>
-#include <QTimerEvent>
+#include <QTimer>
+#include "loadGenerator.h"
+#include "ui_RandomEmitter.h"
 
 class RandomEmitter : public QObject, public InputOutputInterface
 {
@@ -36,6 +38,9 @@ public:
 	const char* SetDataSignal() {return SIGNAL(SetData(std::vector<fvec>, ivec, std::vector<ipair>));}
 	const char* FetchResultsSlot() {return SLOT(FetchResults(std::vector<fvec>));}
 	const char* DoneSignal() {return SIGNAL(Done(QObject *));}
+	const char* AppendDataSignal() {return SIGNAL(AppendData(SampleBatch, ivec, std::vector<ipair>));}
+	const char* DataAppendedSlot() {return SLOT(DataAppended(SampleBatch));}
+	const char* SetCapacitySignal() {return SIGNAL(SetCapacity(int));}
 	QObject *object(){return this;};
 	QString GetName(){return "Random Emitter";};
 
@@ -44,8 +49,13 @@ public:
 
 	RandomEmitter();
 	~RandomEmitter();
-	int ThreadID;
-	void timerEvent(QTimerEvent *event);
+private:
+	Ui::RandomEmitterDialog *gui;
+	QDialog *guiDialog;
+	LoadGenerator *generator;
+	QTimer reportTimer;
+	fvec latencies; // ingest latencies (ms) since the last report
+	qint64 ingested, lastIngested, lastSent, lastReport;
 signals:
 	void Done(QObject *);
 	void SetData(std::vector<fvec> samples, ivec labels, std::vector<ipair> trajectories);
@@ -54,8 +64,14 @@ signals:
 	void QueryDynamical(std::vector<fvec> samples);
 	void QueryClusterer(std::vector<fvec> samples);
 	void QueryMaximizer(std::vector<fvec> samples);
+	void AppendData(SampleBatch samples, ivec labels, std::vector<ipair> trajectories);
+	void SetCapacity(int capacity);
 public slots:
 	void FetchResults(std::vector<fvec> results);
+	void DataAppended(SampleBatch samples);
+	void Restart();
+	void Report();
+	void Closing();
 
 };
 
@@ -0,0 +1,192 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License,
+version 3 as published by the Free Software Foundation.
+
+This library is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#include <public.h>
+#include "loadGenerator.h"
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+using namespace std;
+
+#define BATCH_PERIOD 10 // ms
+#define MAX_BACKLOG 1.0 // seconds of samples, the generator skips ahead when it falls further behind
+
+LoadGenerator::LoadGenerator(QObject *parent)
+	: QThread(parent), bRunning(false), sent(0), seed(2463534242u)
+{
+}
+
+LoadGenerator::~LoadGenerator()
+{
+	Stop();
+}
+
+void LoadGenerator::Start(const LoadParameters &params)
+{
+	Stop();
+	this->params = params;
+	this->params.dim = max(1, params.dim);
+	this->params.classes = max(1, params.classes);
+	this->params.rate = max(1e-3, params.rate);
+	seed = 2463534242u ^ (u32)rand();
+	if(!seed) seed = 1;
+	int dim = this->params.dim, classes = this->params.classes;
+	centers.resize(classes*dim);
+	velocities.resize(classes*dim);
+	FOR(c, classes)
+	{
+		float norm = 0;
+		FOR(d, dim)
+		{
+			centers[c*dim + d] = Uniform() - 0.5f;
+			velocities[c*dim + d] = Normal();
+			norm += velocities[c*dim + d]*velocities[c*dim + d];
+		}
+		norm = norm > 0 ? sqrtf(norm) : 1.f;
+		FOR(d, dim) velocities[c*dim + d] *= this->params.drift / norm;
+	}
+	window.acquire(window.available());
+	window.release(this->params.window);
+	inflight.clear();
+	sent = 0;
+	bRunning = true;
+	clock.start();
+	start();
+}
+
+void LoadGenerator::Stop()
+{
+	if(!isRunning()) return;
+	bRunning = false;
+	wait();
+}
+
+bool LoadGenerator::Acknowledge(const SampleBatch &samples, qint64 &latency)
+{
+	{
+		QMutexLocker lock(&inflightMutex);
+		if(!inflight.remove(samples.stamp)) return false;
+	}
+	latency = (clock.nsecsElapsed() - samples.stamp)/1000;
+	if(params.window) window.release();
+	return true;
+}
+
+float LoadGenerator::Uniform()
+{
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return (seed >> 8) * (1.f/16777216.f);
+}
+
+float LoadGenerator::Normal()
+{
+	// Box-Muller, the second value is dropped
+	float u = max(Uniform(), 1e-7f), v = Uniform();
+	return sqrtf(-2.f*logf(u)) * cosf(2.f*3.14159265f*v);
+}
+
+void LoadGenerator::Generate(SampleBatch &samples, ivec &labels, std::vector<ipair> &trajectories, float dt)
+{
+	int dim = params.dim, classes = params.classes;
+	// the centers drift and bounce off the borders of the [-0.5, 0.5] hypercube
+	FOR(i, centers.size())
+	{
+		centers[i] += velocities[i]*dt;
+		if(centers[i] > 0.5f || centers[i] < -0.5f)
+		{
+			velocities[i] = -velocities[i];
+			centers[i] = max(-0.5f, min(0.5f, centers[i]));
+		}
+	}
+	int length = params.trajectoryLength;
+	for(int i=0; i<samples.count;)
+	{
+		int c = min(classes-1, (int)(Uniform()*classes));
+		const float *center = &centers[c*dim];
+		float *sample = samples.Sample(i);
+		if(!length)
+		{
+			FOR(d, dim) sample[d] = center[d] + params.spread*Normal();
+			labels[i++] = c;
+			continue;
+		}
+		// trajectories start away from their center and converge to it
+		FOR(d, dim) sample[d] = center[d] + 3*params.spread*Normal();
+		int last = min(samples.count, i+length) - 1;
+		labels[i] = c;
+		for(int j=i+1; j<=last; j++)
+		{
+			const float *previous = samples.Sample(j-1);
+			float *current = samples.Sample(j);
+			FOR(d, dim) current[d] = previous[d] + (center[d] - previous[d])*(4.f/length) + 0.1f*params.spread*Normal();
+			labels[j] = c;
+		}
+		trajectories.push_back(ipair(i, last));
+		i = last+1;
+	}
+}
+
+void LoadGenerator::run()
+{
+	double period = max((double)BATCH_PERIOD, 1000./params.rate); // ms between two batches
+	qint64 previous = 0, scheduled = 0;
+	for(int tick=1; bRunning; tick++)
+	{
+		// sleep until the next batch is due
+		qint64 due = (qint64)(tick*period*1000);
+		qint64 now = Elapsed();
+		while(bRunning && now < due)
+		{
+			usleep(min(due - now, (qint64)50000));
+			now = Elapsed();
+		}
+		if(!bRunning) break;
+		// trajectories are only sent whole
+		int length = params.trajectoryLength;
+		qint64 backlog = (qint64)(params.rate*now/1e6) - scheduled;
+		qint64 maxBacklog = max((qint64)(params.rate*MAX_BACKLOG), (qint64)max(1, length));
+		if(backlog > maxBacklog)
+		{
+			scheduled += backlog - maxBacklog;
+			backlog = maxBacklog;
+		}
+		int count = length ? backlog/length*length : backlog;
+		if(count <= 0) continue;
+		if(params.window)
+		{
+			while(bRunning && !window.tryAcquire(1, 50));
+			if(!bRunning) break;
+		}
+		SampleBatch samples(SampleBatch::CLASSIFIER, count, params.dim);
+		ivec labels(count);
+		std::vector<ipair> trajectories;
+		Generate(samples, labels, trajectories, (now - previous)/1e6f);
+		previous = now;
+		samples.stamp = clock.nsecsElapsed();
+		{
+			QMutexLocker lock(&inflightMutex);
+			inflight.insert(samples.stamp);
+			sent += count;
+		}
+		scheduled += count;
+		emit Batch(samples, labels, trajectories);
+	}
+}
@@ -0,0 +1,79 @@
+/*********************************************************************
+MLDemos: A User-Friendly visualization toolkit for machine learning
+Copyright (C) 2010  Basilio Noris
+Contact: mldemos@b4silio.com
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public License,
+version 3 as published by the Free Software Foundation.
+
+This library is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free
+Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*********************************************************************/
+#ifndef _LOAD_GENERATOR_H_
+#define _LOAD_GENERATOR_H_
+
+#include <vector>
+#include <QThread>
+#include <QMutex>
+#include <QSemaphore>
+#include <QElapsedTimer>
+#include <QSet>
+#include <sampleBatch.h>
+
+struct LoadParameters
+{
+	double rate; // samples per second
+	int dim;
+	int classes; // one gaussian per class
+	float spread; // standard deviation of the classes
+	float drift; // speed of the class centers (units per second)
+	int trajectoryLength; // 0: independent samples, otherwise the samples come in trajectories converging to their class center
+	int window; // batches sent but not yet ingested before the generator waits, 0 never waits
+	LoadParameters() : rate(4000), dim(2), classes(2), spread(0.1f), drift(0), trajectoryLength(0), window(8) {};
+};
+
+// generates a stream of labelled samples on its own thread, sent in batches of BATCH_PERIOD ms (or single samples at lower rates)
+// the batches are stamped with the generator clock, the receiver hands them back through Acknowledge once they have been ingested
+class LoadGenerator : public QThread
+{
+	Q_OBJECT
+public:
+	LoadGenerator(QObject *parent=0);
+	~LoadGenerator();
+	void Start(const LoadParameters &params);
+	void Stop();
+	// returns false if the batch was not sent by this generator, otherwise the time since it was sent (in microseconds)
+	bool Acknowledge(const SampleBatch &samples, qint64 &latency);
+	qint64 Sent(){QMutexLocker lock(&inflightMutex); return sent;}; // samples sent since the start
+	qint64 Elapsed(){return clock.nsecsElapsed()/1000;}; // microseconds since the start
+
+signals:
+	void Batch(SampleBatch samples, ivec labels, std::vector<ipair> trajectories);
+
+protected:
+	void run();
+
+private:
+	void Generate(SampleBatch &samples, ivec &labels, std::vector<ipair> &trajectories, float dt);
+	float Uniform();
+	float Normal();
+
+	LoadParameters params;
+	volatile bool bRunning;
+	QElapsedTimer clock;
+	QSemaphore window;
+	QMutex inflightMutex;
+	QSet<qint64> inflight; // stamps of the batches not yet acknowledged
+	qint64 sent; // guarded by inflightMutex as well, it is read from the GUI thread
+	u32 seed; // xorshift state, the thread does not share rand()
+	fvec centers, velocities; // classes x dim
+};
+
+#endif // _LOAD_GENERATOR_H_
@@ -11,6 +11,10 @@ include($$MLPATH/MLDemos_variables.pri)
 ###########################
 # Source Files            #
 ###########################
-HEADERS +=	interfaceRandomEmitter.h
+FORMS += RandomEmitter.ui
 
-SOURCES += 	interfaceRandomEmitter.cpp
+HEADERS +=	interfaceRandomEmitter.h \
+	loadGenerator.h
+
+SOURCES += 	interfaceRandomEmitter.cpp \
+	loadGenerator.cpp
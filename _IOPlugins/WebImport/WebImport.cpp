@@ -21,8 +21,10 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 
 Q_EXPORT_PLUGIN2(IO_WebImport, WebImport)
 
+#define PREVIEW_ROWS 1000
+
 WebImport::WebImport()
-: guiDialog(0)
+: gui(0), guiDialog(0), inputParser(0)
 {
 }
 
@@ -59,13 +61,21 @@ void WebImport::Updating()
 {
     QString filename = QFileDialog::getOpenFileName(NULL, tr("Load Data"), QDir::currentPath(), tr("dataset files (*.data *.csv);;All files (*.*)"));
     if(filename.isEmpty()) return;
-    inputParser->parse(filename.toStdString().c_str());
+    QProgressDialog progress(tr("Loading %1").arg(QFileInfo(filename).fileName()), QString(), 0, 100, guiDialog);
+    progress.setWindowModality(Qt::WindowModal);
+    connect(inputParser, SIGNAL(Progress(int)), &progress, SLOT(setValue(int)));
+    gui->loadFile->setEnabled(false);
+    bool bParsed = inputParser->parse(QFile::encodeName(filename).constData());
+    gui->loadFile->setEnabled(true);
+    if(!bParsed) return;
     pair<vector<fvec>,ivec> data = inputParser->getData(NUMERIC_TYPES);
     std::cout << "Dataset extracted" << std::endl;
     if(data.first.size() < 2) return;
-    gui->tableWidget->setRowCount(data.first.size());
+    // large files are only previewed
+    int rows = min((int)data.first.size(), PREVIEW_ROWS);
+    gui->tableWidget->setRowCount(rows);
     gui->tableWidget->setColumnCount(data.first.at(0).size()+1);
-    for(size_t r = 0; r < data.first.size(); r++)
+    for(int r = 0; r < rows; r++)
     {
         for(size_t c = 0; c < data.first.at(r).size(); c++)
         {
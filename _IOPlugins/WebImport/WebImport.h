@@ -29,6 +29,8 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 #include <interfaces.h>
 #include "ui_WebImport.h"
 #include <QFileDialog>
+#include <QProgressDialog>
+#include <QFileInfo>
 #include <QTableView>
 #include <QDebug>
 
@@ -17,216 +17,422 @@ License along with this library; if not, write to the Free
 Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 *********************************************************************/
 #include <QDebug>
+#include <QFile>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
 #include "parser.h"
 
-/* CSVRow stuff */
+#define CHUNK_SIZE      (4<<20) // bytes of whole lines tokenized by each job
+#define TYPE_SAMPLE     1000    // rows used to infer the column types
+#define PROGRESS_CHUNKS 16      // chunks tokenized between two progress reports
 
-std::istream& operator>>(std::istream& str,CSVRow& data)
-{
-    data.readNextRow(str);
-    return str;
-}
+/* tokenizer stuff */
 
-std::string const& CSVRow::operator[](std::size_t index) const
-{
-    return m_data[index];
-}
-std::string CSVRow::at(size_t column) const
+struct CSVCell
 {
-    return m_data.at(column);
-}
-std::string CSVRow::getFirstCell() const
-{
-	if(!m_data.size()) return string();
-	return m_data.at(0);
-}
-std::string CSVRow::getLastCell() const
+    const char *begin, *end;
+    bool isMissing() const {return end-begin == 1 && *begin == MISSING_VALUE[0];};
+    string toString() const {return string(begin, end);};
+};
+
+static inline bool isSpace(char c)
 {
-	if(!m_data.size()) return string();
-	return m_data.back();
+    return c == ' ' || c == '\t' || c == '\r';
 }
-std::vector<std::string> CSVRow::getParsedLine() const
+
+// end of the line starting at begin (the position of its '\n' or end)
+static inline const char *lineEnd(const char *begin, const char *end)
 {
-    return m_data;
+    const char *eol = (const char *)memchr(begin, '\n', end-begin);
+    return eol ? eol : end;
 }
-std::size_t CSVRow::size() const
+
+static bool isBlank(const char *begin, const char *end)
 {
-    return m_data.size();
+    for(; begin<end; begin++) if(!isSpace(*begin)) return false;
+    return true;
 }
 
-void CSVRow::readNextRow(std::istream& str)
+// splits the line on commas, cells are trimmed of the surrounding whitespace
+static void splitLine(const char *begin, const char *end, vector<CSVCell> &cells)
 {
-    // read line from file
-    std::string line;
-    std::getline(str,line);
-
-    // convert to stream
-    std::stringstream lineStream(line);
-    std::string cell;
-
-    // update row (array) content
-    m_data.clear();
-    while(std::getline(lineStream,cell,','))
+    cells.clear();
+    while(true)
     {
-        m_data.push_back(cell);
+        const char *comma = (const char *)memchr(begin, ',', end-begin);
+        const char *cellEnd = comma ? comma : end;
+        CSVCell cell = {begin, cellEnd};
+        while(cell.begin < cell.end && isSpace(*cell.begin)) cell.begin++;
+        while(cell.end > cell.begin && isSpace(cell.end[-1])) cell.end--;
+        cells.push_back(cell);
+        if(!comma) break;
+        begin = comma+1;
     }
 }
 
-unsigned int getType(string input)
+bool CSVParser::parseNumber(const char *s, const char *end, float &value, bool *integer)
 {
-    if (is<unsigned int>(input))    return UNSIGNED_INT_TYPE;
-    if (is<int>(input))             return INT_TYPE;
-    if (is<float>(input))           return FLOAT_TYPE;
-    if (is<char>(input))            return CHAR_TYPE;
-    if (is<string>(input))          return STRING_TYPE;
-                                    return UNKNOWN_TYPE;
-}
-
-/* CSVIterator stuff */
-
-CSVIterator::CSVIterator(std::istream& str)  :m_str(str.good()?&str:NULL)
-{
-    ++(*this);
+    static const double powers[] = {1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9,1e10,1e11,1e12,1e13,1e14,1e15,1e16,1e17,1e18,1e19,1e20,1e21,1e22};
+    if(s >= end) return false;
+    bool negative = false;
+    if(*s == '+' || *s == '-') negative = *s++ == '-';
+    double mantissa = 0;
+    int exponent = 0, digits = 0;
+    bool isInteger = true;
+    // past 18 significant digits the remaining ones cannot change a float
+    for(; s<end && *s >= '0' && *s <= '9'; s++, digits++)
+    {
+        if(mantissa < 1e18) mantissa = mantissa*10 + (*s - '0');
+        else exponent++;
+    }
+    if(s<end && *s == '.')
+    {
+        isInteger = false;
+        for(s++; s<end && *s >= '0' && *s <= '9'; s++, digits++)
+        {
+            if(mantissa < 1e18)
+            {
+                mantissa = mantissa*10 + (*s - '0');
+                exponent--;
+            }
+        }
+    }
+    if(!digits) return false;
+    if(s<end && (*s == 'e' || *s == 'E'))
+    {
+        isInteger = false;
+        s++;
+        bool negativeExponent = false;
+        if(s<end && (*s == '+' || *s == '-')) negativeExponent = *s++ == '-';
+        if(s == end || *s < '0' || *s > '9') return false;
+        int e = 0;
+        for(; s<end && *s >= '0' && *s <= '9'; s++) if(e < 10000) e = e*10 + (*s - '0');
+        exponent += negativeExponent ? -e : e;
+    }
+    if(s != end) return false;
+    double result = mantissa;
+    if(exponent > 0) result *= exponent <= 22 ? powers[exponent] : pow(10., exponent);
+    else if(exponent < 0) result /= -exponent <= 22 ? powers[-exponent] : pow(10., -exponent);
+    value = (float)(negative ? -result : result);
+    if(integer) *integer = isInteger;
+    return true;
 }
 
-CSVIterator::CSVIterator():m_str(NULL)
+unsigned int CSVParser::getType(const char *begin, const char *end)
 {
+    if(begin == end) return UNKNOWN_TYPE;
+    float value;
+    bool integer;
+    if(parseNumber(begin, end, value, &integer))
+    {
+        if(!integer) return FLOAT_TYPE;
+        return *begin == '-' ? INT_TYPE : UNSIGNED_INT_TYPE;
+    }
+    return end-begin == 1 ? CHAR_TYPE : STRING_TYPE;
 }
 
-bool CSVIterator::eof()
-{
-    return (m_str == NULL);
-}
+/* CSVParser stuff */
 
-// Pre Increment
-CSVIterator& CSVIterator::operator++()
+// distinct values of a non-numeric column, indexed in order of appearance
+struct CSVDictionary
 {
-    if (m_str)
+    map<string,int> indices;
+    vector<string> values;
+    int index(const CSVCell &cell)
     {
-        (*m_str) >> m_row;
-        m_str = m_str->good()?m_str:NULL;
+        // columns of labels rarely have more than a handful of values, they are looked up without allocating
+        size_t length = cell.end - cell.begin;
+        if(values.size() <= 16)
+        {
+            FOR(i, values.size())
+            {
+                if(values[i].size() == length && !memcmp(values[i].data(), cell.begin, length)) return i;
+            }
+        }
+        pair<map<string,int>::iterator,bool> ret = indices.insert(pair<string,int>(cell.toString(), values.size()));
+        if(ret.second) values.push_back(ret.first->first);
+        return ret.first->second;
     }
-    return *this;
-}
-// Post increment
-CSVIterator CSVIterator::operator++(int)
-{
-    CSVIterator tmp(*this);
-    ++(*this);
-    return tmp;
-}
+};
 
-CSVRow const& CSVIterator::operator*()   const
+// tokenizer state of one chunk of lines, its dictionaries are merged once every chunk is done
+struct CSVChunk
 {
-    return m_row;
-}
+    const char *begin, *end;
+    size_t start, count; // rows
+    vector<CSVDictionary> dictionaries; // one per column (the last one holds the class labels)
+    vector<size_t> missing;
+};
 
-CSVRow const* CSVIterator::operator->()  const
+// missing cells are read as 0, non-numeric cells get the index of their value in the chunk dictionary
+static void tokenize(CSVChunk &chunk, const vector<bool> &bNumeric, float *values, int *labels)
 {
-    return &m_row;
+    size_t dim = bNumeric.size()-1;
+    vector<CSVCell> cells;
+    chunk.dictionaries.resize(dim+1);
+    size_t row = chunk.start;
+    for(const char *line = chunk.begin; line < chunk.end;)
+    {
+        const char *eol = lineEnd(line, chunk.end);
+        if(isBlank(line, eol))
+        {
+            line = eol+1;
+            continue;
+        }
+        splitLine(line, eol, cells);
+        // the label is the last cell, short rows miss their last inputs
+        float *sample = values + row*dim;
+        size_t inputs = min(dim, cells.size()-1);
+        bool bMissing = inputs < dim;
+        FOR(j, dim)
+        {
+            // non-numeric cells without a value are marked with -1 until the indices are merged
+            sample[j] = bNumeric[j] ? 0 : -1;
+            if(j >= inputs) continue;
+            if(cells[j].isMissing()) bMissing = true;
+            else if(!bNumeric[j]) sample[j] = (float)chunk.dictionaries[j].index(cells[j]);
+            else if(!CSVParser::parseNumber(cells[j].begin, cells[j].end, sample[j]))
+            {
+                sample[j] = 0;
+                bMissing = true;
+            }
+        }
+        labels[row] = chunk.dictionaries[dim].index(cells.back());
+        if(bMissing) chunk.missing.push_back(row);
+        row++;
+        line = eol+1;
+    }
 }
 
-bool CSVIterator::operator!=(CSVIterator const& rhs)
+CSVParser::CSVParser()
 {
-    return !((*this) == rhs);
 }
 
-bool CSVIterator::operator==(CSVIterator const& rhs)
+void CSVParser::clear()
 {
-    return ((this == &rhs) || ((this->m_str == NULL) && (rhs.m_str == NULL)));
+    values.clear();
+    labels.clear();
+    inputTypes.clear();
+    header.clear();
+    classNames.clear();
+    missingRows.clear();
 }
 
-/* CSVParser stuff */
-
-void CSVParser::parse(const char* fileName)
+bool CSVParser::parse(const char* fileName)
 {
-    // init
-    file.open(fileName);
-	if(!file.is_open()) return;
-    pair<map<string,unsigned int>::iterator,bool> ret;
-    unsigned int id = 0;
-
-    // Parse CSV input file
-    //for(CSVIterator parser(file); parser != CSVIterator(); ++parser)
-    for(CSVIterator parser(file); !parser.eof(); ++parser)
+    clear();
+    QFile file(fileName);
+    if(!file.open(QIODevice::ReadOnly)) return false;
+    qint64 size = file.size();
+    if(!size) return false;
+    QByteArray contents;
+    const char *text = (const char *)file.map(0, size);
+    if(!text) // e.g. not a regular file
     {
-		if(!parser->size()) continue;
-		// Read output (class) labels
-        ret = classLabels.insert( pair<string,unsigned int>(parser->getLastCell(),id) );
-        if (ret.second == true) id++; // new class found
-		vector<string> parsed = parser->getParsedLine();
-		if(!parsed.size()) continue;
-		// Fill dataset
-		data.push_back(parsed);
+        contents = file.readAll();
+        text = contents.constData();
+        size = contents.size();
     }
+    const char *textEnd = text + size;
+    emit Progress(0);
 
-    cout << "Parsing done, read " << data.size() << " entries" << endl;
-    cout << "Found " << data.at(0).size()-1 << " input labels" << endl;
-    cout << "Found " << id << " class labels" << endl;
+    // Infer the column types from the first rows
+    vector<CSVCell> cells;
+    vector< vector<CSVCell> > sample;
+    const char *dataStart = text;
+    for(const char *line = text; line < textEnd && sample.size() <= TYPE_SAMPLE;)
+    {
+        const char *eol = lineEnd(line, textEnd);
+        if(!isBlank(line, eol))
+        {
+            splitLine(line, eol, cells);
+            sample.push_back(cells);
+            if(sample.size() == 1) dataStart = eol;
+        }
+        line = eol+1;
+    }
+    if(!sample.size()) return false;
+    size_t columns = sample[0].size();
+    size_t dim = columns-1;
+    vector<unsigned int> headerTypes(columns, 0), columnTypes(columns, 0);
+    FOR(j, columns) headerTypes[j] = sample[0][j].isMissing() ? 0 : getType(sample[0][j].begin, sample[0][j].end);
+    for(size_t i=1; i<sample.size(); i++)
+    {
+        FOR(j, min(columns, sample[i].size()))
+        {
+            if(!sample[i][j].isMissing()) columnTypes[j] |= getType(sample[i][j].begin, sample[i][j].end);
+        }
+    }
+    // the first row is a header if it has text where the rest of its column is numeric
+    bool bHeader = false;
+    FOR(j, dim)
+    {
+        if((headerTypes[j] & (CHAR_TYPE | STRING_TYPE)) && columnTypes[j] && !(columnTypes[j] & ~NUMERIC_TYPES)) bHeader = true;
+    }
+    if(bHeader) FOR(j, columns) header.push_back(sample[0][j].toString());
+    else
+    {
+        dataStart = text;
+        FOR(j, columns) columnTypes[j] |= headerTypes[j];
+    }
+    inputTypes.resize(dim);
+    vector<bool> bNumeric(columns, false); // the labels are never numeric
+    FOR(j, dim)
+    {
+        unsigned int types = columnTypes[j];
+        if(!types)
+        {
+            inputTypes[j] = UNKNOWN_TYPE;
+            cout << "WebImport: Warning: Found empty column" << endl;
+        }
+        else if(types & STRING_TYPE) inputTypes[j] = STRING_TYPE;
+        else if(types & CHAR_TYPE) inputTypes[j] = CHAR_TYPE;
+        else if(types & FLOAT_TYPE) inputTypes[j] = FLOAT_TYPE;
+        else if(types & INT_TYPE) inputTypes[j] = INT_TYPE;
+        else inputTypes[j] = UNSIGNED_INT_TYPE;
+        bNumeric[j] = (inputTypes[j] & NUMERIC_TYPES) != 0;
+    }
+    sample.clear();
 
-    // look for data types
-    for(size_t i = 0; i < data.at(1).size(); i++)
+    // Split the file into chunks of whole lines
+    vector<CSVChunk> chunks;
+    for(const char *begin = dataStart; begin < textEnd;)
     {
-        // Look for a non-empty cell
-        // start with 2nd row as first might be input labels
-        size_t testRow = 1;
-        while(data.at(testRow).at(i) == "?") testRow++;
+        const char *end = begin + min((qint64)CHUNK_SIZE, (qint64)(textEnd-begin));
+        if(end < textEnd) end = lineEnd(end, textEnd);
+        CSVChunk chunk;
+        chunk.begin = begin;
+        chunk.end = end;
+        chunk.start = chunk.count = 0;
+        chunks.push_back(chunk);
+        begin = end+1;
+    }
+    int chunkCount = chunks.size();
 
-        // The whole column is missing data...
-        if (testRow == data.size())
+    // Count the rows of each chunk so that they can be written in place
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for(int c=0; c<chunkCount; c++)
+    {
+        size_t count = 0;
+        for(const char *line = chunks[c].begin; line < chunks[c].end;)
         {
-            cout << "WebImport: Warning: Found empty column" << endl;
-            // TODO delete it
+            const char *eol = lineEnd(line, chunks[c].end);
+            if(!isBlank(line, eol)) count++;
+            line = eol+1;
         }
+        chunks[c].count = count;
+    }
+    size_t count = 0;
+    FOR(c, chunkCount)
+    {
+        chunks[c].start = count;
+        count += chunks[c].count;
+    }
+    values.resize(count*dim);
+    labels.resize(count);
+    emit Progress(10);
+
+    float *samples = values.size() ? &values[0] : 0;
+    int *classes = labels.size() ? &labels[0] : 0;
+    // Tokenize the chunks straight into the buffers, a few at a time to report the progress
+    for(int first=0; first<chunkCount; first+=PROGRESS_CHUNKS)
+    {
+        int last = min(chunkCount, first+PROGRESS_CHUNKS);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for(int c=first; c<last; c++) tokenize(chunks[c], bNumeric, samples, classes);
+        emit Progress(10 + 80*last/chunkCount);
+    }
 
-        // save input types
-        inputTypes.insert( pair<unsigned int, unsigned int>(i,getType(data.at(testRow).at(i))));
+    // Give the non-numeric values their index in order of appearance across the whole file
+    vector< vector< vector<int> > > remaps(chunkCount, vector< vector<int> >(columns));
+    FOR(j, columns)
+    {
+        if(j < dim && bNumeric[j]) continue;
+        CSVDictionary dictionary;
+        FOR(c, chunkCount)
+        {
+            const vector<string> &chunkValues = chunks[c].dictionaries[j].values;
+            remaps[c][j].resize(chunkValues.size());
+            FOR(v, chunkValues.size())
+            {
+                CSVCell cell = {chunkValues[v].data(), chunkValues[v].data() + chunkValues[v].size()};
+                remaps[c][j][v] = dictionary.index(cell);
+            }
+        }
+        if(j == dim) classNames = dictionary.values;
     }
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for(int c=0; c<chunkCount; c++)
+    {
+        for(size_t row=chunks[c].start; row<chunks[c].start+chunks[c].count; row++)
+        {
+            FOR(j, dim)
+            {
+                if(bNumeric[j]) continue;
+                float &value = values[row*dim + j];
+                value = value < 0 ? 0 : remaps[c][j][(int)value];
+            }
+            labels[row] = remaps[c][dim][labels[row]];
+        }
+    }
+    FOR(c, chunkCount) missingRows.insert(missingRows.end(), chunks[c].missing.begin(), chunks[c].missing.end());
+    emit Progress(100);
+
+    cout << "Parsing done, read " << labels.size() << " entries" << endl;
+    cout << "Found " << dim << " input labels" << endl;
+    cout << "Found " << classNames.size() << " class labels" << endl;
+    return labels.size() > 0;
 }
 
+// rows with at least one missing or unreadable value (read as 0)
 vector<size_t> CSVParser::getMissingValIndex()
 {
-    vector<size_t> missingValIndex;
-    size_t nbCols = data.at(0).size();
-    for (size_t i = 0; i < data.size(); i++)
-        for (size_t j = 0; j < nbCols; j++)
-            if (data[i][j] == "?") missingValIndex.push_back(i);
-    return missingValIndex;
+    return missingRows;
 }
 
+// removes the input columns whose type is not accepted
 void CSVParser::cleanData(unsigned int acceptedTypes)
 {
-    vector<string>::iterator it;
-    for(size_t i = 0; i < inputTypes.size() - 1; i++)
-        if (!(inputTypes[i]&acceptedTypes)) // data type does not correspond to a requested one
-        {
-            std::cout << "Removing colum " << i << " of type " << inputTypes[i] <<  " ... ";
-            for(size_t j = 0; j < data.size(); j++)
-            {
-                it = data.at(j).begin() + i;
-                data.at(j).erase(it); // delete the column
-            }
-            std::cout << "and matching input reference ...  " ;
-            inputTypes.erase(i--); // delete the input to stay consistant
-            std::cout << "Done" << std::endl;
-        }
+    size_t dim = inputTypes.size();
+    vector<size_t> kept;
+    FOR(j, dim)
+    {
+        if(inputTypes[j] & acceptedTypes) kept.push_back(j);
+        else std::cout << "Removing colum " << j << " of type " << inputTypes[j] << std::endl;
+    }
+    if(kept.size() == dim) return;
+    size_t newDim = kept.size();
+    // rows only ever move towards the front, in place
+    FOR(i, labels.size())
+    {
+        FOR(j, newDim) values[i*newDim + j] = values[i*dim + kept[j]];
+    }
+    values.resize(labels.size()*newDim);
+    vector<unsigned int> types(newDim);
+    FOR(j, newDim) types[j] = inputTypes[kept[j]];
+    inputTypes.swap(types);
+    if(header.size())
+    {
+        vector<string> names(newDim);
+        FOR(j, newDim) names[j] = header[kept[j]];
+        names.push_back(header.back());
+        header.swap(names);
+    }
 }
 
 pair<vector<fvec>,ivec> CSVParser::getData(unsigned int acceptedTypes)
 {
-    vector<fvec> samples(data.size());
-    ivec labels(data.size());
-    fvec sample(data.at(0).size()-1);
-    std::cout << "Cleaning dataset" << std::endl;
     cleanData(acceptedTypes);
-    size_t j;
-    std::cout << "Transfering into container" << std::endl;
-    for(size_t i = 0; i < data.size(); i++)
-    {
-        for(j = 0; j < data.at(i).size()-1; j++) // consider last col as label
-            sample.at(j) = atof(data.at(i).at(j).c_str());
-        samples.at(i) = sample;
-        labels.at(i) = classLabels[data.at(i).at(j)]; // j is one the last col now
-    }
+    size_t dim = inputTypes.size();
+    vector<fvec> samples(labels.size());
+    FOR(i, labels.size()) samples[i] = fvec(values.begin() + i*dim, values.begin() + (i+1)*dim);
     return pair<vector<fvec>,ivec>(samples,labels);
 }
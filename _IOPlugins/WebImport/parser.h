@@ -32,83 +32,51 @@ Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
 
 #define MISSING_VALUE        "?"
 
+#include <QObject>
 #include <map>
-#include <iterator>
-#include <iostream>
-#include <fstream>
-#include <sstream>
 #include <vector>
 #include <string>
 #include <types.h>
 
 using namespace std;
 
-template<typename T>
-bool is(const std::string &s)
-{
-    std::istringstream stream(s);
-    T instance;
-    return ((stream >> instance) && (stream >> std::ws) && stream.eof());
-}
-
-class CSVRow
+// comma separated values reader
+// the file is memory-mapped and tokenized in chunks of whole lines, in parallel
+// the column types are inferred from the first rows, the first row is skipped if it looks like a header
+// the last column holds the class labels, the other ones are stored directly as floats
+// (non-numeric columns are stored as the index of each distinct value, in order of appearance)
+class CSVParser : public QObject
 {
+    Q_OBJECT
 public:
-    std::string const& operator[](std::size_t index) const;
-    std::string at(size_t column) const;
-    std::string getFirstCell() const;
-    std::string getLastCell() const;
-    std::vector<std::string> getParsedLine() const;
-    std::size_t size() const;
-
-    void readNextRow(std::istream& str);
-
-private:
-    std::vector<std::string>    m_data;
-};
-
-class CSVIterator
-{
-public:
-    typedef std::input_iterator_tag     iterator_category;
-    typedef CSVRow                      value_type;
-    typedef std::size_t                 difference_type;
-    typedef CSVRow*                     pointer;
-    typedef CSVRow&                     reference;
-
-    CSVIterator(std::istream& str);
-    CSVIterator();
-
-    bool eof();
-
-    // Pre Increment
-    CSVIterator& operator++();
+    CSVParser();
+    bool parse(const char* fileName);
+    vector<size_t> getMissingValIndex();
+    void cleanData(unsigned int acceptedTypes);
+    pair<vector<fvec>,ivec> getData(unsigned int acceptedTypes = ALL_TYPES);
 
-    // Post increment
-    CSVIterator operator++(int);
+    size_t getCount() const {return labels.size();};
+    size_t getDim() const {return inputTypes.size();};
+    unsigned int getType(size_t column) const {return column < inputTypes.size() ? inputTypes[column] : UNKNOWN_TYPE;};
+    const float *getSample(size_t row) const {return values.size() ? &values[row*inputTypes.size()] : 0;};
+    const ivec &getLabels() const {return labels;};
+    const vector<string> &getHeader() const {return header;};
 
-    CSVRow const& operator*()   const;
-    CSVRow const* operator->()  const;
-    bool operator!=(CSVIterator const& rhs);
-    bool operator==(CSVIterator const& rhs);
+    // locale-independent conversion of [begin, end), returns false if it is not a number
+    static bool parseNumber(const char *begin, const char *end, float &value, bool *integer=0);
+    static unsigned int getType(const char *begin, const char *end);
 
-private:
-    std::istream*       m_str;
-    CSVRow              m_row;
-};
+signals:
+    void Progress(int percent);
 
-class CSVParser
-{
-public:
-    void parse(const char* fileName);
-    vector<size_t> getMissingValIndex();
-    void cleanData(unsigned int acceptedTypes);
-    pair<vector<fvec>,ivec> getData(unsigned int acceptedTypes = ALL_TYPES);
 private:
-    ifstream file;
-    map<string,unsigned int> classLabels;
-    vector<vector<string> > data;
-    map<unsigned int, unsigned int> inputTypes;
+    void clear();
+    fvec values; // count x dim, row-major
+    ivec labels;
+    vector<unsigned int> inputTypes;
+    vector<string> header;
+    vector<string> classNames; // class label of each index
+    vector<size_t> missingRows;
 };
 
 #endif // PARSER_H